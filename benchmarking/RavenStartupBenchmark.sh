@@ -0,0 +1,139 @@
+#!/bin/bash
+
+set -e
+
+# Startup (model construction) benchmark for Raven
+# Generates a synthetic model with many subbasins, HRUs, HRU group members, lateral flush
+# connections and gauges, then times a one-day simulation, so that run time is dominated
+# by parsing and initialization rather than by the simulation itself.
+#
+# usage: ./RavenStartupBenchmark.sh [path to Raven.exe] [number of subbasins] [number of gauges]
+
+ravexe=${1:-$PWD"/_Executables/new/Raven.exe"}
+nSB=${2:-20000}
+nGauges=${3:-2000}
+nHRUperSB=4
+
+if [ ! -e ${ravexe} ] ; then
+  echo "raven file executable "${ravexe}" doesn't exist. BENCHMARKING FAILED."
+  exit 1
+fi
+
+workingdir=$(mktemp -d)
+trap "rm -rf ${workingdir}" EXIT
+cd ${workingdir}
+
+echo "generating startup benchmark model: "${nSB}" subbasins, "$((nSB*nHRUperSB))" HRUs, "${nGauges}" gauges ..."
+
+cat > startup.rvi <<EOF
+:SilentMode
+:BenchmarkingMode
+:SuppressOutput
+:StartDate             2000-01-01 00:00:00
+:Duration              1
+:TimeStep              1.0
+:Method                ORDERED_SERIES
+:SoilModel             SOIL_MULTILAYER 1
+:Routing               ROUTE_NONE
+:CatchmentRoute        ROUTE_DUMP
+:Evaporation           PET_CONSTANT
+:RainSnowFraction      RAINSNOW_DATA
+:DefineHRUGroups       UPLAND LOWLAND
+:HydrologicProcesses
+ :Precipitation        PRECIP_RAVEN     ATMOS_PRECIP  MULTIPLE
+ :Infiltration         INF_RATIONAL     PONDED_WATER  MULTIPLE
+ :LateralFlush         RAVEN_DEFAULT    UPLAND SOIL[0] To LOWLAND SOIL[0]
+ :Baseflow             BASE_LINEAR      SOIL[0]       SURFACE_WATER
+:EndHydrologicProcesses
+EOF
+
+cat > startup.rvp <<EOF
+:SoilClasses
+  :Attributes
+  :Units
+   SOIL_A
+:EndSoilClasses
+:SoilProfiles
+  DEFAULT_P, 1, SOIL_A, 1.0
+:EndSoilProfiles
+:VegetationClasses
+   :Attributes, MAX_HT, MAX_LAI, MAX_LEAF_COND
+        :Units,      m,    none,      mm_per_s
+       VEG_ALL,    0.0,     0.0,           0.0
+:EndVegetationClasses
+:LandUseClasses
+  :Attributes, IMPERM, FOREST_COV
+  :Units     ,   frac,       frac
+       LU_ALL,    0.0,        0.0
+:EndLandUseClasses
+:SoilParameterList
+ :Parameters, POROSITY, BASEFLOW_COEFF
+ :Units     ,     none,            1/d
+   [DEFAULT],      0.4,            0.1
+:EndSoilParameterList
+:LandUseParameterList
+ :Parameters, PARTITION_COEFF
+ :Units     ,            none
+   [DEFAULT],             0.3
+:EndLandUseParameterList
+:AvgAnnualRunoff 500
+EOF
+
+awk -v nSB=${nSB} -v nH=${nHRUperSB} 'BEGIN{
+  print ":SubBasins";
+  print "  :Attributes, NAME, DOWNSTREAM_ID, PROFILE, REACH_LENGTH, GAUGED";
+  print "  :Units     , none,          none,    none,           km,   none";
+  for (p=1;p<=nSB;p++){ print "  " p ", SB" p ", -1, NONE, _AUTO, 0"; }
+  print ":EndSubBasins";
+  print ":HRUs";
+  print "  :Attributes, AREA, ELEVATION, LATITUDE, LONGITUDE, BASIN_ID, LAND_USE_CLASS, VEG_CLASS, SOIL_PROFILE, AQUIFER_PROFILE, TERRAIN_CLASS, SLOPE, ASPECT";
+  print "  :Units     ,  km2,         m,      deg,       deg,     none,           none,      none,         none,            none,          none,   deg,    deg";
+  for (p=1;p<=nSB;p++){ for (j=1;j<=nH;j++){
+    k=(p-1)*nH+j;
+    print "  " k ", 1.0, 500.0, " (45+(p%100)*0.01) ", " (-80-(p%97)*0.01) ", " p ", LU_ALL, VEG_ALL, DEFAULT_P, [NONE], [NONE], 0, 0";
+  }}
+  print ":EndHRUs";
+  print ":HRUGroup UPLAND";
+  for (p=1;p<=nSB;p++){ for (j=1;j<=nH/2;j++){ print "  " (p-1)*nH+j; }}
+  print ":EndHRUGroup";
+  print ":HRUGroup LOWLAND";
+  for (p=1;p<=nSB;p++){ for (j=nH/2+1;j<=nH;j++){ print "  " (p-1)*nH+j; }}
+  print ":EndHRUGroup";
+}' > startup.rvh
+
+awk -v nG=${nGauges} 'BEGIN{
+  for (g=1;g<=nG;g++){
+    print ":Gauge G" g;
+    print "  :Latitude  " (45+(g%100)*0.01);
+    print "  :Longitude " (-80-(g%97)*0.01);
+    print "  :Elevation 500.0";
+    print "  :MultiData";
+    print "    2000-01-01 00:00:00 1.0 3";
+    print "    :Parameters, RAINFALL, SNOWFALL, TEMP_AVE";
+    print "    :Units     ,     mm/d,     mm/d,        C";
+    print "    5.0, 0.0, 10.0";
+    print "    5.0, 0.0, 10.0";
+    print "    5.0, 0.0, 10.0";
+    print "  :EndMultiData";
+    print ":EndGauge";
+  }
+}' > startup.rvt
+
+echo "" > startup.rvc
+
+echo "running "${ravexe}" ..."
+t_start=$(date +%s.%N)
+${ravexe} startup -o ${workingdir}/ > startup.log 2>&1
+t_end=$(date +%s.%N)
+
+if ! grep -q "Successful Simulation" startup.log ; then
+  cat startup.log
+  echo "startup benchmark model failed to run. BENCHMARKING FAILED."
+  exit 3
+fi
+
+echo "-------------------------------------------"
+echo "startup benchmark wall clock time: "$(awk -v a=${t_start} -v b=${t_end} 'BEGIN{printf "%.2f",b-a}')" s"
+echo "-------------------------------------------"
+
+exit 0
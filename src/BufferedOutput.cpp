@@ -0,0 +1,844 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2026 the Raven Development Team
+  ----------------------------------------------------------------
+  Buffered output file stream used for .csv minor output
+  ----------------------------------------------------------------*/
+#include "BufferedOutput.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+bool CBufferedOutputFile::_async_writes=false;
+
+///////////////////////////////////////////////////////////////////
+/// \brief block of output waiting to be written by the background writer
+//
+struct output_block
+{
+  FILE              *fp;      ///< destination file
+  char              *data;    ///< output text (owned by block, deleted once written)
+  size_t             size;    ///< number of bytes in data
+  bool               flush;   ///< true if file should be flushed to disk after write
+  std::atomic<bool> *pFailed; ///< set to true if write fails
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief single background thread which writes output blocks in the order received
+//
+class CAsyncOutputWriter
+{
+private:
+  std::mutex               _mtx;
+  std::condition_variable  _cv_work;  ///< signals new block or stop request
+  std::condition_variable  _cv_done;  ///< signals queue empty
+  std::deque<output_block> _queue;
+  bool                     _busy;     ///< true while a block is being written
+  bool                     _stop;
+  std::thread              _thread;
+
+  CAsyncOutputWriter():_busy(false),_stop(false){}
+
+  void Run()
+  {
+    std::unique_lock<std::mutex> lock(_mtx);
+    while (true)
+    {
+      _cv_work.wait(lock,[this]{return _stop || !_queue.empty();});
+      if (_queue.empty()){break;}//stop requested and nothing left to write
+
+      output_block b=_queue.front();
+      _queue.pop_front();
+      _busy=true;
+      lock.unlock();
+      if (fwrite(b.data,1,b.size,b.fp)!=b.size){*(b.pFailed)=true;}
+      if (b.flush){fflush(b.fp);}
+      delete [] b.data;
+      lock.lock();
+      _busy=false;
+      if (_queue.empty()){_cv_done.notify_all();}
+    }
+  }
+
+public:
+  ~CAsyncOutputWriter()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mtx);
+      _stop=true;
+    }
+    _cv_work.notify_one();
+    if (_thread.joinable()){_thread.join();}
+  }
+  static CAsyncOutputWriter &Get()
+  {
+    static CAsyncOutputWriter writer;
+    return writer;
+  }
+  //////////////////////////////////////////////////////////////////
+  /// \brief queues block for writing; starts writer thread on first use
+  //
+  void Push(const output_block &b)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mtx);
+      if (!_thread.joinable()){_thread=std::thread(&CAsyncOutputWriter::Run,this);}
+      _queue.push_back(b);
+    }
+    _cv_work.notify_one();
+  }
+  //////////////////////////////////////////////////////////////////
+  /// \brief waits until all queued blocks have been written
+  //
+  void Drain()
+  {
+    std::unique_lock<std::mutex> lock(_mtx);
+    _cv_done.wait(lock,[this]{return _queue.empty() && !_busy;});
+  }
+};
+
+//////////////////////////////////////////////////////////////////
+/// \brief CBufferedOutputBuf constructor
+//
+CBufferedOutputBuf::CBufferedOutputBuf()
+{
+  _fp          =NULL;
+  _buffer      =NULL;
+  _async       =false;
+  _filename    ="";
+  _write_failed=false;
+  _last_flush  =std::chrono::steady_clock::now();
+}
+//////////////////////////////////////////////////////////////////
+/// \brief CBufferedOutputBuf destructor - writes any remaining output
+//
+CBufferedOutputBuf::~CBufferedOutputBuf()
+{
+  close();
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief opens file for writing
+/// \param filename [in] name of output file
+/// \param mode [in] ios::out (overwrite) or ios::app (append)
+/// \param async [in] true if buffers are to be written by background writer thread
+/// \return true if file successfully opened
+//
+bool CBufferedOutputBuf::open(const char *filename, const ios::openmode mode, const bool async)
+{
+  if (_fp!=NULL){return false;}
+
+  if (mode & ios::app){_fp=fopen(filename,"a");}
+  else                {_fp=fopen(filename,"w");}
+  if (_fp==NULL){return false;}
+  setvbuf(_fp,NULL,_IONBF,0); //buffering done here
+
+  if (_buffer==NULL){
+    _buffer=new char [OUTPUT_BUFFER_SIZE];
+    ExitGracefullyIf(_buffer==NULL,"CBufferedOutputBuf::open",OUT_OF_MEMORY);
+  }
+  setp(_buffer,_buffer+OUTPUT_BUFFER_SIZE);
+
+  _async       =async;
+  _filename    =filename;
+  _write_failed=false;
+  _last_flush  =std::chrono::steady_clock::now();
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief writes buffer contents to file (or passes them to writer thread) and resets buffer
+/// \param flush [in] true if file should also be flushed to disk
+//
+void CBufferedOutputBuf::HandOff(const bool flush)
+{
+  size_t n=(size_t)(pptr()-pbase());
+  if (_async)
+  {
+    if (n>0){
+      output_block b;
+      b.fp     =_fp;
+      b.data   =_buffer;
+      b.size   =n;
+      b.flush  =flush;
+      b.pFailed=&_write_failed;
+      CAsyncOutputWriter::Get().Push(b);
+
+      _buffer=new char [OUTPUT_BUFFER_SIZE]; //writer thread deletes old buffer once written
+      ExitGracefullyIf(_buffer==NULL,"CBufferedOutputBuf::HandOff",OUT_OF_MEMORY);
+    }
+  }
+  else
+  {
+    if ((n>0) && (fwrite(_buffer,1,n,_fp)!=n)){_write_failed=true;}
+    if (flush){fflush(_fp);}
+  }
+  setp(_buffer,_buffer+OUTPUT_BUFFER_SIZE);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief called when buffer is full
+//
+CBufferedOutputBuf::int_type CBufferedOutputBuf::overflow(int_type c)
+{
+  if (_fp==NULL){return traits_type::eof();}
+  HandOff(false);
+  if (!traits_type::eq_int_type(c,traits_type::eof())){
+    *pptr()=traits_type::to_char_type(c);
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief called by endl and flush; only writes to disk if OUTPUT_FLUSH_INTERVAL has elapsed
+//
+int CBufferedOutputBuf::sync()
+{
+  if (_fp==NULL){return 0;}
+  std::chrono::steady_clock::time_point now=std::chrono::steady_clock::now();
+  if (std::chrono::duration<double>(now-_last_flush).count()>=OUTPUT_FLUSH_INTERVAL){
+    HandOff(true);
+    _last_flush=now;
+  }
+  return 0;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief writes remaining output and closes file
+/// \return true if all output was successfully written
+//
+bool CBufferedOutputBuf::close()
+{
+  if (_fp==NULL){return true;}
+
+  HandOff(false);
+  if (_async){CAsyncOutputWriter::Get().Drain();}
+  bool ok=(fclose(_fp)==0) && (!_write_failed);
+  _fp=NULL;
+  delete [] _buffer; _buffer=NULL;
+  setp(NULL,NULL);
+
+  if (!ok){WriteWarning("CBufferedOutputBuf::close: error writing output file "+_filename,false);}
+  return ok;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief CBufferedOutputFile constructor
+/// \details stream buffer is attached on open(); until then stream is in bad state, like an unopened ofstream
+//
+CBufferedOutputFile::CBufferedOutputFile():ostream(NULL)
+{
+}
+//////////////////////////////////////////////////////////////////
+/// \brief CBufferedOutputFile destructor
+//
+CBufferedOutputFile::~CBufferedOutputFile()
+{
+  close();
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief opens output file; sets failbit if unsuccessful
+/// \param filename [in] name of output file
+/// \param mode [in] ios::out (overwrite) or ios::app (append)
+//
+void CBufferedOutputFile::open(const char *filename, const ios::openmode mode)
+{
+  if (_buf.open(filename,mode,_async_writes)){rdbuf(&_buf);}//also clears state
+  else                                        {setstate(ios::failbit);}
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief writes remaining output and closes file
+//
+void CBufferedOutputFile::close()
+{
+  if (!_buf.is_open()){return;}
+  if (!_buf.close()){setstate(ios::failbit);}
+  rdbuf(NULL);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief inserts double using same format as ostream (%g with stream precision)
+//
+CBufferedOutputFile &CBufferedOutputFile::operator<<(const double d)
+{
+  if (!good()){return *this;}
+  if ((!DefaultFormat()) || (precision()>32)){
+    static_cast<ostream &>(*this)<<d;
+    return *this;
+  }
+  char tmp[64];
+  int n=snprintf(tmp,64,"%.*g",(int)(precision()),d);
+  _buf.sputn(tmp,n);
+  return *this;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief inserts integer in decimal notation
+//
+void CBufferedOutputFile::WriteInteger(long long v)
+{
+  char tmp[24];
+  char *p=tmp+24;
+  unsigned long long u=(v<0) ? (0ULL-(unsigned long long)(v)) : (unsigned long long)(v);
+  do {
+    *(--p)=(char)('0'+(u%10));
+    u/=10;
+  } while (u!=0);
+  if (v<0){*(--p)='-';}
+  _buf.sputn(p,(tmp+24)-p);
+}
+CBufferedOutputFile &CBufferedOutputFile::operator<<(const int i)
+{
+  if (!good()){return *this;}
+  if ((!DefaultFormat()) || ((flags() & ios::basefield)!=ios::dec)){
+    static_cast<ostream &>(*this)<<i;
+    return *this;
+  }
+  WriteInteger(i);
+  return *this;
+}
+CBufferedOutputFile &CBufferedOutputFile::operator<<(const long long i)
+{
+  if (!good()){return *this;}
+  if ((!DefaultFormat()) || ((flags() & ios::basefield)!=ios::dec)){
+    static_cast<ostream &>(*this)<<i;
+    return *this;
+  }
+  WriteInteger(i);
+  return *this;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief inserts characters and strings
+//
+CBufferedOutputFile &CBufferedOutputFile::operator<<(const char c)
+{
+  if (!good()){return *this;}
+  if (width()!=0){
+    static_cast<ostream &>(*this)<<c;
+    return *this;
+  }
+  _buf.sputc(c);
+  return *this;
+}
+CBufferedOutputFile &CBufferedOutputFile::operator<<(const char *s)
+{
+  if (!good()){return *this;}
+  if ((width()!=0) || (s==NULL)){
+    static_cast<ostream &>(*this)<<s;
+    return *this;
+  }
+  _buf.sputn(s,strlen(s));
+  return *this;
+}
+CBufferedOutputFile &CBufferedOutputFile::operator<<(const string &s)
+{
+  if (!good()){return *this;}
+  if (width()!=0){
+    static_cast<ostream &>(*this)<<s;
+    return *this;
+  }
+  _buf.sputn(s.c_str(),s.size());
+  return *this;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief applies manipulator (e.g., endl), keeping stream type for further insertions
+//
+CBufferedOutputFile &CBufferedOutputFile::operator<<(ostream &(*manip)(ostream &))
+{
+  manip(*this);
+  return *this;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief CNetCDFBlockBuffer constructor
+//
+CNetCDFBlockBuffer::CNetCDFBlockBuffer()
+{
+  _ncid    =-9;
+  _nVars   =0;
+  _aVarIDs =NULL;
+  _aNames  =NULL;
+  _aWidth  =NULL;
+  _aFill   =NULL;
+  _aData   =NULL;
+  _maxRows =1;
+  _chunk   =1;
+  _nRows   =0;
+  _start   =0;
+  _blockEnd=0;
+  _lastVar =0;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief CNetCDFBlockBuffer destructor
+/// \remark does not write held values; Flush() is called before the file is closed
+//
+CNetCDFBlockBuffer::~CNetCDFBlockBuffer()
+{
+  Destroy();
+}
+//////////////////////////////////////////////////////////////////
+/// \brief detaches buffer from file and frees memory
+//
+void CNetCDFBlockBuffer::Destroy()
+{
+  for (int v=0;v<_nVars;v++){delete [] _aData[v];}
+  delete [] _aData;   _aData  =NULL;
+  delete [] _aVarIDs; _aVarIDs=NULL;
+  delete [] _aNames;  _aNames =NULL;
+  delete [] _aWidth;  _aWidth =NULL;
+  delete [] _aFill;   _aFill  =NULL;
+  _nVars=0;
+  _nRows=0;
+  _ncid =-9;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief attaches buffer to NetCDF file; called once all variables have been defined (after nc_enddef)
+/// \param ncid [in] NetCDF file ID
+//
+void CNetCDFBlockBuffer::Initialize(const int ncid)
+{
+  Destroy();
+#ifdef _RVNETCDF_
+  int    retval,nvars,time_dimid,time_varid,storage,ndims,natts;
+  int    dimids[NC_MAX_VAR_DIMS];
+  char   name[NC_MAX_NAME+1];
+  nc_type xtype;
+  size_t len;
+  double fill;
+
+  _ncid=ncid;
+  retval=nc_inq_dimid(_ncid,"time",&time_dimid); HandleNetCDFErrors(retval);
+  retval=nc_inq_nvars(_ncid,&nvars);             HandleNetCDFErrors(retval);
+  int *varids=new int [nvars];
+  retval=nc_inq_varids(_ncid,&nvars,varids);     HandleNetCDFErrors(retval);
+
+  _aVarIDs=new int    [nvars];
+  _aNames =new string [nvars];
+  _aWidth =new int    [nvars];
+  _aFill  =new double [nvars];
+  _aData  =new double*[nvars];
+  ExitGracefullyIf(_aData==NULL,"CNetCDFBlockBuffer::Initialize",OUT_OF_MEMORY);
+
+  int total_width=0;
+  for (int i=0;i<nvars;i++)
+  {
+    retval=nc_inq_var(_ncid,varids[i],name,&xtype,&ndims,dimids,&natts); HandleNetCDFErrors(retval);
+    if ((xtype!=NC_DOUBLE) || (ndims<1) || (ndims>2) || (dimids[0]!=time_dimid)){continue;}
+
+    _aVarIDs[_nVars]=varids[i];
+    _aNames [_nVars]=name;
+    _aWidth [_nVars]=0;
+    if (ndims==2){
+      retval=nc_inq_dimlen(_ncid,dimids[1],&len); HandleNetCDFErrors(retval);
+      _aWidth[_nVars]=(int)(len);
+    }
+    if (nc_get_att_double(_ncid,varids[i],"_FillValue",&fill)!=NC_NOERR){fill=NC_FILL_DOUBLE;}
+    _aFill[_nVars]=fill;
+    total_width+=max(_aWidth[_nVars],1);
+    _nVars++;
+  }
+  delete [] varids;
+
+  //block length: time chunk of file, limited by buffer memory
+  _chunk=1;
+  retval=nc_inq_varid(_ncid,"time",&time_varid); HandleNetCDFErrors(retval);
+  retval=nc_inq_var_chunking(_ncid,time_varid,&storage,&len); HandleNetCDFErrors(retval);
+  if ((storage==NC_CHUNKED) && (len>0)){_chunk=len;}
+
+  size_t max_rows=(size_t)(NETCDF_CHUNKSIZE_MB)*1024*1024/sizeof(double)/max(total_width,1);
+  _maxRows=(int)(max((size_t)1,min(_chunk,max_rows)));
+
+  for (int v=0;v<_nVars;v++){
+    _aData[v]=new double [_maxRows*max(_aWidth[v],1)];
+    ExitGracefullyIf(_aData[v]==NULL,"CNetCDFBlockBuffer::Initialize(2)",OUT_OF_MEMORY);
+  }
+  _nRows  =0;
+  _lastVar=0;
+#else
+  (void)(ncid); //buffer stays detached (_ncid=-9) without NetCDF
+#endif
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief sets all values of held time step row to fill values
+//
+void CNetCDFBlockBuffer::FillRow(const int row)
+{
+  for (int v=0;v<_nVars;v++){
+    int     w=max(_aWidth[v],1);
+    double *pRow=_aData[v]+(size_t)(row)*w;
+    for (int j=0;j<w;j++){pRow[j]=_aFill[v];}
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief starts new time step; subsequent SetValue()/GetRow() calls refer to this time step
+/// \details skipped time indices (e.g., with output intervals >1) are held as fill values; repeated calls
+/// for the current time step have no effect
+/// \param time_index [in] index of time step in NetCDF file time dimension
+//
+void CNetCDFBlockBuffer::StartTimeStep(const size_t time_index)
+{
+  if (_ncid==-9){return;}
+  if ((_nRows>0) && ((time_index+1<_start+_nRows) || (time_index>=_blockEnd))){Flush();}
+  if (_nRows==0){
+    _start   =time_index;
+    _blockEnd=min(_start+_maxRows,(_start/_chunk+1)*_chunk); //ends at chunk boundary
+  }
+  while (_start+_nRows<=time_index){FillRow(_nRows);_nRows++;}
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief returns index of buffered variable, DOESNT_EXIST if not found
+//
+int CNetCDFBlockBuffer::GetVarIndex(const string &name)
+{
+  for (int i=0;i<_nVars;i++){
+    int v=(_lastVar+i)%_nVars;
+    if (_aNames[v]==name){_lastVar=(v+1)%_nVars;return v;}
+  }
+  return DOESNT_EXIST;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief sets value of 1D time series variable for current time step
+/// \param name [in] NetCDF variable name
+/// \param val [in] value
+//
+void CNetCDFBlockBuffer::SetValue(const string &name,const double &val)
+{
+  if (_ncid==-9){return;}
+  int v=GetVarIndex(name);
+  ExitGracefullyIf(v==DOESNT_EXIST,("CNetCDFBlockBuffer::SetValue: variable "+name+" not found in NetCDF output file").c_str(),RUNTIME_ERR);
+  ExitGracefullyIf(_nRows==0,"CNetCDFBlockBuffer::SetValue: StartTimeStep not called",RUNTIME_ERR);
+  _aData[v][_nRows-1]=val;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief returns pointer to values of 2D variable for current time step
+/// \param name [in] NetCDF variable name
+/// \return pointer to row [size: second dimension of variable], or NULL if variable is not in file
+//
+double *CNetCDFBlockBuffer::GetRow(const string &name)
+{
+  if ((_ncid==-9) || (_nRows==0)){return NULL;}
+  int v=GetVarIndex(name);
+  if (v==DOESNT_EXIST){return NULL;}
+  return _aData[v]+(size_t)(_nRows-1)*max(_aWidth[v],1);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief writes held time steps to file, one hyperslab per variable
+//
+void CNetCDFBlockBuffer::Flush()
+{
+  if ((_ncid==-9) || (_nRows==0)){return;}
+#ifdef _RVNETCDF_
+  int    retval;
+  size_t start[2],count[2];
+  start[0]=_start;
+  start[1]=0;
+  count[0]=(size_t)(_nRows);
+  for (int v=0;v<_nVars;v++){
+    count[1]=(size_t)(_aWidth[v]); //ignored for 1D time series
+    retval=nc_put_vara_double(_ncid,_aVarIDs[v],start,count,_aData[v]); HandleNetCDFErrors(retval);
+  }
+#endif
+  _nRows=0;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief returns string s as a quoted JSON string
+//
+static string JSONString(const string &s)
+{
+  string out="\"";
+  char   tmp[8];
+  for (size_t i=0;i<s.length();i++)
+  {
+    unsigned char c=(unsigned char)(s[i]);
+    if      (c=='\"'){out+="\\\"";}
+    else if (c=='\\'){out+="\\\\";}
+    else if (c<0x20 ){snprintf(tmp,8,"\\u%04x",(int)(c));out+=tmp;}
+    else             {out+=s[i];}
+  }
+  return out+"\"";
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief CBinaryColumnFile constructor
+//
+CBinaryColumnFile::CBinaryColumnFile()
+{
+  _fp           =NULL;
+  _filename     ="";
+  _json_filename="";
+  _nCols        =0;
+  _aNames       =NULL;
+  _aUnits       =NULL;
+  _nAtts        =0;
+  _aAttNames    =NULL;
+  _aAttVals     =NULL;
+  _time_units   ="";
+  _calendar     ="";
+  _timestep     =0.0;
+  _buffer       =NULL;
+  _bufSize      =0;
+  _nBuffered    =0;
+  _iCol         =0;
+  _nRows        =0;
+  _started      =false;
+  _write_failed =false;
+  _last_flush   =std::chrono::steady_clock::now();
+}
+//////////////////////////////////////////////////////////////////
+/// \brief CBinaryColumnFile destructor - writes any remaining output
+//
+CBinaryColumnFile::~CBinaryColumnFile()
+{
+  close();
+  delete [] _aNames;    _aNames   =NULL;
+  delete [] _aUnits;    _aUnits   =NULL;
+  delete [] _aAttNames; _aAttNames=NULL;
+  delete [] _aAttVals;  _aAttVals =NULL;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief opens .npy file for writing; sidecar is named by replacing the file extension with .json
+/// \param filename [in] name of .npy file
+/// \return true if file successfully opened
+//
+bool CBinaryColumnFile::open(const string &filename)
+{
+  if (_fp!=NULL){return false;}
+
+  _fp=fopen(filename.c_str(),"wb");
+  if (_fp==NULL){return false;}
+  setvbuf(_fp,NULL,_IONBF,0); //buffering done here
+
+  _filename=filename;
+  size_t dot=filename.find_last_of('.');
+  size_t sep=filename.find_last_of("/\\");
+  if ((dot!=string::npos) && ((sep==string::npos) || (dot>sep))){_json_filename=filename.substr(0,dot)+".json";}
+  else                                                          {_json_filename=filename+".json";}
+
+  _nCols       =0;
+  _nAtts       =0;
+  _nBuffered   =0;
+  _iCol        =0;
+  _nRows       =0;
+  _started     =false;
+  _write_failed=false;
+  _last_flush  =std::chrono::steady_clock::now();
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief adds column to file
+/// \param name [in] column name
+/// \param units [in] column units
+//
+void CBinaryColumnFile::AddColumn(const string &name,const string &units)
+{
+  ExitGracefullyIf(_started,"CBinaryColumnFile::AddColumn: columns cannot be added once output has been written",RUNTIME_ERR);
+  string *aN=new string [_nCols+1];
+  string *aU=new string [_nCols+1];
+  ExitGracefullyIf(aU==NULL,"CBinaryColumnFile::AddColumn",OUT_OF_MEMORY);
+  for (int i=0;i<_nCols;i++){aN[i]=_aNames[i];aU[i]=_aUnits[i];}
+  aN[_nCols]=name;
+  aU[_nCols]=units;
+  delete [] _aNames; _aNames=aN;
+  delete [] _aUnits; _aUnits=aU;
+  _nCols++;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief adds text attribute (e.g., application, run name) to JSON sidecar
+/// \param name [in] attribute name
+/// \param value [in] attribute value
+//
+void CBinaryColumnFile::AddAttribute(const string &name,const string &value)
+{
+  string *aN=new string [_nAtts+1];
+  string *aV=new string [_nAtts+1];
+  ExitGracefullyIf(aV==NULL,"CBinaryColumnFile::AddAttribute",OUT_OF_MEMORY);
+  for (int i=0;i<_nAtts;i++){aN[i]=_aAttNames[i];aV[i]=_aAttVals[i];}
+  aN[_nAtts]=name;
+  aV[_nAtts]=value;
+  delete [] _aAttNames; _aAttNames=aN;
+  delete [] _aAttVals;  _aAttVals =aV;
+  _nAtts++;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief sets description of time axis (first column)
+/// \param units [in] time units (e.g., "days since 2000-01-01 00:00:00")
+/// \param calendar [in] calendar name
+/// \param timestep [in] [d] model time step
+//
+void CBinaryColumnFile::SetTimeAxis(const string &units,const string &calendar,const double &timestep)
+{
+  _time_units=units;
+  _calendar  =calendar;
+  _timestep  =timestep;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief writes (or rewrites) 128-byte NPY version 1.0 header with current number of rows
+/// \details file position is restored to end of file
+//
+void CBinaryColumnFile::WriteNPYHeader()
+{
+  const int HEADER_SIZE=128;
+  unsigned short one=1;
+  bool little_endian=(*((unsigned char*)(&one))==1);
+
+  char dict[HEADER_SIZE];
+  int  len=snprintf(dict,HEADER_SIZE,"{'descr': '%sf8', 'fortran_order': False, 'shape': (%lld, %d), }",
+                    little_endian ? "<" : ">",_nRows,_nCols);
+  ExitGracefullyIf((len<0) || (len>HEADER_SIZE-11),"CBinaryColumnFile::WriteNPYHeader: header too long",RUNTIME_ERR);
+
+  unsigned char header[HEADER_SIZE];
+  memcpy(header,"\x93NUMPY",6);
+  header[6]=1; //major version
+  header[7]=0; //minor version
+  header[8]=(unsigned char)((HEADER_SIZE-10)%256); //header length (little-endian unsigned short)
+  header[9]=(unsigned char)((HEADER_SIZE-10)/256);
+  memcpy(header+10,dict,len);
+  memset(header+10+len,' ',HEADER_SIZE-11-len);   //padded with spaces
+  header[HEADER_SIZE-1]='\n';
+
+  if (fseek(_fp,0,SEEK_SET)!=0)                           {_write_failed=true;}
+  if (fwrite(header,1,HEADER_SIZE,_fp)!=(size_t)(HEADER_SIZE)){_write_failed=true;}
+  if (fseek(_fp,0,SEEK_END)!=0)                           {_write_failed=true;}
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief writes JSON sidecar describing columns, time axis and attributes of .npy file
+//
+void CBinaryColumnFile::WriteSidecar() const
+{
+  ofstream JSON;
+  JSON.open(_json_filename.c_str());
+  if (JSON.fail()){
+    WriteWarning("CBinaryColumnFile::WriteSidecar: unable to open file "+_json_filename+" for writing",false);
+    return;
+  }
+  string data_file=_filename.substr(_filename.find_last_of("/\\")+1);
+
+  JSON<<"{"<<endl;
+  JSON<<"  \"format\": \"npy\","<<endl;
+  JSON<<"  \"data_file\": "<<JSONString(data_file)<<","<<endl;
+  JSON<<"  \"dtype\": \"float64\","<<endl;
+  JSON<<"  \"layout\": \"row-major [time x column]\","<<endl;
+  JSON<<"  \"num_rows\": "<<_nRows<<","<<endl;
+  JSON<<"  \"num_columns\": "<<_nCols<<","<<endl;
+  JSON<<"  \"missing_value\": \"NaN\","<<endl;
+  if (_time_units!=""){
+    JSON<<"  \"time\": {\"column\": 0, \"units\": "<<JSONString(_time_units)<<", \"calendar\": "<<JSONString(_calendar);
+    JSON<<", \"timestep\": "<<setprecision(12)<<_timestep<<"},"<<endl;
+  }
+  for (int i=0;i<_nAtts;i++){
+    JSON<<"  "<<JSONString(_aAttNames[i])<<": "<<JSONString(_aAttVals[i])<<","<<endl;
+  }
+  JSON<<"  \"columns\": ["<<endl;
+  for (int i=0;i<_nCols;i++){
+    JSON<<"    {\"name\": "<<JSONString(_aNames[i])<<", \"units\": "<<JSONString(_aUnits[i])<<"}";
+    if (i<_nCols-1){JSON<<",";}
+    JSON<<endl;
+  }
+  JSON<<"  ]"<<endl;
+  JSON<<"}"<<endl;
+  JSON.close();
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief writes buffered values to file
+//
+void CBinaryColumnFile::WriteBuffer()
+{
+  if ((_nBuffered>0) && (fwrite(_buffer,sizeof(double),_nBuffered,_fp)!=_nBuffered)){_write_failed=true;}
+  _nBuffered=0;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief appends value to current row
+/// \details header and sidecar are written when the first value is added
+/// \param val [in] value
+//
+void CBinaryColumnFile::AddValue(const double &val)
+{
+  if (_fp==NULL){return;}
+  if (!_started)
+  {
+    ExitGracefullyIf(_nCols==0,"CBinaryColumnFile::AddValue: no columns defined",RUNTIME_ERR);
+    _bufSize=max(OUTPUT_BUFFER_SIZE/sizeof(double),(size_t)(_nCols));
+    _buffer =new double [_bufSize];
+    ExitGracefullyIf(_buffer==NULL,"CBinaryColumnFile::AddValue",OUT_OF_MEMORY);
+    WriteNPYHeader();
+    WriteSidecar();
+    _started=true;
+  }
+  ExitGracefullyIf(_iCol>=_nCols,"CBinaryColumnFile::AddValue: too many values in row",RUNTIME_ERR);
+  if (_nBuffered==_bufSize){WriteBuffer();}
+  _buffer[_nBuffered]=val;
+  _nBuffered++;
+  _iCol++;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief appends missing value (NaN) to current row
+//
+void CBinaryColumnFile::AddMissing()
+{
+  AddValue(std::numeric_limits<double>::quiet_NaN());
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief ends current row; missing trailing values are filled with NaN
+/// \details if OUTPUT_FLUSH_INTERVAL has elapsed since the last flush, rows are written to disk and the header is updated
+//
+void CBinaryColumnFile::EndRow()
+{
+  if (_fp==NULL){return;}
+  while (_iCol<_nCols){AddMissing();}
+  _iCol=0;
+  _nRows++;
+
+  std::chrono::steady_clock::time_point now=std::chrono::steady_clock::now();
+  if (std::chrono::duration<double>(now-_last_flush).count()>=OUTPUT_FLUSH_INTERVAL){
+    WriteBuffer();
+    WriteNPYHeader();
+    fflush(_fp);
+    _last_flush=now;
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief writes remaining rows, final header and sidecar, and closes file
+/// \details an incomplete last row is discarded
+/// \return true if all output was successfully written
+//
+bool CBinaryColumnFile::close()
+{
+  if (_fp==NULL){return true;}
+
+  if (_iCol>0){_nBuffered-=min(_nBuffered,(size_t)(_iCol));_iCol=0;}
+  WriteBuffer();
+  WriteNPYHeader();
+  WriteSidecar();
+  bool ok=(fclose(_fp)==0) && (!_write_failed);
+  _fp=NULL;
+  delete [] _buffer; _buffer=NULL;
+  _started=false;
+
+  if (!ok){WriteWarning("CBinaryColumnFile::close: error writing output file "+_filename,false);}
+  return ok;
+}
@@ -0,0 +1,225 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2026 the Raven Development Team
+  ----------------------------------------------------------------
+  Buffered output for minor (time series) output files
+
+  CBufferedOutputFile: drop-in replacement for ofstream used for .csv
+  output. Rows are collected in a large per-file buffer, endl does
+  not force a write to disk, numbers are formatted without the
+  iostream/locale machinery, and full buffers may optionally be
+  handed to a background writer thread (:AsyncOutput command)
+
+  CNetCDFBlockBuffer: collects a block of time steps of NetCDF time
+  series output and writes each variable as one hyperslab
+
+  CBinaryColumnFile: self-describing binary column file (NumPy .npy
+  array with JSON sidecar) used by :WriteBinaryFormat
+
+  COutputRow: destination of the values of one row of a time series
+  output file, so that each row is generated by a single routine
+  whether it is written as text (CTextOutputRow) or binary
+  ----------------------------------------------------------------*/
+#ifndef BUFFERED_OUTPUT_H
+#define BUFFERED_OUTPUT_H
+
+#include "RavenInclude.h"
+#include <atomic>
+#include <chrono>
+
+const size_t OUTPUT_BUFFER_SIZE   =1<<20; ///< [bytes] size of each output file buffer
+const double OUTPUT_FLUSH_INTERVAL=10.0;  ///< [s] minimum wall-clock time between flushes of an output file to disk
+
+///////////////////////////////////////////////////////////////////
+/// \brief stream buffer which writes to a C file in large blocks
+/// \details sync() (called by endl/flush) only writes to disk if OUTPUT_FLUSH_INTERVAL has elapsed since the last flush
+//
+class CBufferedOutputBuf : public streambuf
+{
+private:/*------------------------------------------------------*/
+  FILE             *_fp;           ///< output file (NULL if closed)
+  char             *_buffer;       ///< current buffer [size: OUTPUT_BUFFER_SIZE]
+  bool              _async;        ///< true if full buffers are passed to background writer thread
+  string            _filename;     ///< name of output file (for error reporting)
+  std::atomic<bool> _write_failed; ///< true if any write to file failed
+  std::chrono::steady_clock::time_point _last_flush; ///< time of last flush to disk
+
+  void HandOff(const bool flush);
+
+protected:/*----------------------------------------------------*/
+  int_type overflow(int_type c);
+  int      sync();
+
+public:/*-------------------------------------------------------*/
+  CBufferedOutputBuf();
+  ~CBufferedOutputBuf();
+
+  bool is_open() const {return (_fp!=NULL);}
+
+  bool open (const char *filename, const ios::openmode mode, const bool async);
+  bool close();
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief output file stream with large buffer and fast number formatting
+/// \details has the interface of ofstream used by Raven (open/is_open/fail/close/<<), and writes identical text.
+/// double, int and string insertion bypass the iostream formatting machinery when no
+/// formatting flags (width, precision style, showpos...) are in effect
+//
+class CBufferedOutputFile : public ostream
+{
+private:/*------------------------------------------------------*/
+  CBufferedOutputBuf _buf;   ///< stream buffer
+
+  static bool _async_writes; ///< true if files opened from now on use the background writer thread
+
+  bool DefaultFormat() const {return ((flags() & (ios::floatfield|ios::showpoint|ios::showpos|ios::uppercase))==0) && (width()==0);}
+  void WriteInteger(long long v);
+
+public:/*-------------------------------------------------------*/
+  CBufferedOutputFile();
+  ~CBufferedOutputFile();
+
+  static void SetAsynchronousWrites(const bool async){_async_writes=async;}
+
+  void open   (const char *filename, const ios::openmode mode=ios::out);
+  bool is_open() const {return _buf.is_open();}
+  void close  ();
+
+  using ostream::operator<<;
+  CBufferedOutputFile &operator<<(const double      d);
+  CBufferedOutputFile &operator<<(const int         i);
+  CBufferedOutputFile &operator<<(const long long   i);
+  CBufferedOutputFile &operator<<(const char        c);
+  CBufferedOutputFile &operator<<(const char       *s);
+  CBufferedOutputFile &operator<<(const string     &s);
+  CBufferedOutputFile &operator<<(ostream &(*manip)(ostream &));
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief collects NetCDF time series output for a block of time steps, written as one hyperslab per variable
+/// \details all double variables of the file with time as first dimension (1D, or 2D [time x n]) are buffered.
+/// Values not set in a time step keep the fill value of the variable, so the file contents are identical to
+/// writing one time step at a time. A block ends at the time chunk boundary of the file, when the buffer
+/// (at most NETCDF_CHUNKSIZE_MB) is full, or when time steps are not written in increasing order.
+/// Flush() must be called before the file is closed
+//
+class CNetCDFBlockBuffer
+{
+private:/*------------------------------------------------------*/
+  int      _ncid;       ///< NetCDF file ID (-9 if not attached to file)
+  int      _nVars;      ///< number of buffered variables
+  int     *_aVarIDs;    ///< NetCDF variable IDs [size: _nVars]
+  string  *_aNames;     ///< variable names [size: _nVars]
+  int     *_aWidth;     ///< number of values per time step (0 for 1D time series) [size: _nVars]
+  double  *_aFill;      ///< fill value of each variable [size: _nVars]
+  double **_aData;      ///< buffered values [size: _nVars][_maxRows*max(_aWidth[v],1)]
+  int      _maxRows;    ///< maximum number of time steps held before writing
+  size_t   _chunk;      ///< time chunk size of file
+  int      _nRows;      ///< number of time steps currently held
+  size_t   _start;      ///< time index of first held time step
+  size_t   _blockEnd;   ///< time index at which current block must be written
+  int      _lastVar;    ///< index of last variable accessed by name (speeds up lookups in file order)
+
+  int  GetVarIndex(const string &name);
+  void FillRow    (const int row);
+
+public:/*-------------------------------------------------------*/
+  CNetCDFBlockBuffer();
+  ~CNetCDFBlockBuffer();
+
+  void    Initialize   (const int ncid);
+  void    StartTimeStep(const size_t time_index);
+  void    SetValue     (const string &name,const double &val);
+  double *GetRow       (const string &name);
+  void    Flush        ();
+  void    Destroy      ();
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief destination of the values of one row of a time series output file
+//
+class COutputRow
+{
+public:/*-------------------------------------------------------*/
+  virtual ~COutputRow(){}
+
+  virtual void AddValue    (const double &val)=0; ///< appends value
+  virtual void AddMissing  ()=0;                  ///< appends missing value (e.g., unavailable observation)
+  virtual void AddUndefined()=0;                  ///< appends undefined value (e.g., precipitation at time zero)
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief writes row values to text output file, each preceded (.csv standard output) or followed (custom output) by separator
+/// \details missing values are blank and undefined values are written as "---"
+//
+class CTextOutputRow : public COutputRow
+{
+private:/*------------------------------------------------------*/
+  CBufferedOutputFile &_OUT;     ///< output file
+  const char          *_sep;     ///< separator
+  bool                 _trailing;///< true if separator follows rather than precedes each value
+
+public:/*-------------------------------------------------------*/
+  CTextOutputRow(CBufferedOutputFile &OUT,const char *sep=",",const bool trailing=false):_OUT(OUT),_sep(sep),_trailing(trailing){}
+
+  void AddValue    (const double &val){if (_trailing){_OUT<<val<<_sep;}   else {_OUT<<_sep<<val;}}
+  void AddMissing  ()                 {_OUT<<_sep;}
+  void AddUndefined()                 {if (_trailing){_OUT<<"---"<<_sep;} else {_OUT<<_sep<<"---";}}
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief binary column file: NumPy .npy array of float64 [rows x columns] with a JSON sidecar
+/// \details column names and units, the time axis and file attributes are written to <name>.json.
+/// Rows are appended as the simulation proceeds; the .npy header (which holds the row count) is rewritten
+/// whenever the file is flushed to disk (at most every OUTPUT_FLUSH_INTERVAL seconds) and on close, so the file
+/// is a valid array throughout the run and may be memory-mapped, e.g., numpy.load(file,mmap_mode='r').
+/// Missing and undefined values are stored as NaN. Columns must be added before the first row is written
+//
+class CBinaryColumnFile : public COutputRow
+{
+private:/*------------------------------------------------------*/
+  FILE     *_fp;           ///< output .npy file (NULL if closed)
+  string    _filename;     ///< name of .npy file
+  string    _json_filename;///< name of JSON sidecar file
+  int       _nCols;        ///< number of columns
+  string   *_aNames;       ///< column names [size: _nCols]
+  string   *_aUnits;       ///< column units [size: _nCols]
+  int       _nAtts;        ///< number of file attributes
+  string   *_aAttNames;    ///< file attribute names [size: _nAtts]
+  string   *_aAttVals;     ///< file attribute values [size: _nAtts]
+  string    _time_units;   ///< units of time column (e.g., "days since 2000-01-01 00:00:00")
+  string    _calendar;     ///< calendar of time column
+  double    _timestep;     ///< [d] model time step
+  double   *_buffer;       ///< values not yet written to file [size: _bufSize]
+  size_t    _bufSize;      ///< capacity of buffer
+  size_t    _nBuffered;    ///< number of values in buffer
+  int       _iCol;         ///< column of next value in current row
+  long long _nRows;        ///< number of complete rows
+  bool      _started;      ///< true once header and sidecar have been written
+  bool      _write_failed; ///< true if any write to file failed
+  std::chrono::steady_clock::time_point _last_flush; ///< time of last flush to disk
+
+  void WriteNPYHeader();
+  void WriteSidecar  () const;
+  void WriteBuffer   ();
+
+public:/*-------------------------------------------------------*/
+  CBinaryColumnFile();
+  ~CBinaryColumnFile();
+
+  bool is_open() const {return (_fp!=NULL);}
+
+  bool open        (const string &filename);
+  void AddColumn   (const string &name,const string &units);
+  void AddAttribute(const string &name,const string &value);
+  void SetTimeAxis (const string &units,const string &calendar,const double &timestep);
+
+  void AddValue    (const double &val);
+  void AddMissing  ();
+  void AddUndefined(){AddMissing();}
+  void EndRow      ();
+  bool close       ();
+};
+
+#endif
@@ -0,0 +1,247 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2026 the Raven Development Team
+  ----------------------------------------------------------------
+  Binary checkpoint file reader and writer (see Checkpoint.h)
+  ----------------------------------------------------------------*/
+#include "Checkpoint.h"
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//////////////////////////////////////////////////////////////////
+/// \brief checkpoint writer constructor
+//
+CCheckpointWriter::CCheckpointWriter()
+{
+  _fp=NULL;
+  _filename="";
+  _type=DOESNT_EXIST;
+  _write_failed=false;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief checkpoint writer destructor
+//
+CCheckpointWriter::~CCheckpointWriter()
+{
+  if (_fp!=NULL){close();}
+}
+//////////////////////////////////////////////////////////////////
+/// \brief writes raw bytes to file
+//
+void CCheckpointWriter::Write(const void *data,const size_t nbytes)
+{
+  if ((_fp==NULL) || (nbytes==0)){return;}
+  if (fwrite(data,1,nbytes,_fp)!=nbytes){_write_failed=true;}
+}
+//////////////////////////////////////////////////////////////////
+/// \brief opens checkpoint file and writes file header
+/// \param filename [in] name of checkpoint file
+/// \param tt_start [in] start time of simulation
+/// \param tt [in] model time of checkpoint
+/// \param tstep [in] [d] model time step
+/// \return true if file was opened
+//
+bool CCheckpointWriter::open(const string &filename,const time_struct &tt_start,const time_struct &tt,const double &tstep)
+{
+  _filename=filename;
+  _write_failed=false;
+  _fp=fopen(filename.c_str(),"wb");
+  if (_fp==NULL){return false;}
+
+  Write(RVB_MAGIC,sizeof(RVB_MAGIC));
+  Write(&RVB_BYTE_ORDER,sizeof(int));
+  Write(&RVB_VERSION,sizeof(int));
+  Write(&tt_start.julian_day,sizeof(double));
+  Write(&tt_start.year,      sizeof(int));
+  Write(&tt.julian_day,      sizeof(double));
+  Write(&tt.year,            sizeof(int));
+  Write(&tstep,              sizeof(double));
+  return true;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief starts new section; all subsequent Put*() calls add to its contents
+//
+void CCheckpointWriter::BeginSection(const rvb_section type)
+{
+  if (_type!=DOESNT_EXIST){EndSection();}
+  _type=(int)(type);
+  _section.clear();
+}
+//////////////////////////////////////////////////////////////////
+/// \brief writes current section (type, size and contents) to file
+//
+void CCheckpointWriter::EndSection()
+{
+  if (_type==DOESNT_EXIST){return;}
+  long long size=(long long)(_section.size());
+  Write(&_type,sizeof(int));
+  Write(&size,sizeof(long long));
+  Write(_section.data(),_section.size());
+  _section.clear();
+  _type=DOESNT_EXIST;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief writes end of file marker and closes file
+/// \return false if any write to file failed
+//
+bool CCheckpointWriter::close()
+{
+  if (_fp==NULL){return !_write_failed;}
+  BeginSection(RVB_END);
+  EndSection();
+  if (fclose(_fp)!=0){_write_failed=true;}
+  _fp=NULL;
+  string().swap(_section);
+  return !_write_failed;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief checkpoint reader constructor
+//
+CCheckpointReader::CCheckpointReader()
+{
+  _buf=NULL; _size=0; _pos=0; _sec_end=0;
+  _mapped=false; _ok=true; _filename="";
+  version=0;
+  start_day=0.0; start_year=0;
+  stamp_day=0.0; stamp_year=0;
+  tstep=0.0;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief checkpoint reader destructor - releases memory map
+//
+CCheckpointReader::~CCheckpointReader()
+{
+#ifndef _WIN32
+  if (_mapped){munmap((void*)(_buf),_size);_buf=NULL;}
+#endif
+  delete [] _buf;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief returns true if file begins with binary checkpoint signature
+/// \param filename [in] name of file (e.g., .rvc or .rvb file)
+//
+bool CCheckpointReader::IsCheckpointFile(const string &filename)
+{
+  char magic[sizeof(RVB_MAGIC)];
+  FILE *fp=fopen(filename.c_str(),"rb");
+  if (fp==NULL){return false;}
+  size_t n=fread(magic,1,sizeof(RVB_MAGIC),fp);
+  fclose(fp);
+  return ((n==sizeof(RVB_MAGIC)) && (memcmp(magic,RVB_MAGIC,sizeof(RVB_MAGIC))==0));
+}
+//////////////////////////////////////////////////////////////////
+/// \brief opens (memory-maps) checkpoint file and reads file header
+/// \param filename [in] name of checkpoint file
+/// \return false if file cannot be read, is not a checkpoint file, was written on a machine with different
+/// byte order, or was written by a newer version of Raven
+//
+bool CCheckpointReader::Open(const string &filename)
+{
+  _filename=filename;
+#ifndef _WIN32
+  int fd=open(filename.c_str(),O_RDONLY);
+  if (fd<0){return false;}
+  struct stat st;
+  if ((fstat(fd,&st)!=0) || (st.st_size<=0)){::close(fd);return false;}
+  void *map=mmap(NULL,(size_t)(st.st_size),PROT_READ,MAP_PRIVATE,fd,0);
+  ::close(fd);
+  if (map==MAP_FAILED){return false;}
+  _buf=(const char*)(map); _size=(size_t)(st.st_size); _mapped=true;
+#ifdef MADV_SEQUENTIAL
+  madvise(map,_size,MADV_SEQUENTIAL);
+#endif
+#else
+  ifstream IN(filename.c_str(),ios::binary);
+  if (IN.fail()){return false;}
+  IN.seekg(0,ios::end);
+  streamoff fsize=(streamoff)(IN.tellg());
+  if (fsize<=0){return false;}
+  IN.seekg(0,ios::beg);
+  char *tmp=new char [(size_t)(fsize)];
+  ExitGracefullyIf(tmp==NULL,"CCheckpointReader::Open",OUT_OF_MEMORY);
+  IN.read(tmp,fsize);
+  _buf=tmp; _size=(size_t)(fsize);
+  if (IN.gcount()!=fsize){return false;}
+#endif
+  _pos=0;
+  _sec_end=_size;
+  if ((_size<sizeof(RVB_MAGIC)) || (memcmp(_buf,RVB_MAGIC,sizeof(RVB_MAGIC))!=0)){return false;}
+  _pos=sizeof(RVB_MAGIC);
+
+  int order =Get<int>();
+  if (order!=RVB_BYTE_ORDER){
+    if (order==(int)(0x04030201)){
+      WriteWarning("CCheckpointReader::Open: binary checkpoint file "+filename+" was written on a machine with different byte order and cannot be read. Use the .rvc file instead",true);
+    }
+    else{
+      WriteWarning("CCheckpointReader::Open: binary checkpoint file "+filename+" has an unrecognized header (written by an earlier version of Raven?)",true);
+    }
+    return false;
+  }
+  version   =Get<int>();
+  start_day =Get<double>();
+  start_year=Get<int>();
+  stamp_day =Get<double>();
+  stamp_year=Get<int>();
+  tstep     =Get<double>();
+  if (!_ok){return false;}
+  if ((version<1) || (version>RVB_VERSION)){
+    WriteWarning("CCheckpointReader::Open: binary checkpoint file "+filename+" was written by a newer version of Raven (format version "+to_string(version)+")",true);
+    return false;
+  }
+  _sec_end=_pos; //no current section
+  return true;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief moves to start of next section
+/// \param type [out] type of section
+/// \return false if end of file has been reached or file is truncated
+//
+bool CCheckpointReader::NextSection(rvb_section &type)
+{
+  _pos    =_sec_end;
+  _sec_end=_size;
+  int       t   =Get<int>();
+  long long size=Get<long long>();
+  if ((!_ok) || (size<0) || (_pos+(size_t)(size)>_size)){_ok=false;return false;}
+  _sec_end=_pos+(size_t)(size);
+  type=(rvb_section)(t);
+  return (type!=RVB_END);
+}
+//////////////////////////////////////////////////////////////////
+/// \brief copies n doubles from file to array a
+//
+bool CCheckpointReader::GetArray(double *a,const int n)
+{
+  if (n<=0){return _ok;}
+  if (!Has((size_t)(n)*sizeof(double))){return false;}
+  memcpy(a,_buf+_pos,(size_t)(n)*sizeof(double));
+  _pos+=(size_t)(n)*sizeof(double);
+  return true;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief skips n doubles
+//
+bool CCheckpointReader::SkipArray(const int n)
+{
+  if (n<=0){return _ok;}
+  if (!Has((size_t)(n)*sizeof(double))){return false;}
+  _pos+=(size_t)(n)*sizeof(double);
+  return true;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief reads string (length, then characters)
+//
+string CCheckpointReader::GetString()
+{
+  int len=Get<int>();
+  if ((!_ok) || (len<0) || (!Has((size_t)(len)))){_ok=false;return "";}
+  string s(_buf+_pos,(size_t)(len));
+  _pos+=(size_t)(len);
+  return s;
+}
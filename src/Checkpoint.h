@@ -0,0 +1,122 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2026 the Raven Development Team
+  ----------------------------------------------------------------
+  Binary checkpoint (solution state) files (:WriteBinaryCheckpoint command)
+
+  A binary checkpoint (.rvb) holds the same model state as the .rvc
+  solution file - HRU state variables, subbasin flow histories,
+  reservoir states, constituent mass histories and management
+  optimization histories - at full double precision. It may be used
+  as the initial conditions file of a subsequent run in place of the
+  .rvc file; any NetCDF state update files are applied afterwards.
+
+  File layout (native byte order of the machine which wrote the file):
+    magic [8 chars], byte order marker [int], version [int]
+    start time [double julian day, int year]
+    time stamp [double julian day, int year], time step [double]
+    {section type [int], section size in bytes [long long], contents} x nSections
+    RVB_END section (size 0)
+  Readers skip sections they do not recognize, and reject files
+  whose byte order marker shows a different byte order.
+  ----------------------------------------------------------------*/
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "RavenInclude.h"
+
+const char RVB_MAGIC[8]={'R','V','N','S','T','A','T','E'}; ///< first bytes of each binary checkpoint file
+const int  RVB_BYTE_ORDER=0x01020304;                      ///< byte order marker; read back as 0x04030201 on machine with opposite byte order
+const int  RVB_VERSION  =2;                                ///< incremented whenever checkpoint file layout changes
+
+////////////////////////////////////////////////////////////////////
+/// \brief sections of binary checkpoint file
+//
+enum rvb_section
+{
+  RVB_HRU_STATES  =1, ///< HRU state variable table
+  RVB_BASIN_STATES=2, ///< subbasin and reservoir states
+  RVB_TRANSPORT   =3, ///< basin transport states of one constituent
+  RVB_MANAGEMENT  =4, ///< management optimization workflow variables and histories
+  RVB_END         =99 ///< end of file
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief writes binary checkpoint file
+/// \details the contents of each section are collected in memory, then written with their size
+//
+class CCheckpointWriter
+{
+private:/*------------------------------------------------------*/
+  FILE   *_fp;           ///< output file (NULL if closed)
+  string  _filename;     ///< name of output file
+  string  _section;      ///< contents of current section
+  int     _type;         ///< type of current section (DOESNT_EXIST if none)
+  bool    _write_failed; ///< true if any write to file failed
+
+  void Write(const void *data,const size_t nbytes);
+
+public:/*-------------------------------------------------------*/
+  CCheckpointWriter();
+  ~CCheckpointWriter();
+
+  bool is_open() const {return (_fp!=NULL);}
+
+  bool open        (const string &filename,const time_struct &tt_start,const time_struct &tt,const double &tstep);
+  void BeginSection(const rvb_section type);
+  void EndSection  ();
+  bool close       ();
+
+  template <class T> void Put(const T &v){_section.append((const char*)(&v),sizeof(T));}
+  void PutArray (const double *a,const int n){if (n>0){_section.append((const char*)(a),(size_t)(n)*sizeof(double));}}
+  void PutString(const string &s){Put<int>((int)(s.length()));_section.append(s);}
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief read-only view of a binary checkpoint file (memory-mapped where possible)
+/// \details any read past the end of the current section marks the reader as failed (ok()==false)
+//
+class CCheckpointReader
+{
+private:/*------------------------------------------------------*/
+  const char *_buf;        ///< file contents
+  size_t      _size;       ///< size of _buf, in bytes
+  size_t      _pos;        ///< current read position
+  size_t      _sec_end;    ///< end of current section
+  bool        _mapped;     ///< true if _buf is a memory map
+  bool        _ok;         ///< false once any read has run past end of section
+  string      _filename;   ///< name of file
+
+  bool Has(const size_t nbytes){if (_pos+nbytes>_sec_end){_ok=false;} return _ok;}
+
+public:/*-------------------------------------------------------*/
+  int         version;     ///< file format version
+  double      start_day;   ///< julian day of start of run which wrote file
+  int         start_year;  ///< year of start of run which wrote file
+  double      stamp_day;   ///< julian day of model time of checkpoint
+  int         stamp_year;  ///< year of model time of checkpoint
+  double      tstep;       ///< [d] time step of run which wrote file
+
+  CCheckpointReader();
+  ~CCheckpointReader();
+
+  static bool IsCheckpointFile(const string &filename);
+
+  bool        Open       (const string &filename);
+  bool        NextSection(rvb_section &type);
+  void        SkipSection(){_pos=_sec_end;}
+  bool        ok         () const {return _ok;}
+
+  template <class T> T Get(){
+    T v=T();
+    if (!Has(sizeof(T))){return v;}
+    memcpy(&v,_buf+_pos,sizeof(T));
+    _pos+=sizeof(T);
+    return v;
+  }
+  bool        GetArray   (double *a,const int n);
+  bool        SkipArray  (const int n);
+  string      GetString  ();
+};
+
+#endif
@@ -4,8 +4,13 @@
 //////////////////////////////////////////////////////////////////
 
 #include <time.h>
+#include <thread>
+#include <vector>
+#include <unordered_map>
 #include "RavenInclude.h"
 
+const int MAX_PARALLEL_FOR_THREADS=16; ///< maximum number of threads used by ParallelFor
+
 //////////////////////////////////////////////////////////////////
 /// \brief Returns a string describing the process corresponding to the enumerated process type passed
 ///
@@ -170,6 +175,9 @@ double DefaultParameterValue(bool is_template, bool is_computable)
 /// \brief Dynamically append pointer to array
 /// \details Dynamically adds additional pointer (*xptr) onto array of pointers (**pArr) of
 /// initial size indicated by parameter. Increments size by 1
+/// \remark storage grows geometrically: the array capacity is always the smallest power of two
+/// no less than size, so reallocation (and copy) only occurs when size reaches a power of two.
+/// Arrays passed to this routine must therefore only be allocated by this routine (or be NULL with size 0)
 ///
 /// \param **&pArr [out] Array of pointers to which *xptr will be added
 /// \param *xptr [in] Pointer to be added to array
@@ -181,21 +189,61 @@ bool DynArrayAppend(void **& pArr, void *xptr,int &size)
   void **tmp=NULL;
   if (xptr==NULL){return false;}
   if ((pArr==NULL) && (size>0)) {return false;}
-  size=size+1;                                                //increment size
-  tmp=new void *[size+1];                                     //allocate memory
-  if (tmp==NULL){ExitGracefully("DynArrayAppend::Out of memory",OUT_OF_MEMORY);}
-  for (int i=0; i<(size-1); i++){                             //copy array
+  if ((size & (size-1))==0)                                   //array full (size is 0 or a power of two)
+  {
+    int capacity=max(2*size,1);
+    tmp=new void *[capacity];                                 //allocate memory
+    if (tmp==NULL){ExitGracefully("DynArrayAppend::Out of memory",OUT_OF_MEMORY);}
+    for (int i=0; i<size; i++){                               //copy array
 #ifdef _STRICTCHECK_
-    if (pArr[i]==NULL){ExitGracefully("DynArrayAppend::Bad existing array",RUNTIME_ERR);}
+      if (pArr[i]==NULL){ExitGracefully("DynArrayAppend::Bad existing array",RUNTIME_ERR);}
 #endif
-    tmp[i]=pArr[i];
+      tmp[i]=pArr[i];
+    }
+    if (size>0){delete [] pArr; pArr=NULL;}                   //delete old array of pointers
+    pArr=tmp;                                                 //redirect pointer
   }
-  tmp[size-1]=xptr;                                           //add new pointer
-  if (size>1){delete [] pArr; pArr=NULL;}                     //delete old array of pointers
-  pArr=tmp;                                                   //redirect pointer
+  pArr[size]=xptr;                                            //add new pointer
+  size=size+1;                                                //increment size
   return true;
 }
 
+///////////////////////////////////////////////////////////////////////////
+/// \brief Applies body to index range [0,N) split into contiguous chunks processed by separate threads
+/// \details each index must be independent of all others. Chunks are statically assigned, so results
+/// do not depend upon the number of threads. Uses g_num_threads threads if set (one per core otherwise,
+/// up to MAX_PARALLEL_FOR_THREADS); runs serially if N<2*min_chunk or only one thread is available.
+/// \remark body must not write warnings or call ExitGracefully (other than for unrecoverable errors)
+///
+/// \param N [in] size of index range
+/// \param min_chunk [in] minimum number of indices handled by one thread
+/// \param &body [in] function processing indices [start,end)
+//
+void ParallelFor(const int N,const int min_chunk,const function<void(int,int)> &body)
+{
+  int nThreads=g_num_threads;
+  if (nThreads<=0){
+    nThreads=(int)(thread::hardware_concurrency());
+    nThreads=min(nThreads,MAX_PARALLEL_FOR_THREADS);
+  }
+  nThreads=min(nThreads,N/max(min_chunk,1));
+  if (nThreads<=1){
+    if (N>0){body(0,N);}
+    return;
+  }
+  thread *aThreads=new thread [nThreads-1];
+  int chunk=(N+nThreads-1)/nThreads;
+  for (int t=1;t<nThreads;t++){
+    int start=min(t*chunk,N);
+    int end  =min(start+chunk,N);
+    aThreads[t-1]=thread(body,start,end);
+  }
+  body(0,min(chunk,N)); //this thread participates
+
+  for (int t=0;t<nThreads-1;t++){aThreads[t].join();}
+  delete [] aThreads;
+}
+
 /**************************************************************************
       Threshold Smoothing functions
 ---------------------------------------------------------------------------
@@ -814,6 +862,25 @@ int StringToCalendar(string cal_chars)
   return -1;  // just to avoid compiler warning of void function return
 }
 
+///////////////////////////////////////////////////////////////////
+/// \brief Returns CF-convention name of calendar (inverse of StringToCalendar)
+///
+/// \param calendar [in] enum integer representing calendar
+/// \return calendar name, e.g., "proleptic_gregorian"
+//
+string CalendarToString(const int calendar)
+{
+  switch(calendar)
+  {
+  case CALENDAR_PROLEPTIC_GREGORIAN: return "proleptic_gregorian";
+  case CALENDAR_365_DAY:             return "365_day";
+  case CALENDAR_360_DAY:             return "360_day";
+  case CALENDAR_JULIAN:              return "julian";
+  case CALENDAR_366_DAY:             return "366_day";
+  default:                           return "gregorian";
+  }
+}
+
 
 ////////////////////////////////////////////////////// /////////////////////
 /// \brief Round the timestep to the nearest fractional day
@@ -1265,6 +1332,19 @@ string StringToUppercase(const string &s)
 #define valid_digit(c) ((c) >= '0' && (c) <= '9')
 
 double fast_s_to_d (const char *p)
+{
+  const char *end;
+  return fast_s_to_d(p,end);
+}
+//////////////////////////////////////////////////////////////////
+/// \brief fast atof which also returns pointer to first character after parsed number
+/// \details used to parse numbers in place, e.g., within memory-mapped input files
+///
+/// \param *p [in] string (need not be NULL-terminated after the number)
+/// \param *&end [out] first unparsed character
+/// \return parsed value (0.0 if not numeric)
+//
+double fast_s_to_d (const char *p, const char *&end)
 {
   int frac;
   double sign, value, scale;
@@ -1338,6 +1418,7 @@ double fast_s_to_d (const char *p)
 
   // Return signed and scaled floating point result.
 
+  end=p;
   return sign * (frac ? (value / scale) : (value * scale));
 }
 
@@ -1397,32 +1478,123 @@ void SubstringReplace(string &str,const string &from,const string &to)
 }
 
 /////////////////////////////////////////////////////////////////
-/// \brief writes warning to screen and to Raven_errors.txt file
-/// \param warn [in] warning message printed
+// Warning log: Raven_errors.txt is kept open while warnings are written. Warnings are counted by
+// message template (message with all numbers replaced by '#', so that messages differing only by
+// IDs, dates or values share a template). At most g_warning_limit warnings of each template are
+// written (a series of identical warnings is written once); a summary table of repeated templates
+// is written when the log is closed
+//
+struct warning_template
+{
+  string example; ///< first message of template
+  int    count;   ///< number of warnings issued with template
+  int    written; ///< number of warnings with template written to file (immediate repeats are written once)
+};
+static ofstream                   s_WARNINGS;           ///< Raven_errors.txt (kept open)
+static string                     s_warn_filename="";   ///< full path of open Raven_errors.txt
+static unordered_map<string,int>  s_template_index;     ///< index of each message template in s_templates
+static vector<warning_template>   s_templates;          ///< message templates, in order of first occurrence
+static string                     s_last_warning="";    ///< most recent warning
+static int                        s_last_template=0;    ///< index of template of most recent warning
+static int                        s_repeat_count=0;     ///< number of immediately repeated issues of most recent warning
+static bool                       s_last_written=false; ///< true if most recent warning was written to file
+
+/////////////////////////////////////////////////////////////////
+/// \brief returns warning message with all numbers (IDs, values, dates, times) replaced by '#'
+/// \param &warn [in] warning message
 //
-void WriteWarning(const string warn, bool noisy)
+static string WarningTemplate(const string &warn)
 {
-  if (!g_suppress_warnings){
-    
-    if (warn==g_last_warning){
-      g_warn_count++;
+  string tmpl;
+  tmpl.reserve(warn.size());
+  size_t i=0,N=warn.size();
+  while (i<N)
+  {
+    if (isdigit((unsigned char)(warn[i])))
+    {
+      while ((i<N) && (isdigit((unsigned char)(warn[i])) ||
+            (((warn[i]=='.') || (warn[i]=='-') || (warn[i]==':') || (warn[i]=='e') || (warn[i]=='E')) &&
+              (i+1<N) && isdigit((unsigned char)(warn[i+1]))))){i++;}
+      tmpl+='#';
     }
     else{
-      ofstream WARNINGS;
-      WARNINGS.open((g_output_directory+"Raven_errors.txt").c_str(),ios::app);
-    
-      if (g_warn_count>1){
-        WARNINGS<<"WARNING  : "<<g_last_warning<<endl;
-        WARNINGS<<" **[PREVIOUS WARNING REPEATED "<<g_warn_count<<" TIMES]**"<<endl;
-      }
-      else if (g_last_warning!=""){ //might be first of series, might not be.
-        if(noisy) { cout<<"WARNING!: "<<g_last_warning<<endl; }
-        WARNINGS<<"WARNING  : "<<g_last_warning<<endl;
-      }
-      WARNINGS.close();
-      g_warn_count=1;
+      tmpl+=warn[i];
+      i++;
     }
-    g_last_warning=warn;
+  }
+  return tmpl;
+}
+/////////////////////////////////////////////////////////////////
+/// \brief returns open warnings file stream, (re-)opening Raven_errors.txt in current output directory if needed
+//
+static ofstream &WarningStream()
+{
+  string filename=g_output_directory+"Raven_errors.txt";
+  if ((!s_WARNINGS.is_open()) || (filename!=s_warn_filename))
+  {
+    if (s_WARNINGS.is_open()){s_WARNINGS.close();}
+    s_WARNINGS.clear();
+    s_WARNINGS.open(filename.c_str(),ios::app);
+    s_warn_filename=filename;
+  }
+  return s_WARNINGS;
+}
+/////////////////////////////////////////////////////////////////
+/// \brief writes number of immediate repeats of most recent warning, if it was repeated
+//
+static void WriteWarningRepeats()
+{
+  if ((s_repeat_count>1) && (s_last_written)){
+    WarningStream()<<" **[PREVIOUS WARNING REPEATED "<<s_repeat_count<<" TIMES]**"<<"\n";
+  }
+  s_repeat_count=0;
+}
+/////////////////////////////////////////////////////////////////
+/// \brief writes warning to screen and to Raven_errors.txt file
+/// \details immediately repeated warnings are counted and written once; at most g_warning_limit
+/// warnings with the same message template are written
+/// \param warn [in] warning message printed
+//
+void WriteWarning(const string warn, bool noisy)
+{
+  if (g_suppress_warnings){return;}
+
+  if ((warn==s_last_warning) && (s_repeat_count>0)){
+    s_repeat_count++;
+    s_templates[s_last_template].count++;
+    return;
+  }
+  WriteWarningRepeats();
+  s_last_warning=warn;
+  s_repeat_count=1;
+
+  string tmpl=WarningTemplate(warn);
+  unordered_map<string,int>::iterator it=s_template_index.find(tmpl);
+  int t;
+  if (it==s_template_index.end()){
+    warning_template T;
+    T.example=warn;
+    T.count  =0;
+    T.written=0;
+    t=(int)(s_templates.size());
+    s_templates.push_back(T);
+    s_template_index[tmpl]=t;
+  }
+  else{
+    t=it->second;
+  }
+  s_templates[t].count++;
+  s_last_template=t;
+
+  s_last_written=((g_warning_limit<=0) || (s_templates[t].written<g_warning_limit));
+  if (s_last_written){
+    if(noisy) { cout<<"WARNING!: "<<warn<<endl; }
+    WarningStream()<<"WARNING  : "<<warn<<"\n";
+    s_templates[t].written++;
+  }
+  else if (s_templates[t].written==g_warning_limit){
+    s_templates[t].written++; //note written only once
+    WarningStream()<<" **[FURTHER WARNINGS LIKE PREVIOUS ONE SUPPRESSED AFTER "<<g_warning_limit<<" - SEE WARNING SUMMARY]**"<<"\n";
   }
 }
 /////////////////////////////////////////////////////////////////
@@ -1432,12 +1604,49 @@ void WriteWarning(const string warn, bool noisy)
 void WriteAdvisory(const string warn, bool noisy)
 {
   if (!g_suppress_warnings){
-    ofstream WARNINGS;
-    WARNINGS.open((g_output_directory+"Raven_errors.txt").c_str(),ios::app);
+    WriteWarningRepeats();
+    s_last_warning="";
     if (noisy){cout<<"ADVISORY: "<<warn<<endl;}
-    WARNINGS<<"ADVISORY : "<<warn<<endl;
-    WARNINGS.close();
+    WarningStream()<<"ADVISORY : "<<warn<<"\n";
+  }
+}
+/////////////////////////////////////////////////////////////////
+/// \brief writes all pending warnings to Raven_errors.txt
+/// \remark must be called before Raven_errors.txt is read or written by other means
+//
+void FlushWarnings()
+{
+  WriteWarningRepeats();
+  s_last_warning="";
+  if (s_WARNINGS.is_open()){s_WARNINGS.flush();}
+}
+/////////////////////////////////////////////////////////////////
+/// \brief writes pending warnings and summary table of repeated warning templates, then closes Raven_errors.txt
+//
+void CloseWarnings()
+{
+  FlushWarnings();
+  bool repeated=false;
+  for (size_t t=0;t<s_templates.size();t++){if (s_templates[t].count>1){repeated=true;}}
+  if (repeated)
+  {
+    ofstream &WARN=WarningStream();
+    WARN<<"----------------------------------------------------------"<<"\n";
+    WARN<<"WARNING SUMMARY (repeated warnings)"<<"\n";
+    WARN<<"  issued | written | first message"<<"\n";
+    for (size_t t=0;t<s_templates.size();t++)
+    {
+      if (s_templates[t].count<=1){continue;}
+      int written=s_templates[t].written;
+      if (g_warning_limit>0){written=min(written,g_warning_limit);}
+      WARN<<setw(8)<<s_templates[t].count<<" |"<<setw(8)<<written<<" | "<<s_templates[t].example<<"\n";
+    }
+    WARN<<"----------------------------------------------------------"<<endl;
   }
+  if (s_WARNINGS.is_open()){s_WARNINGS.close();}
+  s_warn_filename="";
+  s_template_index.clear();
+  s_templates.clear();
 }
 ///////////////////////////////////////////////////////////////////
 /// \brief NetCDF error handling
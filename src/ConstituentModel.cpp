@@ -10,6 +10,7 @@ coordinates information about constituent storage
 #include "Model.h"
 #include "HeatConduction.h"
 #include "Transport.h"
+#include "Checkpoint.h"
 #include "EnergyTransport.h"
 
 bool IsContinuousConcObs(const CTimeSeriesABC *pObs,const long long SBID,const int c); //Defined in StandardOutput.cpp
@@ -17,7 +18,7 @@ void WriteNetCDFGlobalAttributes(const int out_ncid,const optStruct& Options,con
 int  NetCDFAddMetadata     (const int fileid,const int time_dimid,string shortname,string longname,string units);
 int  NetCDFAddMetadata2D   (const int fileid,const int time_dimid,int nbasins_dimid,string shortname,string longname,string units);
 void WriteNetCDFBasinList  (const int ncid,const int varid,const int varid_name,const CModel* pModel,bool is_res,const optStruct& Options);
-void AddSingleValueToNetCDF(const int out_ncid,const string &label,const size_t time_index,const double &value);
+size_t NetCDFSetTimeStorage(const int fileid,const int varid_time,const size_t default_chunk,const optStruct &Options);
 //////////////////////////////////////////////////////////////////
 /// \brief Implentation of the Transport constructor
 /// \param pModel [in] Model object
@@ -1053,6 +1054,7 @@ void CConstituentModel::WriteNetCDFOutputFileHeaders(const optStruct& Options)
   /// Define the time variable.
   dimids1[0] = time_dimid;
   retval = nc_def_var(_CONC_ncid,"time",NC_DOUBLE,ndims1,dimids1,&varid_time); HandleNetCDFErrors(retval);
+  NetCDFSetTimeStorage(_CONC_ncid,varid_time,max(1,(int)(Options.n_out_time)),Options);
   retval = nc_put_att_text(_CONC_ncid,varid_time,"units",strlen(starttime),starttime);   HandleNetCDFErrors(retval);
   retval = nc_put_att_text(_CONC_ncid,varid_time,"calendar",strlen("gregorian"),"gregorian"); HandleNetCDFErrors(retval);
 
@@ -1080,6 +1082,7 @@ void CConstituentModel::WriteNetCDFOutputFileHeaders(const optStruct& Options)
 
   // End define mode. This tells netCDF we are done defining metadata.
   retval = nc_enddef(_CONC_ncid);  HandleNetCDFErrors(retval);
+  _CONC_ncbuf.Initialize(_CONC_ncid);
 
   //Pollutograph / stream temperatures file
   //--------------------------------------------------------------------
@@ -1105,6 +1108,7 @@ void CConstituentModel::WriteNetCDFOutputFileHeaders(const optStruct& Options)
     /// Define the time variable.
     dimids1[0] = time_dimid;
     retval = nc_def_var(_POLLUT_ncid,"time",NC_DOUBLE,ndims1,dimids1,&varid_time); HandleNetCDFErrors(retval);
+    NetCDFSetTimeStorage(_POLLUT_ncid,varid_time,max(1,(int)(Options.n_out_time)),Options);
     retval = nc_put_att_text(_POLLUT_ncid,varid_time,"units",strlen(starttime),starttime);   HandleNetCDFErrors(retval);
     retval = nc_put_att_text(_POLLUT_ncid,varid_time,"calendar",strlen("gregorian"),"gregorian"); HandleNetCDFErrors(retval);
 
@@ -1163,6 +1167,7 @@ void CConstituentModel::WriteNetCDFOutputFileHeaders(const optStruct& Options)
 
     // End define mode. This tells netCDF we are done defining metadata.
     retval = nc_enddef(_POLLUT_ncid);  HandleNetCDFErrors(retval);
+    _POLLUT_ncbuf.Initialize(_POLLUT_ncid);
 
     // write values to NetCDF
     if(nSim > 0)
@@ -1193,6 +1198,7 @@ void CConstituentModel::WriteNetCDFOutputFileHeaders(const optStruct& Options)
     /// Define the time variable.
     dimids1[0] = time_dimid;
     retval = nc_def_var(_LOADING_ncid,"time",NC_DOUBLE,ndims1,dimids1,&varid_time); HandleNetCDFErrors(retval);
+    NetCDFSetTimeStorage(_LOADING_ncid,varid_time,max(1,(int)(Options.n_out_time)),Options);
     retval = nc_put_att_text(_LOADING_ncid,varid_time,"units",strlen(starttime),starttime);   HandleNetCDFErrors(retval);
     retval = nc_put_att_text(_LOADING_ncid,varid_time,"calendar",strlen("gregorian"),"gregorian"); HandleNetCDFErrors(retval);
 
@@ -1546,18 +1552,11 @@ void CConstituentModel::WriteEnsimMinorOutput(const optStruct &Options,const tim
 void CConstituentModel::WriteNetCDFMinorOutput(const optStruct& Options,const time_struct& tt)
 {
 #ifdef _RVNETCDF_
-  int    retval;                   // error value for NetCDF routines
-  int    time_id;                  // variable id in NetCDF for time
-  size_t time_index[1],count1[1];  // determines where and how much will be written to NetCDF; 1D variable (pre, time)
-  size_t start2[2],count2[2];  // determines where and how much will be written to NetCDF; 2D variable (qsim, qobs, qin)
-  double current_time[1];          // current time in hours since start time
-  count1[0] = 1;                    // writes exactly one time step
-
-  size_t time_ind2;
-  current_time[0] = tt.model_time*HR_PER_DAY;
-  current_time[0]=RoundToNearestMinute(current_time[0]);
-  time_index[0] = int(rvn_round(tt.model_time/Options.timestep));   // element of NetCDF array that will be written
-  time_ind2      =int(rvn_round(tt.model_time/Options.timestep));
+  double current_time;             // current time in hours since start time
+  size_t time_ind;                 // element of NetCDF time dimension that will be written
+  current_time=tt.model_time*HR_PER_DAY;
+  current_time=RoundToNearestMinute(current_time);
+  time_ind    =int(rvn_round(tt.model_time/Options.timestep));
 
   //====================================================================
   //  Concentrations.nc / Temperatures.nc
@@ -1592,15 +1591,16 @@ void CConstituentModel::WriteNetCDFMinorOutput(const optStruct& Options,const ti
   double sink        = _pModel->GetAvgStateVar(_pModel->GetStateVarIndex(CONSTITUENT_SINK,_constit_index))*(area*M2_PER_KM2);//[mg]  or [MJ]
   double source      =-_pModel->GetAvgStateVar(_pModel->GetStateVarIndex(CONSTITUENT_SRC, _constit_index))*(area*M2_PER_KM2);//[mg]  or [MJ]
 
+  _CONC_ncbuf.StartTimeStep(time_ind);
   if(_type==ENTHALPY) {
-    AddSingleValueToNetCDF(_CONC_ncid,"air_temp"  ,time_ind2,_pModel->GetAvgForcing(F_TEMP_AVE));
+    _CONC_ncbuf.SetValue("air_temp"  ,_pModel->GetAvgForcing(F_TEMP_AVE));
   }
 
   double inf=influx*convert;
   if (tt.model_time==0.0){inf=NETCDF_BLANK_VALUE;}
-  AddSingleValueToNetCDF(_CONC_ncid,"influx"           ,time_ind2,inf);
-  AddSingleValueToNetCDF(_CONC_ncid,"channel_storage"  ,time_ind2,channel_stor*convert);
-  AddSingleValueToNetCDF(_CONC_ncid,"rivulet_storage"  ,time_ind2,rivulet_stor*convert);
+  _CONC_ncbuf.SetValue("influx"           ,inf);
+  _CONC_ncbuf.SetValue("channel_storage"  ,channel_stor*convert);
+  _CONC_ncbuf.SetValue("rivulet_storage"  ,rivulet_stor*convert);
 
   currentMass=0.0;
   for(int ii=0;ii<_pTransModel->GetNumWaterCompartments();ii++)
@@ -1617,7 +1617,7 @@ void CConstituentModel::WriteNetCDFMinorOutput(const optStruct& Options,const ti
     if(_pTransModel->GetStorWaterIndex(ii)!=iCumPrecip)
     {
       string name=_pModel->GetStateVarInfo()->SVTypeToString(_pModel->GetStateVarType(_pTransModel->GetStorWaterIndex(ii)),_pModel->GetStateVarLayer(_pTransModel->GetStorWaterIndex(ii)));
-      AddSingleValueToNetCDF(_CONC_ncid, name.c_str(),time_ind2,concentration);
+      _CONC_ncbuf.SetValue(name,concentration);
       currentMass+=M*(area*M2_PER_KM2); //[mg]  or [MJ]  //increment total mass in system
     }
     else {
@@ -1629,96 +1629,47 @@ void CConstituentModel::WriteNetCDFMinorOutput(const optStruct& Options,const ti
   CumInflux =source+atmos_prec+_cumul_input;        //[mg] or [MJ]
   CumOutflux=sink  +_cumul_output;//outflow from system [mg] or [MJ]
 
-  AddSingleValueToNetCDF(_CONC_ncid,"total"      ,time_ind2,currentMass*convert);
-  AddSingleValueToNetCDF(_CONC_ncid,"cum_loading",time_ind2,CumInflux  *convert);
-  AddSingleValueToNetCDF(_CONC_ncid,"cum_loss"   ,time_ind2,CumOutflux *convert);
-  AddSingleValueToNetCDF(_CONC_ncid,"MB_error"   ,time_ind2,((currentMass-initMass)+(CumOutflux-CumInflux))*convert);
+  _CONC_ncbuf.SetValue("total"      ,currentMass*convert);
+  _CONC_ncbuf.SetValue("cum_loading",CumInflux  *convert);
+  _CONC_ncbuf.SetValue("cum_loss"   ,CumOutflux *convert);
+  _CONC_ncbuf.SetValue("MB_error"   ,((currentMass-initMass)+(CumOutflux-CumInflux))*convert);
 
   //====================================================================
   //  Pollutographs.nc / StreamTemperatures.nc
   //====================================================================
   if(!_is_passive) {
-    // (a) count how many values need to be written for q_obs, q_sim, q_in
-    int nSim=0; //total # of sub-basins with simulated outflows
-    for(int p=0;p<_pModel->GetNumSubBasins();p++) {
-      if(_pModel->GetSubBasin(p)->IsGauged()  && (_pModel->GetSubBasin(p)->IsEnabled())) { nSim++; }
-    }
-
-    // (b) allocate memory if necessary
-    double* C_obs  =NULL;
-    double* C_sim  =NULL;
-    double* pctfroz=NULL;
-    if(nSim>0) {
-      C_obs  =new double[nSim];
-      C_sim  =new double[nSim];
-      pctfroz=new double[nSim];
-    }
-
-    // write new time step
-    retval = nc_inq_varid(_POLLUT_ncid,"time",&time_id);                            HandleNetCDFErrors(retval);
-    retval = nc_put_vara_double(_POLLUT_ncid,time_id,time_index,count1,&current_time[0]); HandleNetCDFErrors(retval);
-
-    // write air temperature values
+    _POLLUT_ncbuf.StartTimeStep(time_ind);
+    _POLLUT_ncbuf.SetValue("time",current_time);
     if(_type==ENTHALPY) {
-      int    temp_id;               // variable id in NetCDF for air temp
-      double current_temp[1];
-      current_temp[0]=_pModel->GetAvgForcing(F_TEMP_AVE);
-
-      retval = nc_inq_varid(_POLLUT_ncid,"air_temp",&temp_id);                                HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_POLLUT_ncid,temp_id,time_index,count1,&current_temp[0]);   HandleNetCDFErrors(retval);
+      _POLLUT_ncbuf.SetValue("air_temp",_pModel->GetAvgForcing(F_TEMP_AVE));
     }
 
-    // get simulated conc/obs conc/pct froz values
-    int iSim=0;
-    for(int p=0;p<_pModel->GetNumSubBasins();p++) {
-      CSubBasin* pBasin=_pModel->GetSubBasin(p);
-      if(pBasin->IsGauged() && (pBasin->IsEnabled()))
-      {
-        C_sim[iSim]=GetOutflowConcentration(p);
-        if(_type==ENTHALPY) {
-          pctfroz[iSim]=pEnthalpyModel->GetOutflowIceFraction(p);
-        }
-        C_obs[iSim]=NETCDF_BLANK_VALUE;
-        for(int i = 0; i < _pModel->GetNumObservedTS(); i++) {
-          if(IsContinuousConcObs(_pModel->GetObservedTS(i),pBasin->GetID(),_constit_index))
-          {
-            double val = _pModel->GetObservedTS(i)->GetAvgValue(tt.model_time,Options.timestep);
-            if((val != RAV_BLANK_DATA) && (tt.model_time>0)) { C_obs[iSim]=val; }
+    double *C_sim  =_POLLUT_ncbuf.GetRow((_type==ENTHALPY) ? "T_sim" : "C_sim"); // NULL if no gauged basins
+    double *C_obs  =_POLLUT_ncbuf.GetRow((_type==ENTHALPY) ? "T_obs" : "C_obs");
+    double *pctfroz=_POLLUT_ncbuf.GetRow("pct_froz");                            // NULL unless enthalpy
+    if(C_sim!=NULL)
+    {
+      int iSim=0;
+      for(int p=0;p<_pModel->GetNumSubBasins();p++) {
+        CSubBasin* pBasin=_pModel->GetSubBasin(p);
+        if(pBasin->IsGauged() && (pBasin->IsEnabled()))
+        {
+          C_sim[iSim]=GetOutflowConcentration(p);
+          if((_type==ENTHALPY) && (pctfroz!=NULL)) {
+            pctfroz[iSim]=pEnthalpyModel->GetOutflowIceFraction(p);
           }
+          C_obs[iSim]=NETCDF_BLANK_VALUE;
+          for(int i = 0; i < _pModel->GetNumObservedTS(); i++) {
+            if(IsContinuousConcObs(_pModel->GetObservedTS(i),pBasin->GetID(),_constit_index))
+            {
+              double val = _pModel->GetObservedTS(i)->GetAvgValue(tt.model_time,Options.timestep);
+              if((val != RAV_BLANK_DATA) && (tt.model_time>0)) { C_obs[iSim]=val; }
+            }
+          }
+          iSim++;
         }
-        iSim++;
-      }
-    }
-    // write simulated conc/obs conc/pct froz values to file
-    int    Csim_id;               // variable id in NetCDF for simulated concentration
-    int    Cobs_id;               // variable id in NetCDF for observed concentration
-    if(nSim > 0) {
-      start2[0] = int(rvn_round(tt.model_time/Options.timestep)); // element of NetCDF array that will be written
-      start2[1] = 0;                                              // element of NetCDF array that will be written
-      count2[0] = 1;      // writes exactly one time step
-      count2[1] = nSim;   // writes exactly nSim elements
-
-      if(_type!=ENTHALPY) {
-        retval = nc_inq_varid(_POLLUT_ncid,"C_sim",&Csim_id);                              HandleNetCDFErrors(retval);
-        retval = nc_inq_varid(_POLLUT_ncid,"C_obs",&Cobs_id);                              HandleNetCDFErrors(retval);
-        retval = nc_put_vara_double(_POLLUT_ncid,Csim_id,start2,count2,&C_sim[0]);         HandleNetCDFErrors(retval);
-        retval = nc_put_vara_double(_POLLUT_ncid,Cobs_id,start2,count2,&C_obs[0]);         HandleNetCDFErrors(retval);
-      }
-      else if(_type==ENTHALPY)
-      {
-        retval = nc_inq_varid(_POLLUT_ncid,"T_sim",&Csim_id);                              HandleNetCDFErrors(retval);
-        retval = nc_inq_varid(_POLLUT_ncid,"T_obs",&Cobs_id);                              HandleNetCDFErrors(retval);
-        retval = nc_put_vara_double(_POLLUT_ncid,Csim_id,start2,count2,&C_sim[0]);         HandleNetCDFErrors(retval);
-        retval = nc_put_vara_double(_POLLUT_ncid,Cobs_id,start2,count2,&C_obs[0]);         HandleNetCDFErrors(retval);
-        int pctfroz_id;
-        retval = nc_inq_varid(_POLLUT_ncid,"pct_froz",&pctfroz_id);                        HandleNetCDFErrors(retval);
-        retval = nc_put_vara_double(_POLLUT_ncid,pctfroz_id,start2,count2,&pctfroz[0]);    HandleNetCDFErrors(retval);
       }
     }
-
-    delete[] C_obs;
-    delete[] C_sim;
-    delete[] pctfroz;
   }
 #endif
 }
@@ -1733,6 +1684,8 @@ void CConstituentModel::CloseOutputFiles()
 
   #ifdef _RVNETCDF_
   int    retval;      // error value for NetCDF routines
+  _CONC_ncbuf.Flush();   _CONC_ncbuf.Destroy();
+  _POLLUT_ncbuf.Flush(); _POLLUT_ncbuf.Destroy();
   if (_CONC_ncid != -9)    {retval = nc_close(_CONC_ncid);    HandleNetCDFErrors(retval); }
   _CONC_ncid    = -9;
   if (_POLLUT_ncid != -9)  {retval = nc_close(_POLLUT_ncid);  HandleNetCDFErrors(retval); }
@@ -1770,6 +1723,39 @@ void CConstituentModel::WriteMajorOutput(ofstream &RVC) const
   RVC<<":EndBasinTransportVariables"<<endl;
 }
 //////////////////////////////////////////////////////////////////
+/// \brief writes basin transport state to binary checkpoint file
+/// \details binary equivalent of WriteMajorOutput; one RVB_TRANSPORT section per constituent
+//
+void CConstituentModel::WriteToCheckpoint(CCheckpointWriter &CHK) const
+{
+  CHK.BeginSection(RVB_TRANSPORT);
+  CHK.PutString(_name);
+  CHK.Put<int>(_pModel->GetNumSubBasins());
+  for(int p=0;p<_pModel->GetNumSubBasins();p++)
+  {
+    int nSegs=_pModel->GetSubBasin(p)->GetNumSegments();
+    CHK.Put<long long>(_pModel->GetSubBasin(p)->GetID());
+    CHK.Put<double>(_channel_storage[p]);
+    CHK.Put<double>(_rivulet_storage[p]);
+    CHK.Put<int>(nSegs);         CHK.PutArray(_aMout[p],    nSegs);         CHK.Put<double>(_aMout_last[p]);
+    CHK.Put<int>(_nMlatHist[p]); CHK.PutArray(_aMlatHist[p],_nMlatHist[p]); CHK.Put<double>(_aMlat_last[p]);
+    CHK.Put<int>(_nMinHist[p]);  CHK.PutArray(_aMinHist[p], _nMinHist[p]);
+    bool has_res=(_pModel->GetSubBasin(p)->GetReservoir()!=NULL);
+    CHK.Put<int>((int)(has_res));
+    if(has_res) {
+      CHK.Put<double>(_aMout_res[p]); CHK.Put<double>(_aMout_res_last[p]);
+      CHK.Put<double>(_aMres    [p]); CHK.Put<double>(_aMres_last    [p]);
+      CHK.Put<double>(_aMsed    [p]); CHK.Put<double>(_aMsed_last    [p]);
+    }
+    CHK.Put<int>((int)(_type==ENTHALPY));
+    if (_type == ENTHALPY) {
+      CEnthalpyModel *pEnth=(CEnthalpyModel*)(this);
+      CHK.Put<double>(pEnth->GetBedTemperature(p));
+    }
+  }
+  CHK.EndSection();
+}
+//////////////////////////////////////////////////////////////////
 /// \brief clears all time series data for re-read of .rvt file
 /// \remark Called only in ensemble mode
 ///
@@ -6,6 +6,8 @@
 #include "CustomOutput.h"
 
 void WriteNetCDFGlobalAttributes(const int out_ncid,const optStruct &Options,const string descript);//in StandardOutput.cpp
+size_t NetCDFSetTimeStorage(const int fileid,const int varid_time,const size_t default_chunk,const optStruct &Options);//in StandardOutput.cpp
+void WriteBinaryFileAttributes(CBinaryColumnFile &BIN,const optStruct &Options,const string descript);//in StandardOutput.cpp
 
 /*****************************************************************
    Constructor/Destructor
@@ -48,6 +50,7 @@ CCustomOutput::CCustomOutput( const diagnostic    variable,
   _svind    =sv_index;                                      // state variable index (if output var is a SV or flux)
   _svind2   =sv_index2;                                     // state variable target index (if output var is a flux between)
   _force_str=force_string;                                  // name of forcing variable (if output var is a forcing function)
+  _ftype    =F_UNRECOGNIZED;                                // set below (if output var is a forcing function)
 
   _spaceAgg  =space_aggregation;                            // how we're aggregation the data (ByHRU,BySubbasin, etc.)
   _timeAgg   =time_aggregation;                             // yearly, monthly, etc.
@@ -74,6 +77,11 @@ CCustomOutput::CCustomOutput( const diagnostic    variable,
 
   _kk_only      =kk;
 
+  _pAggregator  =NULL;
+  _iSource      =DOESNT_EXIST;
+  _aVals        =NULL;
+  _aDrainVals   =NULL;
+
   ExitGracefullyIf((_kk_only==DOESNT_EXIST) && (_spaceAgg==BY_SELECT_HRUS),
                    "CCustomOutput Constructor: invalid HRU group index for Select HRU Aggregation. Undefined HRU group?",BAD_DATA);
   _time_index=0;
@@ -214,6 +222,8 @@ CCustomOutput::~CCustomOutput()
 {
   for (int k=0;k<_nData;k++){delete [] _aData[k];}
   delete [] _aData; _aData=NULL;
+  delete [] _aVals; _aVals=NULL;
+  delete [] _aDrainVals; _aDrainVals=NULL;
   CloseFiles(*pModel->GetOptStruct());
 }
 //////////////////////////////////////////////////////////////////
@@ -286,9 +296,9 @@ int CCustomOutput::ApproximateNumTimeSteps(const optStruct &Options) const
 void CCustomOutput::InitializeCustomOutput(const optStruct &Options)
 {
 // figure out how much space we need
-  if      (_spaceAgg==BY_HRU        ){_nData=pModel->GetNumHRUs();}
-  else if (_spaceAgg==BY_BASIN      ){_nData=pModel->GetNumSubBasins();}
-  else if (_spaceAgg==BY_DRAINAGE   ){_nData=pModel->GetNumSubBasins();}
+  if      (_spaceAgg==BY_HRU        ){_nData=pModel->GetNumOutputHRUs();}
+  else if (_spaceAgg==BY_BASIN      ){_nData=pModel->GetNumOutputSubBasins();}
+  else if (_spaceAgg==BY_DRAINAGE   ){_nData=pModel->GetNumOutputSubBasins();}
   else if (_spaceAgg==BY_WSHED      ){_nData=1;}
   else if (_spaceAgg==BY_HRU_GROUP  ){_nData=pModel->GetNumHRUGroups();}
   else if (_spaceAgg==BY_SB_GROUP   ){_nData=pModel->GetNumSubBasinGroups(); }
@@ -327,6 +337,38 @@ void CCustomOutput::InitializeCustomOutput(const optStruct &Options)
     ExitGracefullyIf(_aData[k]==NULL,"CCustomOutput constructor",OUT_OF_MEMORY);
     for (int a=0;a<_nDataItems;a++){_aData[k][a]=0.0;}
   }
+
+  delete [] _aVals;
+  _aVals=new double [_nData];
+  ExitGracefullyIf(_aVals==NULL,"CCustomOutput::InitializeCustomOutput",OUT_OF_MEMORY);
+  for (int k=0;k<_nData;k++){_aVals[k]=0.0;}
+
+  delete [] _aDrainVals; _aDrainVals=NULL;
+  if ((_spaceAgg==BY_DRAINAGE) && (_nData<pModel->GetNumSubBasins())){ //drainage averages require all subbasins
+    _aDrainVals=new double [pModel->GetNumSubBasins()];
+    ExitGracefullyIf(_aDrainVals==NULL,"CCustomOutput::InitializeCustomOutput",OUT_OF_MEMORY);
+  }
+}
+///////////////////////////////////////////////////////////////////
+/// \brief Registers the output variable with the shared aggregator of HRU-based values
+/// \remarks Called prior to simulation, after InitializeCustomOutput. Streamflow and storage outputs are subbasin-based and remain evaluated by the custom output itself
+/// \param *pAgg [in] Aggregator shared by all custom outputs of the model
+//
+void CCustomOutput::SetAggregator(CCustomOutputAggregator *pAgg)
+{
+  _pAggregator=pAgg;
+  _iSource    =DOESNT_EXIST;
+  if ((_var==VAR_STATE_VAR) || (_var==VAR_FORCING_FUNCTION) ||
+      (_var==VAR_TO_FLUX)   || (_var==VAR_FROM_FLUX)        || (_var==VAR_BETWEEN_FLUX))
+  {
+    custom_source src;
+    src.var    =_var;
+    src.svind  =_svind;
+    src.svind2 =_svind2;
+    src.ftype  =_ftype;
+    src.is_conc=(_var==VAR_STATE_VAR) && (pModel->GetStateVarType(_svind)==CONSTITUENT);
+    _iSource=pAgg->AddSource(src,_spaceAgg,_kk_only);
+  }
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Open a stream to the file and write header info
@@ -346,6 +388,7 @@ void CCustomOutput::DetermineCustomFilename(const optStruct& Options)
   {
   case OUTPUT_ENSIM:      sFILENAME<<".tb0"<<ends; break;
   case OUTPUT_NETCDF:     sFILENAME<<".nc" <<ends; break;
+  case OUTPUT_BINARY:     sFILENAME<<".npy"<<ends; break;
   case OUTPUT_STANDARD:
   default:                sFILENAME<<".csv"<<ends; break;
   }
@@ -373,9 +416,16 @@ void CCustomOutput::WriteFileHeader(const optStruct &Options)
 {
   DetermineCustomFilename(Options);
 
-  _CUSTOM.open(_filename.c_str());
-  if (_CUSTOM.fail()){
-    WriteWarning("CCustomOutput::WriteFileHeader: Unable to create file "+_filename,true);
+  if (Options.output_format==OUTPUT_BINARY){
+    if (!_BINARY.open(_filename)){
+      WriteWarning("CCustomOutput::WriteFileHeader: Unable to create file "+_filename,true);
+    }
+  }
+  else{
+    _CUSTOM.open(_filename.c_str());
+    if (_CUSTOM.fail()){
+      WriteWarning("CCustomOutput::WriteFileHeader: Unable to create file "+_filename,true);
+    }
   }
   // clear data (for ensembles)
   for(int k=0;k<_nData;k++){
@@ -394,6 +444,8 @@ void CCustomOutput::WriteFileHeader(const optStruct &Options)
     WriteEnSimFileHeader(Options);  return;
   case OUTPUT_NETCDF:
     WriteNetCDFFileHeader(Options); return;
+  case OUTPUT_BINARY:
+    WriteBinaryFileHeader(Options); return;
   }
 }
 
@@ -424,12 +476,12 @@ void CCustomOutput::WriteCSVFileHeader(void)
   {
     string title;
     ostrstream  TMP;
-    if      (_spaceAgg==BY_HRU        ){TMP<<pModel->GetHydroUnit(k)->GetHRUID() <<ends;}
+    if      (_spaceAgg==BY_HRU        ){TMP<<pModel->GetHydroUnit(pModel->GetOutputHRUIndex(k))->GetHRUID() <<ends;}
     else if (_spaceAgg==BY_HRU_GROUP  ){TMP<<pModel->GetHRUGroup(k)->GetName()<<ends;}
     else if (_spaceAgg==BY_SB_GROUP   ){TMP<<pModel->GetSubBasinGroup(k)->GetName()<<ends;}
     else if (_spaceAgg==BY_WSHED      ){TMP<<"Watershed"                      <<ends;}
-    else if (_spaceAgg==BY_BASIN      ){TMP<<pModel->GetSubBasin(k)->GetID()  <<ends;}
-    else if (_spaceAgg==BY_DRAINAGE   ){TMP<<pModel->GetSubBasin(k)->GetID()  <<ends;}
+    else if (_spaceAgg==BY_BASIN      ){TMP<<pModel->GetSubBasin(pModel->GetOutputSubBasinIndex(k))->GetID()  <<ends;}
+    else if (_spaceAgg==BY_DRAINAGE   ){TMP<<pModel->GetSubBasin(pModel->GetOutputSubBasinIndex(k))->GetID()  <<ends;}
     else if (_spaceAgg==BY_SELECT_HRUS){TMP<<pModel->GetHRUGroup(_kk_only)->GetHRU(k)->GetHRUID()<<ends;}
 
     title=TMP.str();
@@ -474,6 +526,59 @@ void CCustomOutput::WriteCSVFileHeader(void)
   _CUSTOM<<endl;
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief Write column descriptions to binary column file sidecar
+/// \details first column is time (end of aggregation period, days since simulation start);
+/// remaining columns are identical to those of the .csv file
+//
+void CCustomOutput::WriteBinaryFileHeader(const optStruct &Options)
+{
+  WriteBinaryFileAttributes(_BINARY,Options,"Custom Output");
+  _BINARY.AddAttribute("variable"            ,_varName);
+  _BINARY.AddAttribute("statistic"           ,_statStr);
+  _BINARY.AddAttribute("temporal_aggregation",_timeAggStr);
+  _BINARY.AddAttribute("spatial_aggregation" ,_spaceAggStr);
+
+  _BINARY.AddColumn("time","d");
+  for (int k=0;k<_nData;k++)
+  {
+    string title;
+    if      (_spaceAgg==BY_HRU        ){title="HRU "      +to_string(pModel->GetHydroUnit(pModel->GetOutputHRUIndex(k))->GetHRUID());}
+    else if (_spaceAgg==BY_HRU_GROUP  ){title=pModel->GetHRUGroup(k)->GetName();}
+    else if (_spaceAgg==BY_SB_GROUP   ){title=pModel->GetSubBasinGroup(k)->GetName();}
+    else if (_spaceAgg==BY_WSHED      ){title="Watershed";}
+    else if (_spaceAgg==BY_BASIN      ){title="SubBasin " +to_string(pModel->GetSubBasin(pModel->GetOutputSubBasinIndex(k))->GetID());}
+    else if (_spaceAgg==BY_DRAINAGE   ){title="SubBasin " +to_string(pModel->GetSubBasin(pModel->GetOutputSubBasinIndex(k))->GetID());}
+    else if (_spaceAgg==BY_SELECT_HRUS){title="HRU "      +to_string(pModel->GetHRUGroup(_kk_only)->GetHRU(k)->GetHRUID());}
+
+    if      (_aggstat==AGG_AVERAGE  ){_BINARY.AddColumn(title+" mean"    ,_varUnits);}
+    else if (_aggstat==AGG_MAXIMUM  ){_BINARY.AddColumn(title+" maximum" ,_varUnits);}
+    else if (_aggstat==AGG_MINIMUM  ){_BINARY.AddColumn(title+" minimum" ,_varUnits);}
+    else if (_aggstat==AGG_CUMULSUM ){_BINARY.AddColumn(title+" cumulsum",_varUnits);}
+    else if (_aggstat==AGG_MEDIAN   ){_BINARY.AddColumn(title+" median"  ,_varUnits);}
+    else if (_aggstat==AGG_RANGE    ){
+      _BINARY.AddColumn(title+" minimum",_varUnits);
+      _BINARY.AddColumn(title+" maximum",_varUnits);
+    }
+    else if (_aggstat==AGG_95CI     ){
+      _BINARY.AddColumn(title+" 5% quantile" ,_varUnits);
+      _BINARY.AddColumn(title+" 95% quantile",_varUnits);
+    }
+    else if (_aggstat==AGG_QUARTILES){
+      _BINARY.AddColumn(title+" 25% quartile",_varUnits);
+      _BINARY.AddColumn(title+" 50% quartile",_varUnits);
+      _BINARY.AddColumn(title+" 75% quartile",_varUnits);
+    }
+    else if (_aggstat==AGG_HISTOGRAM){
+      for (int bin=0;bin<_nBins;bin++){
+        ostrstream TMP;
+        TMP<<title<<" "<<_hist_min+bin*(_hist_max-_hist_min)/_nBins<<"-"<<_hist_min+(bin+1)*(_hist_max-_hist_min)/_nBins<<ends;
+        _BINARY.AddColumn(TMP.str(),"count");
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Write header info to EnSim file
 //
@@ -536,12 +641,12 @@ void CCustomOutput::WriteEnSimFileHeader(const optStruct &Options)
     ostrstream  curSpaceIdentifier;
     switch(_spaceAgg)
     {
-    case BY_HRU:                    curSpaceIdentifier<<"HRU_"           <<pModel->GetHydroUnit(k)->GetHRUID() <<ends; break;
+    case BY_HRU:                    curSpaceIdentifier<<"HRU_"           <<pModel->GetHydroUnit(pModel->GetOutputHRUIndex(k))->GetHRUID() <<ends; break;
     case BY_HRU_GROUP:              curSpaceIdentifier<<"HRUGroup_"      <<pModel->GetHRUGroup(k)->GetName()<<ends; break;
     case BY_SB_GROUP:               curSpaceIdentifier<<"SubbasinGroup_" <<pModel->GetSubBasinGroup(k)->GetName()<<ends; break;
     case BY_WSHED:                  curSpaceIdentifier<<"Watershed_"     <<"Watershed"                      <<ends; break;
-    case BY_BASIN:                  curSpaceIdentifier<<"SubBasin_"      <<pModel->GetSubBasin(k)->GetID()  <<ends; break;
-    case BY_DRAINAGE:               curSpaceIdentifier<<"SubBasin_"      <<pModel->GetSubBasin(k)->GetID()  <<ends; break;
+    case BY_BASIN:                  curSpaceIdentifier<<"SubBasin_"      <<pModel->GetSubBasin(pModel->GetOutputSubBasinIndex(k))->GetID()  <<ends; break;
+    case BY_DRAINAGE:               curSpaceIdentifier<<"SubBasin_"      <<pModel->GetSubBasin(pModel->GetOutputSubBasinIndex(k))->GetID()  <<ends; break;
     case BY_SELECT_HRUS:            curSpaceIdentifier<<"HRU_"           <<pModel->GetHRUGroup(_kk_only)->GetHRU(k)->GetHRUID()  <<ends; break;
     }
     string title=curSpaceIdentifier.str();
@@ -642,12 +747,8 @@ void CCustomOutput::WriteNetCDFFileHeader(const optStruct &Options)
   dimids1[0] = time_dimid;
   retval = nc_def_var(_netcdf_ID, "time", NC_DOUBLE, ndims1,dimids1, &varid_time); HandleNetCDFErrors(retval);
 
-  // Enable deflate compression for time variable (shuffle, zlib, deflate_level)
-  retval = nc_def_var_deflate(_netcdf_ID, varid_time, 1, 1, NETCDF_DEFLATE_LEVEL); HandleNetCDFErrors(retval);
-
-  // Set chunksize to len(time)
-  chunksize2[0] = ApproximateNumTimeSteps(Options) + 1;
-  retval = nc_def_var_chunking(_netcdf_ID, varid_time, NC_CHUNKED, &chunksize2[0]); HandleNetCDFErrors(retval);
+  // Enable deflate compression for time variable and set chunksize to len(time)
+  chunksize2[0] = NetCDFSetTimeStorage(_netcdf_ID, varid_time, ApproximateNumTimeSteps(Options) + 1, Options);
 
 
   // (c) Assign units attributes to the netCDF VARIABLES.
@@ -704,7 +805,9 @@ void CCustomOutput::WriteNetCDFFileHeader(const optStruct &Options)
     retval = nc_def_var(_netcdf_ID, netCDFtag.c_str(), NC_DOUBLE, ndims2, dimids2, &varid_data);    HandleNetCDFErrors(retval);
 
     // Enable deflate compression for data variable
-    retval = nc_def_var_deflate(_netcdf_ID, varid_data, 1, 1, NETCDF_DEFLATE_LEVEL); HandleNetCDFErrors(retval);
+    if (Options.NetCDF_deflate_level>0){
+      retval = nc_def_var_deflate(_netcdf_ID, varid_data, 1, 1, Options.NetCDF_deflate_level); HandleNetCDFErrors(retval);
+    }
 
     // Set chunksizes for data variable (time, ndata)
     chunksize2[1] = max((size_t)1, min((size_t)_nData, (size_t)(NETCDF_CHUNKSIZE_MB * 1024 * 1024 / sizeof(double) / chunksize2[0]))); // Ensure at least one basin per chunk
@@ -724,6 +827,7 @@ void CCustomOutput::WriteNetCDFFileHeader(const optStruct &Options)
 
   // End define mode. This tells netCDF we are done defining metadata.
   retval = nc_enddef(_netcdf_ID);  HandleNetCDFErrors(retval);
+  _netcdf_buf.Initialize(_netcdf_ID);
 
   // write values to NetCDF
   // write HRU/subbasin/HRU group names to variable "HRUID" or "SBID" or...
@@ -735,12 +839,12 @@ void CCustomOutput::WriteNetCDFFileHeader(const optStruct &Options)
   {
     ostrstream  TMP;
     string temp;
-    if      (_spaceAgg==BY_HRU        ){TMP<<pModel->GetHydroUnit(k)->GetHRUID()      <<ends;}
+    if      (_spaceAgg==BY_HRU        ){TMP<<pModel->GetHydroUnit(pModel->GetOutputHRUIndex(k))->GetHRUID()      <<ends;}
     else if (_spaceAgg==BY_HRU_GROUP  ){TMP<<pModel->GetHRUGroup(k)->GetName()     <<ends;}
     else if (_spaceAgg==BY_SB_GROUP   ){TMP<<pModel->GetSubBasinGroup(k)->GetName()<<ends;}
     else if (_spaceAgg==BY_WSHED      ){TMP<<"Watershed"                           <<ends;}
-    else if (_spaceAgg==BY_BASIN      ){TMP<<pModel->GetSubBasin(k)->GetID()       <<ends;}
-    else if (_spaceAgg==BY_DRAINAGE   ){TMP<<pModel->GetSubBasin(k)->GetID()       <<ends;}
+    else if (_spaceAgg==BY_BASIN      ){TMP<<pModel->GetSubBasin(pModel->GetOutputSubBasinIndex(k))->GetID()       <<ends;}
+    else if (_spaceAgg==BY_DRAINAGE   ){TMP<<pModel->GetSubBasin(pModel->GetOutputSubBasinIndex(k))->GetID()       <<ends;}
     else if (_spaceAgg==BY_SELECT_HRUS){TMP<<pModel->GetHRUGroup(_kk_only)->GetHRU(k)->GetHRUID()<<ends;}
     temp=TMP.str();
     strcpy(group_name[0],temp.c_str());
@@ -809,6 +913,51 @@ void GetQuartiles(const double *values, const int size, double &Q1, double &Q2,
   }
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief Writes aggregated statistic(s) of all data items for the current period to row
+/// \details shared by .csv/.tb0 and .npy output; sorts _aData for order statistics
+/// \param &ROW [out] destination of row values
+//
+void CCustomOutput::WriteStatistics(COutputRow &ROW)
+{
+  for (int k=0;k<_nData;k++)
+  {
+    if     (_aggstat==AGG_AVERAGE ){ ROW.AddValue(FormatDouble(_aData[k][0])); }
+    else if(_aggstat==AGG_MAXIMUM ){ ROW.AddValue(FormatDouble(_aData[k][0])); }
+    else if(_aggstat==AGG_MINIMUM ){ ROW.AddValue(FormatDouble(_aData[k][0])); }
+    else if(_aggstat==AGG_CUMULSUM){ ROW.AddValue(FormatDouble(_aData[k][0])); }
+    else if(_aggstat==AGG_RANGE   ){ ROW.AddValue(FormatDouble(_aData[k][0])); ROW.AddValue(FormatDouble(_aData[k][1])); }
+    else if((_aggstat==AGG_MEDIAN) || (_aggstat==AGG_QUARTILES)) //find lower quartile, median, then upper quartile
+    {
+      double Q1,Q2,Q3;
+      quickSort(_aData[k],0,_count-1);
+      GetQuartiles(_aData[k],_count,Q1,Q2,Q3);
+      if (_aggstat==AGG_QUARTILES){ROW.AddValue(FormatDouble(Q1));ROW.AddValue(FormatDouble(Q2));ROW.AddValue(FormatDouble(Q3));}
+      else                        {ROW.AddValue(FormatDouble(Q2));}
+    }
+    else if(_aggstat==AGG_95CI)
+    {
+      quickSort(_aData[k],0,_count-1);//take floor and ceiling of lower and upper intervals to be conservative
+      ROW.AddValue(FormatDouble(_aData[k][(int)floor((double)(_count-1)*0.025)]));
+      ROW.AddValue(FormatDouble(_aData[k][(int)ceil ((double)(_count-1)*0.975)]));
+    }
+    else if(_aggstat==AGG_HISTOGRAM)
+    {
+      double binsize = (_hist_max-_hist_min)/_nBins;
+      int bincount[MAX_HISTOGRAM_BINS];
+
+      for(int bin=0;bin<_nBins;bin++){ bincount[bin]=0; }
+      for(int a=0;a<_count;a++)
+      {
+        for(int bin=0;bin<_nBins;bin++){
+          if((_aData[k][a]>=(_hist_min+bin*binsize)) && (_aData[k][a]<(_hist_min+(bin+1)*binsize))){ bincount[bin]++; }
+        }
+      }
+      for(int bin=0;bin<_nBins;bin++){ ROW.AddValue((double)(bincount[bin])); }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Write custom output to file by querying the model and calculating diagnostics
 /// \brief now handles .csv, .nc, and .tb0 (Ensim) formats
@@ -841,9 +990,6 @@ void CCustomOutput::WriteCustomOutput(const time_struct &tt,
 
   if (t==0){return;} //initial conditions should not be printed to custom output, only period data.
 
-  double *output=NULL;
-  if(Options.output_format==OUTPUT_NETCDF){output=new double[_nData]; }
-
   //Check to see if it is time to write to file
   //------------------------------------------------------------------------------
   reset=false;
@@ -893,8 +1039,6 @@ void CCustomOutput::WriteCustomOutput(const time_struct &tt,
     else if(Options.output_format==OUTPUT_NETCDF)//=============================================================
     {
 #ifdef _RVNETCDF_
-      int retval,time_id;
-      size_t start1[1], count1[1];  // determines where and how much will be written to NetCDF; 1D variable (time)
       double current_time[1];       // current time in days since start of interval
 
       if      (_timeAgg==YEARLY      ){current_time[0]=yest.model_time-yest.julian_day;}
@@ -912,263 +1056,125 @@ void CCustomOutput::WriteCustomOutput(const time_struct &tt,
 
       current_time[0]=RoundToNearestMinute(current_time[0]*HR_PER_DAY); //convert to hours
 
-      //start1[0] = int(rvn_round(current_time[0]/Options.timestep));   // element of NetCDF array that will be written
-      start1[0]=_time_index;
-      count1[0] = 1;                                              // writes exactly one time step
-
-      retval = nc_inq_varid (_netcdf_ID, "time",   &time_id);                             HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_netcdf_ID, time_id, start1, count1, &current_time[0]); HandleNetCDFErrors(retval);
+      _netcdf_buf.StartTimeStep(_time_index);
+      _netcdf_buf.SetValue("time",current_time[0]);
 #endif
     }
   }
 
-  bool is_concentration=false;
-  is_concentration = (_var == VAR_STATE_VAR) && (pModel->GetStateVarType(_svind)==CONSTITUENT);
-
-  //--Precalculate drainage area averaged values in one sweep-----------------------
-  // go from upstream to downstream summing cumulative area*value
-  // at end, divide by drainage area to get area-weighted mean value
-  double *aDrainageVals=NULL;
-  double area;
-  if (_spaceAgg==BY_DRAINAGE)
-  {
-    aDrainageVals  =new double[pModel->GetNumSubBasins()];
-    double     *sum=new double[pModel->GetNumSubBasins()];
-    double *areasum=new double[pModel->GetNumSubBasins()]; //required when some basins are disabled (drainage area=0)
-    for (int p=0;p<pModel->GetNumSubBasins();p++){
-      sum[p]=0;
-      areasum[p]=0.0;
-      aDrainageVals[p]=0;
-    }
-    CSubBasin *pSB;
-    int p,p_down;
-    for (int pp=0;pp<pModel->GetNumSubBasins();pp++)
+  //Get current values of diagnostic variable (from end of timestep)
+  //--------------------------------------------------------------------------
+  //_nData=1 if BY_WATERSHED, =nSubBasins if BY_BASIN, =nHRUs if BY_HRU...
+  if (_iSource!=DOESNT_EXIST)
+  {
+    _pAggregator->GetSpatialValues(_iSource,_spaceAgg,_kk_only,_aVals,_nData); //HRU-based variables, gathered once for all custom outputs
+  }
+  else
+  {
+    const CSubBasin *pSB;
+    double *aVals=_aVals;
+    int     nVals=_nData;
+    if (_aDrainVals!=NULL){aVals=_aDrainVals; nVals=pModel->GetNumSubBasins();} //all subbasins, selected below
+    for (int k=0;k<nVals;k++)
     {
-      p=pModel->GetOrderedSubBasinIndex(pp);
-      pSB=pModel->GetSubBasin(p);
-      area=pSB->GetBasinArea();
-      if      (is_concentration           ){val=pSB->GetAvgConcentration(_svind);}
-      else if (_var==VAR_STATE_VAR        ){val=pSB->GetAvgStateVar     (_svind);}
-      else if (_var==VAR_FORCING_FUNCTION ){val=pSB->GetAvgForcing      (_ftype);}
-      else if (_var==VAR_TO_FLUX          ){val=pSB->GetAvgCumulFlux    (_svind,true);}
-      else if (_var==VAR_FROM_FLUX        ){val=pSB->GetAvgCumulFlux    (_svind,false);}
-      else if (_var==VAR_BETWEEN_FLUX     ){val=pSB->GetAvgCumulFluxBet (_svind,_svind2);}
-      else if (_var==VAR_STREAMFLOW       ){}//do nothing
-      else if (_var==VAR_RESERVOIR_STORAGE){val=pSB->GetReservoirStorage();}
-      else if (_var==VAR_CHANNEL_STORAGE  ){val=pSB->GetChannelStorage  ();}
-      else if (_var==VAR_RIVULET_STORAGE  ){val=pSB->GetRivuletStorage  ();}
-      sum    [p]+=area*val;
-      areasum[p]+=area;
-
-      p_down=pSB->GetDownstreamIndex();
-      if (p_down!=DOESNT_EXIST){
-        sum    [p_down]+=sum    [p];
-        areasum[p_down]+=areasum[p];
+      val=0.0;
+      if ((_spaceAgg==BY_BASIN) || (_spaceAgg==BY_DRAINAGE))
+      {
+        if (_aDrainVals!=NULL){pSB=pModel->GetSubBasin(k);}
+        else                  {pSB=pModel->GetSubBasin(pModel->GetOutputSubBasinIndex(k));}
+        if      (_var==VAR_STREAMFLOW       ){val=pSB->GetIntegratedOutflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);}
+        else if (_var==VAR_RESERVOIR_STORAGE){val=pSB->GetReservoirStorage();}
+        else if (_var==VAR_CHANNEL_STORAGE  ){val=pSB->GetChannelStorage  ();}
+        else if (_var==VAR_RIVULET_STORAGE  ){val=pSB->GetRivuletStorage  ();}
+      }
+      else if (_spaceAgg==BY_SB_GROUP)
+      {
+        if      (_var==VAR_STREAMFLOW       ){val=RAV_BLANK_DATA;} //todo [funct] - may wish to support later
+        else if (_var==VAR_RESERVOIR_STORAGE){val=pModel->GetSubBasinGroup(k)->GetTotalResStorage();  }
+        else if (_var==VAR_CHANNEL_STORAGE  ){val=pModel->GetSubBasinGroup(k)->GetTotalChannelStor(); }
+        else if (_var==VAR_RIVULET_STORAGE  ){val=pModel->GetSubBasinGroup(k)->GetTotalRivuletStor(); }
+      }
+      else if ((_var==VAR_STREAMFLOW) || (_var==VAR_RESERVOIR_STORAGE) || (_var==VAR_CHANNEL_STORAGE) || (_var==VAR_RIVULET_STORAGE))
+      {
+        val=RAV_BLANK_DATA; //todo [funct] - may wish to support by watershed later
       }
+      aVals[k]=val;
     }
-    for (int p=0;p<pModel->GetNumSubBasins();p++)
+    //streamflow is already cumulative; storage is averaged over drainage area upstream of subbasin outlet
+    if ((_spaceAgg==BY_DRAINAGE) && (_var!=VAR_STREAMFLOW))
     {
-      aDrainageVals[p]=sum[p]/areasum[p];//pModel->GetSubBasin(p)->GetDrainageArea();
+      CCustomOutputAggregator::DrainageAverage(pModel,aVals,aVals);
+    }
+    if (_aDrainVals!=NULL){
+      for (int k=0;k<_nData;k++){_aVals[k]=_aDrainVals[pModel->GetOutputSubBasinIndex(k)];}
     }
-    delete [] sum;
   }
+  _count++;//increment number of data items stored
 
-
-  //Sift through HRUs, BASINs or watershed, updating aggregate statistics
-  //--------------------------------------------------------------------------
-  //_nData=1 if BY_WATERSHED, =nSubBasins if BY_BASIN, =nHRUs if BY_HRU...
-  for (int k=0;k<_nData;k++)
+  //---Update diagnostics--------------------------------------------------
+  //-----------------------------------------------------------------------
+  if      (_aggstat==AGG_AVERAGE)
   {
-    //---access current diagnostic variable (from end of timestep)------------
-    if (is_concentration){
-      if      (_spaceAgg==BY_HRU        ) { val=pModel->GetTransportModel()->GetConcentration(k,_svind);}
-      else if (_spaceAgg==BY_BASIN      ) { val=pModel->GetSubBasin     (k)->GetAvgConcentration(_svind); }
-      else if (_spaceAgg==BY_DRAINAGE   ) { val=aDrainageVals[k];                                         }
-      else if (_spaceAgg==BY_WSHED      ) { val=pModel->                     GetAvgConcentration(_svind); }
-      else if (_spaceAgg==BY_HRU_GROUP  ) { val=pModel->GetHRUGroup     (k)->GetAvgConcentration(_svind); }
-      else if (_spaceAgg==BY_SB_GROUP   ) { val=pModel->GetSubBasinGroup(k)->GetAvgConcentration(_svind); }
-      else if (_spaceAgg==BY_SELECT_HRUS) { val=pModel->GetTransportModel()->GetConcentration(pModel->GetHRUGroup(_kk_only)->GetHRU(k)->GetGlobalIndex(),_svind);}
-    }
-    else if (_var==VAR_STATE_VAR){
-      if      (_spaceAgg==BY_HRU        ){val=pModel->GetHydroUnit     (k)->GetStateVarValue(_svind);}
-      else if (_spaceAgg==BY_BASIN      ){val=pModel->GetSubBasin      (k)->GetAvgStateVar  (_svind);}
-      else if (_spaceAgg==BY_DRAINAGE   ){val=aDrainageVals[k];                                      }
-      else if (_spaceAgg==BY_WSHED      ){val=pModel->                      GetAvgStateVar  (_svind);}
-      else if (_spaceAgg==BY_HRU_GROUP  ){val=pModel->GetHRUGroup      (k)->GetAvgStateVar  (_svind);}
-      else if (_spaceAgg==BY_SB_GROUP   ){val=pModel->GetSubBasinGroup (k)->GetAvgStateVar  (_svind);}
-      else if (_spaceAgg==BY_SELECT_HRUS){val=pModel->GetHRUGroup(_kk_only)->GetHRU(k)->GetStateVarValue(_svind);}
-    }
-    else if (_var==VAR_FORCING_FUNCTION){
-      if      (_spaceAgg==BY_HRU        ){val=pModel->GetHydroUnit     (k)->GetForcing   (_ftype);}
-      else if (_spaceAgg==BY_BASIN      ){val=pModel->GetSubBasin      (k)->GetAvgForcing(_ftype);}
-      else if (_spaceAgg==BY_DRAINAGE   ){val=aDrainageVals[k];                                   }
-      else if (_spaceAgg==BY_WSHED      ){val=pModel->                      GetAvgForcing(_ftype);}
-      else if (_spaceAgg==BY_HRU_GROUP  ){val=pModel->GetHRUGroup      (k)->GetAvgForcing(_ftype);}
-      else if (_spaceAgg==BY_SB_GROUP   ){val=pModel->GetSubBasinGroup (k)->GetAvgForcing(_ftype);}
-      else if (_spaceAgg==BY_SELECT_HRUS){val=pModel->GetHRUGroup (_kk_only)->GetHRU(k)->GetForcing(_ftype);}
-    }
-    else if (_var == VAR_TO_FLUX){
-      if      (_spaceAgg==BY_HRU        ){val=pModel->GetHydroUnit     (k)->GetCumulFlux   (_svind,true);}
-      else if (_spaceAgg==BY_BASIN      ){val=pModel->GetSubBasin      (k)->GetAvgCumulFlux(_svind,true);}
-      else if (_spaceAgg==BY_DRAINAGE   ){val=aDrainageVals[k];                                          }
-      else if (_spaceAgg==BY_WSHED      ){val=pModel->                      GetAvgCumulFlux(_svind,true);}
-      else if (_spaceAgg==BY_HRU_GROUP  ){val=pModel->GetHRUGroup      (k)->GetAvgCumulFlux(_svind,true);}
-      else if (_spaceAgg==BY_SB_GROUP   ){val=pModel->GetSubBasinGroup (k)->GetAvgCumulFlux(_svind,true);}
-      else if (_spaceAgg==BY_SELECT_HRUS){val=pModel->GetHRUGroup (_kk_only)->GetHRU(k)->GetCumulFlux(_svind,true);}
-    }
-    else if (_var == VAR_FROM_FLUX){
-      if      (_spaceAgg==BY_HRU        ){val=pModel->GetHydroUnit     (k)->GetCumulFlux   (_svind,false);}
-      else if (_spaceAgg==BY_BASIN      ){val=pModel->GetSubBasin      (k)->GetAvgCumulFlux(_svind,false);}
-      else if (_spaceAgg==BY_DRAINAGE   ){val=aDrainageVals[k];                                           }
-      else if (_spaceAgg==BY_WSHED      ){val=pModel->                      GetAvgCumulFlux(_svind,false);}
-      else if (_spaceAgg==BY_HRU_GROUP  ){val=pModel->GetHRUGroup      (k)->GetAvgCumulFlux(_svind,false);}
-      else if (_spaceAgg==BY_SB_GROUP   ){val=pModel->GetSubBasinGroup (k)->GetAvgCumulFlux(_svind,false);}
-      else if (_spaceAgg==BY_SELECT_HRUS){val=pModel->GetHRUGroup (_kk_only)->GetHRU(k)->GetCumulFlux(_svind,false);}
-    }
-    else if (_var == VAR_BETWEEN_FLUX){
-      if      (_spaceAgg==BY_HRU        ){val=pModel->GetHydroUnit     (k)->GetCumulFluxBet   (_svind,_svind2);}
-      else if (_spaceAgg==BY_BASIN      ){val=pModel->GetSubBasin      (k)->GetAvgCumulFluxBet(_svind,_svind2);}
-      else if (_spaceAgg==BY_DRAINAGE   ){val=aDrainageVals[k];                                                }
-      else if (_spaceAgg==BY_WSHED      ){val=pModel->                      GetAvgCumulFluxBet(_svind,_svind2);}
-      else if (_spaceAgg==BY_HRU_GROUP  ){val=pModel->GetHRUGroup      (k)->GetAvgCumulFluxBet(_svind,_svind2);}
-      else if (_spaceAgg==BY_SB_GROUP   ){val=pModel->GetSubBasinGroup (k)->GetAvgCumulFluxBet(_svind,_svind2);}
-      else if (_spaceAgg==BY_SELECT_HRUS){val=pModel->GetHRUGroup (_kk_only)->GetHRU(k)->GetCumulFluxBet(_svind,_svind2);}
-    }
-    else if(_var==VAR_STREAMFLOW) {
-      if      (_spaceAgg==BY_HRU        ){val=RAV_BLANK_DATA;                                        }
-      else if (_spaceAgg==BY_BASIN      ){val=pModel->GetSubBasin      (k)->GetIntegratedOutflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);}
-      else if (_spaceAgg==BY_DRAINAGE   ){val=pModel->GetSubBasin      (k)->GetIntegratedOutflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);}
-      else if (_spaceAgg==BY_WSHED      ){val=RAV_BLANK_DATA;} //todo [funct] - may wish to support later
-      else if (_spaceAgg==BY_HRU_GROUP  ){val=RAV_BLANK_DATA;}
-      else if (_spaceAgg==BY_SB_GROUP   ){val=RAV_BLANK_DATA;} //todo [funct] - may wish to support later
-      else if (_spaceAgg==BY_SELECT_HRUS){val=RAV_BLANK_DATA;}
-    }
-    else if(_var==VAR_RESERVOIR_STORAGE) {
-      if      (_spaceAgg==BY_HRU        ){val=RAV_BLANK_DATA;                                        }
-      else if (_spaceAgg==BY_BASIN      ){val=pModel->GetSubBasin      (k)->GetReservoirStorage();   }
-      else if (_spaceAgg==BY_DRAINAGE   ){val=aDrainageVals[k];                                      } 
-      else if (_spaceAgg==BY_WSHED      ){val=RAV_BLANK_DATA;} //todo [funct] - may wish to support later
-      else if (_spaceAgg==BY_HRU_GROUP  ){val=RAV_BLANK_DATA;}
-      else if (_spaceAgg==BY_SB_GROUP   ){val=pModel->GetSubBasinGroup (k)->GetTotalResStorage();    } 
-      else if (_spaceAgg==BY_SELECT_HRUS){val=RAV_BLANK_DATA;}
-    }
-    else if(_var==VAR_CHANNEL_STORAGE) {
-      if      (_spaceAgg==BY_HRU        ){val=RAV_BLANK_DATA;                                        }
-      else if (_spaceAgg==BY_BASIN      ){val=pModel->GetSubBasin      (k)->GetChannelStorage();     }
-      else if (_spaceAgg==BY_DRAINAGE   ){val=aDrainageVals[k];                                      } 
-      else if (_spaceAgg==BY_WSHED      ){val=RAV_BLANK_DATA;} //todo [funct] - may wish to support later
-      else if (_spaceAgg==BY_HRU_GROUP  ){val=RAV_BLANK_DATA;}
-      else if (_spaceAgg==BY_SB_GROUP   ){val=pModel->GetSubBasinGroup (k)->GetTotalChannelStor();   } 
-      else if (_spaceAgg==BY_SELECT_HRUS){val=RAV_BLANK_DATA;}
-    }
-    else if(_var==VAR_RIVULET_STORAGE) {
-      if      (_spaceAgg==BY_HRU        ){val=RAV_BLANK_DATA;                                         }
-      else if (_spaceAgg==BY_BASIN      ){val=pModel->GetSubBasin      (k)->GetRivuletStorage();      }
-      else if (_spaceAgg==BY_DRAINAGE   ){val=aDrainageVals[k];                                       } 
-      else if (_spaceAgg==BY_WSHED      ){val=RAV_BLANK_DATA;} //todo [funct] - may wish to support later
-      else if (_spaceAgg==BY_HRU_GROUP  ){val=RAV_BLANK_DATA;}
-      else if (_spaceAgg==BY_SB_GROUP   ){val=pModel->GetSubBasinGroup (k)->GetTotalRivuletStor();    }
-      else if (_spaceAgg==BY_SELECT_HRUS){val=RAV_BLANK_DATA;}
+    //incrementally adding to average - 1/N*((N-1)(old mean)+(val))
+    double wt=(double)(_count-1)/(double)(_count);
+    for (int k=0;k<_nData;k++){_aData[k][0]=wt*_aData[k][0]+_aVals[k]/(double)(_count);}
+  }
+  else if (_aggstat==AGG_MAXIMUM)
+  {
+    for (int k=0;k<_nData;k++){upperswap(_aData[k][0],_aVals[k]);}
+  }
+  else if (_aggstat==AGG_MINIMUM)
+  {
+    for (int k=0;k<_nData;k++){lowerswap(_aData[k][0],_aVals[k]);}
+  }
+  else if(_aggstat==AGG_CUMULSUM)
+  {
+    for (int k=0;k<_nData;k++){_aData[k][0]+=_aVals[k]*Options.timestep;}
+  }
+  else if (_aggstat==AGG_RANGE)
+  {
+    for (int k=0;k<_nData;k++){
+      lowerswap(_aData[k][0],_aVals[k]);
+      upperswap(_aData[k][1],_aVals[k]);
     }
-    if (k==0){_count++;}//increment number of data items stored
+  }
+  else if ((_aggstat==AGG_MEDIAN)    ||
+           (_aggstat==AGG_QUARTILES) ||
+           (_aggstat==AGG_95CI)      ||
+           (_aggstat==AGG_HISTOGRAM))
+  {
+    //populate data
+    for (int k=0;k<_nData;k++){_aData[k][_count-1]=_aVals[k];}
+  }
+  else
+  {
+    for (int k=0;k<_nData;k++){_aData[k][0]=_aVals[k];}//most recent value
+  }
 
-    //---Update diagnostics--------------------------------------------------
-    //-----------------------------------------------------------------------
-    if      (_aggstat==AGG_AVERAGE)
-    {
-      //incrementally adding to average - 1/N*((N-1)(old mean)+(val))
-      _aData[k][0]=(double)(_count-1)/(double)(_count)*_aData[k][0]+val/(double)(_count);
-    }
-    else if (_aggstat==AGG_MAXIMUM)
-    {
-      upperswap(_aData[k][0],val);
-    }
-    else if (_aggstat==AGG_MINIMUM)
-    {
-      lowerswap(_aData[k][0],val);
-    }
-    else if(_aggstat==AGG_CUMULSUM)
-    {
-      _aData[k][0]+=val*Options.timestep;
-    }
-    else if (_aggstat==AGG_RANGE)
-    {
-      lowerswap(_aData[k][0],val);
-      upperswap(_aData[k][1],val);
-    }
-    else if ((_aggstat==AGG_MEDIAN)    ||
-             (_aggstat==AGG_QUARTILES) ||
-             (_aggstat==AGG_95CI)      ||
-             (_aggstat==AGG_HISTOGRAM))
-    {
-      //populate data
-      _aData[k][_count-1] = val;
-    }
-    else
-    {
-      _aData[k][0]=val;//most recent value
-    }
+  //---Write output to file and reinitialize statistics, if needed---------
+  //-----------------------------------------------------------------------
+  if ((!reset) || (skip)){return;}
 
-    //---Write output to file and reinitialize statistics, if needed---------
-    //-----------------------------------------------------------------------
-    if (reset)
+  if((Options.output_format==OUTPUT_STANDARD) || (Options.output_format==OUTPUT_ENSIM))
+  {
+    string sep=",";
+    if(Options.output_format==OUTPUT_ENSIM){ sep=" "; }//space separated
+    //write to .csv or .tb0 file
+    CTextOutputRow ROW(_CUSTOM,sep.c_str(),true);
+    WriteStatistics(ROW);
+    _CUSTOM<<endl;//valid for ensim or .csv format
+  }
+  else if(Options.output_format==OUTPUT_NETCDF)
+  {
+#ifdef _RVNETCDF_
+    // Write to NetCDF (done entire vector of data at once, held in block buffer)
+    if (_nData > 0)
     {
-      if ((pModel->GetEnsemble() != NULL) && (pModel->GetEnsemble()->DontWriteOutput())) { return; }
-
-      if((Options.output_format==OUTPUT_STANDARD) || (Options.output_format==OUTPUT_ENSIM))
-      {
-        string sep=",";
-        if(Options.output_format==OUTPUT_ENSIM){ sep=" "; }//space separated
-        //write to .csv or .tb0 file
-        if     (_aggstat==AGG_AVERAGE ){ _CUSTOM<<FormatDouble(_aData[k][0])      <<sep; }
-        else if(_aggstat==AGG_MAXIMUM ){ _CUSTOM<<FormatDouble(_aData[k][0])      <<sep; }
-        else if(_aggstat==AGG_MINIMUM ){ _CUSTOM<<FormatDouble(_aData[k][0])      <<sep; }
-        else if(_aggstat==AGG_CUMULSUM){ _CUSTOM<<FormatDouble(_aData[k][0])      <<sep; }
-        else if(_aggstat==AGG_RANGE   ){ _CUSTOM<<FormatDouble(_aData[k][0])      <<sep<<FormatDouble(_aData[k][1])<<sep; }
-        else if(_aggstat==AGG_MEDIAN)
-        {
-          double Q1,Q2,Q3;
-          quickSort(_aData[k],0,_count-1);
-          GetQuartiles(_aData[k],_count,Q1,Q2,Q3);
-          _CUSTOM<<FormatDouble(Q2)<<sep;
-        }
-        else if(_aggstat==AGG_QUARTILES) //find lower quartile, median, then upper quartile
-        {
-          double Q1,Q2,Q3;
-          quickSort(_aData[k],0,_count-1);
-          GetQuartiles(_aData[k],_count,Q1,Q2,Q3);
-          _CUSTOM<<FormatDouble(Q1)<<sep<<FormatDouble(Q2)<<sep<<FormatDouble(Q3)<<sep;
-        }
-        else if(_aggstat==AGG_95CI)
-        {
-          quickSort(_aData[k],0,_count-1);//take floor and ceiling of lower and upper intervals to be conservative
-          _CUSTOM  << FormatDouble(_aData[k][(int)floor((double)(_count-1)*0.025)])<<sep;
-          _CUSTOM  << FormatDouble(_aData[k][(int)ceil((double)(_count-1)*0.975)])<<sep;
-        }
-        else if(_aggstat==AGG_HISTOGRAM)
-        {
-          quickSort(_aData[k],0,_count-1);
-          double binsize = (_hist_max-_hist_min)/_nBins;
-          int bincount[MAX_HISTOGRAM_BINS];
-
-          for(int bin=0;bin<_nBins;bin++){ bincount[bin]=0; }
-          for(int a=0;a<_count;a++)
-          {
-            for(int bin=0;bin<_nBins;bin++){
-              if((_aData[k][a]>=(_hist_min+bin*binsize)) && (_aData[k][a]<(_hist_min+(bin+1)*binsize))){ bincount[bin]++; }
-            }
-          }
-
-          for(int bin=0;bin<_nBins;bin++){
-            _CUSTOM<<bincount[bin]<<sep;
-          }
-        }
-
-      }
-      else if(Options.output_format==OUTPUT_NETCDF)
+      string netCDFtag=_statStr+"_"+_varName;
+      _netcdf_buf.StartTimeStep(_time_index);
+      double *row=_netcdf_buf.GetRow(netCDFtag);
+      for (int k=0;(row!=NULL) && (k<_nData);k++)
       {
-#ifdef _RVNETCDF_
-        // Collect Data
         double out=0.0;
         if     (_aggstat==AGG_AVERAGE ){ out=_aData[k][0]; }
         else if(_aggstat==AGG_MAXIMUM ){ out=_aData[k][0]; }
@@ -1181,65 +1187,44 @@ void CCustomOutput::WriteCustomOutput(const time_struct &tt,
           GetQuartiles(_aData[k],_count,Q1,Q2,Q3);
           out=Q2;
         }
-        output[k]=out;
-#endif
-      }
-
-      //-reset to initial conditions
-      //-----------------------------------------------------------------------
-      if      (_aggstat==AGG_AVERAGE ){_aData[k][0]= 0.0;}
-      else if (_aggstat==AGG_MAXIMUM ){_aData[k][0]=-ALMOST_INF;}
-      else if (_aggstat==AGG_MINIMUM ){_aData[k][0]= ALMOST_INF;}
-      else if (_aggstat==AGG_CUMULSUM){_aData[k][0]= 0.0;}
-      else if (_aggstat==AGG_RANGE   )
-      {
-        _aData[k][0]= ALMOST_INF;
-        _aData[k][1]=-ALMOST_INF;
-      }
-      else if ((_aggstat==AGG_MEDIAN)    ||
-               (_aggstat==AGG_QUARTILES) ||
-               (_aggstat==AGG_95CI)      ||
-               (_aggstat==AGG_HISTOGRAM))
-      {
-        for(int j=0;j<_nDataItems;j++){
-          _aData[k][j]=0;
-        }
-      }
-      //...more stats here
-      if (k==_nData-1){_count=0;}//don't reboot count until last HRU/basin is done
-    }//end if (reset)
-  }//end for (k=0;...
-
-  delete[] aDrainageVals;
-
-  if (reset){
-    if ((pModel->GetEnsemble() != NULL) && (pModel->GetEnsemble()->DontWriteOutput())) { return; }
-
-  	if((Options.output_format==OUTPUT_STANDARD) || (Options.output_format==OUTPUT_ENSIM))
-    {
-      _CUSTOM<<endl;//valid for ensim or .csv format
-		}
-		else if (Options.output_format==OUTPUT_NETCDF)
-    {
-#ifdef _RVNETCDF_
-      // Write to NetCDF (done entire vector of data at once)
-
-      if (_nData > 0)
-      {
-        int retval,data_id;
-        size_t start2[2], count2[2];
-        start2[0]=_time_index;  count2[0] = 1;         // writes exactly one time interval (yr/mo/day/hr)
-        start2[1] = 0;          count2[1] = _nData;    // writes exactly num_data elements
-
-        string netCDFtag=_statStr+"_"+_varName;
-        retval = nc_inq_varid      (_netcdf_ID, netCDFtag.c_str(), &data_id);          HandleNetCDFErrors(retval);
-        retval = nc_put_vara_double(_netcdf_ID, data_id, start2, count2, &output[0]);  HandleNetCDFErrors(retval);
+        row[k]=out;
       }
-      delete [] output;
+    }
 #endif
-		}
-    _time_index++;
   }
+  else if(Options.output_format==OUTPUT_BINARY)
+  {
+    //write to .npy file (time, then same values as .csv file)
+    _BINARY.AddValue(t);
+    WriteStatistics(_BINARY);
+    _BINARY.EndRow();
+  }
+
+  //-reset to initial conditions
+  //-----------------------------------------------------------------------
+  if      (_aggstat==AGG_AVERAGE ){for (int k=0;k<_nData;k++){_aData[k][0]= 0.0;}}
+  else if (_aggstat==AGG_MAXIMUM ){for (int k=0;k<_nData;k++){_aData[k][0]=-ALMOST_INF;}}
+  else if (_aggstat==AGG_MINIMUM ){for (int k=0;k<_nData;k++){_aData[k][0]= ALMOST_INF;}}
+  else if (_aggstat==AGG_CUMULSUM){for (int k=0;k<_nData;k++){_aData[k][0]= 0.0;}}
+  else if (_aggstat==AGG_RANGE   )
+  {
+    for (int k=0;k<_nData;k++){
+      _aData[k][0]= ALMOST_INF;
+      _aData[k][1]=-ALMOST_INF;
+    }
+  }
+  else if ((_aggstat==AGG_MEDIAN)    ||
+           (_aggstat==AGG_QUARTILES) ||
+           (_aggstat==AGG_95CI)      ||
+           (_aggstat==AGG_HISTOGRAM))
+  {
+    for (int k=0;k<_nData;k++){
+      for(int j=0;j<_nDataItems;j++){_aData[k][j]=0;}
+    }
+  }
+  //...more stats here
+  _count=0;
+  _time_index++;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -1248,9 +1233,11 @@ void CCustomOutput::WriteCustomOutput(const time_struct &tt,
 void CCustomOutput::CloseFiles(const optStruct& Options)
 {
   if (_CUSTOM.is_open()){_CUSTOM.close();}
+  _BINARY.close();
   if(Options.output_format==OUTPUT_NETCDF) {
 #ifdef _RVNETCDF_
     int retval;
+    _netcdf_buf.Flush(); _netcdf_buf.Destroy();
     if(_netcdf_ID!=-9) { retval=nc_close(_netcdf_ID); HandleNetCDFErrors(retval); } _netcdf_ID=-9;
 #endif
   }
@@ -1438,3 +1425,491 @@ CCustomOutput *CCustomOutput::ParseCustomOutputCommand(char *s[MAXINPUTITEMS], c
 
   return pCustom;
 }
+
+//////////////////////////////////////////////////////////////////
+/// \brief Implementation of the CCustomOutputAggregator constructor
+/// \param *pMod [in] Pointer to model
+//
+CCustomOutputAggregator::CCustomOutputAggregator(const CModel *pMod)
+{
+  ExitGracefullyIf(pMod==NULL,"CCustomOutputAggregator Constructor: NULL model",BAD_DATA);
+  _pModel       =pMod;
+  _nSources     =0;
+  _aSources     =NULL;
+  _aNeedsBasin  =NULL;
+  _aHRUVals     =NULL;
+  _aBasinVals   =NULL;
+  _aHRUMask     =NULL;
+  _aBasinMask   =NULL;
+  _aHRUList     =NULL;
+  _nHRUList     =NULL;
+  _aBasinList   =NULL;
+  _nBasinList   =NULL;
+  _aFullSources =NULL;
+  _nFullSources =0;
+  _aDrainVals   =NULL;
+  _nHRUs        =0;
+  _nSubBasins   =0;
+  _aSBStart     =NULL;
+  _aSBHRUs      =NULL;
+  _aSBHRUArea   =NULL;
+  _aGrpStart    =NULL;
+  _aGrpHRUs     =NULL;
+  _aGrpHRUArea  =NULL;
+  _aGrpArea     =NULL;
+  _nWshedHRUs   =0;
+  _aWshedHRUs   =NULL;
+  _aWshedHRUArea=NULL;
+  _aSBGrpStart  =NULL;
+  _aSBGrpSBs    =NULL;
+  _aSBGrpArea   =NULL;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Implementation of the default destructor
+//
+CCustomOutputAggregator::~CCustomOutputAggregator()
+{
+  DestroyIndexLists();
+  for (int s=0;s<_nSources;s++){
+    delete [] _aHRUMask  [s];
+    delete [] _aBasinMask[s];
+  }
+  delete [] _aHRUMask;    _aHRUMask=NULL;
+  delete [] _aBasinMask;  _aBasinMask=NULL;
+  delete [] _aSources;    _aSources=NULL;
+  delete [] _aNeedsBasin; _aNeedsBasin=NULL;
+  _nSources=0;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Deletes value arrays and index lists
+//
+void CCustomOutputAggregator::DestroyIndexLists()
+{
+  if (_aHRUVals!=NULL){
+    for (int s=0;s<_nSources;s++){delete [] _aHRUVals[s];  } delete [] _aHRUVals;   _aHRUVals=NULL;
+  }
+  if (_aBasinVals!=NULL){
+    for (int s=0;s<_nSources;s++){delete [] _aBasinVals[s];} delete [] _aBasinVals; _aBasinVals=NULL;
+  }
+  if (_aHRUList!=NULL){
+    for (int s=0;s<_nSources;s++){delete [] _aHRUList[s];  } delete [] _aHRUList;   _aHRUList=NULL;
+  }
+  if (_aBasinList!=NULL){
+    for (int s=0;s<_nSources;s++){delete [] _aBasinList[s];} delete [] _aBasinList; _aBasinList=NULL;
+  }
+  delete [] _nHRUList;      _nHRUList=NULL;
+  delete [] _nBasinList;    _nBasinList=NULL;
+  delete [] _aFullSources;  _aFullSources=NULL;
+  delete [] _aDrainVals;    _aDrainVals=NULL;
+  _nFullSources=0;
+  delete [] _aSBStart;      _aSBStart=NULL;
+  delete [] _aSBHRUs;       _aSBHRUs=NULL;
+  delete [] _aSBHRUArea;    _aSBHRUArea=NULL;
+  delete [] _aGrpStart;     _aGrpStart=NULL;
+  delete [] _aGrpHRUs;      _aGrpHRUs=NULL;
+  delete [] _aGrpHRUArea;   _aGrpHRUArea=NULL;
+  delete [] _aGrpArea;      _aGrpArea=NULL;
+  delete [] _aWshedHRUs;    _aWshedHRUs=NULL;
+  delete [] _aWshedHRUArea; _aWshedHRUArea=NULL;
+  delete [] _aSBGrpStart;   _aSBGrpStart=NULL;
+  delete [] _aSBGrpSBs;     _aSBGrpSBs=NULL;
+  delete [] _aSBGrpArea;    _aSBGrpArea=NULL;
+  _nWshedHRUs=0;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Adds source of HRU values, if not already present
+/// \param &src [in] HRU-based quantity required by custom output
+/// \param agg [in] spatial aggregation of custom output
+/// \param kk_only [in] HRU group index (if agg==BY_SELECT_HRUS)
+/// \return index of source
+//
+int CCustomOutputAggregator::AddSource(const custom_source &src,const spatial_agg agg,const int kk_only)
+{
+  ExitGracefullyIf(_aHRUVals!=NULL,"CCustomOutputAggregator::AddSource: sources cannot be added after initialization",RUNTIME_ERR);
+  int  iSource=DOESNT_EXIST;
+  bool same;
+  for (int s=0;s<_nSources;s++)
+  {
+    same=(_aSources[s].var==src.var) && (_aSources[s].is_conc==src.is_conc);
+    if      (src.var==VAR_FORCING_FUNCTION){same=same && (_aSources[s].ftype==src.ftype);}
+    else if (src.var==VAR_BETWEEN_FLUX    ){same=same && (_aSources[s].svind==src.svind) && (_aSources[s].svind2==src.svind2);}
+    else                                   {same=same && (_aSources[s].svind==src.svind);}
+    if (same){iSource=s;break;}
+  }
+  if (iSource==DOESNT_EXIST)
+  {
+    int nHRUs=_pModel->GetNumHRUs();
+    int nSB  =_pModel->GetNumSubBasins();
+    custom_source *aSources   =new custom_source[_nSources+1];
+    bool          *aNeedsBasin=new bool         [_nSources+1];
+    bool         **aHRUMask   =new bool        *[_nSources+1];
+    bool         **aBasinMask =new bool        *[_nSources+1];
+    ExitGracefullyIf(aBasinMask==NULL,"CCustomOutputAggregator::AddSource",OUT_OF_MEMORY);
+    for (int s=0;s<_nSources;s++){
+      aSources   [s]=_aSources   [s];
+      aNeedsBasin[s]=_aNeedsBasin[s];
+      aHRUMask   [s]=_aHRUMask   [s];
+      aBasinMask [s]=_aBasinMask [s];
+    }
+    aSources   [_nSources]=src;
+    aNeedsBasin[_nSources]=false;
+    aHRUMask   [_nSources]=new bool [max(nHRUs,1)];
+    aBasinMask [_nSources]=new bool [max(nSB,1)];
+    ExitGracefullyIf(aBasinMask[_nSources]==NULL,"CCustomOutputAggregator::AddSource",OUT_OF_MEMORY);
+    for (int k=0;k<nHRUs;k++){aHRUMask  [_nSources][k]=false;}
+    for (int p=0;p<nSB;  p++){aBasinMask[_nSources][p]=false;}
+    delete [] _aSources;    _aSources   =aSources;
+    delete [] _aNeedsBasin; _aNeedsBasin=aNeedsBasin;
+    delete [] _aHRUMask;    _aHRUMask   =aHRUMask;
+    delete [] _aBasinMask;  _aBasinMask =aBasinMask;
+    iSource=_nSources;
+    _nSources++;
+  }
+  if ((agg==BY_BASIN) || (agg==BY_DRAINAGE) || (agg==BY_SB_GROUP)){_aNeedsBasin[iSource]=true;}
+
+  //flag HRUs and subbasins in which source is needed
+  bool *hmask=_aHRUMask  [iSource];
+  bool *bmask=_aBasinMask[iSource];
+  int   nHRUs=_pModel->GetNumHRUs();
+  int   nSB  =_pModel->GetNumSubBasins();
+  if (agg==BY_HRU)
+  {
+    for (int i=0;i<_pModel->GetNumOutputHRUs();i++){hmask[_pModel->GetOutputHRUIndex(i)]=true;}
+  }
+  else if (agg==BY_BASIN)
+  {
+    for (int i=0;i<_pModel->GetNumOutputSubBasins();i++){
+      const CSubBasin *pSB=_pModel->GetSubBasin(_pModel->GetOutputSubBasinIndex(i));
+      bmask[_pModel->GetOutputSubBasinIndex(i)]=true;
+      for (int k=0;k<pSB->GetNumHRUs();k++){hmask[pSB->GetHRU(k)->GetGlobalIndex()]=true;}
+    }
+  }
+  else if (agg==BY_SELECT_HRUS)
+  {
+    const CHRUGroup *pGrp=_pModel->GetHRUGroup(kk_only);
+    for (int k=0;k<pGrp->GetNumHRUs();k++){hmask[pGrp->GetHRU(k)->GetGlobalIndex()]=true;}
+  }
+  else //drainage, watershed and group averages
+  {
+    for (int k=0;k<nHRUs;k++){hmask[k]=true;}
+    if ((agg==BY_DRAINAGE) || (agg==BY_SB_GROUP)){
+      for (int p=0;p<nSB;p++){bmask[p]=true;}
+    }
+  }
+  return iSource;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Allocates value arrays and builds index/area lists of enabled HRUs by subbasin, HRU group and watershed, and of subbasins by subbasin group
+/// \remarks Called prior to simulation, after all custom outputs have registered their sources. HRU areas and enabled status do not change during simulation
+//
+void CCustomOutputAggregator::Initialize()
+{
+  int k,p,kk,pp,n;
+  const CHydroUnit *pHRU;
+
+  DestroyIndexLists();
+
+  _nHRUs     =_pModel->GetNumHRUs();
+  _nSubBasins=_pModel->GetNumSubBasins();
+  int nHRUGroups=_pModel->GetNumHRUGroups();
+  int nSBGroups =_pModel->GetNumSubBasinGroups();
+
+  //value arrays
+  _aHRUVals  =new double *[_nSources];
+  _aBasinVals=new double *[_nSources];
+  ExitGracefullyIf(_aBasinVals==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+  for (int s=0;s<_nSources;s++)
+  {
+    _aHRUVals[s]=new double [_nHRUs];
+    ExitGracefullyIf(_aHRUVals[s]==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+    for (k=0;k<_nHRUs;k++){_aHRUVals[s][k]=0.0;}
+    _aBasinVals[s]=NULL;
+    if (_aNeedsBasin[s]){
+      _aBasinVals[s]=new double [_nSubBasins];
+      ExitGracefullyIf(_aBasinVals[s]==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+      for (p=0;p<_nSubBasins;p++){_aBasinVals[s][p]=0.0;}
+    }
+  }
+
+  //enabled HRUs by subbasin
+  _aSBStart=new int [_nSubBasins+1];
+  ExitGracefullyIf(_aSBStart==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+  n=0;
+  for (p=0;p<_nSubBasins;p++){
+    _aSBStart[p]=n;
+    const CSubBasin *pSB=_pModel->GetSubBasin(p);
+    for (k=0;k<pSB->GetNumHRUs();k++){if (pSB->GetHRU(k)->IsEnabled()){n++;}}
+  }
+  _aSBStart[_nSubBasins]=n;
+  _aSBHRUs   =new int    [max(n,1)];
+  _aSBHRUArea=new double [max(n,1)];
+  ExitGracefullyIf(_aSBHRUArea==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+  n=0;
+  for (p=0;p<_nSubBasins;p++){
+    const CSubBasin *pSB=_pModel->GetSubBasin(p);
+    for (k=0;k<pSB->GetNumHRUs();k++){
+      pHRU=pSB->GetHRU(k);
+      if (pHRU->IsEnabled()){_aSBHRUs[n]=pHRU->GetGlobalIndex(); _aSBHRUArea[n]=pHRU->GetArea(); n++;}
+    }
+  }
+
+  //enabled HRUs by HRU group
+  _aGrpStart=new int    [nHRUGroups+1];
+  _aGrpArea =new double [max(nHRUGroups,1)];
+  ExitGracefullyIf(_aGrpArea==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+  n=0;
+  for (kk=0;kk<nHRUGroups;kk++){
+    _aGrpStart[kk]=n;
+    const CHRUGroup *pGrp=_pModel->GetHRUGroup(kk);
+    for (k=0;k<pGrp->GetNumHRUs();k++){if (pGrp->GetHRU(k)->IsEnabled()){n++;}}
+  }
+  _aGrpStart[nHRUGroups]=n;
+  _aGrpHRUs   =new int    [max(n,1)];
+  _aGrpHRUArea=new double [max(n,1)];
+  ExitGracefullyIf(_aGrpHRUArea==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+  n=0;
+  for (kk=0;kk<nHRUGroups;kk++){
+    const CHRUGroup *pGrp=_pModel->GetHRUGroup(kk);
+    _aGrpArea[kk]=0.0;
+    for (k=0;k<pGrp->GetNumHRUs();k++){
+      pHRU=pGrp->GetHRU(k);
+      if (pHRU->IsEnabled()){_aGrpHRUs[n]=pHRU->GetGlobalIndex(); _aGrpHRUArea[n]=pHRU->GetArea(); _aGrpArea[kk]+=_aGrpHRUArea[n]; n++;}
+    }
+  }
+
+  //enabled HRUs in watershed
+  _nWshedHRUs=0;
+  for (k=0;k<_nHRUs;k++){if (_pModel->GetHydroUnit(k)->IsEnabled()){_nWshedHRUs++;}}
+  _aWshedHRUs   =new int    [max(_nWshedHRUs,1)];
+  _aWshedHRUArea=new double [max(_nWshedHRUs,1)];
+  ExitGracefullyIf(_aWshedHRUArea==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+  n=0;
+  for (k=0;k<_nHRUs;k++){
+    pHRU=_pModel->GetHydroUnit(k);
+    if (pHRU->IsEnabled()){_aWshedHRUs[n]=k; _aWshedHRUArea[n]=pHRU->GetArea(); n++;}
+  }
+
+  //subbasins by subbasin group
+  _aSBGrpStart=new int    [nSBGroups+1];
+  _aSBGrpArea =new double [max(nSBGroups,1)];
+  ExitGracefullyIf(_aSBGrpArea==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+  n=0;
+  for (kk=0;kk<nSBGroups;kk++){
+    _aSBGrpStart[kk]=n;
+    n+=_pModel->GetSubBasinGroup(kk)->GetNumSubbasins();
+  }
+  _aSBGrpStart[nSBGroups]=n;
+  _aSBGrpSBs=new int [max(n,1)];
+  ExitGracefullyIf(_aSBGrpSBs==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+  n=0;
+  for (kk=0;kk<nSBGroups;kk++){
+    const CSubbasinGroup *pSBGrp=_pModel->GetSubBasinGroup(kk);
+    _aSBGrpArea[kk]=0.0;
+    for (pp=0;pp<pSBGrp->GetNumSubbasins();pp++){
+      _aSBGrpSBs[n]=pSBGrp->GetSubBasin(pp)->GetGlobalIndex();
+      _aSBGrpArea[kk]+=pSBGrp->GetSubBasin(pp)->GetBasinArea();
+      n++;
+    }
+  }
+
+  //HRUs and subbasins in which each source is needed (NULL list if all)
+  _aHRUList    =new int *[max(_nSources,1)];
+  _nHRUList    =new int  [max(_nSources,1)];
+  _aBasinList  =new int *[max(_nSources,1)];
+  _nBasinList  =new int  [max(_nSources,1)];
+  _aFullSources=new int  [max(_nSources,1)];
+  ExitGracefullyIf(_aFullSources==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+  _nFullSources=0;
+  for (int s=0;s<_nSources;s++)
+  {
+    _aHRUList[s]=NULL;
+    _nHRUList[s]=0;
+    for (k=0;k<_nHRUs;k++){if (_aHRUMask[s][k]){_nHRUList[s]++;}}
+    if (_nHRUList[s]==_nHRUs){_aFullSources[_nFullSources]=s; _nFullSources++;}
+    else{
+      _aHRUList[s]=new int [max(_nHRUList[s],1)];
+      ExitGracefullyIf(_aHRUList[s]==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+      n=0;
+      for (k=0;k<_nHRUs;k++){if (_aHRUMask[s][k]){_aHRUList[s][n]=k; n++;}}
+    }
+    _aBasinList[s]=NULL;
+    _nBasinList[s]=0;
+    for (p=0;p<_nSubBasins;p++){if (_aBasinMask[s][p]){_nBasinList[s]++;}}
+    if (_nBasinList[s]<_nSubBasins){
+      _aBasinList[s]=new int [max(_nBasinList[s],1)];
+      ExitGracefullyIf(_aBasinList[s]==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+      n=0;
+      for (p=0;p<_nSubBasins;p++){if (_aBasinMask[s][p]){_aBasinList[s][n]=p; n++;}}
+    }
+  }
+  if (_pModel->GetNumOutputSubBasins()<_nSubBasins){
+    _aDrainVals=new double [_nSubBasins];
+    ExitGracefullyIf(_aDrainVals==NULL,"CCustomOutputAggregator::Initialize",OUT_OF_MEMORY);
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Returns current value of source in HRU k
+/// \param &src [in] HRU-based quantity
+/// \param k [in] global HRU index
+//
+double CCustomOutputAggregator::GetHRUValue(const custom_source &src,const int k) const
+{
+  if      (src.is_conc                 ){return _pModel->GetConcentration(k,src.svind);}
+  else if (src.var==VAR_STATE_VAR      ){return _pModel->GetHydroUnit(k)->GetStateVarValue(src.svind);}
+  else if (src.var==VAR_FORCING_FUNCTION){return _pModel->GetHydroUnit(k)->GetForcing(src.ftype);}
+  else if (src.var==VAR_TO_FLUX        ){return _pModel->GetCumulativeFlux  (k,src.svind,true);}
+  else if (src.var==VAR_FROM_FLUX      ){return _pModel->GetCumulativeFlux  (k,src.svind,false);}
+  else if (src.var==VAR_BETWEEN_FLUX   ){return _pModel->GetCumulFluxBetween(k,src.svind,src.svind2);}
+  return 0.0;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Gathers current values of all sources in all HRUs in one sweep, then computes subbasin averages where needed
+/// \details sources only needed in some HRUs/subbasins are gathered and averaged in those HRUs/subbasins only
+/// \param &tt [in] Current model time
+/// \param &Options [in] Global model options information
+//
+void CCustomOutputAggregator::GatherValues(const time_struct &tt,const optStruct &Options)
+{
+  if (Options.output_format==OUTPUT_NONE){return;}
+  if (tt.model_time==0){return;} //initial conditions are not printed to custom output
+  if (_aHRUVals==NULL){return;}
+
+  int s,k,p,i,j,n;
+  if (_nFullSources>0)
+  {
+    for (k=0;k<_nHRUs;k++)
+    {
+      for (j=0;j<_nFullSources;j++){s=_aFullSources[j]; _aHRUVals[s][k]=GetHRUValue(_aSources[s],k);}
+    }
+  }
+  for (s=0;s<_nSources;s++)
+  {
+    if (_aHRUList[s]==NULL){continue;}
+    for (j=0;j<_nHRUList[s];j++){k=_aHRUList[s][j]; _aHRUVals[s][k]=GetHRUValue(_aSources[s],k);}
+  }
+
+  double sum,area;
+  for (s=0;s<_nSources;s++)
+  {
+    if (!_aNeedsBasin[s]){continue;}
+    const double *v=_aHRUVals[s];
+    n=_nSubBasins;
+    if (_aBasinList[s]!=NULL){n=_nBasinList[s];}
+    for (j=0;j<n;j++)
+    {
+      p=j;
+      if (_aBasinList[s]!=NULL){p=_aBasinList[s][j];}
+      sum=0.0;
+      for (i=_aSBStart[p];i<_aSBStart[p+1];i++){sum+=v[_aSBHRUs[i]]*_aSBHRUArea[i];}
+      area=_pModel->GetSubBasin(p)->GetBasinArea();
+      if (area==0.0){_aBasinVals[s][p]=0.0;}
+      else          {_aBasinVals[s][p]=sum/area;}
+    }
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Returns spatially aggregated current values of source
+/// \param s [in] source index
+/// \param agg [in] spatial aggregation
+/// \param kk_only [in] HRU group index (if agg==BY_SELECT_HRUS)
+/// \param *aVals [out] aggregated values [size: nData]
+/// \param nData [in] number of HRUs, subbasins, groups, etc. for this aggregation
+//
+void CCustomOutputAggregator::GetSpatialValues(const int s,const spatial_agg agg,const int kk_only,double *aVals,const int nData) const
+{
+  const double *v=_aHRUVals[s];
+  double sum;
+  int k,i;
+  if      (agg==BY_HRU)
+  {
+    if (nData==_nHRUs){for (k=0;k<nData;k++){aVals[k]=v[k];}}
+    else              {for (k=0;k<nData;k++){aVals[k]=v[_pModel->GetOutputHRUIndex(k)];}}
+  }
+  else if (agg==BY_BASIN)
+  {
+    if (nData==_nSubBasins){for (k=0;k<nData;k++){aVals[k]=_aBasinVals[s][k];}}
+    else                   {for (k=0;k<nData;k++){aVals[k]=_aBasinVals[s][_pModel->GetOutputSubBasinIndex(k)];}}
+  }
+  else if (agg==BY_DRAINAGE)
+  {
+    if (nData==_nSubBasins){DrainageAverage(_pModel,_aBasinVals[s],aVals);}
+    else{
+      DrainageAverage(_pModel,_aBasinVals[s],_aDrainVals);
+      for (k=0;k<nData;k++){aVals[k]=_aDrainVals[_pModel->GetOutputSubBasinIndex(k)];}
+    }
+  }
+  else if (agg==BY_WSHED)
+  {
+    sum=0.0;
+    for (i=0;i<_nWshedHRUs;i++){sum+=(v[_aWshedHRUs[i]]*_aWshedHRUArea[i]);}
+    aVals[0]=sum/_pModel->GetWatershedArea();
+  }
+  else if (agg==BY_HRU_GROUP)
+  {
+    for (k=0;k<nData;k++)
+    {
+      sum=0.0;
+      for (i=_aGrpStart[k];i<_aGrpStart[k+1];i++){sum+=v[_aGrpHRUs[i]]*_aGrpHRUArea[i];}
+      if (_aGrpArea[k]==0.0){aVals[k]=0.0;}
+      else                  {aVals[k]=sum/_aGrpArea[k];}
+    }
+  }
+  else if (agg==BY_SB_GROUP)
+  {
+    for (k=0;k<nData;k++)
+    {
+      sum=0.0;
+      for (i=_aSBGrpStart[k];i<_aSBGrpStart[k+1];i++){
+        sum+=_aBasinVals[s][_aSBGrpSBs[i]]*_pModel->GetSubBasin(_aSBGrpSBs[i])->GetBasinArea();
+      }
+      aVals[k]=sum/_aSBGrpArea[k];
+    }
+  }
+  else if (agg==BY_SELECT_HRUS)
+  {
+    const CHRUGroup *pGrp=_pModel->GetHRUGroup(kk_only);
+    for (k=0;k<nData;k++){aVals[k]=v[pGrp->GetHRU(k)->GetGlobalIndex()];}
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Calculates drainage area-weighted averages of subbasin values in one sweep
+/// \details goes from upstream to downstream summing cumulative area*value;
+/// at end, divides by drainage area to get area-weighted mean value
+/// \param *pMod [in] Pointer to model
+/// \param *aBasinVals [in] subbasin values [size: nSubBasins]
+/// \param *aDrainageVals [out] drainage area-weighted average values [size: nSubBasins] (may be same array as aBasinVals)
+//
+void CCustomOutputAggregator::DrainageAverage(const CModel *pMod,const double *aBasinVals,double *aDrainageVals)
+{
+  int nSB=pMod->GetNumSubBasins();
+  double     *sum=new double[nSB];
+  double *areasum=new double[nSB]; //required when some basins are disabled (drainage area=0)
+  ExitGracefullyIf(areasum==NULL,"CCustomOutputAggregator::DrainageAverage",OUT_OF_MEMORY);
+  for (int p=0;p<nSB;p++){
+    sum[p]=0;
+    areasum[p]=0.0;
+  }
+  const CSubBasin *pSB;
+  int p,p_down;
+  double area;
+  for (int pp=0;pp<nSB;pp++)
+  {
+    p=pMod->GetOrderedSubBasinIndex(pp);
+    pSB=pMod->GetSubBasin(p);
+    area=pSB->GetBasinArea();
+    sum    [p]+=area*aBasinVals[p];
+    areasum[p]+=area;
+
+    p_down=pSB->GetDownstreamIndex();
+    if (p_down!=DOESNT_EXIST){
+      sum    [p_down]+=sum    [p];
+      areasum[p_down]+=areasum[p];
+    }
+  }
+  for (p=0;p<nSB;p++)
+  {
+    aDrainageVals[p]=sum[p]/areasum[p];
+  }
+  delete [] sum;
+  delete [] areasum;
+}
@@ -8,6 +8,7 @@
 #define _CUSTOM_OUTPUT_H
 
 #include "RavenInclude.h"
+#include "BufferedOutput.h"
 #include "ModelABC.h"
 #include "Model.h"
 #include "Forcings.h"
@@ -65,15 +66,89 @@ enum diagnostic
   VAR_BETWEEN_FLUX      ///< track net flux between specific state variables
 };
 
+///////////////////////////////////////////////////////////////////
+/// \brief HRU-based quantity shared by one or more custom outputs
+//
+struct custom_source
+{
+  diagnostic   var;    ///< output variable identifier (state variable, forcing, or flux)
+  int          svind;  ///< state variable index (if SV or flux)
+  int          svind2; ///< target state variable index (if flux between two compartments)
+  forcing_type ftype;  ///< forcing function type (if forcing function)
+  bool         is_conc;///< true if state variable is reported as concentration
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief Gathers the HRU values of all custom outputs once per time step
+/// \details Each distinct HRU-based quantity (state variable, concentration, forcing or cumulative flux)
+/// is queried for every HRU in a single sweep through the HRUs, and subbasin averages are computed once
+/// for all custom outputs which need them. Spatial aggregates use HRU/subbasin index and area lists built
+/// at initialization. Results are identical to the area-weighted averages of CSubBasin, CHRUGroup,
+/// CSubbasinGroup and CModel. Sources only used by outputs restricted to some HRUs or subbasins
+/// (output selection, BY_SELECT_HRUS) are only gathered in those HRUs/subbasins
+//
+class CCustomOutputAggregator
+{
+private:/*------------------------------------------------------*/
+  const CModel   *_pModel;        ///< pointer to model
+
+  int             _nSources;      ///< number of distinct sources
+  custom_source  *_aSources;      ///< distinct sources [size: _nSources]
+  bool           *_aNeedsBasin;   ///< true if subbasin averages of source are needed [size: _nSources]
+  double        **_aHRUVals;      ///< current value of source in each HRU [size: _nSources][nHRUs]
+  double        **_aBasinVals;    ///< current area-weighted average of source in each subbasin [size: _nSources][nSubBasins] (NULL if not needed)
+  bool          **_aHRUMask;      ///< true if source is needed in HRU k [size: _nSources][nHRUs]
+  bool          **_aBasinMask;    ///< true if subbasin average of source is needed in subbasin p [size: _nSources][nSubBasins]
+  int           **_aHRUList;      ///< global indices of HRUs in which source is gathered [size: _nSources][_nHRUList[s]] (NULL if all HRUs)
+  int            *_nHRUList;      ///< number of HRUs in which source is gathered [size: _nSources]
+  int           **_aBasinList;    ///< indices of subbasins in which source is averaged [size: _nSources][_nBasinList[s]] (NULL if all subbasins)
+  int            *_nBasinList;    ///< number of subbasins in which source is averaged [size: _nSources]
+  int            *_aFullSources;  ///< indices of sources gathered in all HRUs [size: _nFullSources]
+  int             _nFullSources;  ///< number of sources gathered in all HRUs
+  double         *_aDrainVals;    ///< drainage averages of all subbasins, if only selected subbasins are output [size: nSubBasins]
+
+  int             _nHRUs;         ///< number of HRUs in model
+  int             _nSubBasins;    ///< number of subbasins in model
+  int            *_aSBStart;      ///< start of subbasin p in _aSBHRUs [size: nSubBasins+1]
+  int            *_aSBHRUs;       ///< global indices of enabled HRUs, grouped by subbasin
+  double         *_aSBHRUArea;    ///< areas of enabled HRUs, grouped by subbasin
+  int            *_aGrpStart;     ///< start of HRU group kk in _aGrpHRUs [size: nHRUGroups+1]
+  int            *_aGrpHRUs;      ///< global indices of enabled HRUs, grouped by HRU group
+  double         *_aGrpHRUArea;   ///< areas of enabled HRUs, grouped by HRU group
+  double         *_aGrpArea;      ///< total enabled area of HRU group [size: nHRUGroups]
+  int             _nWshedHRUs;    ///< number of enabled HRUs in model
+  int            *_aWshedHRUs;    ///< global indices of enabled HRUs [size: _nWshedHRUs]
+  double         *_aWshedHRUArea; ///< areas of enabled HRUs [size: _nWshedHRUs]
+  int            *_aSBGrpStart;   ///< start of subbasin group kk in _aSBGrpSBs [size: nSBGroups+1]
+  int            *_aSBGrpSBs;     ///< subbasin indices, grouped by subbasin group
+  double         *_aSBGrpArea;    ///< total area of subbasin group [size: nSBGroups]
+
+  double          GetHRUValue(const custom_source &src,const int k) const;
+  void            DestroyIndexLists();
+
+public:/*-------------------------------------------------------*/
+  CCustomOutputAggregator(const CModel *pMod);
+  ~CCustomOutputAggregator();
+
+  int             AddSource       (const custom_source &src,const spatial_agg agg,const int kk_only);
+  void            Initialize      ();
+  void            GatherValues    (const time_struct &tt,const optStruct &Options);
+  void            GetSpatialValues(const int s,const spatial_agg agg,const int kk_only,double *aVals,const int nData) const;
+
+  static void     DrainageAverage (const CModel *pMod,const double *aBasinVals,double *aDrainageVals);
+};
+
 ///////////////////////////////////////////////////////////////////
 /// \brief Data abstraction for custom model output generator
 class CCustomOutput
 {
 private:/*------------------------------------------------------*/
 
-  ofstream     _CUSTOM;     ///< output file stream
+  CBufferedOutputFile _CUSTOM; ///< output file stream
 
   int          _netcdf_ID;  ///< netCDF file identifier
+  CNetCDFBlockBuffer _netcdf_buf; ///< block buffer for netCDF time series
+  CBinaryColumnFile  _BINARY;     ///< binary column file (binary output format)
 
   diagnostic   _var;        ///< output variable identifier
   sv_type      _svtype;     ///< state variable output type (if output var is a SV)
@@ -111,6 +186,11 @@ private:/*------------------------------------------------------*/
 
   const CModel *pModel;     ///< Reference to model
 
+  const CCustomOutputAggregator *_pAggregator; ///< shared source of HRU-based values (or NULL)
+  int          _iSource;    ///< index of output variable in _pAggregator (or DOESNT_EXIST if not HRU-based)
+  double      *_aVals;      ///< current value of output variable for each HRU, Basin or WShed [size: _nData]
+  double      *_aDrainVals; ///< values of all subbasins, if BY_DRAINAGE and only selected subbasins are output (or NULL) [size: nSubBasins]
+
   void DetermineCustomFilename(const optStruct& Options);
 
 public:/*------------------------------------------------------*/
@@ -138,6 +218,7 @@ public:/*------------------------------------------------------*/
   spatial_agg GetSpatialAgg() const;
 
   void        InitializeCustomOutput(const optStruct &Options);
+  void        SetAggregator         (CCustomOutputAggregator *pAgg);
 
   void        WriteFileHeader  (const optStruct &Options);
   void        WriteCustomOutput(const time_struct &tt, const optStruct &Options);
@@ -148,6 +229,8 @@ private:
   void      WriteCSVFileHeader();
   void      WriteEnSimFileHeader(const optStruct &Options);
   void      WriteNetCDFFileHeader(const optStruct &Options);
+  void      WriteBinaryFileHeader(const optStruct &Options);
+  void      WriteStatistics      (COutputRow &ROW);
 };
 
 ///////////////////////////////////////////////////////////////////
@@ -156,7 +239,7 @@ class CCustomTable {
 
 private:
 
-  ofstream      _CUSTTAB;      ///< output file stream
+  CBufferedOutputFile _CUSTTAB; ///< output file stream
   string        _filename;
 
   int           _sb_grp_ind;   ///<index of subbasin group
@@ -28,6 +28,7 @@ CDDSEnsemble::CDDSEnsemble(const int num_members,const optStruct &Options)
   _calib_SBID=DOESNT_EXIST;
   _calib_Obj=DIAG_NASH_SUTCLIFFE;
   _calib_Period="ALL";
+  _early_term=false;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -74,6 +75,14 @@ void CDDSEnsemble::SetCalibrationTarget(const long long SBID,const diag_type obj
   _calib_Period=period;
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief turns on early termination of DDS runs which can no longer beat the current best objective
+//
+void CDDSEnsemble::SetEarlyTermination(const bool early_term)
+{
+  _early_term=early_term;
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief initializes DDS caliobration run
 /// \param &Options [out] Global model options information
@@ -91,6 +100,10 @@ void CDDSEnsemble::Initialize(const CModel* pModel,const optStruct &Options)
   if(_nParamDists==0) {
     ExitGracefully("CDDSEnsemble::Initialize: at least one parameter distribution must be set using :ParameterDistributions command",BAD_DATA);
   }
+  if((_early_term) && (!CDiagnostic::HasAchievableBound(_calib_Obj))) {
+    WriteWarning("CDDSEnsemble::Initialize: :EarlyTermination only supported for NASH_SUTCLIFFE, RMSE and ABSERR objective functions. It will be ignored.",Options.noisy);
+    _early_term=false;
+  }
 
   // Initialize best and test parames to default
   //-----------------------------------------------
@@ -199,6 +212,11 @@ void CDDSEnsemble::UpdateModel(CModel *pModel,optStruct &Options,const int e)
   }
   pModel->CalculateInitialWaterStorage(Options);
 
+  //- end run as soon as it cannot beat current best ------------
+  if(_early_term) {
+    pModel->SetObjectiveBound(_calib_SBID,_calib_Obj,_calib_Period,_Fbest);
+  }
+
   //The model is run following this routine call...
 }
 //////////////////////////////////////////////////////////////////
@@ -224,7 +242,12 @@ void CDDSEnsemble::FinishEnsembleRun(CModel *pModel,optStruct &Options,const tim
 
   //Write objective function to screen
   //----------------------------------------------
-  cout<<"DDS Obj. Function: "<<Ftest <<" [best: "<<_Fbest<<"]"<<endl;
+  if(pModel->IsTerminatedEarly()) {
+    cout<<"DDS Obj. Function: (run ended early) [best: "<<_Fbest<<"]"<<endl;
+  }
+  else {
+    cout<<"DDS Obj. Function: "<<Ftest <<" [best: "<<_Fbest<<"]"<<endl;
+  }
   //for(int i=0;i<_nParamDists;i++) {cout<<"P["<<i<<"]: "<<_TestParams[i]<<", ";}cout<<endl;
 
   // write best parameter vector
@@ -8,6 +8,7 @@
     under GNU Public License
   ----------------------------------------------------------------*/
 #include "DemandOptimization.h"
+#include "Checkpoint.h"
 
 void SummarizeExpression(const char **s, const int Len, expressionStruct* exp); //defined in DemandExpressionHandling.cpp
 string DVTypeToString(dv_type t);
@@ -2714,6 +2715,39 @@ void   CDemandOptimizer::WriteMajorOutput      (ofstream &RVC)
     }
   }
 }
+//////////////////////////////////////////////////////////////////
+/// \brief writes workflow variables and flow/reservoir histories to binary checkpoint file
+/// \details binary equivalent of WriteMajorOutput; histories are identified by subbasin ID
+//
+void   CDemandOptimizer::WriteToCheckpoint     (CCheckpointWriter &CHK) const
+{
+  CHK.BeginSection(RVB_MANAGEMENT);
+  CHK.Put<int>(_nWorkflowVars);
+  for (int i=0;i<_nWorkflowVars;i++){
+    CHK.PutString(_pWorkflowVars[i]->name);
+    CHK.Put<double>(_pWorkflowVars[i]->current_val);
+  }
+  int nEnabled=0;
+  for (int p=0;p<_pModel->GetNumSubBasins();p++){
+    if (_pModel->GetSubBasin(p)->IsEnabled()){nEnabled++;}
+  }
+  CHK.Put<int>(_nHistoryItems);
+  CHK.Put<int>(nEnabled);
+  for (int p=0;p<_pModel->GetNumSubBasins();p++){
+    if (_pModel->GetSubBasin(p)->IsEnabled()){
+      bool has_res=(_pModel->GetSubBasin(p)->GetReservoir()!=NULL);
+      CHK.Put<long long>(_pModel->GetSubBasin(p)->GetID());
+      CHK.Put<int>((int)(has_res));
+      CHK.PutArray(_aQhist[_aSBIndices[p]],_nHistoryItems);
+      if (has_res){
+        CHK.PutArray(_aIhist[_aSBIndices[p]],_nHistoryItems);
+        CHK.PutArray(_ahhist[_aSBIndices[p]],_nHistoryItems);
+        CHK.PutArray(_aAhist[_aSBIndices[p]],_nHistoryItems);
+      }
+    }
+  }
+  CHK.EndSection();
+}
 
 //////////////////////////////////////////////////////////////////
 /// \brief Closes output file streams
@@ -196,6 +196,7 @@ struct workflowVar
 /// \brief Data abstraction for demand optimization
 //
 class CDemandGroup;
+class CCheckpointWriter;
 class CDemandOptimizer
 {
 private: /*------------------------------------------------------*/
@@ -363,6 +364,7 @@ public: /*------------------------------------------------------*/
   void   WriteOutputFileHeaders(const optStruct &Options);
   void   WriteMinorOutput      (const optStruct &Options,const time_struct &tt);
   void   WriteMajorOutput      (ofstream &RVC);
+  void   WriteToCheckpoint     (CCheckpointWriter &CHK) const;
   void   CloseOutputStreams    ();
 
   void   Closure               (const optStruct &Options);
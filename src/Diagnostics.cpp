@@ -85,6 +85,36 @@ diag_type CDiagnostic::GetType() const
   return _type;
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief returns observation value corresponding to threshold quantile of observations in sampled index range [nnstart,nnend)
+/// \param pTSObs [in] observation time series
+/// \param nnstart [in] first sampled time index
+/// \param nnend [in] sampled time index ending range (not included)
+/// \param compare [in] period comparison criterion
+/// \param threshold [in] threshold quantile (0-1)
+//
+static double GetThresholdObsValue(CTimeSeriesABC *pTSObs,const int nnstart,const int nnend,comparison compare,double threshold)
+{
+  double obsval;
+  threshold=max(min(threshold,1.0),0.0);
+
+  double *allvals=new double [nnend];
+  double thresh_obsval=0;
+  int Nobs=0;
+  for(int nn=nnstart;nn<nnend;nn++)
+  {
+    obsval=pTSObs->GetSampledValue(nn);
+    if (obsval!=RAV_BLANK_DATA){allvals[Nobs]=obsval;Nobs++;  }
+  }
+  if(Nobs>1) {
+    int corr=0;
+    if(compare==COMPARE_LESSTHAN) { corr=-1; } //shifts threshold comparator
+    quickSort(allvals,0,Nobs-1);
+    thresh_obsval=allvals[(int)rvn_floor(threshold*Nobs)+corr];
+  }
+  delete[] allvals;
+  return thresh_obsval;
+}
 //////////////////////////////////////////////////////////////////
 /// \brief Implementation of the CDiagnostic constructor
 /// \param typ [in] type of diagnostics
@@ -111,25 +141,9 @@ double CDiagnostic::CalculateDiagnostic(CTimeSeriesABC  *pTSMod,
   int nnstart=pTSObs->GetTimeIndexFromModelTime(starttime)+skip; //works for avg. hydrographs
   int nnend  =pTSObs->GetTimeIndexFromModelTime(endtime  )+1; //+1 is just because below loops expressed w.r.t N, not N-1
 
-  threshold=max(min(threshold,1.0),0.0);
-
   // Modify weights for thresholds/blank observation data
   //----------------------------------------------------------
-  double *allvals=new double [nnend];
-  double thresh_obsval=0;
-  int Nobs=0;
-  for(nn=nnstart;nn<nnend;nn++)
-  {
-    obsval=pTSObs->GetSampledValue(nn);
-    if (obsval!=RAV_BLANK_DATA){allvals[Nobs]=obsval;Nobs++;  }
-  }
-  if(Nobs>1) {
-    int corr=0;
-    if(compare==COMPARE_LESSTHAN) { corr=-1; } //shifts threshold comparator
-    quickSort(allvals,0,Nobs-1);
-    thresh_obsval=allvals[(int)rvn_floor(threshold*Nobs)+corr];
-  }
-  delete[] allvals;
+  double thresh_obsval=GetThresholdObsValue(pTSObs,nnstart,nnend,compare,threshold);
 
   double *baseweight=new double [nnend]; //array stores base weights for each observation point
   for(nn=nnstart;nn<nnend;nn++)
@@ -1496,6 +1510,219 @@ case(DIAG_DAILY_KGE)://----------------------------------------------------
   delete [] baseweight; //\todo: fix! This never gets called!!
   return 0;
 }
+
+//////////////////////////////////////////////////////////////////
+/// \brief returns true if diagnostic type can be computed from running sums (diag_accum)
+/// \param typ [in] diagnostic type
+//
+bool CDiagnostic::IsStreamable(const diag_type typ)
+{
+  switch(typ)
+  {
+  case(DIAG_NASH_SUTCLIFFE):
+  case(DIAG_RMSE):
+  case(DIAG_PCT_BIAS):
+  case(DIAG_ABS_PCT_BIAS):
+  case(DIAG_ABSERR):
+  case(DIAG_RSR):
+  case(DIAG_R2):
+  case(DIAG_KLING_GUPTA):
+  case(DIAG_KGE_PRIME):
+  case(DIAG_KLING_GUPTA_DEVIATION):
+  case(DIAG_MBF):               {return true;}
+  default:                      {return false;}
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief returns true if the best final value of the diagnostic still achievable can be determined from
+/// running sums (i.e., CalculateBestAchievable is supported)
+/// \param typ [in] diagnostic type
+//
+bool CDiagnostic::HasAchievableBound(const diag_type typ)
+{
+  return ((typ==DIAG_NASH_SUTCLIFFE) || (typ==DIAG_RMSE) || (typ==DIAG_ABSERR));
+}
+//////////////////////////////////////////////////////////////////
+/// \brief prepares running sums for observation time series over diagnostic period
+/// \details time index range and observation threshold are determined exactly as in CalculateDiagnostic;
+/// all sums are reset to zero. The weight total and spread of all observations in the period (used by
+/// CalculateBestAchievable) are computed from the observations, assuming modeled values are available at all
+/// observation times within the :EvaluationTime window
+///
+/// \param A [out] running sums
+/// \param pTSObs [in] observation time series
+/// \param pTSWeights [in] observation weights time series (or NULL)
+/// \param starttime, endtime [in] diagnostic period (model time)
+/// \param compare, threshold [in] period comparison criterion and threshold quantile
+/// \param Options [in] global model options
+//
+void CDiagnostic::InitializeAccum(diag_accum      &A,
+                                  CTimeSeriesABC  *pTSObs,
+                                  CTimeSeriesABC  *pTSWeights,
+                                  const double    &starttime,
+                                  const double    &endtime,
+                                  comparison       compare,
+                                  double           threshold,
+                                  const optStruct &Options)
+{
+  int skip=0;
+  if (!strcmp(pTSObs->GetName().c_str(), "HYDROGRAPH") && (Options.ave_hydrograph == true)){ skip = 1; }
+
+  A.nnstart      =pTSObs->GetTimeIndexFromModelTime(starttime)+skip;
+  A.nnend        =pTSObs->GetTimeIndexFromModelTime(endtime  )+1;
+  A.compare      =compare;
+  A.thresh_obsval=GetThresholdObsValue(pTSObs,A.nnstart,A.nnend,compare,threshold);
+  A.last_n       =DOESNT_EXIST;
+  A.shift        =0.0;
+  A.N=A.sumO=A.sumM=A.sumOO=A.sumMM=A.sumOM=A.sumSqErr=A.sumAbsErr=A.sumMBF=0.0;
+
+  //totals over all observations in period
+  double obsval,weight,t;
+  double sum=0.0;
+  A.Ntot=A.SSobsTot=0.0;
+  for (int pass=0;pass<2;pass++)
+  {
+    for (int nn=A.nnstart;nn<A.nnend;nn++)
+    {
+      t=nn*Options.timestep;
+      if ((t<Options.diag_start_time) || (t>=Options.diag_end_time)){continue;}
+      obsval=pTSObs->GetSampledValue(nn);
+      weight=1.0;
+      if (pTSWeights!=NULL){weight=pTSWeights->GetSampledValue(nn);}
+      if (obsval==RAV_BLANK_DATA){continue;}
+      if      (compare==COMPARE_GREATERTHAN){if (obsval<A.thresh_obsval){continue;}}
+      else if (compare==COMPARE_LESSTHAN   ){if (obsval>A.thresh_obsval){continue;}}
+      if (pass==0){A.Ntot+=weight; sum+=weight*obsval;}
+      else        {A.SSobsTot+=weight*(obsval-sum/A.Ntot)*(obsval-sum/A.Ntot);}
+    }
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief adds sampled time index n to running sums
+/// \details weighting (blank data, thresholds, observation weights) is that of CalculateDiagnostic.
+/// Repeated calls for the same time index are ignored
+///
+/// \param A [in/out] running sums
+/// \param pTSObs [in] observation time series
+/// \param pTSWeights [in] observation weights time series (or NULL)
+/// \param n [in] sampled time index
+/// \param modval [in] modeled value at sampled time index n
+//
+void CDiagnostic::UpdateAccum(diag_accum      &A,
+                              CTimeSeriesABC  *pTSObs,
+                              CTimeSeriesABC  *pTSWeights,
+                              const int        n,
+                              const double    &modval)
+{
+  if (n==A.last_n){return;}
+  A.last_n=n;
+  if ((n<A.nnstart) || (n>=A.nnend)){return;}
+
+  double obsval=pTSObs->GetSampledValue(n);
+  double weight=1.0;
+  if (pTSWeights!=NULL){weight=pTSWeights->GetSampledValue(n);}
+  if (obsval==RAV_BLANK_DATA){return;}
+  if (modval==RAV_BLANK_DATA){return;}
+  if      (A.compare==COMPARE_GREATERTHAN){if (obsval<A.thresh_obsval){return;}}
+  else if (A.compare==COMPARE_LESSTHAN   ){if (obsval>A.thresh_obsval){return;}}
+  if (weight==0.0){return;}
+
+  if (A.N==0.0){A.shift=obsval;}
+  double o=obsval-A.shift;
+  double m=modval-A.shift;
+
+  A.N        +=weight;
+  A.sumO     +=weight*o;
+  A.sumM     +=weight*m;
+  A.sumOO    +=weight*o*o;
+  A.sumMM    +=weight*m*m;
+  A.sumOM    +=weight*o*m;
+  A.sumSqErr +=weight*(obsval-modval)*(obsval-modval);
+  A.sumAbsErr+=weight*fabs(obsval-modval);
+  A.sumMBF   +=weight/(1.0+pow(((modval-obsval)/(2.0*obsval)),2));
+}
+//////////////////////////////////////////////////////////////////
+/// \brief calculates diagnostic from running sums
+/// \details equivalent to CalculateDiagnostic for the time steps accumulated so far (to round-off);
+/// returns the same values as CalculateDiagnostic if diagnostic cannot be evaluated, but without warnings,
+/// as this may be called during the simulation. Returns 0.0 if diagnostic type is not streamable
+///
+/// \param A [in] running sums
+//
+double CDiagnostic::CalculateFromAccum(const diag_accum &A) const
+{
+  const double N=A.N;
+  if (N<=0.0)
+  {
+    if ((_type==DIAG_PCT_BIAS) || (_type==DIAG_ABS_PCT_BIAS)){return ALMOST_INF;}
+    if (IsStreamable(_type)){return -ALMOST_INF;}
+    return 0.0;
+  }
+  double ObsSum=A.sumO+A.shift*N;
+  double ObsAvg=ObsSum/N;
+  double ModAvg=A.sumM/N+A.shift;
+  double SSobs =max(A.sumOO-A.sumO*A.sumO/N,0.0); //sum of w*(obs-ObsAvg)^2
+  double SSmod =max(A.sumMM-A.sumM*A.sumM/N,0.0); //sum of w*(mod-ModAvg)^2
+  double SSom  =A.sumOM-A.sumO*A.sumM/N;          //sum of w*(obs-ObsAvg)*(mod-ModAvg)
+
+  switch(_type)
+  {
+  case(DIAG_NASH_SUTCLIFFE):{return 1.0-A.sumSqErr/SSobs;}
+  case(DIAG_RMSE):          {return sqrt(A.sumSqErr/N);}
+  case(DIAG_PCT_BIAS):      {return 100.0*(A.sumM-A.sumO)/ObsSum;}
+  case(DIAG_ABS_PCT_BIAS):  {return fabs(100.0*(A.sumM-A.sumO)/ObsSum);}
+  case(DIAG_ABSERR):        {return A.sumAbsErr/N;}
+  case(DIAG_MBF):           {return A.sumMBF;}
+  case(DIAG_RSR):
+  {
+    if ((SSobs!=0.0) && (ObsSum!=0.0)){return sqrt(A.sumSqErr/SSobs);}
+    return -ALMOST_INF;
+  }
+  case(DIAG_R2):
+  {
+    if ((SSmod!=0.0) && (SSobs!=0.0)){return (SSom/N)*(SSom/N)/((SSmod/N)*(SSobs/N));}
+    return -ALMOST_INF;
+  }
+  case(DIAG_KLING_GUPTA):
+  case(DIAG_KGE_PRIME):
+  case(DIAG_KLING_GUPTA_DEVIATION):
+  {
+    double ObsStd=sqrt(SSobs/N);
+    double ModStd=sqrt(SSmod/N);
+    double r     =(SSom/N)/ObsStd/ModStd;
+    double Beta  =ModAvg/ObsAvg;
+    double Alpha =ModStd/ObsStd;
+
+    if (_type==DIAG_KLING_GUPTA_DEVIATION){Beta=1.0;}
+    if (_type==DIAG_KGE_PRIME){if (Beta!=0.0){Alpha/=Beta;}}
+
+    if (((ObsAvg!=0.0) || (Beta==1.0)) && (ObsStd!=0.0) && (ModStd!=0.0))
+    {
+      return 1.0 - sqrt(pow((r - 1), 2) + pow((Alpha - 1), 2) + pow((Beta - 1), 2));
+    }
+    return -ALMOST_INF;
+  }
+  default:                  {return 0.0;}
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief returns best value of diagnostic over the full period that can still be achieved, given the time steps accumulated so far
+/// \details the error sums can only grow as the simulation proceeds, so the final NSE is at most
+/// 1-sumSqErr/SSobsTot, and final RMSE and ABSERR are at least sqrt(sumSqErr/Ntot) and sumAbsErr/Ntot.
+/// Returns the value of a perfect simulation if the diagnostic does not support this (see HasAchievableBound)
+///
+/// \param A [in] running sums
+//
+double CDiagnostic::CalculateBestAchievable(const diag_accum &A) const
+{
+  switch(_type)
+  {
+  case(DIAG_NASH_SUTCLIFFE):{if (A.SSobsTot>0.0){return 1.0-A.sumSqErr/A.SSobsTot;} return 1.0;}
+  case(DIAG_RMSE):          {if (A.Ntot    >0.0){return sqrt(A.sumSqErr/A.Ntot);  } return 0.0;}
+  case(DIAG_ABSERR):        {if (A.Ntot    >0.0){return A.sumAbsErr/A.Ntot;       } return 0.0;}
+  default:                  {return 0.0;}
+  }
+}
 /*****************************************************************
 Constructor/Destructor
 ------------------------------------------------------------------
@@ -54,6 +54,33 @@ struct agg_diag
 };
 diag_type StringToDiagnostic(string distring);
 
+///////////////////////////////////////////////////////////////////
+/// \brief running weighted sums of one observation time series and its modeled counterpart over one diagnostic period
+/// \details updated as each time step is simulated, so that moment-based diagnostics are available at any
+/// point of the simulation without revisiting the stored series. Values are accumulated relative to the first
+/// weighted observation (shift), which avoids cancellation when computing variances from sums of squares
+//
+struct diag_accum
+{
+  int        nnstart;       ///< first sampled time index included in period
+  int        nnend;         ///< sampled time index ending period (not included)
+  comparison compare;       ///< period comparison criterion
+  double     thresh_obsval; ///< observation threshold of period
+  int        last_n;        ///< last sampled time index accumulated (DOESNT_EXIST if none)
+  double     shift;         ///< value subtracted from observed/modeled values before accumulating
+  double     N;             ///< sum of weights
+  double     sumO;          ///< sum of w*(obs-shift)
+  double     sumM;          ///< sum of w*(mod-shift)
+  double     sumOO;         ///< sum of w*(obs-shift)^2
+  double     sumMM;         ///< sum of w*(mod-shift)^2
+  double     sumOM;         ///< sum of w*(obs-shift)*(mod-shift)
+  double     sumSqErr;      ///< sum of w*(obs-mod)^2
+  double     sumAbsErr;     ///< sum of w*|obs-mod|
+  double     sumMBF;        ///< sum of w/(1+((mod-obs)/(2*obs))^2)
+  double     Ntot;          ///< sum of weights of all observations in period (known before simulation)
+  double     SSobsTot;      ///< sum of w*(obs-mean obs)^2 of all observations in period (known before simulation)
+};
+
 ///////////////////////////////////////////////////////////////////
 /// \brief Data abstraction for time series comparison diagnostics
 //
@@ -81,6 +108,24 @@ public:/*------------------------------------------------------*/
                              comparison       compare,
                              double           threshold,
                              const optStruct &Options) const;
+
+  static bool IsStreamable     (const diag_type typ);
+  static bool HasAchievableBound(const diag_type typ);
+  static void InitializeAccum  (diag_accum      &A,
+                                CTimeSeriesABC  *pTSObs,
+                                CTimeSeriesABC  *pTSWeights,
+                                const double    &starttime,
+                                const double    &endtime,
+                                comparison       compare,
+                                double           threshold,
+                                const optStruct &Options);
+  static void UpdateAccum      (diag_accum      &A,
+                                CTimeSeriesABC  *pTSObs,
+                                CTimeSeriesABC  *pTSWeights,
+                                const int        n,
+                                const double    &modval);
+  double      CalculateFromAccum(const diag_accum &A) const;
+  double      CalculateBestAchievable(const diag_accum &A) const;
 };
 
 ///////////////////////////////////////////////////////////////////
@@ -80,6 +80,18 @@ CForcingGrid::CForcingGrid(string       ForcingType,
   _IdxNonZeroGridCells = NULL;
   _nNonZeroWeightedGridCells=0;
 
+  //initialized in BuildWeightMatrix()
+  _aWtRowStart         = NULL;
+  _aWtCellIdx          = NULL;
+  _aWtVal              = NULL;
+  _aCellAgg            = NULL;
+  for (int i=0;i<3;i++){
+    _aHRUCache  [i]=NULL;
+    _aCacheTime [i]=-ALMOST_INF;
+    _aCacheTstep[i]=0.0;
+  }
+  _pCacheRain          = NULL;
+
   //initialized in CalculateChunkSize()
   _ChunkSize           =0;
   _nChunk              =1;
@@ -95,12 +107,19 @@ CForcingGrid::CForcingGrid(string       ForcingType,
   _AttVarNames[2]      ="NONE";
   _AttVarNames[3]      ="NONE";
 
+  //initialized in SetAsLinearView() or SetAsTemporalView()
+  _derivation          = DERIVE_NONE;
+  _pSrcGrid[0]=_pSrcGrid[1]=_pSrcGrid[2]=NULL;
+  _aDerivCoeff[0]=_aDerivCoeff[1]=_aDerivCoeff[2]=0.0;
+  _deriv_tshift        = 0.0;
+  _deriv_tstep         = 1.0;
 }
 ///////////////////////////////////////////////////////////////////
 /// \brief Copy constructor.
 ///
-/// \param ForcingType   [in] an existing grid
-CForcingGrid::CForcingGrid( const CForcingGrid &grid )
+/// \param grid         [in] an existing grid
+/// \param copy_values  [in] true if the current chunk of values should be copied; otherwise _aVal is left unallocated
+CForcingGrid::CForcingGrid( const CForcingGrid &grid, const bool copy_values )
 {
   ExitGracefullyIf(grid._nNonZeroWeightedGridCells  == 0, " CForcingGrid copy constructor",RUNTIME_ERR);
 
@@ -141,24 +160,39 @@ CForcingGrid::CForcingGrid( const CForcingGrid &grid )
   for (int ii=0; ii<12; ii++) {_aMaxTemp [ii] = grid._aMaxTemp [ii]; }
   for (int ii=0; ii<12; ii++) {_aAvePET  [ii] = grid._aAvePET  [ii]; }
 
+  _derivation                  = grid._derivation                      ;
+  _deriv_tshift                = grid._deriv_tshift                    ;
+  _deriv_tstep                 = grid._deriv_tstep                     ;
+  for (int ii=0; ii<3;  ii++) {_pSrcGrid   [ii] = grid._pSrcGrid   [ii]; }
+  for (int ii=0; ii<3;  ii++) {_aDerivCoeff[ii] = grid._aDerivCoeff[ii]; }
+
   _aVal=NULL;
-  _aVal = new double *[_ChunkSize];
-  ExitGracefullyIf(_aVal==NULL,"CForcingGrid::Copy Constructor(1)",OUT_OF_MEMORY);
-  for (int it=0; it<_ChunkSize; it++) {                       // loop over time points in buffer
-    _aVal[it]=NULL;
-    _aVal[it] = new double [_nNonZeroWeightedGridCells];
-    ExitGracefullyIf(_aVal[it]==NULL,"CForcingGrid::Constructor",OUT_OF_MEMORY);
-    for (int ic=0; ic<_nNonZeroWeightedGridCells;ic++){       // loop over non-zero weighted cells
-      _aVal[it][ic]=grid._aVal[it][ic];                            // copy the value
+  if ((copy_values) && (grid._aVal!=NULL))
+  {
+    _aVal = new double *[_ChunkSize];
+    ExitGracefullyIf(_aVal==NULL,"CForcingGrid::Copy Constructor(1)",OUT_OF_MEMORY);
+    for (int it=0; it<_ChunkSize; it++) {                       // loop over time points in buffer
+      _aVal[it]=NULL;
+      _aVal[it] = new double [_nNonZeroWeightedGridCells];
+      ExitGracefullyIf(_aVal[it]==NULL,"CForcingGrid::Constructor",OUT_OF_MEMORY);
+      for (int ic=0; ic<_nNonZeroWeightedGridCells;ic++){       // loop over non-zero weighted cells
+        _aVal[it][ic]=grid._aVal[it][ic];                            // copy the value
+      }
     }
   }
 
   //cout<<"Creating new GridWeights array (Copy Constructor): "<<ForcingToString(_ForcingType)<<endl;
 
   AllocateWeightArray(_nHydroUnits,_nCells);
-  for (int k=0; k<_nHydroUnits; k++) {
-    for(int i=0;i<grid._nWeights[k];i++) {
-      SetWeightVal(k,grid._GridWtCellIDs[k][i],grid._GridWeight[k][i]); //dynamically grows sparse matrix
+  for (int k=0; k<_nHydroUnits; k++) { //rows are empty if grid weight matrix is already built
+    _nWeights[k]=grid._nWeights[k];
+    if(_nWeights[k]==0) { continue; }
+    _GridWeight   [k]=new double[_nWeights[k]];
+    _GridWtCellIDs[k]=new int   [_nWeights[k]];
+    ExitGracefullyIf(_GridWtCellIDs[k]==NULL,"CForcingGrid::Copy Constructor(10)",OUT_OF_MEMORY);
+    for(int i=0;i<_nWeights[k];i++) {
+      _GridWeight   [k][i]=grid._GridWeight   [k][i];
+      _GridWtCellIDs[k][i]=grid._GridWtCellIDs[k][i];
     }
   }
 
@@ -176,6 +210,23 @@ CForcingGrid::CForcingGrid( const CForcingGrid &grid )
     _IdxNonZeroGridCells[ic]=grid._IdxNonZeroGridCells[ic];
   }
 
+  _aWtRowStart=NULL;_aWtCellIdx=NULL;_aWtVal=NULL;_aCellAgg=NULL;
+  for (int i=0;i<3;i++){
+    _aHRUCache  [i]=NULL;
+    _aCacheTime [i]=-ALMOST_INF;
+    _aCacheTstep[i]=0.0;
+  }
+  _pCacheRain=NULL;
+  if(grid._aWtRowStart!=NULL) {
+    long long nnz=grid._aWtRowStart[_nHydroUnits];
+    _aWtRowStart=new long long[_nHydroUnits+1];
+    _aWtCellIdx =new int   [max(nnz,1LL)];
+    _aWtVal     =new double[max(nnz,1LL)];
+    ExitGracefullyIf(_aWtVal==NULL,"CForcingGrid::Copy Constructor(9)",OUT_OF_MEMORY);
+    for(int k=0; k<=_nHydroUnits; k++)  { _aWtRowStart[k]=grid._aWtRowStart[k]; }
+    for(long long j=0; j<nnz; j++)     { _aWtCellIdx[j]=grid._aWtCellIdx[j]; _aWtVal[j]=grid._aWtVal[j]; }
+  }
+
   _aLatitude=NULL;_aLongitude=NULL;_aElevation=NULL;_aStationIDs=NULL;
   if(grid._aLatitude!=NULL) {
     _aLatitude=new double [_nNonZeroWeightedGridCells];
@@ -219,6 +270,13 @@ CForcingGrid::~CForcingGrid()
   delete [] _CellIDToIdx;           _CellIDToIdx         = NULL;
   delete [] _nWeights;              _nWeights            = NULL;
   delete [] _IdxNonZeroGridCells;   _IdxNonZeroGridCells = NULL;
+  delete [] _aWtRowStart;           _aWtRowStart         = NULL;
+  delete [] _aWtCellIdx;            _aWtCellIdx          = NULL;
+  delete [] _aWtVal;                _aWtVal              = NULL;
+  delete [] _aCellAgg;              _aCellAgg            = NULL;
+  for (int i=0;i<3;i++){
+    delete [] _aHRUCache[i];        _aHRUCache[i]        = NULL;
+  }
   delete [] _aLatitude;             _aLatitude           = NULL;
   delete [] _aLongitude;            _aLongitude          = NULL;
   delete [] _aElevation;            _aElevation          = NULL;
@@ -1082,6 +1140,8 @@ bool CForcingGrid::ReadData(const optStruct   &Options,
 
 #endif   // end #ifdef _RVNETCDF_
 
+  if(new_chunk_read) { ClearWeightedValueCache(); }
+
   return new_chunk_read;
 
 }
@@ -1356,11 +1416,74 @@ void CForcingGrid::SetIdxNonZeroGridCells(const int nHydroUnits, const int nGrid
   }
   delete[] nonzero;
 
+  BuildWeightMatrix(disabledHRUs);
+
   if (Options.noisy){
     cout<<"Finished SetIdxNonZeroGridCells routine, # of non-zero weighted cells: "<<_nNonZeroWeightedGridCells<<endl;
   }
 }
 
+///////////////////////////////////////////////////////////////////
+/// \brief builds compressed sparse row (CSR) weight matrix with pre-resolved local cell indices
+/// \details called once cell indexing (_CellIDToIdx) is known. Rows of disabled HRUs are left
+///          empty, as are entries referring to cells which are not stored (weights below threshold
+///          in SetIdxNonZeroGridCells). Entry order matches _GridWeight[k][] so that sums are identical.
+///          The rows of _GridWeight and _GridWtCellIDs are no longer needed and are freed.
+/// \param disabledHRUs [in] array of HRU disabled flags [size: _nHydroUnits]
+//
+void CForcingGrid::BuildWeightMatrix(const bool *disabledHRUs)
+{
+  long long nnz=0;
+  for(int k=0; k<_nHydroUnits; k++) {
+    if(disabledHRUs[k]) { continue; }
+    for(int i=0; i<_nWeights[k]; i++) {
+      if(_CellIDToIdx[_GridWtCellIDs[k][i]]!=DOESNT_EXIST) { nnz++; }
+    }
+  }
+  delete [] _aWtRowStart;
+  delete [] _aWtCellIdx;
+  delete [] _aWtVal;
+  _aWtRowStart=new long long[_nHydroUnits+1];
+  _aWtCellIdx =new int   [max(nnz,1LL)];
+  _aWtVal     =new double[max(nnz,1LL)];
+  ExitGracefullyIf(_aWtVal==NULL,"CForcingGrid::BuildWeightMatrix",OUT_OF_MEMORY);
+
+  long long j=0;
+  int ic;
+  for(int k=0; k<_nHydroUnits; k++) {
+    _aWtRowStart[k]=j;
+    if(disabledHRUs[k]) { continue; }
+    for(int i=0; i<_nWeights[k]; i++) {
+      ic=_CellIDToIdx[_GridWtCellIDs[k][i]];
+      if(ic!=DOESNT_EXIST) {
+        _aWtCellIdx[j]=ic;
+        _aWtVal    [j]=_GridWeight[k][i];
+        j++;
+      }
+    }
+  }
+  _aWtRowStart[_nHydroUnits]=j;
+
+  for(int k=0; k<_nHydroUnits; k++) {
+    delete [] _GridWeight   [k]; _GridWeight   [k]=NULL;
+    delete [] _GridWtCellIDs[k]; _GridWtCellIDs[k]=NULL;
+    _nWeights[k]=0;
+  }
+
+  ClearWeightedValueCache();
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief marks all cached HRU weighted values as stale
+/// \details called after a new chunk of data is read and by the model at the start of each time step,
+///          so that derived grid views (which never read data themselves) are also refreshed
+//
+void CForcingGrid::ClearWeightedValueCache()
+{
+  for(int i=0;i<3;i++) { _aCacheTime[i]=-ALMOST_INF; }
+  _pCacheRain=NULL;
+}
+
 ///////////////////////////////////////////////////////////////////
 /// \brief calculates _ChunkSize and total number of chunks to read (_nChunks)
 /// depending upon size of grid (_nNonZeroWeightedGridCells*buffersize*8byte <=  10 MB=10*1024*1024 byte)
@@ -1546,6 +1669,8 @@ void CForcingGrid::SetaAvePET(const double aAvePET [12]){
 //
 void CForcingGrid::SetValue( const int ic, const int it, const double aVal) {
 #ifdef _STRICTCHECK_
+  if(_derivation!=DERIVE_NONE) {
+    ExitGracefully("CForcingGrid::SetValue: cannot set values of derived forcing grid view",RUNTIME_ERR);}
   if(it>=_ChunkSize) {
     ExitGracefully("CForcingGrid::SetValue:invalid time index",RUNTIME_ERR);}
   if(ic>=_nNonZeroWeightedGridCells) {
@@ -1706,6 +1831,40 @@ void   CForcingGrid::SetWeightVal(const int HRUID,
   delete [] _GridWtCellIDs[k]; _GridWtCellIDs[k]=tmpid;
 }
 ///////////////////////////////////////////////////////////////////
+/// \brief sets all weights of all HRUs at once (replaces any existing weights)
+/// \details bulk alternative to repeated calls of SetWeightVal(), e.g., for weights read from file;
+///          entries must have unique cell IDs within each HRU. Weight array must be allocated.
+///
+/// \param aStart   [in] weights of HRU k are entries aStart[k] to aStart[k+1]-1 [size: _nHydroUnits+1]
+/// \param aCellIDs [in] cell ID in NetCDF of each entry (0 to _nCells-1)
+/// \param aWts     [in] weight of each entry
+//
+void   CForcingGrid::SetWeightArrays(const long long *aStart,const int *aCellIDs,const double *aWts)
+{
+  if (_GridWeight == NULL){
+    ExitGracefully(
+      "CForcingGrid: SetWeightArrays: _GridWeight is not allocated yet. Call AllocateWeightArray(nHRUs) first.",RUNTIME_ERR);
+  }
+  for(int k=0;k<_nHydroUnits;k++)
+  {
+    delete [] _GridWeight   [k]; _GridWeight   [k]=NULL;
+    delete [] _GridWtCellIDs[k]; _GridWtCellIDs[k]=NULL;
+    _nWeights[k]=(int)(aStart[k+1]-aStart[k]);
+    if(_nWeights[k]==0) { continue; }
+
+    _GridWeight   [k]=new double[_nWeights[k]];
+    _GridWtCellIDs[k]=new int   [_nWeights[k]];
+    ExitGracefullyIf(_GridWtCellIDs[k]==NULL,"CForcingGrid::SetWeightArrays",OUT_OF_MEMORY);
+    for(int i=0;i<_nWeights[k];i++) {
+      int CellID=aCellIDs[aStart[k]+i];
+      if((CellID<0) || (CellID>=_nCells)) {
+        ExitGracefully("CForcingGrid: SetWeightArrays: invalid cell ID",BAD_DATA);}
+      _GridWeight   [k][i]=aWts[aStart[k]+i];
+      _GridWtCellIDs[k][i]=CellID;
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////
 /// \brief sets one entry of _aElevation[CellID]
 //
 /// \param cellID [in] cell ID/stationID in NetCDF (from 0 to _nCells-1)
@@ -1782,6 +1941,14 @@ double CForcingGrid::GetGridWeight(const int k,
   if ((CellID<0) || (CellID>=nCells  )){ExitGracefully("CForcingGrid::GetGridWeight: invalid CellID index",RUNTIME_ERR); }
   if (_GridWeight==NULL){ ExitGracefully("CForcingGrid::GetGridWeight: NULL Grid weight matrix",RUNTIME_ERR); }
 #endif
+  if(_aWtRowStart!=NULL) { //weight matrix built; rows of _GridWeight freed
+    int ic=_CellIDToIdx[CellID];
+    if(ic==DOESNT_EXIST) { return 0.0; }
+    for(long long j=_aWtRowStart[k]; j<_aWtRowStart[k+1]; j++) {
+      if(_aWtCellIdx[j]==ic) { return _aWtVal[j]; }
+    }
+    return 0.0;
+  }
   for(int i=0; i<_nWeights[k];i++)
   {
     if(_GridWtCellIDs[k][i]==CellID) { return _GridWeight[k][i]; }
@@ -1807,6 +1974,65 @@ bool   CForcingGrid::GetIsDerived() const{return _is_derived;}
 //
 void   CForcingGrid::SetIsDerived(const bool is_derived){_is_derived=is_derived;}
 
+///////////////////////////////////////////////////////////////////
+/// \brief converts grid into a lightweight view evaluated as a*A+b*B+c on demand
+/// \details value storage (_aVal) is released; source grids must share cell indexing and
+///          time indexing (interval, chunk size) with this grid
+/// \param pSrcA [in] first source grid (may be NULL if a==0)
+/// \param a     [in] multiplier of first source grid
+/// \param pSrcB [in] second source grid (may be NULL if b==0)
+/// \param b     [in] multiplier of second source grid
+/// \param c     [in] constant offset
+//
+void   CForcingGrid::SetAsLinearView(const CForcingGrid *pSrcA, const double a,
+                                     const CForcingGrid *pSrcB, const double b,
+                                     const double c)
+{
+  ExitGracefullyIf((pSrcA==NULL) && (a!=0.0),"CForcingGrid::SetAsLinearView: NULL source grid",RUNTIME_ERR);
+  ExitGracefullyIf((pSrcB==NULL) && (b!=0.0),"CForcingGrid::SetAsLinearView: NULL source grid",RUNTIME_ERR);
+  if(_aVal!=NULL) {
+    for(int it=0; it<_ChunkSize; it++) { delete[] _aVal[it]; _aVal[it]=NULL; } delete[] _aVal; _aVal=NULL;
+  }
+  _derivation    =DERIVE_LINEAR;
+  _pSrcGrid[0]   =pSrcA;   _aDerivCoeff[0]=a;
+  _pSrcGrid[1]   =pSrcB;   _aDerivCoeff[1]=b;
+  _pSrcGrid[2]   =NULL;    _aDerivCoeff[2]=c;
+  _is_derived    =true;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief converts grid into a lightweight view evaluated on demand as a daily aggregate of,
+///        or subdaily downscaling from, its source grids
+/// \details value storage (_aVal) is released; see grid_derivation for use of source grids
+/// \param type    [in] derivation method
+/// \param pSrc0   [in] first source grid (daily min or subdaily temperature)
+/// \param pSrc1   [in] second source grid (daily max, or NULL)
+/// \param pSrc2   [in] third source grid (daily average, or NULL)
+/// \param Options [in] global model options
+//
+void   CForcingGrid::SetAsTemporalView(const grid_derivation type,
+                                       const CForcingGrid *pSrc0,
+                                       const CForcingGrid *pSrc1,
+                                       const CForcingGrid *pSrc2,
+                                       const optStruct &Options)
+{
+  ExitGracefullyIf(pSrc0==NULL,"CForcingGrid::SetAsTemporalView: NULL source grid",RUNTIME_ERR);
+  ExitGracefullyIf(((type==DERIVE_DAILY_MINMAX_AVE) || (type==DERIVE_SUBDAILY_TEMP)) && (pSrc1==NULL),
+                   "CForcingGrid::SetAsTemporalView: missing maximum temperature source grid",RUNTIME_ERR);
+  ExitGracefullyIf((type==DERIVE_SUBDAILY_TEMP) && (pSrc2==NULL),
+                   "CForcingGrid::SetAsTemporalView: missing daily average temperature source grid",RUNTIME_ERR);
+  if(_aVal!=NULL) {
+    for(int it=0; it<_ChunkSize; it++) { delete[] _aVal[it]; _aVal[it]=NULL; } delete[] _aVal; _aVal=NULL;
+  }
+  _derivation    =type;
+  _pSrcGrid[0]   =pSrc0;
+  _pSrcGrid[1]   =pSrc1;
+  _pSrcGrid[2]   =pSrc2;
+  _deriv_tshift  =Options.julian_start_day-floor(Options.julian_start_day+TIME_CORRECTION);
+  _deriv_tstep   =Options.timestep;
+  _is_derived    =true;
+}
+
 ///////////////////////////////////////////////////////////////////
 /// \brief Returns _is_3D class variable.\n
 ///        True if NetCDF data are (lat,lon,time), false if data are (nstations,time).
@@ -1876,73 +2102,141 @@ int CForcingGrid::GetTimeIndex(const double &t) const
   return ((int) floor((t+TIME_CORRECTION) *rvn_round(1.0/_interval)))  % _ChunkSize;
 }
 
+///////////////////////////////////////////////////////////////////
+/// \brief sparse matrix-vector product: aHRUVals[k]=sum(w_ki * aCellVals[i])
+/// \param aCellVals [in]  array of values for each non-zero weighted cell [size: _nNonZeroWeightedGridCells]
+/// \param aHRUVals  [out] weighted values in each HRU [size: _nHydroUnits]
+//
+void CForcingGrid::WeightCellValues(const double *aCellVals, double *aHRUVals) const
+{
+  double sum;
+  for(int k=0; k<_nHydroUnits; k++)
+  {
+    sum=0.0;
+    for(long long j=_aWtRowStart[k]; j<_aWtRowStart[k+1]; j++) {
+      sum+=_aWtVal[j]*aCellVals[_aWtCellIdx[j]];
+    }
+    aHRUVals[k]=sum;
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief calculates weighted value of gridded forcing in all HRUs over timestep starting at time t
+/// \details each cell is first aggregated over the time step, then weighted (one sparse mat-vec)
+/// \param t     [in]  model time [days]
+/// \param tstep [in]  model time step [days]
+/// \param aVals [out] timestep weighted value of gridded forcing in each HRU [size: _nHydroUnits]
+//
+void CForcingGrid::CalculateWeightedValues(const double &t,const double &tstep,double *aVals)
+{
+  if(_aCellAgg==NULL) { _aCellAgg=new double[max(_nNonZeroWeightedGridCells,1)]; }
+  int idx_new = GetTimeIndex(t);
+  int nSteps = max(1,(int)(rvn_round(tstep/_interval)));//# of intervals in time step
+  for(int ic=0; ic<_nNonZeroWeightedGridCells; ic++) {
+    _aCellAgg[ic]=GetValue_avg(ic,idx_new,nSteps);
+  }
+  WeightCellValues(_aCellAgg,aVals);
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief calculates daily weighted value of gridded forcing in all HRUs
+/// \param t       [in]  model time [days]
+/// \param Options [in]  global model options
+/// \param aVals   [out] daily weighted value of gridded forcing in each HRU [size: _nHydroUnits]
+//
+void CForcingGrid::CalculateDailyWeightedValues(const double &t,const optStruct &Options,double *aVals)
+{
+  if(_aCellAgg==NULL) { _aCellAgg=new double[max(_nNonZeroWeightedGridCells,1)]; }
+  double time_shift=Options.julian_start_day-floor(Options.julian_start_day+TIME_CORRECTION);
+  int it_new_day = GetTimeIndex(t-time_shift);//index corresponding to start of day
+  for(int ic=0; ic<_nNonZeroWeightedGridCells; ic++) {
+    _aCellAgg[ic]=GetValue_avg(ic,it_new_day,_steps_per_day);
+  }
+  WeightCellValues(_aCellAgg,aVals);
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief calculates weighted snow fraction in all HRUs if this is a gridded snow dataset
+/// \param t     [in]  model time [days]
+/// \param tstep [in]  model time step [days]
+/// \param pRain [in]  pointer to gridded rain dataset
+/// \param aVals [out] weighted snow fraction in each HRU [size: _nHydroUnits]
+//
+void CForcingGrid::CalculateWeightedSnowFracs(const double &t,const double &tstep,const CForcingGrid *pRain,double *aVals)
+{
+  if(_aCellAgg==NULL) { _aCellAgg=new double[max(_nNonZeroWeightedGridCells,1)]; }
+  int idx_new = GetTimeIndex(t);
+  int nSteps = max(1,(int)(rvn_round(tstep/_interval)));//# of intervals in time step
+  double snow,rain;
+  for(int ic=0; ic<_nNonZeroWeightedGridCells; ic++) {
+    snow = max(GetValue_avg(ic, idx_new, nSteps),0.0);
+    _aCellAgg[ic]=0.0;
+    if(snow>0.0){
+      rain=max(pRain->GetValue_avg(ic, idx_new, nSteps),0.0);
+      _aCellAgg[ic]=snow/(snow+rain);
+    }
+  }
+  WeightCellValues(_aCellAgg,aVals);
+}
+
 ///////////////////////////////////////////////////////////////////
 /// \brief returns weighted value of gridded forcing in HRU k over timestep starting at time t
+/// \details values for all HRUs are calculated on the first call for each (t,tstep) and cached;
+///          not thread-safe (called from the serial HRU loop of CModel::UpdateHRUForcingFunctions, as is ReadData)
 /// \param k    [in] HRU index
 /// \param t      [in] model time [days]
 /// \return tstep [in] model time step [days]
 /// \returns timestep weighted value of gridded forcing in HRU k
 //
-double CForcingGrid::GetWeightedValue(const int k,const double &t,const double &tstep) const
+double CForcingGrid::GetWeightedValue(const int k,const double &t,const double &tstep)
 {
-  int idx_new = GetTimeIndex(t);
-  int nSteps = max(1,(int)(rvn_round(tstep/_interval)));//# of intervals in time step
-  double wt,sum=0.0;
-  for(int i = 0;i <_nWeights[k]; i++)
-  {
-    wt   = _GridWeight[k][i];
-    sum += wt * GetValue_avg(_CellIDToIdx[_GridWtCellIDs[k][i]],idx_new,nSteps);
+  if((_aCacheTime[0]!=t) || (_aCacheTstep[0]!=tstep)) {
+    if(_aHRUCache[0]==NULL) { _aHRUCache[0]=new double[_nHydroUnits]; }
+    CalculateWeightedValues(t,tstep,_aHRUCache[0]);
+    _aCacheTime [0]=t;
+    _aCacheTstep[0]=tstep;
   }
-  return sum;
+  return _aHRUCache[0][k];
 }
 ///////////////////////////////////////////////////////////////////
 /// \brief returns daily weighted value of gridded forcing in HRU k
+/// \details cached as in GetWeightedValue(); Options (start day) are fixed over the run
 /// \param k     [in] HRU index
 /// \param t     [in] model time [days]
 /// \param tstep [in] model time step [days]
 /// \returns daily weighted value of gridded forcing in HRU k
 //
-double CForcingGrid::GetDailyWeightedValue(const int k,const double &t,const double &tstep, const optStruct &Options) const
+double CForcingGrid::GetDailyWeightedValue(const int k,const double &t,const double &tstep, const optStruct &Options)
 {
-  double time_shift=Options.julian_start_day-floor(Options.julian_start_day+TIME_CORRECTION);
-  int it_new_day = GetTimeIndex(t-time_shift);//index corresponding to start of day
-  double wt,sum=0;
-  for(int i = 0;i <_nWeights[k]; i++)
-  {
-    wt   = _GridWeight[k][i];
-    sum += wt * GetValue_avg(_CellIDToIdx[_GridWtCellIDs[k][i]],it_new_day,_steps_per_day);
+  if((_aCacheTime[1]!=t) || (_aCacheTstep[1]!=tstep)) {
+    if(_aHRUCache[1]==NULL) { _aHRUCache[1]=new double[_nHydroUnits]; }
+    CalculateDailyWeightedValues(t,Options,_aHRUCache[1]);
+    _aCacheTime [1]=t;
+    _aCacheTstep[1]=tstep;
   }
-  return sum;
+  return _aHRUCache[1][k];
 }
 ///////////////////////////////////////////////////////////////////
 /// \brief returns daily weighted snowfrac value if this is a gridded snow dataset and pRain is provided
+/// \details cached as in GetWeightedValue(), also keyed on pRain
 /// \param k     [in] HRU index
 /// \param t     [in] model time [days]
 /// \param pRain [in] pointer to gridded rain dataset
 /// \param tstep [in] model time step [days]
 //
-double CForcingGrid::GetWeightedAverageSnowFrac(const int k,const double &t,const double &tstep,const CForcingGrid *pRain) const
+double CForcingGrid::GetWeightedAverageSnowFrac(const int k,const double &t,const double &tstep,const CForcingGrid *pRain)
 {
 #ifdef _STRICTCHECK_
   if ((k<0) || (k>_nHydroUnits)){ExitGracefully("CForcingGrid::GetWeightedAverageSnowFrac: invalid HRU index",RUNTIME_ERR); }
 #endif
-
-  int idx_new = GetTimeIndex(t);
-  int nSteps = max(1,(int)(rvn_round(tstep/_interval)));//# of intervals in time step
-  double wt,sum=0.0;
-  double snow; double rain;
-  int ic;
-  for (int i=0;i<_nWeights[k];i++)
-  {
-    ic=_CellIDToIdx[_GridWtCellIDs[k][i]];
-    wt   = _GridWeight[k][i];
-    snow = max(GetValue_avg(ic, idx_new, nSteps),0.0);
-    if(snow>0.0){
-      rain=max(pRain->GetValue_avg(ic, idx_new, nSteps),0.0);
-      sum+= wt * snow/(snow+rain);
-    }
-  }
-  return sum;
+  if((_aCacheTime[2]!=t) || (_aCacheTstep[2]!=tstep) || (_pCacheRain!=pRain)) {
+    if(_aHRUCache[2]==NULL) { _aHRUCache[2]=new double[_nHydroUnits]; }
+    CalculateWeightedSnowFracs(t,tstep,pRain,_aHRUCache[2]);
+    _aCacheTime [2]=t;
+    _aCacheTstep[2]=tstep;
+    _pCacheRain    =pRain;
+  }
+  return _aHRUCache[2][k];
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1953,11 +2247,9 @@ double CForcingGrid::GetWeightedAverageSnowFrac(const int k,const double &t,cons
 double CForcingGrid::GetRefElevation(const int k) const
 {
   if(_aElevation==NULL) { return RAV_BLANK_DATA; }
-  double wt,sum=0.0;
-  for(int i = 0;i <_nWeights[k]; i++)
-  {
-    wt   = _GridWeight[k][i];
-    sum += wt * _aElevation[_CellIDToIdx[_GridWtCellIDs[k][i]]];
+  double sum=0.0;
+  for(long long j=_aWtRowStart[k]; j<_aWtRowStart[k+1]; j++) {
+    sum+=_aWtVal[j]*_aElevation[_aWtCellIdx[j]];
   }
   return sum;
 }
@@ -1991,9 +2283,64 @@ double CForcingGrid::GetCellLongitude(const int l) const
 //
 double CForcingGrid::GetValue(const int ic, const int it) const
 {
+  if(_derivation!=DERIVE_NONE) { return GetDerivedValue(ic,it); }
   return _aVal[it][ic];
 }
 
+///////////////////////////////////////////////////////////////////
+/// \brief Evaluates value of derived grid view from its source grids
+/// \details time index it is local to the current chunk of this grid; source grids are
+///          assumed to hold the corresponding chunk of data
+/// \param ic    [in] Index of grid cell with non-zero weighting (value between 0 and _nNonZeroWeightedGridCells)
+/// \param it    [in] Time index
+/// \return derived value of cell ic at time index it
+//
+double CForcingGrid::GetDerivedValue(const int ic, const int it) const
+{
+  double val,t,Tmin,Tmax;
+  int    n,t_idx;
+  switch(_derivation)
+  {
+  case(DERIVE_LINEAR):
+  {
+    val=_aDerivCoeff[2];
+    if(_aDerivCoeff[0]!=0.0) { val+=_aDerivCoeff[0]*_pSrcGrid[0]->GetValue(ic,it); }
+    if(_aDerivCoeff[1]!=0.0) { val+=_aDerivCoeff[1]*_pSrcGrid[1]->GetValue(ic,it); }
+    return val;
+  }
+  case(DERIVE_DAILY_MINMAX_AVE):
+  {
+    n    =(int)(1.0/_pSrcGrid[0]->GetInterval());
+    t_idx=(int)floor((double)(it)-_deriv_tshift+TIME_CORRECTION)*n;
+    return 0.5*(_pSrcGrid[0]->GetValue_avg(ic,t_idx,n)+_pSrcGrid[1]->GetValue_avg(ic,t_idx,n));
+  }
+  case(DERIVE_SUBDAILY_TEMP):
+  {
+    n    =(int)(1.0/_pSrcGrid[0]->GetInterval());
+    t    =(double)(it)*_deriv_tstep;
+    t_idx=(int)floor(t-_deriv_tshift+TIME_CORRECTION)*n;
+    Tmin =_pSrcGrid[0]->GetValue_avg(ic,t_idx,n);
+    Tmax =_pSrcGrid[1]->GetValue_avg(ic,t_idx,n);
+    val  =_pSrcGrid[2]->GetValue(ic,(int)(floor(t+TIME_CORRECTION)));
+    return val+0.25*(Tmax-Tmin)*(DailyTempCorrection(t)+DailyTempCorrection(t+_deriv_tstep));
+  }
+  case(DERIVE_DAILY_MIN):
+  case(DERIVE_DAILY_MAX):
+  case(DERIVE_DAILY_AVE):
+  {
+    n    =(int)(rvn_round(1.0/_pSrcGrid[0]->GetInterval()));
+    t_idx=(int)(floor((double)(it)*n-_deriv_tshift+TIME_CORRECTION));
+    if      (_derivation==DERIVE_DAILY_MIN) { return _pSrcGrid[0]->GetValue_min(ic,t_idx,n); }
+    else if (_derivation==DERIVE_DAILY_MAX) { return _pSrcGrid[0]->GetValue_max(ic,t_idx,n); }
+    else                                    { return _pSrcGrid[0]->GetValue_avg(ic,t_idx,n); }
+  }
+  default:
+  {
+    return _aVal[it][ic];
+  }
+  }
+}
+
 ///////////////////////////////////////////////////////////////////
 /// \brief Returns average over n timesteps of time series data point for which t is an index
 /// \param ic     [in] Index of grid cell with non-zero weighting (value between 0 and _nNonZeroWeightedGridCells)
@@ -2006,8 +2353,15 @@ double CForcingGrid::GetValue_avg(const int ic, const int t_idx, const int nstep
   int it_start=max(t_idx,0);
   int lim=min(nsteps,_ChunkSize-it_start);
   double sum = 0.0;
-  for (int it=it_start; it<it_start+lim;it++){
-    sum += _aVal[it][ic];
+  if(_derivation!=DERIVE_NONE) {
+    for (int it=it_start; it<it_start+lim;it++){
+      sum += GetDerivedValue(ic,it);
+    }
+  }
+  else {
+    for (int it=it_start; it<it_start+lim;it++){
+      sum += _aVal[it][ic];
+    }
   }
   sum /= (double)(lim);
 
@@ -2024,10 +2378,12 @@ double CForcingGrid::GetValue_avg(const int ic, const int t_idx, const int nstep
 double CForcingGrid::GetValue_min(const int ic, const int t_idx, const int nsteps) const
 {
   double min_val = ALMOST_INF ;
+  double val;
   int it_start=max(t_idx,0);
   int lim=min(nsteps,_ChunkSize-it_start);
   for (int it=it_start; it<it_start+lim;it++){
-    if(_aVal[it][ic] < min_val){min_val=_aVal[it][ic];}
+    val=(_derivation!=DERIVE_NONE) ? GetDerivedValue(ic,it) : _aVal[it][ic];
+    if(val < min_val){min_val=val;}
   }
   return min_val;
 }
@@ -2042,10 +2398,12 @@ double CForcingGrid::GetValue_min(const int ic, const int t_idx, const int nstep
 double CForcingGrid::GetValue_max(const int ic, const int t_idx, const int nsteps) const
 {
   double max_val = -ALMOST_INF ;
+  double val;
   int it_start=max(t_idx,0);
   int lim=min(nsteps,_ChunkSize-it_start);
   for (int it=it_start; it<it_start+lim;it++){
-    if(_aVal[it][ic] > max_val){max_val=_aVal[it][ic];}
+    val=(_derivation!=DERIVE_NONE) ? GetDerivedValue(ic,it) : _aVal[it][ic];
+    if(val > max_val){max_val=val;}
   }
   return max_val;
 }
@@ -14,6 +14,20 @@
 #include <netcdf.h>
 #endif
 
+///////////////////////////////////////////////////////////////////
+/// \brief Methods of evaluating a derived forcing grid on demand from its source grids
+//
+enum grid_derivation
+{
+  DERIVE_NONE,             ///< values stored in _aVal (read from file or copied)
+  DERIVE_LINEAR,           ///< a*src[0]+b*src[1]+c (copies, sums, offsets, and constant grids)
+  DERIVE_DAILY_MINMAX_AVE, ///< daily average temperature as mean of daily min (src[0]) and max (src[1])
+  DERIVE_SUBDAILY_TEMP,    ///< subdaily temperature from daily ave (src[2]) with diurnal correction using daily min (src[0]) and max (src[1])
+  DERIVE_DAILY_MIN,        ///< daily minimum of subdaily src[0]
+  DERIVE_DAILY_MAX,        ///< daily maximum of subdaily src[0]
+  DERIVE_DAILY_AVE         ///< daily average of subdaily src[0]
+};
+
 ///////////////////////////////////////////////////////////////////
 /// \brief   Data abstraction for gridded, 3D forcings
 /// \details Data Abstraction for gridded, 3D forcing data.
@@ -71,6 +85,16 @@ private:/*------------------------------------------------------*/
   int        **_GridWtCellIDs;               ///< cell IDs for all non-zero grid weights for HRU k size=[_nHydroUnits][_nWeights[k]] (variable)
   int         *_CellIDToIdx;                 ///< local cell index ic (ranging from 0 to _nNonZeroWeightedGridCells-1)) corresponding to cell ID [size: _nCells]
   int         *_nWeights;                    ///< number of weights for each HRU k (size=_nHydroUnits) (each entry greater or equal to 1)
+  long long   *_aWtRowStart;                 ///< compressed sparse row (CSR) form of weights: weights of HRU k are entries
+  //                                         ///< _aWtRowStart[k].._aWtRowStart[k+1]-1 [size: _nHydroUnits+1] (empty for disabled HRUs)
+  //                                         ///< once built, replaces _GridWeight/_GridWtCellIDs, whose rows are freed
+  int         *_aWtCellIdx;                  ///< CSR local (non-zero weighted) cell index ic of each weight [size: _aWtRowStart[_nHydroUnits]]
+  double      *_aWtVal;                      ///< CSR weight of each entry [size: _aWtRowStart[_nHydroUnits]]
+  double      *_aCellAgg;                    ///< scratch array of time-aggregated cell values [size: _nNonZeroWeightedGridCells]
+  double      *_aHRUCache[3];                ///< weighted values of all HRUs [0: time step average, 1: daily average, 2: snow fraction] [size: _nHydroUnits]
+  double       _aCacheTime[3];               ///< model time at which _aHRUCache[] was evaluated (-ALMOST_INF if stale)
+  double       _aCacheTstep[3];              ///< model time step with which _aHRUCache[] was evaluated
+  const CForcingGrid *_pCacheRain;           ///< rain grid with which _aHRUCache[2] (snow fraction) was evaluated
   int          _nNonZeroWeightedGridCells;   ///< Number of non-zero weighted grid cells:
   //                                         ///< This is effectively the number of data points which is stored from the original data.
   int         *_IdxNonZeroGridCells;         ///< indexes of non-zero weighted grid cells [size = _nNonZeroWeightedGridCells]
@@ -104,6 +128,12 @@ private:/*------------------------------------------------------*/
   double*      _aElevation;                  ///< fixed array of cell representative elevations, if provided (size: _IdxNonZeroGridCells)
   string*      _aStationIDs;                 ///< fixed array of cell station/cell IDS (size:_IdxNonZeroGridCells)
 
+  grid_derivation     _derivation;           ///< method of evaluating values on demand (DERIVE_NONE if values are stored in _aVal)
+  const CForcingGrid *_pSrcGrid[3];          ///< source grids of derived view (NULL if unused)
+  double       _aDerivCoeff[3];              ///< coefficients [a,b,c] of DERIVE_LINEAR view (a*src[0]+b*src[1]+c)
+  double       _deriv_tshift;                ///< fractional day of model start used by daily derivations [d]
+  double       _deriv_tstep;                 ///< model time step used by DERIVE_SUBDAILY_TEMP [d]
+
   void   CellIdxToRowCol(const int        cellid,
                          int              &row,
                          int              &column) const;             ///< returns row and column index of cell ID
@@ -113,6 +143,11 @@ private:/*------------------------------------------------------*/
 
   void   Deaccumulate ();
 
+  double GetDerivedValue(const int ic, const int it) const;
+
+  void   BuildWeightMatrix(const bool *disabledHRUs);
+  void   WeightCellValues (const double *aCellVals, double *aHRUVals) const;
+
 public:/*------------------------------------------------------*/
   //Constructors:
 
@@ -125,8 +160,8 @@ public:/*------------------------------------------------------*/
     bool         is_3D
     );
 
-  // copy constructor
-  CForcingGrid( const CForcingGrid &grid );
+  // copy constructor (values only copied if copy_values==true)
+  CForcingGrid( const CForcingGrid &grid, const bool copy_values=true );
 
   ~CForcingGrid();
 
@@ -158,6 +193,9 @@ public:/*------------------------------------------------------*/
   void   SetWeightVal(                     const int        HRUID,
                                            const int        CellID,
                                            const double     weight);                    ///< sets one entry of _GridWeight[HRUID, CellID] = weight
+  void   SetWeightArrays(                  const long long *aStart,
+                                           const int       *aCellIDs,
+                                           const double    *aWts);                      ///< sets all weights of all HRUs at once from compressed sparse rows
   bool   CheckWeightArray(                 const int        nHydroUnits,
                                            const int        nGridCells,
                                            const CModel    *pModel);                    ///< checks if sum(_GridWeight[HRUID, :]) = 1.0 for all HRUIDs
@@ -212,6 +250,14 @@ public:/*------------------------------------------------------*/
   void         SetAttributeVarName(        const string var, const string varname); ///< set elevation, lat, or long var name
   void         SetStationElevation(        const int idx, const double &elev);      ///< set elevation of station idx
   void         SetIsDerived               (const bool is_derived);
+  void         SetAsLinearView            (const CForcingGrid *pSrcA, const double a,
+                                           const CForcingGrid *pSrcB, const double b,
+                                           const double c);                         ///< evaluate as a*A+b*B+c on demand
+  void         SetAsTemporalView          (const grid_derivation type,
+                                           const CForcingGrid *pSrc0,
+                                           const CForcingGrid *pSrc1,
+                                           const CForcingGrid *pSrc2,
+                                           const optStruct &Options);               ///< evaluate daily/subdaily aggregate on demand
 
   // get class variables
   double       GetInterval()                                      const; ///< data interval (in days)
@@ -243,9 +289,14 @@ public:/*------------------------------------------------------*/
   double       GetCellLongitude      (const int l) const;        ///< returns Longitude of cell l (or 0, if not available)
   double       GetRefElevation       (const int k) const;        ///< returns representative elevation of forcing data in HRU k (or 0, if not available)
 
-  double       GetWeightedValue          (const int k, const double &t,const double &tstep) const; ///<returns weighted value in HRU k
-  double       GetDailyWeightedValue     (const int k, const double &t,const double &tstep, const optStruct &Options) const; ///<returns daily weighted value in HRU k
-  double       GetWeightedAverageSnowFrac(const int k, const double &t,const double &tstep,const CForcingGrid *pRain) const; ///<returns daily weighted value in HRU k
+  void         ClearWeightedValueCache   ();                                                   ///< marks cached HRU weighted values as stale
+  double       GetWeightedValue          (const int k, const double &t,const double &tstep); ///<returns weighted value in HRU k
+  double       GetDailyWeightedValue     (const int k, const double &t,const double &tstep, const optStruct &Options); ///<returns daily weighted value in HRU k
+  double       GetWeightedAverageSnowFrac(const int k, const double &t,const double &tstep,const CForcingGrid *pRain); ///<returns daily weighted value in HRU k
+
+  void         CalculateWeightedValues       (const double &t,const double &tstep,double *aVals);                           ///< weighted values in all HRUs [size: _nHydroUnits]
+  void         CalculateDailyWeightedValues  (const double &t,const optStruct &Options,double *aVals);                       ///< daily weighted values in all HRUs
+  void         CalculateWeightedSnowFracs    (const double &t,const double &tstep,const CForcingGrid *pRain,double *aVals); ///< weighted snow fraction in all HRUs
 };
 
 #endif
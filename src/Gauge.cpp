@@ -144,6 +144,8 @@ void CGauge::Initialize(const optStruct   &Options,
   for (int i=0; i<_nTimeSeries;i++){
     _pTimeSeries[i]->Initialize(model_start_day,model_start_yr,model_duration,timestep,false,Options.calendar);
   }
+  //index precip for 5-day window averages (CModel::UpdateHRUForcingFunctions)
+  if (GetTimeSeries(F_PRECIP)!=NULL){GetTimeSeries(F_PRECIP)->IndexWindowAverages(5.0);}
 
   //QA/QC: check time series for valid values
   //--------------------------------------------------------------------------
@@ -312,6 +314,26 @@ void     CGauge::SetElevation         (const double &e){_elevation=e;}
 //
 void     CGauge::SetMeasurementHt     (const double &ht){_meas_ht=ht;}
 
+//////////////////////////////////////////////////////////////////
+/// \brief Returns address of gauge property
+/// \param param_name [in] Property Identifier (string)
+/// \return address of property, or NULL if unrecognized
+//
+double  *CGauge::GetGaugePropertyAddress   (const string param_name)
+{
+  string label_n = StringToUppercase(param_name);
+
+  if      (!label_n.compare("RAINFALL_CORR"   ))  {return &(_rainfall_corr);}
+  else if (!label_n.compare("SNOWFALL_CORR"   ))  {return &(_snowfall_corr);}
+  else if (!label_n.compare("TEMP_CORR"       ))  {return &(_temperature_corr);}
+  else if (!label_n.compare("ELEVATION"       ))  {return &(_elevation);}
+  else if (!label_n.compare("CLOUD_MIN_RANGE" ))  {return &(_cloud_min_temp);}
+  else if (!label_n.compare("CLOUD_MAX_RANGE" ))  {return &(_cloud_max_temp);}
+  else if (!label_n.compare("LATITUDE"        ))  {return &(_Loc.latitude);}
+  else if (!label_n.compare("LONGITUDE"       ))  {return &(_Loc.longitude);}
+
+  return NULL;
+}
 //////////////////////////////////////////////////////////////////
 /// \brief Sets gauge property
 /// \param prop_tag [in] Property Identifier (string)
@@ -321,14 +343,8 @@ void     CGauge::SetMeasurementHt     (const double &ht){_meas_ht=ht;}
 bool     CGauge::SetGaugeProperty          (const string prop_tag, const double &value)
 {
   string label_n = StringToUppercase(prop_tag);
-  if      (!label_n.compare("RAINFALL_CORR"   ))  {_rainfall_corr=value;}
-  else if (!label_n.compare("SNOWFALL_CORR"   ))  {_snowfall_corr=value;}
-  else if (!label_n.compare("TEMP_CORR"       ))  { _temperature_corr=value; }
-  else if (!label_n.compare("ELEVATION"       ))  {_elevation=value;}
-  else if (!label_n.compare("CLOUD_MIN_RANGE" ))  {_cloud_min_temp=value;}
-  else if (!label_n.compare("CLOUD_MAX_RANGE" ))  {_cloud_max_temp=value;}
-  else if (!label_n.compare("LATITUDE"        ))  {_Loc.latitude=value;}
-  else if (!label_n.compare("LONGITUDE"       ))  {_Loc.longitude=value;}
+  double *px=GetGaugePropertyAddress(label_n);
+  if      (px!=NULL){*px=value;}
   else{
     WriteWarning("CGauge::SetGaugeProperty: unrecognized gauge property "+prop_tag,false);
     return false;//bad string
@@ -27,6 +27,7 @@ public:/*-------------------------------------------------------*/
   //Accessors
   const global_struct *GetParams();
   double GetParameter     (const string param_name);
+  double *GetGlobalPropertyAddress(const string param_name);
   void   SetGlobalProperty(const string  &param_name, const double &value);
 
   //routines
@@ -35,6 +36,7 @@ public:/*-------------------------------------------------------*/
   void InitializeGlobalParameters (global_struct &G, bool is_template);
   void SetGlobalProperty          (global_struct &G, const string  param_name, const double value);
   double GetGlobalProperty        (const global_struct &G, string  param_name, const bool strict=true);
+  double *GetGlobalPropertyAddress(global_struct &G, const string param_name);
 
   double *GetAddress(const string param_name);
 
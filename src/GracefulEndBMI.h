@@ -27,6 +27,8 @@ void FinalizeGracefully(const char *statement, exitcode code)
 
   // error message is printed to the standard error stream
   if (code != RAVEN_OPEN_ERR) { //avoids recursion problems
+    if (code==BAD_DATA_WARN){FlushWarnings();}
+    else                    {CloseWarnings();}//writes warning summary
     if (code!=SIMULATION_DONE) { cerr << "ERROR : " << statement << endl;}
     else                       { cout << "SIMULATION COMPLETE :)" << endl;}
   }
@@ -42,7 +42,8 @@ inline void FinalizeGracefully(const char *statement, exitcode code)
   }
 
   if (code != RAVEN_OPEN_ERR) { //avoids recursion problems
-    WriteWarning("",false);//prints last warning in memory, if present
+    if (code==BAD_DATA_WARN){FlushWarnings();}
+    else                    {CloseWarnings();}//writes warning summary
     ofstream WARNINGS;
     WARNINGS.open((Options->main_output_dir+"Raven_errors.txt").c_str(),ios::app);
     if (WARNINGS.fail()) {
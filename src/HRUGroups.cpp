@@ -13,6 +13,7 @@ CHRUGroup::CHRUGroup(string tag, int global_ind)
 {
   _name=tag;
   _nHRUs=0;  _pHRUs=NULL;
+  _aMemberBits=NULL; _nMemberWords=0;
   _global_kk=global_ind;
   _disabled=false;
 }
@@ -24,6 +25,7 @@ CHRUGroup::CHRUGroup(string tag, int global_ind)
 CHRUGroup::~CHRUGroup()
 {
   delete [] _pHRUs; _pHRUs=NULL; //deletes pointers only
+  delete [] _aMemberBits; _aMemberBits=NULL;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -53,10 +55,8 @@ int    CHRUGroup::GetGlobalIndex       () const {return _global_kk;}
 //
 bool  CHRUGroup::IsInGroup          (const int k_global) const
 {
-  for (int k=0;k<_nHRUs; k++){
-    if (_pHRUs[k]->GetGlobalIndex()==k_global){return true;}
-  }
-  return false;
+  if ((k_global<0) || ((k_global>>5)>=_nMemberWords)){return false;}
+  return ((_aMemberBits[k_global>>5]>>(k_global&31)) & 1u)!=0;
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Returns HRU corresponding to index k in group
@@ -76,6 +76,22 @@ void CHRUGroup::AddHRU(CHydroUnit *pHRU)
 {
   if (!DynArrayAppend((void**&)(_pHRUs),(void*)(pHRU),_nHRUs)){
    ExitGracefully("CHRUGroup::AddHRU: adding NULL HRU",BAD_DATA);}
+
+  //update membership bitset, growing geometrically to cover global index
+  int k=pHRU->GetGlobalIndex();
+  if (k<0){return;}
+  if ((k>>5)>=_nMemberWords)
+  {
+    int nWords=max((k>>5)+1,2*_nMemberWords);
+    unsigned int *tmp=new unsigned int [nWords];
+    ExitGracefullyIf(tmp==NULL,"CHRUGroup::AddHRU",OUT_OF_MEMORY);
+    for (int w=0;w<_nMemberWords;w++){tmp[w]=_aMemberBits[w];}
+    for (int w=_nMemberWords;w<nWords;w++){tmp[w]=0;}
+    delete [] _aMemberBits;
+    _aMemberBits=tmp;
+    _nMemberWords=nWords;
+  }
+  _aMemberBits[k>>5]|=(1u<<(k&31));
 }
 //////////////////////////////////////////////////////////////////
 /// \brief initializes HRU Groups
@@ -103,6 +119,7 @@ void CHRUGroup::EmptyGroup()
 {
   _nHRUs=0;
   delete [] _pHRUs; _pHRUs=NULL; //deletes pointers only
+  for (int w=0;w<_nMemberWords;w++){_aMemberBits[w]=0;}
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Returns average value of a state variable specified by index i over the total area covered by the HRU group
@@ -282,6 +282,23 @@ void CHydroProcessABC::Redirect(const int toSVindex,const int newToSVindex)
   }
 }
 //////////////////////////////////////////////////////////////////
+/// \brief Checks data of conditional statements
+/// \details called serially before ShouldApply() is evaluated for all HRUs in parallel, so that any
+///  invalid HRU type is reported (or, in strict builds, ends the run) here rather than from a worker thread.
+///  Unrecognized types never match any HRU
+//
+void CHydroProcessABC::CheckConditions() const
+{
+  for (int i=0;i<_nConditions;i++)
+  {
+    if ((_pConditions[i]->basis==BASIS_HRU_TYPE) && (StringToHRUType(_pConditions[i]->data)==HRU_INVALID_TYPE))
+    {
+      string warn="CHydroProcessABC::CheckConditions: unrecognized HRU type code "+_pConditions[i]->data+" in :-->Conditional command";
+      WriteWarning(warn.c_str(),false);
+    }
+  }
+}
+//////////////////////////////////////////////////////////////////
 /// \brief Tests conditional statements to determine whether this specific process should be applied in this particular HRU
 /// \note based upon HRU type or other diagnostics
 /// \param *pHRU [in] Reference to pertinent HRU
@@ -82,6 +82,7 @@ public:/*-------------------------------------------------------*/
   virtual int          GetNumLatConnections() const { return 0; }
 
   bool                 ShouldApply(const CHydroUnit*pHRU) const;
+  void                 CheckConditions() const;
   //functions
   void                 SetModel(CModelABC *pM);/// \todo [reorg]: should really not be accessible
 
@@ -186,6 +186,9 @@ private:/*------------------------------------------------------*/
     int          _global_kk; ///< index of group in master HRU Group array (in CModel)
     bool          _disabled; ///< true if all HRUs in group are disabled
 
+    unsigned int *_aMemberBits; ///< membership bitset, bit k set if HRU with global index k is in group [size: _nMemberWords]
+    int         _nMemberWords; ///< number of 32-bit words in _aMemberBits
+
 public:/*-------------------------------------------------------*/
   //Constructors:
   CHRUGroup(string tag, int global_ind);
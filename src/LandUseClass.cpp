@@ -455,6 +455,109 @@ void  CLandUseClass::SetSurfaceProperty(const string &param_name,
   SetSurfaceProperty(S, param_name, value);
 }
 //////////////////////////////////////////////////////////////////
+/// \brief Returns address of the surface property corresponding to param_name
+/// \param param_name [in] Parameter identifier
+/// \return address of parameter, or NULL if param_name is not a single-valued surface property
+//
+double *CLandUseClass::GetSurfacePropertyAddress(const string &param_name)
+{
+  return GetSurfacePropertyAddress(S,param_name);
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Returns address of the surface property corresponding to param_name
+/// \param &S [in] Surface properties structure
+/// \param param_name [in] Parameter identifier
+/// \return address of parameter in S, or NULL if param_name is not a single-valued surface property
+//
+double *CLandUseClass::GetSurfacePropertyAddress(surface_struct &S,
+                                                 const string    param_name)
+{
+  string name = StringToUppercase(param_name);
+
+  if      (!name.compare("IMPERMEABLE_FRAC"       )){return &(S.impermeable_frac);}
+  else if (!name.compare("FOREST_COVERAGE"        )){return &(S.forest_coverage);}
+  else if (!name.compare("ROUGHNESS"              )){return &(S.roughness);}
+
+  else if (!name.compare("FOREST_SPARSENESS"      )){return &(S.forest_sparseness);}
+  else if (!name.compare("MELT_FACTOR"            )){return &(S.melt_factor);}
+  else if (!name.compare("MIN_MELT_FACTOR"        )){return &(S.min_melt_factor);}
+  else if (!name.compare("MAX_MELT_FACTOR"        )){return &(S.max_melt_factor);}
+  else if (!name.compare("DD_AGGRADATION"         )){return &(S.DD_aggradation);}
+  else if (!name.compare("DD_MELT_TEMP"           )){return &(S.DD_melt_temp);}
+  else if (!name.compare("REFREEZE_FACTOR"        )){return &(S.refreeze_factor);}
+  else if (!name.compare("DD_REFREEZE_TEMP"       )){return &(S.DD_refreeze_temp);}
+  else if (!name.compare("REFREEZE_EXP"           )){return &(S.refreeze_exp);}
+  else if (!name.compare("HBV_MELT_ASP_CORR"      )){return &(S.HBV_melt_asp_corr);}
+  else if (!name.compare("HBV_MELT_FOR_CORR"      )){return &(S.HBV_melt_for_corr);}
+  else if (!name.compare("MAX_SAT_AREA_FRAC"      )){return &(S.max_sat_area_frac);}
+  else if (!name.compare("HBV_MELT_GLACIER_CORR"  )){return &(S.HBV_melt_glacier_corr);}
+  else if (!name.compare("FIRN_MELT_CORR"         )){return &(S.firn_melt_corr);}
+  else if (!name.compare("FIRN_COMPACTION_RATE"   )){return &(S.firn_compaction_rate);}
+  else if (!name.compare("HBV_GLACIER_KMIN"       )){return &(S.HBV_glacier_Kmin);}
+  else if (!name.compare("GLAC_STORAGE_COEFF"     )){return &(S.glac_storage_coeff);}
+  else if (!name.compare("HBV_GLACIER_AG"         )){return &(S.HBV_glacier_Ag);}
+  else if (!name.compare("SNOW_PATCH_LIMIT"		    )){return &(S.snow_patch_limit);}
+  else if (!name.compare("CONV_MELT_MULT"		      )){return &(S.conv_melt_mult);}
+  else if (!name.compare("COND_MELT_MULT"		      )){return &(S.cond_melt_mult);}
+  else if (!name.compare("RAIN_MELT_MULT"		      )){return &(S.rain_melt_mult);}
+  else if (!name.compare("CC_DECAY_COEFF"         )){return &(S.CC_decay_coeff);}
+  else if (!name.compare("PARTITION_COEFF"        )){return &(S.partition_coeff);}
+  else if (!name.compare("SCS_CN"                 )){return &(S.SCS_CN);}
+  else if (!name.compare("SCS_IA_FRACTION"        )){return &(S.SCS_Ia_fraction);}
+  else if (!name.compare("DEP_MAX"                )){return &(S.dep_max);}
+  else if (!name.compare("DEP_MAX_FLOW"           )){return &(S.dep_max_flow);}
+  else if (!name.compare("DEP_N"                  )){return &(S.dep_n);}
+  else if (!name.compare("DEP_THRESHOLD"          )){return &(S.dep_threshold);}
+  else if (!name.compare("DEP_CRESTRATIO"         )){return &(S.dep_crestratio);}
+  else if (!name.compare("PDMROF_B"               )){return &(S.PDMROF_b);}
+  else if (!name.compare("PDM_B"                  )){return &(S.PDM_b);}
+  else if (!name.compare("HYMOD2_G"               )){return &(S.HYMOD2_G);}
+  else if (!name.compare("HYMOD2_KMAX"            )){return &(S.HYMOD2_Kmax);}
+  else if (!name.compare("HYMOD2_EXP"             )){return &(S.HYMOD2_exp);}
+  else if (!name.compare("MAX_DEP_AREA_FRAC"      )){return &(S.max_dep_area_frac);}
+  else if (!name.compare("PONDED_EXP"             )){return &(S.ponded_exp);}
+  else if (!name.compare("UWFS_B"                 )){return &(S.uwfs_b);}
+  else if (!name.compare("UWFS_BETAMIN"           )){return &(S.uwfs_betamin);}
+  else if (!name.compare("BF_LOSS_FRACTION"       )){return &(S.bf_loss_fraction);}
+  else if (!name.compare("AWBM_AREAFRAC1"         )){return &(S.AWBM_areafrac1);}
+  else if (!name.compare("AWBM_AREAFRAC2"         )){return &(S.AWBM_areafrac2);}
+  else if (!name.compare("AWBM_BFLOW_INDEX"       )){return &(S.AWBM_bflow_index);}
+  else if (!name.compare("DIVERT_FRACT"           )){return &(S.divert_fract);}
+  else if (!name.compare("LAKE_REL_COEFF"         )){return &(S.lake_rel_coeff);}
+  else if (!name.compare("DEP_K"                  )){return &(S.dep_k);}
+  else if (!name.compare("DEP_SEEP_K"             )){return &(S.dep_seep_k);}
+  else if (!name.compare("ABST_PERCENT"           )){return &(S.abst_percent);}
+  else if (!name.compare("OW_PET_CORR"            )){return &(S.ow_PET_corr);}
+  else if (!name.compare("LAKE_PET_CORR"          )){return &(S.lake_PET_corr);}
+  else if (!name.compare("FOREST_PET_CORR"        )){return &(S.forest_PET_corr);}
+  else if (!name.compare("PRIESTLEYTAYLOR_COEFF"  )){return &(S.priestleytaylor_coeff);}
+  else if (!name.compare("PET_LIN_COEFF"          )){return &(S.pet_lin_coeff);}
+  else if (!name.compare("PET_VAP_COEFF"          )){return &(S.pet_vap_coeff);}
+  else if (!name.compare("RELHUM_CORR"            )){return &(S.relhum_corr);}
+  else if (!name.compare("WINDVEL_CORR"           )){return &(S.wind_vel_corr);}
+  else if (!name.compare("WIND_VEL_CORR"          )){return &(S.wind_vel_corr);}
+  else if (!name.compare("GR4J_X4"                )){return &(S.GR4J_x4);}
+  else if (!name.compare("UBC_ICEPT_FACTOR"       )){return &(S.UBC_icept_factor);}
+  else if (!name.compare("WIND_EXPOSURE"          )){return &(S.wind_exposure);}
+  else if (!name.compare("FETCH"                  )){return &(S.fetch);}
+  else if (!name.compare("AET_COEFF"              )){return &(S.AET_coeff);}
+  else if (!name.compare("GAMMA_SCALE"            )){return &(S.gamma_scale);}
+  else if (!name.compare("GAMMA_SHAPE"            )){return &(S.gamma_shape);}
+  else if (!name.compare("GAMMA_SCALE2"           )){return &(S.gamma_scale2);}
+  else if (!name.compare("GAMMA_SHAPE2"           )){return &(S.gamma_shape2);}
+  else if (!name.compare("HMETS_RUNOFF_COEFF"     )){return &(S.HMETS_runoff_coeff);}
+  else if (!name.compare("BSNOW_DISTRIB"          )){return &(S.bsnow_distrib);}
+  else if (!name.compare("LAKESNOW_BUFFER_HT"     )){return &(S.lakesnow_buffer_ht);}
+  else if (!name.compare("SKY_VIEW_FACTOR"        )){return &(S.sky_view_factor);}
+  else if (!name.compare("CONVECTION_COEFF"       )){return &(S.convection_coeff);}
+  else if (!name.compare("GEOTHERMAL_GRAD"        )){return &(S.geothermal_grad);}
+  else if (!name.compare("MIN_WIND_SPEED"         )){return &(S.min_wind_speed);}
+  else if (!name.compare("MAX_WIND_SPEED"         )){return &(S.max_wind_speed);}
+  else if (!name.compare("STREAM_FRACTION"        )){return &(S.stream_fraction);}
+
+  return NULL;
+}
+//////////////////////////////////////////////////////////////////
 /// \brief Sets the value of the surface property corresponding to param_name
 /// \param &S [out] Surface properties class
 /// \param param_name [in] Parameter identifier
@@ -471,86 +574,8 @@ void  CLandUseClass::SetSurfaceProperty(surface_struct &S,
      if (!name.compare(S.params[i].name)){S.params[i].value=value;}
   }*/ // \todo[funct] - PARAMETEROVERHAUL (replaces below)
 
-  if      (!name.compare("IMPERMEABLE_FRAC"       )){S.impermeable_frac=value;}
-  else if (!name.compare("FOREST_COVERAGE"        )){S.forest_coverage=value;}
-  else if (!name.compare("ROUGHNESS"              )){S.roughness=value;}
-
-  else if (!name.compare("FOREST_SPARSENESS"      )){S.forest_sparseness=value;}
-  else if (!name.compare("MELT_FACTOR"            )){S.melt_factor=value;}
-  else if (!name.compare("MIN_MELT_FACTOR"        )){S.min_melt_factor=value;}
-  else if (!name.compare("MAX_MELT_FACTOR"        )){S.max_melt_factor=value;}
-  else if (!name.compare("DD_AGGRADATION"         )){S.DD_aggradation=value;}
-  else if (!name.compare("DD_MELT_TEMP"           )){S.DD_melt_temp=value;}
-  else if (!name.compare("REFREEZE_FACTOR"        )){S.refreeze_factor=value;}
-  else if (!name.compare("DD_REFREEZE_TEMP"       )){S.DD_refreeze_temp=value; }
-  else if (!name.compare("REFREEZE_EXP"           )){S.refreeze_exp=value; }
-  else if (!name.compare("HBV_MELT_ASP_CORR"      )){S.HBV_melt_asp_corr=value;}
-  else if (!name.compare("HBV_MELT_FOR_CORR"      )){S.HBV_melt_for_corr=value;}
-  else if (!name.compare("MAX_SAT_AREA_FRAC"      )){S.max_sat_area_frac=value;}
-  else if (!name.compare("HBV_MELT_GLACIER_CORR"  )){S.HBV_melt_glacier_corr=value;}
-  else if (!name.compare("FIRN_MELT_CORR"         )){S.firn_melt_corr=value;}
-  else if (!name.compare("FIRN_COMPACTION_RATE"   )){S.firn_compaction_rate=value;}
-  else if (!name.compare("HBV_GLACIER_KMIN"       )){S.HBV_glacier_Kmin=value;}
-  else if (!name.compare("GLAC_STORAGE_COEFF"     )){S.glac_storage_coeff=value;}
-  else if (!name.compare("HBV_GLACIER_AG"         )){S.HBV_glacier_Ag=value;}
-  else if (!name.compare("SNOW_PATCH_LIMIT"		    )){S.snow_patch_limit=value;}
-  else if (!name.compare("CONV_MELT_MULT"		      )){S.conv_melt_mult=value;}
-  else if (!name.compare("COND_MELT_MULT"		      )){S.cond_melt_mult=value;}
-  else if (!name.compare("RAIN_MELT_MULT"		      )){S.rain_melt_mult=value;}
-  else if (!name.compare("CC_DECAY_COEFF"         )){S.CC_decay_coeff=value;}
-  else if (!name.compare("PARTITION_COEFF"        )){S.partition_coeff=value;}
-  else if (!name.compare("SCS_CN"                 )){S.SCS_CN=value;}
-  else if (!name.compare("SCS_IA_FRACTION"        )){S.SCS_Ia_fraction=value;}
-  else if (!name.compare("DEP_MAX"                )){S.dep_max =value;}
-  else if (!name.compare("DEP_MAX_FLOW"           )){S.dep_max_flow =value;}
-  else if (!name.compare("DEP_N"                  )){S.dep_n =value;}
-  else if (!name.compare("DEP_THRESHOLD"          )){S.dep_threshold =value;}
-  else if (!name.compare("DEP_CRESTRATIO"         )){S.dep_crestratio =value;}
-  else if (!name.compare("PDMROF_B"               )){S.PDMROF_b =value; }
-  else if (!name.compare("PDM_B"                  )){S.PDM_b =value; }
-  else if (!name.compare("HYMOD2_G"               )){S.HYMOD2_G =value; }
-  else if (!name.compare("HYMOD2_KMAX"            )){S.HYMOD2_Kmax =value; }
-  else if (!name.compare("HYMOD2_EXP"             )){S.HYMOD2_exp =value; }
-  else if (!name.compare("MAX_DEP_AREA_FRAC"      )){S.max_dep_area_frac =value; }
-  else if (!name.compare("PONDED_EXP"             )){S.ponded_exp =value; }
-  else if (!name.compare("UWFS_B"                 )){S.uwfs_b =value; }
-  else if (!name.compare("UWFS_BETAMIN"           )){S.uwfs_betamin =value; }
-  else if (!name.compare("BF_LOSS_FRACTION"       )){S.bf_loss_fraction =value; }
-  else if (!name.compare("AWBM_AREAFRAC1"         )){S.AWBM_areafrac1 =value; }
-  else if (!name.compare("AWBM_AREAFRAC2"         )){S.AWBM_areafrac2 =value; }
-  else if (!name.compare("AWBM_BFLOW_INDEX"       )){S.AWBM_bflow_index =value; }
-  else if (!name.compare("DIVERT_FRACT"           )){S.divert_fract =value; }
-  else if (!name.compare("LAKE_REL_COEFF"         )){S.lake_rel_coeff =value;}
-  else if (!name.compare("DEP_K"                  )){S.dep_k =value;}
-  else if (!name.compare("DEP_SEEP_K"             )){S.dep_seep_k =value;}
-  else if (!name.compare("ABST_PERCENT"           )){S.abst_percent =value;}
-  else if (!name.compare("OW_PET_CORR"            )){S.ow_PET_corr=value;}
-  else if (!name.compare("LAKE_PET_CORR"          )){S.lake_PET_corr=value;}
-  else if (!name.compare("FOREST_PET_CORR"        )){S.forest_PET_corr=value;}
-  else if (!name.compare("PRIESTLEYTAYLOR_COEFF"  )){S.priestleytaylor_coeff=value;}
-  else if (!name.compare("PET_LIN_COEFF"          )){S.pet_lin_coeff=value;}
-  else if (!name.compare("PET_VAP_COEFF"          )){S.pet_vap_coeff=value;}
-  else if (!name.compare("RELHUM_CORR"            )){S.relhum_corr=value;}
-  else if (!name.compare("WINDVEL_CORR"           )){S.wind_vel_corr=value;}
-  else if (!name.compare("WIND_VEL_CORR"          )){S.wind_vel_corr=value;}
-  else if (!name.compare("GR4J_X4"                )){S.GR4J_x4=value;}
-  else if (!name.compare("UBC_ICEPT_FACTOR"       )){S.UBC_icept_factor=value;}
-  else if (!name.compare("WIND_EXPOSURE"          )){S.wind_exposure=value;}
-  else if (!name.compare("FETCH"                  )){S.fetch=value;}
-  else if (!name.compare("AET_COEFF"              )){S.AET_coeff=value;}
-  else if (!name.compare("GAMMA_SCALE"            )){S.gamma_scale=value;}
-  else if (!name.compare("GAMMA_SHAPE"            )){S.gamma_shape=value;}
-  else if (!name.compare("GAMMA_SCALE2"           )){S.gamma_scale2=value;}
-  else if (!name.compare("GAMMA_SHAPE2"           )){S.gamma_shape2=value;}
-  else if (!name.compare("HMETS_RUNOFF_COEFF"     )){S.HMETS_runoff_coeff=value; }
-  else if (!name.compare("BSNOW_DISTRIB"          )){S.bsnow_distrib=value;}
-  else if (!name.compare("LAKESNOW_BUFFER_HT"     )){S.lakesnow_buffer_ht=value;}
-  else if (!name.compare("SKY_VIEW_FACTOR"        )){S.sky_view_factor=value;}
-  else if (!name.compare("CONVECTION_COEFF"       )){S.convection_coeff=value;}
-  else if (!name.compare("GEOTHERMAL_GRAD"        )){S.geothermal_grad=value;}
-  else if (!name.compare("MIN_WIND_SPEED"         )){S.min_wind_speed=value;}
-  else if (!name.compare("MAX_WIND_SPEED"         )){S.max_wind_speed=value;}
-  else if (!name.compare("STREAM_FRACTION"        )){S.stream_fraction=value;}
+  double *px=GetSurfacePropertyAddress(S,name);
+  if      (px!=NULL){*px=value;}
   else{
     WriteWarning("Trying to set value of unrecognized/invalid land use/land type parameter "+ name,false);
   }
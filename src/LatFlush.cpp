@@ -62,6 +62,7 @@ void CmvLatFlush::Initialize()
   CHRUGroup *toHRUGrp  =_pModel->GetHRUGroup(_kk_to);
   _aFrac=NULL;
 
+  //two passes: first counts connections, second fills connection arrays
   q=0;
   if(_constrain_to_SBs)
   {
@@ -69,49 +70,55 @@ void CmvLatFlush::Initialize()
     int k1,k2;
     int nRecipients;
     double Asum,area;
-    for(int p=0;p<_pModel->GetNumSubBasins();p++)
+    for (int pass=0;pass<2;pass++)
     {
-      if (_pModel->GetSubBasin(p)->IsEnabled()) {
-
-        for(int ks=0; ks<_pModel->GetSubBasin(p)->GetNumHRUs(); ks++) //sources
-        {
-          k1=_pModel->GetSubBasin(p)->GetHRU(ks)->GetGlobalIndex();
-          Asum=0.0;
-          nRecipients=0;
-          if (fromHRUGrp->IsInGroup(k1)) {
-
-            for(int ks2=0; ks2<_pModel->GetSubBasin(p)->GetNumHRUs(); ks2++) //recipients
-            {
-              k2=_pModel->GetSubBasin(p)->GetHRU(ks2)->GetGlobalIndex();
-
-              if (toHRUGrp->IsInGroup(k2))
+      if (pass==1){
+        kTo   =new int   [q]; ExitGracefullyIf(kTo   == NULL, "LatFLush::Initialize (1a)",OUT_OF_MEMORY);
+        kFrom =new int   [q]; ExitGracefullyIf(kFrom == NULL, "LatFLush::Initialize (1b)",OUT_OF_MEMORY);
+        _aFrac=new double[q]; ExitGracefullyIf(_aFrac== NULL, "LatFLush::Initialize (1c)",OUT_OF_MEMORY);
+        q=0;
+      }
+      for(int p=0;p<_pModel->GetNumSubBasins();p++)
+      {
+        if (_pModel->GetSubBasin(p)->IsEnabled()) {
+
+          for(int ks=0; ks<_pModel->GetSubBasin(p)->GetNumHRUs(); ks++) //sources
+          {
+            k1=_pModel->GetSubBasin(p)->GetHRU(ks)->GetGlobalIndex();
+            Asum=0.0;
+            nRecipients=0;
+            if (fromHRUGrp->IsInGroup(k1)) {
+
+              for(int ks2=0; ks2<_pModel->GetSubBasin(p)->GetNumHRUs(); ks2++) //recipients
               {
-                if (k1!=k2)
+                k2=_pModel->GetSubBasin(p)->GetHRU(ks2)->GetGlobalIndex();
+
+                if (toHRUGrp->IsInGroup(k2))
                 {
-                  //dynamically allocate memory
-                  int    *tmpT=new int    [q+1]; for (int i=0;i<q;i++){tmpT[i]= kTo  [i];}delete [] kTo;    kTo  =tmpT; ExitGracefullyIf(kTo   == NULL, "LatFLush::Initialize (1a)",OUT_OF_MEMORY);
-                  int    *tmpF=new int    [q+1]; for (int i=0;i<q;i++){tmpF[i]= kFrom[i];}delete [] kFrom;  kFrom=tmpF; ExitGracefullyIf(kFrom == NULL, "LatFLush::Initialize (1b)",OUT_OF_MEMORY);
-                  double *tmpA=new double [q+1]; for (int i=0;i<q;i++){tmpA[i]=_aFrac[i];}delete [] _aFrac;_aFrac=tmpA; ExitGracefullyIf(_aFrac== NULL, "LatFLush::Initialize (1c)",OUT_OF_MEMORY);
-                  area=_pModel->GetSubBasin(p)->GetHRU(ks2)->GetArea();
-                  kFrom [q]=k1;
-                  kTo   [q]=k2;
-                  _aFrac[q]=area;
-                  Asum+=area;//sum of recipient areas
-                  nRecipients++;
-
-                  //cout << "ADDING CONNECTION " << q << " in subbasin "<< _pModel->GetSubBasin(p)->GetName() << ": "
-                  //     << _pModel->GetHydroUnit(kFrom[q])->GetHRUID()  << " To " <<_pModel->GetHydroUnit(kTo[q])->GetHRUID() <<" "<<_aFrac[q]<<endl;
-                  q++;
-                }
-                else {
-                  source_sink_issue=true;//throw warning if source is also sink
+                  if (k1!=k2)
+                  {
+                    if (pass==1){
+                      area=_pModel->GetSubBasin(p)->GetHRU(ks2)->GetArea();
+                      kFrom [q]=k1;
+                      kTo   [q]=k2;
+                      _aFrac[q]=area;
+                      Asum+=area;//sum of recipient areas
+                      nRecipients++;
+                    }
+                    //cout << "ADDING CONNECTION " << q << " in subbasin "<< _pModel->GetSubBasin(p)->GetName() << ": "
+                    //     << _pModel->GetHydroUnit(kFrom[q])->GetHRUID()  << " To " <<_pModel->GetHydroUnit(kTo[q])->GetHRUID() <<" "<<_aFrac[q]<<endl;
+                    q++;
+                  }
+                  else {
+                    source_sink_issue=true;//throw warning if source is also sink
+                  }
                 }
               }
             }
-          }
-          for (int qq = 0; qq < nRecipients; qq++) {//once sum is known for each source, calculate fraction
-            //cout << "AFRAC INDEX: "<<q-qq-1<<endl;
-            _aFrac[q-qq-1]=_aFrac[q-qq-1]/Asum;
+            for (int qq = 0; qq < nRecipients; qq++) {//once sum is known for each source, calculate fraction
+              //cout << "AFRAC INDEX: "<<q-qq-1<<endl;
+              _aFrac[q-qq-1]=_aFrac[q-qq-1]/Asum;
+            }
           }
         }
       }
@@ -138,19 +145,25 @@ void CmvLatFlush::Initialize()
         kToSB=k;
       }
     }
-      //find 'from' HRUs to make connections
-    for(k=0;k<_pModel->GetNumHRUs();k++)
+    for (int pass=0;pass<2;pass++)
     {
-      if (fromHRUGrp->IsInGroup(k) && (kToSB!=DOESNT_EXIST) && _pModel->GetHydroUnit(k)->IsEnabled()) {
-        //dynamically allocate memory
-        int    *tmpT=new int    [q+1]; for (int i=0;i<q;i++){tmpT[i]= kTo  [i];}delete [] kTo;    kTo  =tmpT; ExitGracefullyIf(kTo   == NULL, "LatFLush::Initialize (1a)",OUT_OF_MEMORY);
-        int    *tmpF=new int    [q+1]; for (int i=0;i<q;i++){tmpF[i]= kFrom[i];}delete [] kFrom;  kFrom=tmpF; ExitGracefullyIf(kFrom == NULL, "LatFLush::Initialize (1b)",OUT_OF_MEMORY);
-        double *tmpA=new double [q+1]; for (int i=0;i<q;i++){tmpA[i]=_aFrac[i];}delete [] _aFrac;_aFrac=tmpA; ExitGracefullyIf(_aFrac== NULL, "LatFLush::Initialize (1c)",OUT_OF_MEMORY);
-
-        kFrom [q]=k;
-        kTo   [q]=kToSB;
-        _aFrac[q]=1.0; //only a single recipient
-        q++;
+      if (pass==1){
+        kTo   =new int   [q]; ExitGracefullyIf(kTo   == NULL, "LatFLush::Initialize (1a)",OUT_OF_MEMORY);
+        kFrom =new int   [q]; ExitGracefullyIf(kFrom == NULL, "LatFLush::Initialize (1b)",OUT_OF_MEMORY);
+        _aFrac=new double[q]; ExitGracefullyIf(_aFrac== NULL, "LatFLush::Initialize (1c)",OUT_OF_MEMORY);
+        q=0;
+      }
+      //find 'from' HRUs to make connections
+      for(k=0;k<_pModel->GetNumHRUs();k++)
+      {
+        if (fromHRUGrp->IsInGroup(k) && (kToSB!=DOESNT_EXIST) && _pModel->GetHydroUnit(k)->IsEnabled()) {
+          if (pass==1){
+            kFrom [q]=k;
+            kTo   [q]=kToSB;
+            _aFrac[q]=1.0; //only a single recipient
+          }
+          q++;
+        }
       }
     }
     nConn=q;
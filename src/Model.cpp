@@ -29,15 +29,18 @@ CModel::CModel(const int        nsoillayers,
   _nGauges=0;         _pGauges=NULL;
   _nForcingGrids=0;   _pForcingGrids=NULL;
   _nProcesses=0;      _pProcesses=NULL;
-  _nCustomOutputs=0;  _pCustomOutputs=NULL;
+  _nCustomOutputs=0;  _pCustomOutputs=NULL; _pCustomAgg=NULL;
   _nTransParams=0;    _pTransParams=NULL;
   _nClassChanges=0;   _pClassChanges=NULL;
   _nParamOverrides=0; _pParamOverrides=NULL;
   _nStateVarOverrides=0;_pStateVarOverrides=NULL;
-  _nObservedTS=0;     _pObservedTS=NULL; _pModeledTS=NULL; _aObsIndex=NULL;
+  _nObservedTS=0;     _pObservedTS=NULL; _pModeledTS=NULL; _aObsIndex=NULL; _aObsBindings=NULL;
   _nObsWeightTS =0;   _pObsWeightTS=NULL;
   _nDiagnostics=0;    _pDiagnostics=NULL;
-  _nDiagPeriods=0;    _pDiagPeriods=NULL;
+  _nDiagPeriods=0;    _pDiagPeriods=NULL;   _aDiagAccums=NULL;
+  _objbound_SBID=DOESNT_EXIST; _objbound_diag=DIAG_NASH_SUTCLIFFE; _objbound_period="ALL"; _objbound=ALMOST_INF;
+  _objbound_ind[0]=_objbound_ind[1]=_objbound_ind[2]=DOESNT_EXIST;
+  _terminated_early=false;
   _nAggDiagnostics=0; _pAggDiagnostics=NULL;
   _nPerturbations=0;  _pPerturbations=NULL;
 
@@ -117,9 +120,10 @@ CModel::CModel(const int        nsoillayers,
   }
   _lake_sv=0; //by default, rain on lake goes direct to surface storage [0]
 
-  _aGaugeWeights    =NULL; //Initialized in Initialize
-  _aGaugeWtTemp     =NULL;
-  _aGaugeWtPrecip   =NULL;
+  //_GaugeWts, _GaugeWtsTemp, _GaugeWtsPrecip initialized in Initialize
+  _nSolarClasses    =0;    //Initialized in Initialize
+  _aSolarClasses    =NULL;
+  _aSolarClassIndex =NULL;
   _aCumulativeBal   =NULL;
   _aFlowBal         =NULL;
   _aCumulativeLatBal=NULL;
@@ -128,11 +132,23 @@ CModel::CModel(const int        nsoillayers,
   _CumulOutput      =0.0;
   _initWater        =0.0;
 
+  _reductions_valid =false;
+  _nAvgStateVars    =0;
+  _aAvgStateVars    =NULL;
+  _avg_precip       =0.0;
+  _avg_snowfall     =0.0;
+  _tot_channel_stor =0.0;
+  _tot_res_stor     =0.0;
+  _tot_rivulet_stor =0.0;
+  ZeroOutForcings(_aveForcings);
+
   _UTM_zone=-1;
 
   _nOutputTimes=0;   _aOutputTimes=NULL;
   _currOutputTimeInd=0;
   _pOutputGroup=NULL;
+  _aOutputHRUs=NULL;      _nOutputHRUs=0;
+  _aOutputSubBasins=NULL; _nOutputSubBasins=0;
 
   _aShouldApplyProcess=NULL; //Initialized in Initialize
 
@@ -164,6 +180,13 @@ CModel::~CModel()
   for (f=0;f<_nForcingGrids; f++){delete _pForcingGrids [f];} delete [] _pForcingGrids; _pForcingGrids=NULL;
   for (j=0;j<_nProcesses;    j++){delete _pProcesses    [j];} delete [] _pProcesses;    _pProcesses=NULL;
   for (c=0;c<_nCustomOutputs;c++){delete _pCustomOutputs[c];} delete [] _pCustomOutputs;_pCustomOutputs=NULL;
+  delete _pCustomAgg; _pCustomAgg=NULL;
+  delete [] _aAvgStateVars; _aAvgStateVars=NULL;
+  delete [] _aOutputHRUs;      _aOutputHRUs=NULL;
+  delete [] _aOutputSubBasins; _aOutputSubBasins=NULL;
+  if (_aDiagAccums != NULL){
+    for (i = 0; i < _nObservedTS; i++){ delete [] _aDiagAccums[i]; } delete [] _aDiagAccums; _aDiagAccums = NULL;
+  }
   for (i=0;i<_nObservedTS;   i++){delete _pObservedTS   [i];} delete [] _pObservedTS;   _pObservedTS=NULL;
   if (_pModeledTS != NULL){
     for (i = 0; i < _nObservedTS; i++){ delete _pModeledTS[i]; } delete[] _pModeledTS;    _pModeledTS = NULL;
@@ -181,15 +204,11 @@ CModel::~CModel()
   }
   if (_aCumulativeLatBal!=NULL){delete [] _aCumulativeLatBal; _aCumulativeLatBal=NULL;}
   if (_aFlowLatBal      !=NULL){delete [] _aFlowLatBal;       _aFlowLatBal=NULL;}
-  if (_aGaugeWeights!=NULL){
-    for (k=0;k<_nHydroUnits;   k++){delete [] _aGaugeWeights[k]; } delete [] _aGaugeWeights;  _aGaugeWeights=NULL;
-  }
-  if (_aGaugeWtPrecip!=NULL){
-    for (k=0;k<_nHydroUnits;   k++){delete [] _aGaugeWtPrecip[k]; } delete [] _aGaugeWtPrecip;  _aGaugeWtPrecip=NULL;
-  }
-  if (_aGaugeWtTemp!=NULL){
-    for (k=0;k<_nHydroUnits;   k++){delete [] _aGaugeWtTemp[k]; } delete [] _aGaugeWtTemp;  _aGaugeWtTemp=NULL;
-  }
+  _GaugeWts.Clear();
+  _GaugeWtsPrecip.Clear();
+  _GaugeWtsTemp.Clear();
+  delete [] _aSolarClasses;    _aSolarClasses=NULL;
+  delete [] _aSolarClassIndex; _aSolarClassIndex=NULL;
   if (_aShouldApplyProcess!=NULL){
     for (k=0;k<_nProcesses;   k++){delete [] _aShouldApplyProcess[k]; } delete [] _aShouldApplyProcess;  _aShouldApplyProcess=NULL;
   }
@@ -213,6 +232,7 @@ CModel::~CModel()
   delete [] _aDownstreamInds;_aDownstreamInds=NULL;
   delete [] _aOutputTimes;   _aOutputTimes=NULL;
   delete [] _aObsIndex;      _aObsIndex=NULL;
+  delete [] _aObsBindings;   _aObsBindings=NULL;
 
   delete [] _aDAQadjust;     _aDAQadjust=NULL;
   delete [] _aDADrainSum;    _aDADrainSum=NULL;
@@ -314,6 +334,68 @@ int CModel::GetNumProcesses   () const{return _nProcesses;}
 //
 double CModel::GetWatershedArea () const{return _WatershedArea;}
 
+//////////////////////////////////////////////////////////////////
+/// \brief Returns number of HRUs for which HRU-based output is written
+/// \return number of HRUs selected for output (all HRUs if no selection was made)
+//
+int CModel::GetNumOutputHRUs() const
+{
+  if (_aOutputHRUs==NULL){return _nHydroUnits;}
+  return _nOutputHRUs;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns global index of i-th HRU selected for output
+/// \param i [in] index in output selection (0..GetNumOutputHRUs()-1)
+/// \return global HRU index k
+//
+int CModel::GetOutputHRUIndex(const int i) const
+{
+  if (_aOutputHRUs==NULL){return i;}
+  return _aOutputHRUs[i];
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns true if HRU-based output is written for HRU k
+/// \param k [in] global HRU index
+//
+bool CModel::IsOutputHRU(const int k) const
+{
+  if (_aOutputHRUs==NULL){return true;}
+  return binary_search(_aOutputHRUs,_aOutputHRUs+_nOutputHRUs,k);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns number of subbasins for which subbasin-based output is written
+/// \return number of subbasins selected for output (all subbasins if no selection was made)
+//
+int CModel::GetNumOutputSubBasins() const
+{
+  if (_aOutputSubBasins==NULL){return _nSubBasins;}
+  return _nOutputSubBasins;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns global index of i-th subbasin selected for output
+/// \param i [in] index in output selection (0..GetNumOutputSubBasins()-1)
+/// \return global subbasin index p
+//
+int CModel::GetOutputSubBasinIndex(const int i) const
+{
+  if (_aOutputSubBasins==NULL){return i;}
+  return _aOutputSubBasins[i];
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns true if subbasin-based output is written for subbasin p
+/// \param p [in] global subbasin index
+//
+bool CModel::IsOutputSubBasin(const int p) const
+{
+  if (_aOutputSubBasins==NULL){return true;}
+  return binary_search(_aOutputSubBasins,_aOutputSubBasins+_nOutputSubBasins,p);
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Returns number of observation time series
 /// \return number of observation time series
@@ -350,12 +432,42 @@ double CModel::GetObservedFlow(const int p, const int n) const
 //////////////////////////////////////////////////////////////////
 /// \brief Returns simulated equivalent of observation time series i
 /// \param i [in] index of observation time series
-/// \return pointer to simulated equivalent of observation time series i
+/// \return pointer to simulated equivalent of observation time series i (NULL if not stored)
 //
 const CTimeSeriesABC* CModel::GetSimulatedTS(const int i) const {
   return _pModeledTS[i];
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief Returns diagnostic j of observation time series i over diagnostic period d, for the time steps simulated so far
+/// \details computed from running sums updated in UpdateDiagnostics; only valid for streamable diagnostics
+/// (CDiagnostic::IsStreamable)
+/// \param i [in] index of observation time series
+/// \param d [in] index of diagnostic period
+/// \param j [in] index of diagnostic
+//
+double CModel::GetRunningDiagnostic(const int i, const int d, const int j) const
+{
+  if (_aDiagAccums==NULL){return 0.0;}
+  return _pDiagnostics[j]->CalculateFromAccum(_aDiagAccums[i][d]);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns diagnostic j of observation time series i over diagnostic period d
+/// \details calculated from stored modeled series where available, otherwise from running sums
+/// \param i [in] index of observation time series
+/// \param d [in] index of diagnostic period
+/// \param j [in] index of diagnostic
+/// \param &Options [in] global model options
+//
+double CModel::EvaluateDiagnostic(const int i, const int d, const int j, const optStruct &Options) const
+{
+  if (_pModeledTS[i]==NULL){return GetRunningDiagnostic(i,d,j);}
+  return _pDiagnostics[j]->CalculateDiagnostic(_pModeledTS[i],_pObservedTS[i],_pObsWeightTS[i],
+                                               _pDiagPeriods[d]->GetStartTime(),_pDiagPeriods[d]->GetEndTime(),
+                                               _pDiagPeriods[d]->GetComparison(),_pDiagPeriods[d]->GetThreshold(),Options);
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Returns specific hydrologic process denoted by parameter
 /// \param j [in] Process index
@@ -418,14 +530,9 @@ CHydroUnit *CModel::GetHydroUnit(const int k) const
 //
 CHydroUnit *CModel::GetHRUByID(const long long int HRUID) const
 {
-  static int last_k=0;
-  //smart find
-  int k;
-  for (int i=0;i<_nHydroUnits;i++){
-    k=NearSearchIndex(i,last_k,_nHydroUnits);
-    if (HRUID==_pHydroUnits[k]->GetHRUID()){ last_k=k; return _pHydroUnits[k];}
-  }
-  return NULL;
+  unordered_map<long long,int>::const_iterator it=_HRUIndexByID.find(HRUID);
+  if (it==_HRUIndexByID.end()){return NULL;}
+  return _pHydroUnits[it->second];
 }
 
 //////////////////////////////////////////////////////////////////
@@ -468,12 +575,7 @@ bool CModel::IsInHRUGroup(const int k, const string HRUGroupName) const
   pGrp=GetHRUGroup(HRUGroupName);
   if (pGrp == NULL){ return false; }//throw warning?
 
-  int kk = pGrp->GetGlobalIndex();
-  for (int k_loc=0; k_loc<_pHRUGroups[kk]->GetNumHRUs(); k_loc++)
-  {
-    if (_pHRUGroups[kk]->GetHRU(k_loc)->GetGlobalIndex()==k){return true;}
-  }
-  return false;
+  return pGrp->IsInGroup(k);
 }
 
 //////////////////////////////////////////////////////////////////
@@ -510,15 +612,10 @@ int         CModel::GetDownstreamBasin(const int p) const
 //
 CSubBasin  *CModel::GetSubBasinByID(const long long SBID) const
 {
-  static int last_p=0;
-  int p;
   if (SBID < 0) { return NULL; }
-  //smart find
-  for (int i=0;i<_nSubBasins;i++){
-    p = NearSearchIndex(i, last_p, _nSubBasins);
-    if (_pSubBasins[p]->GetID()==SBID){last_p=p; return _pSubBasins[p];}
-  }
-  return NULL;
+  unordered_map<long long,int>::const_iterator it=_SBIndexByID.find(SBID);
+  if (it==_SBIndexByID.end()){return NULL;}
+  return _pSubBasins[it->second];
 }
 
 //////////////////////////////////////////////////////////////////
@@ -528,15 +625,10 @@ CSubBasin  *CModel::GetSubBasinByID(const long long SBID) const
 //
 int         CModel::GetSubBasinIndex(const long long SBID) const
 {
-  static int last_p = 0;
-  int p;
   if (SBID<0){return DOESNT_EXIST;}
-  //smart find
-  for (int i = 0; i < _nSubBasins; i++) {
-    p = NearSearchIndex(i, last_p, _nSubBasins);
-    if (_pSubBasins[p]->GetID() == SBID) { last_p = p; return p; }
-  }
-  return INDEX_NOT_FOUND;
+  unordered_map<long long,int>::const_iterator it=_SBIndexByID.find(SBID);
+  if (it==_SBIndexByID.end()){return INDEX_NOT_FOUND;}
+  return it->second;
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Returns array of pointers to subbasins upstream of subbasin SBID, including that subbasin
@@ -834,10 +926,9 @@ int         CModel::GetLakeStorageIndex() const{return _lake_sv;}
 //
 int  CModel::GetGaugeIndexFromName (const string name) const
 {
-  for (int g=0;g<_nGauges;g++){
-    if (name==_pGauges[g]->GetName()){return g;}
-  }
-  return DOESNT_EXIST;
+  unordered_map<string,int>::const_iterator it=_GaugeIndexByName.find(name);
+  if (it==_GaugeIndexByName.end()){return DOESNT_EXIST;}
+  return it->second;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -1047,6 +1138,7 @@ CDemandOptimizer  *CModel::GetManagementOptimizer() const { return _pDO; }
 //
 double CModel::GetAveragePrecip() const
 {
+  if (_reductions_valid){return _avg_precip;}
   double sum(0);
   for (int k=0;k<_nHydroUnits;k++)
   {
@@ -1066,6 +1158,7 @@ double CModel::GetAveragePrecip() const
 //
 double CModel::GetAverageSnowfall() const
 {
+  if (_reductions_valid){return _avg_snowfall;}
   double sum(0);
   const force_struct *f;
   for (int k=0;k<_nHydroUnits;k++)
@@ -1079,6 +1172,63 @@ double CModel::GetAverageSnowfall() const
   return sum/_WatershedArea;
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief Adds weighted forcing functions of one HRU to running area-weighted average
+/// \param &F [in/out] running average forcing functions
+/// \param *pF [in] HRU forcing functions
+/// \param wt [in] HRU area weight (area/watershed area)
+//
+void AddWeightedForcings(force_struct &F,const force_struct *pF,const double wt)
+{
+  F.precip          +=wt*pF->precip;
+  F.precip_daily_ave+=wt*pF->precip_daily_ave;
+  F.precip_5day     +=wt*pF->precip_5day;
+  F.snow_frac       +=wt*pF->snow_frac;
+
+  F.temp_ave       +=wt*pF->temp_ave;
+  F.temp_daily_min +=wt*pF->temp_daily_min;
+  F.temp_daily_max +=wt*pF->temp_daily_max;
+  F.temp_daily_ave +=wt*pF->temp_daily_ave;
+  F.temp_month_max +=wt*pF->temp_month_max;
+  F.temp_month_min +=wt*pF->temp_month_min;
+  F.temp_month_ave +=wt*pF->temp_month_ave;
+
+  F.temp_ave_unc   +=wt*pF->temp_ave_unc;
+  F.temp_min_unc   +=wt*pF->temp_min_unc;
+  F.temp_max_unc   +=wt*pF->temp_max_unc;
+
+  F.air_dens       +=wt*pF->air_dens;
+  F.air_pres       +=wt*pF->air_pres;
+  F.rel_humidity   +=wt*pF->rel_humidity;
+
+  F.cloud_cover    +=wt*pF->cloud_cover;
+  F.ET_radia       +=wt*pF->ET_radia;
+  F.ET_radia_flat  +=wt*pF->ET_radia_flat;
+  F.SW_radia       +=wt*pF->SW_radia;
+  F.SW_radia_unc   +=wt*pF->SW_radia_unc;
+  F.SW_radia_net   +=wt*pF->SW_radia_net;
+  F.SW_radia_subcan+=wt*pF->SW_radia_subcan;
+  F.SW_subcan_net  +=wt*pF->SW_subcan_net;
+  F.LW_incoming    +=wt*pF->LW_incoming;
+  F.LW_radia_net   +=wt*pF->LW_radia_net;
+  F.day_length     +=wt*pF->day_length;
+  F.day_angle      +=wt*pF->day_angle;   //not really necc.
+
+  F.wind_vel       +=wt*pF->wind_vel;
+
+  F.PET            +=wt*pF->PET;
+  F.OW_PET         +=wt*pF->OW_PET;
+  F.PET_month_ave  +=wt*pF->PET_month_ave;
+
+  F.potential_melt +=wt*pF->potential_melt;
+
+  F.recharge       +=wt*pF->recharge;
+  F.precip_temp    +=wt*pF->precip_temp;
+  F.precip_conc    +=wt*pF->precip_conc;
+
+  F.subdaily_corr  +=wt*pF->subdaily_corr;
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Returns current area-weighted average forcing functions at all HRUs
 ///
@@ -1086,6 +1236,7 @@ double CModel::GetAverageSnowfall() const
 //
 force_struct CModel::GetAverageForcings() const
 {
+  if (_reductions_valid){return _aveForcings;}
   static force_struct Fave;
   const force_struct *pF_hru;
   double area_wt;
@@ -1098,53 +1249,7 @@ force_struct CModel::GetAverageForcings() const
       pF_hru =_pHydroUnits[k]->GetForcingFunctions();
       area_wt=_pHydroUnits[k]->GetArea()/_WatershedArea;
 
-      Fave.precip          +=area_wt*pF_hru->precip;
-      Fave.precip_daily_ave+=area_wt*pF_hru->precip_daily_ave;
-      Fave.precip_5day     +=area_wt*pF_hru->precip_5day;
-      Fave.snow_frac       +=area_wt*pF_hru->snow_frac;
-
-      Fave.temp_ave       +=area_wt*pF_hru->temp_ave;
-      Fave.temp_daily_min +=area_wt*pF_hru->temp_daily_min;
-      Fave.temp_daily_max +=area_wt*pF_hru->temp_daily_max;
-      Fave.temp_daily_ave +=area_wt*pF_hru->temp_daily_ave;
-      Fave.temp_month_max +=area_wt*pF_hru->temp_month_max;
-      Fave.temp_month_min +=area_wt*pF_hru->temp_month_min;
-      Fave.temp_month_ave +=area_wt*pF_hru->temp_month_ave;
-
-      Fave.temp_ave_unc   +=area_wt*pF_hru->temp_ave_unc;
-      Fave.temp_min_unc   +=area_wt*pF_hru->temp_min_unc;
-      Fave.temp_max_unc   +=area_wt*pF_hru->temp_max_unc;
-
-      Fave.air_dens       +=area_wt*pF_hru->air_dens;
-      Fave.air_pres       +=area_wt*pF_hru->air_pres;
-      Fave.rel_humidity   +=area_wt*pF_hru->rel_humidity;
-
-      Fave.cloud_cover    +=area_wt*pF_hru->cloud_cover;
-      Fave.ET_radia       +=area_wt*pF_hru->ET_radia;
-      Fave.ET_radia_flat  +=area_wt*pF_hru->ET_radia_flat;
-      Fave.SW_radia       +=area_wt*pF_hru->SW_radia;
-      Fave.SW_radia_unc   +=area_wt*pF_hru->SW_radia_unc;
-      Fave.SW_radia_net   +=area_wt*pF_hru->SW_radia_net;
-      Fave.SW_radia_subcan+=area_wt*pF_hru->SW_radia_subcan;
-      Fave.SW_subcan_net  +=area_wt*pF_hru->SW_subcan_net;
-      Fave.LW_incoming    +=area_wt*pF_hru->LW_incoming;
-      Fave.LW_radia_net   +=area_wt*pF_hru->LW_radia_net;
-      Fave.day_length     +=area_wt*pF_hru->day_length;
-      Fave.day_angle      +=area_wt*pF_hru->day_angle;   //not really necc.
-
-      Fave.wind_vel       +=area_wt*pF_hru->wind_vel;
-
-      Fave.PET            +=area_wt*pF_hru->PET;
-      Fave.OW_PET         +=area_wt*pF_hru->OW_PET;
-      Fave.PET_month_ave  +=area_wt*pF_hru->PET_month_ave;
-
-      Fave.potential_melt +=area_wt*pF_hru->potential_melt;
-
-      Fave.recharge       +=area_wt*pF_hru->recharge;
-      Fave.precip_temp    +=area_wt*pF_hru->precip_temp;
-      Fave.precip_conc    +=area_wt*pF_hru->precip_conc;
-
-      Fave.subdaily_corr  +=area_wt*pF_hru->subdaily_corr;
+      AddWeightedForcings(Fave,pF_hru,area_wt);
     }
   }
   return Fave;
@@ -1162,6 +1267,7 @@ double CModel::GetAvgStateVar(const int i) const
 #ifdef _STRICTCHECK_
   ExitGracefullyIf((i<0) || (i>=_nStateVars),"CModel GetAvgStateVar::improper index",BAD_DATA);
 #endif
+  if (_reductions_valid){return _aAvgStateVars[i];}
   double sum(0.0);
   for (int k=0;k<_nHydroUnits;k++)
   {
@@ -1219,6 +1325,7 @@ double CModel::GetAvgForcing (const forcing_type &ftype) const
 //
 double CModel::GetTotalChannelStorage() const
 {
+  if (_reductions_valid){return _tot_channel_stor;}
   double sum(0);
 
   for (int p=0;p<_nSubBasins;p++)
@@ -1233,6 +1340,7 @@ double CModel::GetTotalChannelStorage() const
 //
 double CModel::GetTotalReservoirStorage() const
 {
+  if (_reductions_valid){return _tot_res_stor;}
   double sum(0);
 
   for (int p=0;p<_nSubBasins;p++)
@@ -1247,6 +1355,7 @@ double CModel::GetTotalReservoirStorage() const
 //
 double CModel::GetTotalRivuletStorage() const
 {
+  if (_reductions_valid){return _tot_rivulet_stor;}
   double sum(0);
 
   for (int p=0;p<_nSubBasins;p++)
@@ -1256,6 +1365,68 @@ double CModel::GetTotalRivuletStorage() const
 
   return sum/(_WatershedArea*M2_PER_KM2)*MM_PER_METER;
 }
+//////////////////////////////////////////////////////////////////
+/// \brief Computes all area-weighted watershed averages and totals used by output and mass balance in one pass
+/// \details Caches average state variables, precipitation, snowfall and forcings (one sweep through HRUs) and
+/// total channel, reservoir and rivulet storage (one sweep through subbasins). Until InvalidateWatershedReductions()
+/// is called, GetAvgStateVar(), GetAveragePrecip(), GetAverageSnowfall(), GetAverageForcings() and GetTotal*Storage()
+/// return the cached values, which are identical to those computed directly.
+/// \remarks Called once per time step after the mass/energy balance; must not be in effect while model states change
+//
+void CModel::UpdateWatershedReductions()
+{
+  int i,k,p;
+  _reductions_valid=false;
+
+  if (_nAvgStateVars!=_nStateVars){
+    delete [] _aAvgStateVars;
+    _aAvgStateVars=new double [_nStateVars];
+    ExitGracefullyIf(_aAvgStateVars==NULL,"CModel::UpdateWatershedReductions",OUT_OF_MEMORY);
+    _nAvgStateVars=_nStateVars;
+  }
+
+  double precip(0),snowfall(0),area;
+  const force_struct *pF;
+  const double       *aSV;
+  for (i=0;i<_nStateVars;i++){_aAvgStateVars[i]=0.0;}
+  ZeroOutForcings(_aveForcings);
+  for (k=0;k<_nHydroUnits;k++)
+  {
+    if(_pHydroUnits[k]->IsEnabled())
+    {
+      area=_pHydroUnits[k]->GetArea();
+      pF  =_pHydroUnits[k]->GetForcingFunctions();
+      aSV =_pHydroUnits[k]->GetStateVarArray();
+      precip  +=(pF->precip+pF->irrigation)*area;
+      snowfall+=(pF->precip*pF->snow_frac)*area;
+      AddWeightedForcings(_aveForcings,pF,area/_WatershedArea);
+      for (i=0;i<_nStateVars;i++){_aAvgStateVars[i]+=(aSV[i]*area);}
+    }
+  }
+  for (i=0;i<_nStateVars;i++){_aAvgStateVars[i]/=_WatershedArea;}
+  _avg_precip  =precip  /_WatershedArea;
+  _avg_snowfall=snowfall/_WatershedArea;
+
+  double chan(0),res(0),riv(0);
+  for (p=0;p<_nSubBasins;p++)
+  {
+    chan+=_pSubBasins[p]->GetChannelStorage();  //[m3]
+    res +=_pSubBasins[p]->GetReservoirStorage();//[m3]
+    riv +=_pSubBasins[p]->GetRivuletStorage();  //[m3]
+  }
+  _tot_channel_stor=chan/(_WatershedArea*M2_PER_KM2)*MM_PER_METER;
+  _tot_res_stor    =res /(_WatershedArea*M2_PER_KM2)*MM_PER_METER;
+  _tot_rivulet_stor=riv /(_WatershedArea*M2_PER_KM2)*MM_PER_METER;
+
+  _reductions_valid=true;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Discards cached watershed reductions; subsequent queries are computed directly from model state
+//
+void CModel::InvalidateWatershedReductions()
+{
+  _reductions_valid=false;
+}
 
 
 /*****************************************************************
@@ -1271,6 +1442,7 @@ void CModel::AddHRU(CHydroUnit *pHRU)
 {
   if (!DynArrayAppend((void**&)(_pHydroUnits),(void*)(pHRU),_nHydroUnits)){
     ExitGracefully("CModel::AddHRU: adding NULL HRU",BAD_DATA);}
+  _HRUIndexByID.emplace(pHRU->GetHRUID(),_nHydroUnits-1);
 }
 
 //////////////////////////////////////////////////////////////////
@@ -1299,6 +1471,7 @@ void CModel::AddSubBasin(CSubBasin *pSB)
 {
   if (!DynArrayAppend((void**&)(_pSubBasins),(void*)(pSB),_nSubBasins)){
     ExitGracefully("CModel::AddSubBasin: adding NULL HRU",BAD_DATA);}
+  _SBIndexByID.emplace(pSB->GetID(),_nSubBasins-1);
 }
 
 //////////////////////////////////////////////////////////////////
@@ -1328,6 +1501,7 @@ void CModel::AddGauge  (CGauge *pGage)
 {
   if (!DynArrayAppend((void**&)(_pGauges),(void*)(pGage),_nGauges)){
     ExitGracefully("CModel::AddGauge: adding NULL Gauge",BAD_DATA);}
+  _GaugeIndexByName.emplace(pGage->GetName(),_nGauges-1);
 }
 
 //////////////////////////////////////////////////////////////////
@@ -1685,6 +1859,49 @@ void CModel::SetOutputGroup(const CHRUGroup *pOut){
   _pOutputGroup=pOut;
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief Adds HRUs to output selection
+/// \details once any HRU is selected, HRU-based output (custom output by HRU, HRU storage) is only written for selected HRUs
+///
+/// \param *aHRUs [in] global HRU indices [size: n]
+/// \param n [in] number of HRUs added
+//
+void CModel::AddOutputHRUs(const int *aHRUs,const int n)
+{
+  int *tmp=new int [_nOutputHRUs+n];
+  ExitGracefullyIf(tmp==NULL,"CModel::AddOutputHRUs",OUT_OF_MEMORY);
+  for (int i=0;i<_nOutputHRUs;i++){tmp[i]=_aOutputHRUs[i];}
+  for (int i=0;i<n;i++){
+    ExitGracefullyIf((aHRUs[i]<0) || (aHRUs[i]>=_nHydroUnits),"CModel::AddOutputHRUs: invalid HRU index",RUNTIME_ERR);
+    tmp[_nOutputHRUs+i]=aHRUs[i];
+  }
+  delete [] _aOutputHRUs;
+  _aOutputHRUs=tmp;
+  _nOutputHRUs+=n;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Adds subbasins to output selection
+/// \details once any subbasin is selected, subbasin-based output (hydrographs, reservoir stages, custom output by subbasin, etc.)
+/// is only written for selected subbasins
+///
+/// \param *aSubBasins [in] global subbasin indices [size: n]
+/// \param n [in] number of subbasins added
+//
+void CModel::AddOutputSubBasins(const int *aSubBasins,const int n)
+{
+  int *tmp=new int [_nOutputSubBasins+n];
+  ExitGracefullyIf(tmp==NULL,"CModel::AddOutputSubBasins",OUT_OF_MEMORY);
+  for (int i=0;i<_nOutputSubBasins;i++){tmp[i]=_aOutputSubBasins[i];}
+  for (int i=0;i<n;i++){
+    ExitGracefullyIf((aSubBasins[i]<0) || (aSubBasins[i]>=_nSubBasins),"CModel::AddOutputSubBasins: invalid subbasin index",RUNTIME_ERR);
+    tmp[_nOutputSubBasins+i]=aSubBasins[i];
+  }
+  delete [] _aOutputSubBasins;
+  _aOutputSubBasins=tmp;
+  _nOutputSubBasins+=n;
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Sets Ensemble mode for model
 ///
@@ -1751,7 +1968,9 @@ void CModel::DeleteCustomOutputs()
     delete _pCustomOutputs[i];
   }
   delete [] _pCustomOutputs;
+  _pCustomOutputs=NULL;
   _nCustomOutputs=0;
+  delete _pCustomAgg; _pCustomAgg=NULL;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -1821,6 +2040,24 @@ void CModel::OverrideStreamflow   (const long long SBID)
   }
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief Returns index of class identified by name (case-insensitive) or by 1-based index
+/// \details if both apply to different classes, the one earlier in the class list is returned
+/// \param &index [in] map from uppercase class names to class indices
+/// \param s [in] class identifier (name or index)
+/// \param nClasses [in] number of classes
+/// \return index of class corresponding to identifier s, DOESNT_EXIST if none
+//
+static int ClassIndexFromString(const unordered_map<string,int> &index,const string &s,const int nClasses)
+{
+  int c=DOESNT_EXIST;
+  unordered_map<string,int>::const_iterator it=index.find(StringToUppercase(s));
+  if (it!=index.end()){c=it->second;}
+  int c_num=s_to_i(s.c_str())-1;
+  if ((c_num>=0) && (c_num<nClasses) && ((c==DOESNT_EXIST) || (c_num<c))){c=c_num;}
+  return c;
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Returns the LU class corresponding to passed string
 /// \details Converts string (e.g., "AGRICULTURAL" in HRU file) to LU class
@@ -1831,18 +2068,9 @@ void CModel::OverrideStreamflow   (const long long SBID)
 //
 CLandUseClass *CModel::StringToLUClass(const string s)
 {
-  string s_sup = StringToUppercase(s);
-  for (int c=0;c<_nLandUseClasses;c++)
-  {
-    if (!s_sup.compare(StringToUppercase(_pLandUseClasses[c]->GetLanduseName()))) {
-      return this->_pLandUseClasses[c];
-    }
-    else if (s_to_i(s.c_str())==(c+1)) {
-      return this->_pLandUseClasses[c];
-    }
-  }
-
-  return NULL;
+  int c=ClassIndexFromString(_LUClassIndex,s,_nLandUseClasses);
+  if (c==DOESNT_EXIST){return NULL;}
+  return this->_pLandUseClasses[c];
 }
 
 //////////////////////////////////////////////////////////////////
@@ -1892,6 +2120,7 @@ void CModel::DestroyAllLanduseClasses()
   // the static variables must be reset to avoid dangling pointers and attempts to re-delete
   _pLandUseClasses = NULL;
   _nLandUseClasses = 0;
+  _LUClassIndex.clear();
 }
 
 //////////////////////////////////////////////////////////////////
@@ -1904,13 +2133,9 @@ void CModel::DestroyAllLanduseClasses()
 //
 CSoilClass *CModel::StringToSoilClass(const string s)
 {
-  string sup=StringToUppercase(s);
-  for (int c=0;c<_nAllSoilClasses;c++)
-  {
-    if (!sup.compare(StringToUppercase(_pAllSoilClasses[c]->GetTag()))){return _pAllSoilClasses[c];}
-    else if (s_to_i(s.c_str())==(c+1))                                 {return _pAllSoilClasses[c];}
-  }
-  return NULL;
+  int c=ClassIndexFromString(_SoilClassIndex,s,_nAllSoilClasses);
+  if (c==DOESNT_EXIST){return NULL;}
+  return _pAllSoilClasses[c];
 }
 
 //////////////////////////////////////////////////////////////////
@@ -1941,6 +2166,7 @@ void CModel::AddSoilClass(CSoilClass *pSoilClass) {
   if (!DynArrayAppend((void**&)(_pAllSoilClasses), (void*)pSoilClass, _nAllSoilClasses)) {
     ExitGracefully("CModel::AddSoilClass: adding NULL soil class", BAD_DATA);
   }
+  _SoilClassIndex.emplace(StringToUppercase(pSoilClass->GetTag()),_nAllSoilClasses-1);
 }
 
 //////////////////////////////////////////////////////////////////
@@ -1980,6 +2206,7 @@ void CModel::DestroyAllSoilClasses()
   // the static variables must be reset to avoid dangling pointers and attempts to re-delete
   _pAllSoilClasses = NULL;
   _nAllSoilClasses = 0;
+  _SoilClassIndex.clear();
 }
 
 //////////////////////////////////////////////////////////////////
@@ -1992,14 +2219,9 @@ void CModel::DestroyAllSoilClasses()
 //
 CVegetationClass *CModel::StringToVegClass(const string s)
 {
-  string sup;
-  sup = StringToUppercase(s);
-  for (int c=0; c<this->_numVegClasses; c++)
-  {
-    if (!sup.compare(StringToUppercase(this->_pAllVegClasses[c]->GetVegetationName()))){return this->_pAllVegClasses[c];}
-    else if (s_to_i(sup.c_str()) == (c+1))                                             {return this->_pAllVegClasses[c];}
-  }
-  return NULL;
+  int c=ClassIndexFromString(_VegClassIndex,s,_numVegClasses);
+  if (c==DOESNT_EXIST){return NULL;}
+  return this->_pAllVegClasses[c];
 }
 
 //////////////////////////////////////////////////////////////////
@@ -2032,6 +2254,7 @@ void CModel::AddVegClass(CVegetationClass *pVegClass) {
                       this->_numVegClasses)) {
     ExitGracefully("CModel::AddVegClass: adding NULL vegetation class", BAD_DATA);
   }
+  _VegClassIndex.emplace(StringToUppercase(pVegClass->GetVegetationName()),_numVegClasses-1);
 }
 
 //////////////////////////////////////////////////////////////////
@@ -2073,6 +2296,7 @@ void CModel::DestroyAllVegClasses()
   // the static variables must be reset to avoid dangling pointers and attempts to re-delete
   this->_pAllVegClasses = NULL;
   this->_numVegClasses = 0;
+  _VegClassIndex.clear();
 }
 
 //////////////////////////////////////////////////////////////////
@@ -2085,13 +2309,9 @@ void CModel::DestroyAllVegClasses()
 //
 CTerrainClass *CModel::StringToTerrainClass(const string s)
 {
-  string sup = StringToUppercase(s);
-  for (int c=0; c < this->_nAllTerrainClasses; c++)
-  {
-    if (!sup.compare(StringToUppercase(this->_pAllTerrainClasses[c]->GetTag()))){return this->_pAllTerrainClasses[c];}
-    else if (s_to_i(s.c_str())==(c+1))                                   {return this->_pAllTerrainClasses[c];}
-  }
-  return NULL;
+  int c=ClassIndexFromString(_TerrainClassIndex,s,_nAllTerrainClasses);
+  if (c==DOESNT_EXIST){return NULL;}
+  return this->_pAllTerrainClasses[c];
 }
 
 //////////////////////////////////////////////////////////////////
@@ -2124,6 +2344,7 @@ void CModel::AddTerrainClass(CTerrainClass *pTerrainClass){
                       _nAllTerrainClasses)) {
     ExitGracefully("CModel::AddTerrainClass: creating NULL terrain class", BAD_DATA);
   };
+  _TerrainClassIndex.emplace(StringToUppercase(pTerrainClass->GetTag()),_nAllTerrainClasses-1);
 }
 
 //////////////////////////////////////////////////////////////////
@@ -2161,6 +2382,7 @@ void CModel::DestroyAllTerrainClasses()
   // the static variables must be reset to avoid dangling pointers and attempts to re-delete
   this->_pAllTerrainClasses = NULL;
   this->_nAllTerrainClasses = 0;
+  _TerrainClassIndex.clear();
 }
 
 //////////////////////////////////////////////////////////////////
@@ -2460,6 +2682,8 @@ void CModel::IncrementCumulInput(const optStruct &Options, const time_struct &tt
   double area;
   area = _WatershedArea * M2_PER_KM2;
 
+  UpdateWatershedReductions(); //shared with WriteMinorOutput() for this time step
+
   _CumulInput+=GetAveragePrecip()*Options.timestep;
 
   _CumulInput+=GetAverageForcings().recharge*Options.timestep;
@@ -2551,12 +2775,7 @@ void CModel::UpdateTransientParams(const optStruct   &Options,
   int nn=(int)((tt.model_time+REAL_SMALL)/Options.timestep);//current timestep index
   for (int j=0;j<_nTransParams;j++)
   {
-    class_type ctype=_pTransParams[j]->GetParameterClassType();
-    string     pname=_pTransParams[j]->GetParameterName();
-    string     cname=_pTransParams[j]->GetParameterClass();
-    double     value=_pTransParams[j]->GetTimeSeries()->GetSampledValue(nn);
-
-    UpdateParameter(ctype,pname,cname,value);
+    _pTransParams[j]->Update(nn);
   }
 
   //--update land use and HRU types-----------------------------------------------
@@ -2641,6 +2860,7 @@ void  CModel::AddLandUseClass(CLandUseClass* pLU)
 {
   if (!DynArrayAppend((void**&)(_pLandUseClasses),(void*)(pLU),_nLandUseClasses)) {
     ExitGracefully("CLandUseClass::Constructor: creating NULL land use class",BAD_DATA);};
+  _LUClassIndex.emplace(StringToUppercase(pLU->GetLanduseName()),_nLandUseClasses-1);
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Returns the LU class corresponding to passed string
@@ -2657,12 +2877,9 @@ const CLandUseClass *CModel::StringToLUClass(const string s) const
 }
 const int CModel::GetLandClassIndex(const string s) const
 {
-  string sup=StringToUppercase(s);
-  for (int c=0;c<_nLandUseClasses;c++)
-  {
-    if (!sup.compare(StringToUppercase(_pLandUseClasses[c]->GetLanduseName()))){return c;}
-  }
-  return DOESNT_EXIST;
+  unordered_map<string,int>::const_iterator it=_LUClassIndex.find(StringToUppercase(s));
+  if (it==_LUClassIndex.end()){return DOESNT_EXIST;}
+  return it->second;
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Returns the land use  class corresponding to the passed index
@@ -2879,7 +3096,8 @@ void CModel::ApplyForcingPerturbation(const forcing_type ftype, force_struct &F,
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Updates values stored in modeled time series of observation data
-/// modifies _pModeledTS[] time series and _aObsIndex array
+/// modifies _pModeledTS[] time series (where stored), running diagnostic sums and _aObsIndex array
+/// \note modeled quantity of each observation is resolved once in BindObservation()
 /// \param &Options [in] Global model options information
 /// \param &tt [in] Current time structure
 //
@@ -2890,43 +3108,22 @@ void CModel::UpdateDiagnostics(const optStruct   &Options,
 
   int n=(int)(floor((tt.model_time+TIME_CORRECTION)/Options.timestep));//current timestep index
 
-  double     value, obsTime;
-  string     datatype;
-  sv_type    svtyp;
-  int        layer_ind;
-  CSubBasin *pBasin=NULL;
-  bool       invalid_data;
+  double       value, obsTime;
+  CSubBasin   *pBasin=NULL;
+  CTimeSeries *pTS;
 
   for (int i=0;i<_nObservedTS;i++)
   {
-    datatype = _pObservedTS[i]->GetName();
-    svtyp    = _pStateVar->StringToSVType(datatype, layer_ind, false);
+    const obs_binding &B=_aObsBindings[i];
+    pBasin=B.pBasin;
 
-    invalid_data=false;
-    pBasin=GetSubBasinByID (_pObservedTS[i]->GetLocID());
-    if ((pBasin==NULL) && (svtyp==UNRECOGNIZED_SVTYPE))
-    {
-      invalid_data=true;
-    }
-    else if ((pBasin==NULL) && (datatype == "RESERVOIR_STAGE")) //because svtyp would not be UNRECOGNIZED
+    switch(B.type)
     {
-      invalid_data=true;
-    }
-    else if ( (datatype == "RESERVOIR_STAGE") ||
-              (datatype == "RESERVOIR_INFLOW") ||
-              (datatype == "RESERVOIR_NETINFLOW") ||
-              (datatype == "LAKE_AREA")) {
-      if (pBasin->GetReservoir() == NULL) {
-        invalid_data=true;
-      }
-    }
-
-
-    if (invalid_data)
+    case(OBS_INVALID):
     {
-      value=RAV_BLANK_DATA;
+      value=RAV_BLANK_DATA; break;
     }
-    else if (datatype=="HYDROGRAPH")//===============================================
+    case(OBS_HYDROGRAPH)://=========================================================
     {
       if ((Options.ave_hydrograph) && (tt.model_time!=0)){
         value=pBasin->GetIntegratedOutflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);
@@ -2934,18 +3131,24 @@ void CModel::UpdateDiagnostics(const optStruct   &Options,
       else{
         value=pBasin->GetOutflowRate();
       }
+      break;
     }
-    else if (datatype == "RESERVOIR_STAGE")//=======================================
+    case(OBS_RES_STAGE)://==========================================================
     {
+      if (pBasin->GetReservoir()==NULL){value=RAV_BLANK_DATA; break;}
       value = pBasin->GetReservoir()->GetResStage();
+      break;
     }
-    else if (datatype == "RESERVOIR_INFLOW")//======================================
+    case(OBS_RES_INFLOW)://=========================================================
     {
+      if (pBasin->GetReservoir()==NULL){value=RAV_BLANK_DATA; break;}
       value = pBasin->GetIntegratedReservoirInflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);
+      break;
     }
-    else if (datatype == "RESERVOIR_NETINFLOW")//===================================
+    case(OBS_RES_NETINFLOW)://======================================================
     {
       CReservoir *pRes= pBasin->GetReservoir();
+      if (pRes==NULL){value=RAV_BLANK_DATA; break;}
       double avg_area=0.0;
       if (pRes->GetHRUIndex()!=DOESNT_EXIST){ avg_area = _pHydroUnits[pRes->GetHRUIndex()]->GetArea(); }
 
@@ -2953,45 +3156,39 @@ void CModel::UpdateDiagnostics(const optStruct   &Options,
       double losses      = pRes->GetReservoirEvapLosses        (Options.timestep) / (Options.timestep*SEC_PER_DAY);
       losses            += pRes->GetReservoirGWLosses          (Options.timestep) / (Options.timestep*SEC_PER_DAY);
       value              = pBasin->GetIntegratedReservoirInflow(Options.timestep) / (Options.timestep*SEC_PER_DAY) + tem_precip1 - losses;
+      break;
     }
-    else if(datatype == "STREAM_CONCENTRATION")//=======================================
-    {
-      int c=_pObservedTS[i]->GetConstitInd();
-      int p=GetSubBasinIndex(_pObservedTS[i]->GetLocID());
-      if (c==DOESNT_EXIST){value=RAV_BLANK_DATA;}
-      else                {value = _pTransModel->GetConstituentModel(c)->GetOutflowConcentration(p);}
-    }
-    else if(datatype == "STREAM_TEMPERATURE")//=======================================
-    {
-      int c=_pObservedTS[i]->GetConstitInd();
-      int p=GetSubBasinIndex(_pObservedTS[i]->GetLocID());
-      if (c==DOESNT_EXIST){value=RAV_BLANK_DATA;}
-      else                {value = _pTransModel->GetConstituentModel(c)->GetOutflowConcentration(p);}
+    case(OBS_STREAM_CONC)://========================================================
+    { //STREAM_CONCENTRATION or STREAM_TEMPERATURE
+      if (B.c==DOESNT_EXIST){value=RAV_BLANK_DATA;}
+      else                  {value = _pTransModel->GetConstituentModel(B.c)->GetOutflowConcentration(B.p);}
+      break;
     }
-    else if(datatype == "WATER_LEVEL")//=======================================
+    case(OBS_WATER_LEVEL)://========================================================
     {
       value = pBasin->GetWaterLevel();
+      break;
     }
-    else if (datatype == "LAKE_AREA")//========================================
+    case(OBS_LAKE_AREA)://==========================================================
     {
+      if (pBasin->GetReservoir()==NULL){value=RAV_BLANK_DATA; break;}
       value = pBasin->GetReservoir()->GetSurfaceArea();
+      break;
     }
-    else if (svtyp!=UNRECOGNIZED_SVTYPE)//==========================================
-    { //State variable
-      CHydroUnit *pHRU=NULL;
-      pHRU=GetHRUByID((long long int)(_pObservedTS[i]->GetLocID()));
-      string error="CModel::UpdateDiagnostics: Invalid HRU ID specified in observed state variable time series "+_pObservedTS[i]->GetName();
-      ExitGracefullyIf(pHRU==NULL,error.c_str(),BAD_DATA);
-      int sv_index=this->GetStateVarIndex(svtyp,layer_ind);
-      value       =pHRU->GetStateVarValue(sv_index);
+    case(OBS_STATE_VAR)://==========================================================
+    {
+      value = _pHydroUnits[B.k]->GetStateVarValue(B.i);
+      break;
     }
-    else// ERROR ===================================================================
+    default:// ERROR ===============================================================
     {
       if (tt.model_time ==0){
-        string warn="CModel::UpdateDiagnostics: invalid tag ("+datatype+")used for specifying Observation type";
+        string warn="CModel::UpdateDiagnostics: invalid tag ("+_pObservedTS[i]->GetName()+")used for specifying Observation type";
         WriteWarning(warn.c_str(),BAD_DATA);
       }
       value=0;
+      break;
+    }
     }
 
     // only set values within diagnostic evaluation times. The rest stay as BLANK_DATA
@@ -3001,10 +3198,13 @@ void CModel::UpdateDiagnostics(const optStruct   &Options,
     }
 
 
+    pTS=_pModeledTS[i]; //NULL if not stored (streaming diagnostics only)
     if     (_pObservedTS[i]->GetType()==CTimeSeriesABC::TS_REGULAR)
     {
-      _pModeledTS[i]->SetValue(n,value);
-      _pModeledTS[i]->SetSampledValue(n,value); //Handles blank value issue in final time  step
+      if (pTS!=NULL){
+        pTS->SetValue(n,value);
+        pTS->SetSampledValue(n,value); //Handles blank value issue in final time  step
+      }
     }
     else if(_pObservedTS[i]->GetType()==CTimeSeriesABC::TS_IRREGULAR)
     {
@@ -3014,14 +3214,24 @@ void CModel::UpdateDiagnostics(const optStruct   &Options,
         obsTime =_pObservedTS[i]->GetTime(_aObsIndex[i]);
       }
       if ((obsTime>=tt.model_time) && (obsTime<tt.model_time+Options.timestep)) {
-        _pModeledTS[i]->SetValue(_aObsIndex[i],value);
-        _pModeledTS[i]->SetSampledValue(n,value);
+        if (pTS!=NULL){
+          pTS->SetValue(_aObsIndex[i],value);
+          pTS->SetSampledValue(n,value);
+        }
         if(_aObsIndex[i]<_pObservedTS[i]->GetNumValues()-1){
           _aObsIndex[i]++;
         }
       }
       else{
-        _pModeledTS[i]->SetSampledValue(n,RAV_BLANK_DATA);
+        value=RAV_BLANK_DATA;
+        if (pTS!=NULL){pTS->SetSampledValue(n,RAV_BLANK_DATA);}
+      }
+    }
+
+    if (_aDiagAccums!=NULL)
+    {
+      for (int d=0;d<_nDiagPeriods;d++){
+        CDiagnostic::UpdateAccum(_aDiagAccums[i][d],_pObservedTS[i],_pObsWeightTS[i],n,value);
       }
     }
   }
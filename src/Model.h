@@ -6,6 +6,7 @@
 #define MODEL_H
 
 #include "RavenInclude.h"
+#include "BufferedOutput.h"
 #include "ModelABC.h"
 #include "StateVariables.h"
 #include "HydroProcessABC.h"
@@ -31,10 +32,12 @@
 #include "ChannelXSect.h"
 #include "Convolution.h"
 #include "DemandOptimization.h"
+#include <unordered_map>
 
 class CHydroProcessABC;
 class CGauge;
 class CCustomOutput;
+class CCustomOutputAggregator;
 class CCustomTable;
 class CGroundwaterModel;
 class CTransportModel;
@@ -57,6 +60,53 @@ struct sv_over { // state variable override structure
   }
   ~sv_over() {delete pTS;}
 };
+struct gauge_weights { // sparse (compressed row) HRU-gauge interpolation weights
+  int    *aStart;  ///< weights of HRU k are entries aStart[k]..aStart[k+1]-1 [size: nHRUs+1]
+  int    *aGauge;  ///< gauge index g of each non-zero weight [size: aStart[nHRUs]]
+  double *aWt;     ///< non-zero weights [size: aStart[nHRUs]]
+  bool   *aUsed;   ///< true if gauge g has a non-zero weight for any HRU [size: nGauges]
+  gauge_weights() {
+    aStart=NULL; aGauge=NULL; aWt=NULL; aUsed=NULL;
+  }
+  ~gauge_weights() {Clear();}
+  void Clear() {
+    delete [] aStart; aStart=NULL;
+    delete [] aGauge; aGauge=NULL;
+    delete [] aWt;    aWt   =NULL;
+    delete [] aUsed;  aUsed =NULL;
+  }
+};
+enum obs_quantity { // modeled quantity compared to an observation time series
+  OBS_INVALID,         ///< observation does not correspond to model entity (always blank)
+  OBS_HYDROGRAPH,      ///< subbasin outflow
+  OBS_RES_STAGE,       ///< reservoir stage
+  OBS_RES_INFLOW,      ///< reservoir inflow
+  OBS_RES_NETINFLOW,   ///< reservoir net inflow
+  OBS_STREAM_CONC,     ///< subbasin outflow concentration or temperature
+  OBS_WATER_LEVEL,     ///< subbasin water level
+  OBS_LAKE_AREA,       ///< reservoir surface area
+  OBS_STATE_VAR,       ///< HRU state variable
+  OBS_UNRECOGNIZED     ///< unrecognized observation type
+};
+struct obs_binding { // observation time series pre-resolved to the modeled quantity it is compared to
+  obs_quantity type;   ///< modeled quantity
+  CSubBasin   *pBasin; ///< subbasin (NULL if not subbasin-based)
+  int          p;      ///< subbasin index (OBS_STREAM_CONC)
+  int          c;      ///< constituent index (OBS_STREAM_CONC)
+  int          k;      ///< HRU global index (OBS_STATE_VAR)
+  int          i;      ///< state variable index (OBS_STATE_VAR)
+};
+struct solar_geom { // solar geometry class: HRUs sharing latitude, slope, aspect (and elevation, for UBCWM radiation)
+  double latrad;        ///< latitude [rad]
+  double slope;         ///< slope [rad]
+  double aspect;        ///< aspect [rad]
+  double elev;          ///< elevation [masl] (only used as key for SW_RAD_UBCWM)
+  double t_cached;      ///< model time at which radiation below was calculated (-ALMOST_INF if never)
+  double opt_air_mass;  ///< optical air mass [-]
+  double ET_radia;      ///< extraterrestrial radiation on slope [MJ/m2/d]
+  double ET_radia_flat; ///< extraterrestrial radiation on flat ground [MJ/m2/d]
+  double clear_sky;     ///< clear sky radiation (SW_RAD_UBCWM only) [MJ/m2/d]
+};
 ////////////////////////////////////////////////////////////////////
 /// \brief Data abstraction for water surface model
 /// \details Stores and organizes HRUs and basins, provides access to all
@@ -71,6 +121,7 @@ private:/*------------------------------------------------------*/
 
   int              _nHydroUnits;  ///< number of HRUs in model
   CHydroUnit     **_pHydroUnits;  ///< Array of pointers to HRUs
+  unordered_map<long long,int> _HRUIndexByID; ///< global index k of HRU with given HRU ID (first added, if repeated)
 
   int               _nHRUGroups;  ///< number of HRU groups in model
   CHRUGroup       **_pHRUGroups;  ///< Array of pointers to HRU groups
@@ -79,6 +130,7 @@ private:/*------------------------------------------------------*/
 
   int               _nSubBasins;  ///< number of subbasins
   CSubBasin       **_pSubBasins;  ///< array of pointers to subbasins [size:_nSubBasins]; each subbasin includes multiple HRUs/HydroUnits
+  unordered_map<long long,int> _SBIndexByID;  ///< index p of subbasin with given subbasin ID (first added, if repeated)
   int          *_aSubBasinOrder;  ///< stores order of subbasin for routing [size:_nSubBasins] (may be relegated to local variable in InitializeRoutingNetwork)
   int         _maxSubBasinOrder;  ///< stores maximum subasin order for routing (may be relegated to local variable in InitializeRoutingNetwork)
   int           *_aOrderedSBind;  ///< stores list of subbasin indices ordered upstream to downstream [size:_nSubBasins]
@@ -101,9 +153,14 @@ private:/*------------------------------------------------------*/
 
   int                  _nGauges;  ///< number of precip/temp gauges for forcing interpolation
   CGauge             **_pGauges;  ///< array of pointers to gauges which store time series info [size:_nGauges]
-  double       **_aGaugeWeights;  ///< array of weights for each gauge/HRU pair [_nHydroUnits][_nGauges]
-  double        **_aGaugeWtTemp;
-  double      **_aGaugeWtPrecip;
+  unordered_map<string,int> _GaugeIndexByName; ///< index g of gauge with given name (first added, if repeated)
+  gauge_weights      _GaugeWts;  ///< sparse weights for each gauge/HRU pair for 'other' forcings
+  gauge_weights  _GaugeWtsTemp;  ///< sparse weights for each gauge/HRU pair for temperature
+  gauge_weights _GaugeWtsPrecip;  ///< sparse weights for each gauge/HRU pair for precipitation
+
+  int            _nSolarClasses;  ///< number of distinct HRU solar geometry classes
+  solar_geom     *_aSolarClasses;  ///< solar geometry classes with cached radiation [size: _nSolarClasses]
+  int          *_aSolarClassIndex; ///< index of solar geometry class of each HRU [size: _nHydroUnits]
 
   int            _nForcingGrids;  ///< number of gridded forcing input data
   CForcingGrid **_pForcingGrids;  ///< gridded input data [size: _nForcingGrids]
@@ -128,9 +185,10 @@ private:/*------------------------------------------------------*/
 
   //For Diagnostics Calculation
   CTimeSeriesABC **_pObservedTS;  ///< array of pointers of observation time series [size: _nObservedTS]
-  CTimeSeries     **_pModeledTS;  ///< array of pointers of modeled time series corresponding to observations [size: _nObservedTS]
+  CTimeSeries     **_pModeledTS;  ///< array of pointers of modeled time series corresponding to observations (NULL entries if not stored, see ModeledSeriesNeeded) [size: _nObservedTS]
   int              _nObservedTS;  ///< number of observation time series
   int               *_aObsIndex;  ///< index of the next unprocessed observation
+  obs_binding   *_aObsBindings;  ///< modeled quantity of each observation, resolved in InitializeObservations [size: _nObservedTS]
 
   CTimeSeriesABC**_pObsWeightTS;  ///< array of pointers of observation weight time series [size: _nObsWeightTS]
   int             _nObsWeightTS;  ///< number of observation weight time series
@@ -139,6 +197,14 @@ private:/*------------------------------------------------------*/
   int             _nDiagnostics;  ///< number of diagnostics to be calculated comparing obs. vs modeled
   CDiagPeriod   **_pDiagPeriods;  ///< array of pointers to diagnostic periods [size _nDiagPeriods]
   int             _nDiagPeriods;  ///< number of diagnostic periods
+  diag_accum    **_aDiagAccums;   ///< running sums for streaming diagnostics (NULL if no diagnostics) [size: _nObservedTS][_nDiagPeriods]
+
+  long long      _objbound_SBID;  ///< hydrograph subbasin ID of objective used for early termination (DOESNT_EXIST if not used)
+  diag_type      _objbound_diag;  ///< diagnostic of objective used for early termination
+  string       _objbound_period;  ///< diagnostic period of objective used for early termination
+  double              _objbound;  ///< objective bound (as returned by GetObjFuncVal, i.e., minimized); run ends once it can't be met
+  int           _objbound_ind[3]; ///< observation, diagnostic and period index of objective (DOESNT_EXIST if unresolved)
+  bool        _terminated_early;  ///< true if current run was ended because objective bound could no longer be met
   agg_diag   **_pAggDiagnostics;  ///< array of pointers to aggregate diagnostic structures [size: _nAggDiagnostics]
   int          _nAggDiagnostics;  ///< number of aggregated diagnostics
 
@@ -167,27 +233,51 @@ private:/*------------------------------------------------------*/
   double           _CumulOutput;  ///< cumulative outflow of water from system [mm]
   double             _initWater;  ///< initial water in system [mm]
 
+  //Watershed reductions (cached once per time step for output and mass balance)
+  bool        _reductions_valid;  ///< true if cached watershed reductions below reflect current model state
+  int            _nAvgStateVars;  ///< size of _aAvgStateVars
+  double        *_aAvgStateVars;  ///< area-weighted watershed average of each state variable [size: _nAvgStateVars]
+  double            _avg_precip;  ///< area-weighted watershed average precipitation+irrigation [mm/d]
+  double          _avg_snowfall;  ///< area-weighted watershed average snowfall [mm/d]
+  double      _tot_channel_stor;  ///< total channel storage [mm]
+  double          _tot_res_stor;  ///< total reservoir storage [mm]
+  double      _tot_rivulet_stor;  ///< total rivulet storage [mm]
+  force_struct     _aveForcings;  ///< area-weighted watershed average forcing functions
+
   //Output
   CCustomOutput**_pCustomOutputs; ///< Array of pointers to custom output objects [size:_nCustomOutputs]
   int            _nCustomOutputs; ///< Nuber of custom output objects
+  CCustomOutputAggregator *_pCustomAgg; ///< gathers HRU values shared by custom outputs once per time step (or NULL)
   CCustomTable  **_pCustomTables; ///< Array of pointers to custom table objects [size:_nCustomTables]
   int             _nCustomTables; ///< Number of custom tables
-  ofstream                _HYDRO; ///< output file stream for Hydrographs.csv
-  ofstream              _STORAGE; ///< output file stream for WatershedStorage.csv
-  ofstream             _FORCINGS; ///< output file stream for ForcingFunctions.csv
-  ofstream             _RESSTAGE; ///< output file stream for ReservoirStages.csv
-  ofstream              _DEMANDS; ///< output file stream for Demands.csv
-  ofstream               _LEVELS; ///< output file stream for WaterLevels.csv
+  CBufferedOutputFile     _HYDRO; ///< output file stream for Hydrographs.csv
+  CBufferedOutputFile   _STORAGE; ///< output file stream for WatershedStorage.csv
+  CBufferedOutputFile  _FORCINGS; ///< output file stream for ForcingFunctions.csv
+  CBufferedOutputFile  _RESSTAGE; ///< output file stream for ReservoirStages.csv
+  CBufferedOutputFile   _DEMANDS; ///< output file stream for Demands.csv
+  CBufferedOutputFile    _LEVELS; ///< output file stream for WaterLevels.csv
   int                _HYDRO_ncid; ///< output file ID for Hydrographs.nc
   int             _RESSTAGE_ncid; ///< output file ID for ReservoirStages.nc
   int              _STORAGE_ncid; ///< output file ID for WatershedStorage.nc
   int             _FORCINGS_ncid; ///< output file ID for ForcingFunctions.nc
   int                _RESMB_ncid; ///< output file ID for ReservoirMassBalance.nc
+  CNetCDFBlockBuffer    _HYDRO_ncbuf; ///< block buffer for Hydrographs.nc time series
+  CNetCDFBlockBuffer _RESSTAGE_ncbuf; ///< block buffer for ReservoirStages.nc time series
+  CNetCDFBlockBuffer  _STORAGE_ncbuf; ///< block buffer for WatershedStorage.nc time series
+  CNetCDFBlockBuffer _FORCINGS_ncbuf; ///< block buffer for ForcingFunctions.nc time series
+  CNetCDFBlockBuffer    _RESMB_ncbuf; ///< block buffer for ReservoirMassBalance.nc time series
+  CBinaryColumnFile       _HYDRO_bin; ///< binary column file for Hydrographs.npy
+  CBinaryColumnFile    _RESSTAGE_bin; ///< binary column file for ReservoirStages.npy
+  CBinaryColumnFile     _STORAGE_bin; ///< binary column file for WatershedStorage.npy
 
   double          *_aOutputTimes; ///< array of model major output times (LOCAL times at which full solution is written)
   int              _nOutputTimes; ///< size of array of model major output times
   int         _currOutputTimeInd; ///< index of current output time
   const CHRUGroup *_pOutputGroup; ///< pointer to HRU group for which storage histories are written to file (or NULL)
+  int             *_aOutputHRUs; ///< global indices of HRUs selected for output, sorted once initialized [size: _nOutputHRUs] (NULL if all HRUs)
+  int              _nOutputHRUs; ///< number of HRUs selected for output
+  int        *_aOutputSubBasins; ///< global indices of subbasins selected for output, sorted once initialized [size: _nOutputSubBasins] (NULL if all subbasins)
+  int         _nOutputSubBasins; ///< number of subbasins selected for output
 
   const optStruct   *_pOptStruct; ///< pointer to model options information
 
@@ -211,6 +301,10 @@ private:/*------------------------------------------------------*/
   CSoilProfile     **_pAllSoilProfiles;    ///< Reference to array of all soil profiles in model
   int                _nAllSoilProfiles;    ///< Number of soil profiles in model (size of pAllSoilProfiles)
   CChannelXSect    **_pAllChannelXSects;
+  unordered_map<string,int> _LUClassIndex;      ///< index of land use class with given uppercase name
+  unordered_map<string,int> _SoilClassIndex;    ///< index of soil class with given uppercase tag
+  unordered_map<string,int> _VegClassIndex;     ///< index of vegetation class with given uppercase name
+  unordered_map<string,int> _TerrainClassIndex; ///< index of terrain class with given uppercase tag
   int                _nAllChannelXSects;
 
   CStateVariable    *_pStateVar;           ///< pointer to state variable information object
@@ -218,20 +312,43 @@ private:/*------------------------------------------------------*/
 
   //initialization subroutines:
   void           GenerateGaugeWeights (double **&aWts, const forcing_type forcing, const optStruct 	 &Options);
+  void           CompressGaugeWeights (double **&aWts, gauge_weights &W) const;
+  void           GenerateSolarClasses (const optStruct &Options);
   void       InitializeRoutingNetwork ();
   void         InitializeObservations (const optStruct 	 &Options);
+  void         BindObservation        (const int i);
+  void         InitializeDiagAccums   (const optStruct   &Options);
+  bool         ModeledSeriesNeeded    (const int i) const;
+  double       EvaluateDiagnostic     (const int i, const int d, const int j, const optStruct &Options) const;
+  void         FindObjective          (const long long SBID, const diag_type obj, const string period,
+                                       int &ii, int &jj, int &dd) const;
   void     InitializeDataAssimilation (const optStruct   &Options);
+  void        FinalizeOutputSelection ();
 
   void      WriteEnsimStandardHeaders (const optStruct 	 &Options);
   void     WriteNetcdfStandardHeaders (const optStruct 	 &Options);
+  void     WriteBinaryStandardHeaders (const optStruct   &Options);
   void          WriteEnsimMinorOutput (const optStruct 	 &Options,
                                        const time_struct &tt);
   void         WriteNetcdfMinorOutput (const optStruct   &Options,
                                        const time_struct &tt);
+  void         WriteBinaryMinorOutput (const optStruct   &Options,
+                                       const time_struct &tt);
+  void       WriteWatershedStorageRow (const optStruct   &Options,
+                                       const time_struct &tt,
+                                             COutputRow  &ROW) const;
+  void             WriteHydrographRow (const optStruct   &Options,
+                                       const time_struct &tt,
+                                             COutputRow  &ROW) const;
+  void         WriteReservoirStageRow (const optStruct   &Options,
+                                       const time_struct &tt,
+                                             COutputRow  &ROW) const;
   void    InitializeParameterOverrides();
 
   //private routines used during simulation:
   force_struct      GetAverageForcings() const;
+  void       UpdateWatershedReductions();
+  void   InvalidateWatershedReductions();
   double       GetTotalChannelStorage () const;
   double      GetTotalReservoirStorage() const;
   double       GetTotalRivuletStorage () const;
@@ -290,14 +407,12 @@ private:/*------------------------------------------------------*/
                                       const force_struct* F,
                                       const optStruct& Options);
 
-  double       CalculateAggDiagnostic(const int ii, const int j,
-                                      const double &starttime, const double &endtime,
-                                      const comparison compare,const double &thresh,
+  double       CalculateAggDiagnostic(const int ii, const int j, const int d,
                                       const optStruct &Options);
 
   //Routines for deriving missing data based on gridded data provided
 
-  CForcingGrid *ForcingCopyCreate(const CForcingGrid *pGrid, const forcing_type typ, const double &interval, const int nVals, const optStruct &Options);
+  CForcingGrid *ForcingCopyCreate(const CForcingGrid *pGrid, const forcing_type typ, const double &interval, const int nVals, const optStruct &Options, const bool as_view=false);
 
 
   void         GenerateAveSubdailyTempFromMinMax        (const optStruct &Options);
@@ -436,6 +551,13 @@ public:/*-------------------------------------------------------*/
   const CSubBasin **GetUpstreamSubbasins              (const long long SBID, int &nUpstream) const;
   bool              IsSubBasinUpstream                (const long long SBID,const long long SBIDdown) const;
 
+  int               GetNumOutputHRUs                  () const;
+  int               GetOutputHRUIndex                 (const int i) const;
+  bool              IsOutputHRU                       (const int k) const;
+  int               GetNumOutputSubBasins             () const;
+  int               GetOutputSubBasinIndex            (const int i) const;
+  bool              IsOutputSubBasin                  (const int p) const;
+
   double            GetWatershedArea                  () const;
   bool              IsInHRUGroup                      (const int k,
                                                        const string HRUGroupName) const;
@@ -448,6 +570,8 @@ public:/*-------------------------------------------------------*/
   double                GetObservedFlow               (const int p, const int n) const;
 
   double               GetObjFuncVal                  (long long calib_SBID,diag_type calib_Obj, const string calib_period) const;
+  double               GetRunningDiagnostic           (const int i, const int d, const int j) const;
+  bool                 IsTerminatedEarly              () const;
 
   const optStruct     *GetOptStruct                   () const;
   CTransportModel     *GetTransportModel              () const;
@@ -495,7 +619,15 @@ public:/*-------------------------------------------------------*/
   void    SetLakeStorage            (const sv_type            SV,
                                      const int                lev               );//TMP?
   void    SetOutputGroup            (const CHRUGroup         *pOut              );
+  void    AddOutputHRUs             (const int               *aHRUs,
+                                     const int                n                 );
+  void    AddOutputSubBasins        (const int               *aSubBasins,
+                                     const int                n                 );
   void    SetNumSnowLayers          (const int                nLayers           );
+  void    SetObjectiveBound         (const long long          SBID,
+                                     const diag_type          obj,
+                                     const string             period,
+                                     const double            &bound             );
 
   void    OverrideStreamflow        (const long long SBID);
   void    SetEnsembleMode           (CEnsemble *pEnsemble);
@@ -535,8 +667,14 @@ public:/*-------------------------------------------------------*/
                                           const time_struct &tt);
   void        UpdateHRUForcingFunctions  (const optStruct   &Options,
                                           const time_struct &tt); //declaration in UpdateForcings.cpp
+  const solar_geom *GetSolarGeometry     (const int          k,
+                                          const force_struct *F,
+                                          const optStruct   &Options,
+                                          const time_struct &tt); //declaration in UpdateForcings.cpp
   void        UpdateDiagnostics          (const optStruct   &Options,
                                           const time_struct &tt);
+  bool        CheckObjectiveBound        (const optStruct   &Options,
+                                          const time_struct &tt);
   void        RecalculateHRUDerivedParams(const optStruct   &Options,
                                           const time_struct &tt);
   bool        ApplyProcess               (const int          j,
@@ -581,6 +719,8 @@ public:/*-------------------------------------------------------*/
   void        WriteSimpleOutput       (const optStruct &Options, const time_struct &tt);
   void        WriteMajorOutput        (const time_struct &tt,string solfile,bool final) const;
   void        WriteMajorOutput        (const optStruct &Options, const time_struct &tt,string solfile,bool final) const;
+  void        WriteSolutionFile       (const time_struct &tt,string solfile) const;
+  void        WriteBinaryCheckpoint   (const time_struct &tt,string solfile) const;
   void        WriteProgressOutput     (const optStruct &Options, clock_t elapsed_time, int elapsed_steps, int total_steps);
   void        CloseOutputStreams      ();
   void        SummarizeToScreen       (const optStruct &Options) const;
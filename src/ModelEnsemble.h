@@ -110,6 +110,7 @@ private:
   long long    _calib_SBID;  ///< observation hydrograph subbasin ID
   diag_type    _calib_Obj;   ///< diagnostic used as objective function (e.g., DIAG_NASH_SUTCLIFFE)
   string       _calib_Period;///< name of calibration period (e.g., CALIB)
+  bool         _early_term;  ///< true if runs which can no longer beat the best objective are ended early
 
   ofstream     _DDSOUT;      ///< output file stream
 
@@ -123,6 +124,7 @@ public:
 
   void SetPerturbationValue(const double &perturb);
   void SetCalibrationTarget(const long long SBID, const diag_type object_diag, const string period);
+  void SetEarlyTermination (const bool early_term);
   void AddParamDist(const param_dist *dist);
 
   void Initialize(const CModel* pModel,const optStruct &Options);
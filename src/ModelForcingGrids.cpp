@@ -11,7 +11,11 @@
    -GenerateMinMaxAveTempFromSubdaily
    -GenerateMinMaxSubdailyTempFromAve
    -GeneratePrecipFromSnowRain
-   -GetAverageSnowFrac
+   -GenerateRainFromPrecip
+   -GenerateZeroSnow
+   derived grids (other than daily temperature read as TEMP_AVE) are
+   lightweight views evaluated on demand from their source grids
+   (see CForcingGrid::SetAsLinearView, SetAsTemporalView)
 ------------------------------------------------------------------
 *****************************************************************/
 
@@ -20,18 +24,20 @@
 ///    but with potentially new time interval specified
 ///    otherwise just returns existing grid of type typ
 ///    assume
+/// \param as_view [in] if true, no value storage is allocated; caller must assign the derivation (SetAsLinearView/SetAsTemporalView)
 //
 CForcingGrid *CModel::ForcingCopyCreate(const CForcingGrid *pGrid,
                                         const forcing_type typ,
                                         const double &interval,
-                                        const int nVals, const optStruct &Options)
+                                        const int nVals, const optStruct &Options,
+                                        const bool as_view)
 {
   static CForcingGrid *pTout;
   if (GetForcingGridIndexFromType(typ) == DOESNT_EXIST )
   { // for the first chunk, the derived grid does not exist and has to be added to the model
     // all weights, etc., are copied from the base grid
 
-    pTout = new CForcingGrid(*pGrid);  // copy everything from pGrid; matrices are deep copies
+    pTout = new CForcingGrid(*pGrid,false);  // copy everything but values from pGrid; matrices are deep copies
 
     //type, chunk size, and time dimension are overwritten:
     int    GridDims[3];
@@ -49,7 +55,9 @@ CForcingGrid *CModel::ForcingCopyCreate(const CForcingGrid *pGrid,
     pTout->SetGridDims(GridDims);
 
     pTout->CalculateChunkSize(Options);
-    pTout->ReallocateArraysInForcingGrid();
+    if (!as_view){
+      pTout->ReallocateArraysInForcingGrid();
+    }
   }
   else
   {
@@ -214,29 +222,14 @@ void CModel::GenerateAveSubdailyTempFromMinMax(const optStruct &Options)
   pTmin->Initialize(Options);// needed for correct mapping from time series to model time
   pTmax->Initialize(Options);
 
-  int nValsPerDay= (int)(1.0 / pTmin->GetInterval()); //typically should be 1.0
-
   // ----------------------------------------------------
   // Generate daily average grid, if it doesnt exist
   // ----------------------------------------------------
   if(!ForcingGridIsInput(F_TEMP_DAILY_AVE))
   {
     int    nVals     = (int)ceil(pTmin->GetChunkSize() * pTmin->GetInterval());
-    double Tave;
-    pTave_daily = ForcingCopyCreate(pTmin,F_TEMP_DAILY_AVE,1.0,nVals,Options);
-
-    double time_shift=Options.julian_start_day-floor(Options.julian_start_day+TIME_CORRECTION);
-    double t=0.0;
-    int chunk_size =pTave_daily->GetChunkSize();
-    int nNonZero   =pTave_daily->GetNumberNonZeroGridCells();
-    for(int it=0; it<chunk_size; it++) {            // loop over time points in buffer
-      for(int ic=0; ic<nNonZero;ic++) {             // loop over non-zero grid cell indexes
-        Tave=0.5*(pTmin->GetValue_avg(ic,(int)floor(t -time_shift+TIME_CORRECTION)* nValsPerDay,nValsPerDay) +
-                  pTmax->GetValue_avg(ic,(int)floor(t -time_shift+TIME_CORRECTION)* nValsPerDay,nValsPerDay));
-        pTave_daily->SetValue(ic,it,Tave);
-      }
-      t+=1.0;
-    }
+    pTave_daily = ForcingCopyCreate(pTmin,F_TEMP_DAILY_AVE,1.0,nVals,Options,true);
+    pTave_daily->SetAsTemporalView(DERIVE_DAILY_MINMAX_AVE,pTmin,pTmax,NULL,Options);
     AddForcingGrid(pTave_daily,F_TEMP_DAILY_AVE);
   }
   else {
@@ -250,30 +243,10 @@ void CModel::GenerateAveSubdailyTempFromMinMax(const optStruct &Options)
   {
     int    nVals     = (int)ceil(pTave_daily->GetChunkSize()/Options.timestep);
 
-    pTave = ForcingCopyCreate(pTmin,F_TEMP_AVE,Options.timestep,nVals,Options);
-
-    // set forcing values
-    // Tmax       is with input time resolution
-    // Tmin       is with input time resolution
-    // Tave       is with model time resolution
-    // Tave_daily is with daily resolution
-    double t=0.0; // model time
-    double Tmax,Tmin,T1corr,T2corr,val;
-    int time_idx_chunk;
-    int nNonZero  =pTave->GetNumberNonZeroGridCells();
-    double time_shift=Options.julian_start_day-floor(Options.julian_start_day+TIME_CORRECTION);
-    for (int it=0; it<nVals; it++) {                   // loop over all time points (nVals)
-      for (int ic=0; ic<nNonZero; ic++){               // loop over non-zero grid cell indexes
-        time_idx_chunk = int(floor(t+TIME_CORRECTION));
-        Tmin   = pTmin->GetValue_avg(ic, (int)floor(t-time_shift+TIME_CORRECTION)*nValsPerDay, nValsPerDay);
-        Tmax   = pTmax->GetValue_avg(ic, (int)floor(t-time_shift+TIME_CORRECTION)*nValsPerDay, nValsPerDay);
-        T1corr = pTave->DailyTempCorrection(t);
-        T2corr = pTave->DailyTempCorrection(t+Options.timestep);
-        val=pTave_daily->GetValue(ic, time_idx_chunk)+0.25*(Tmax-Tmin)*(T1corr+T2corr);
-        pTave->SetValue( ic, it, val);
-      }
-      t += Options.timestep;
-    }
+    // Tmax, Tmin are with input time resolution, Tave_daily is with daily resolution
+    // Tave is with model time resolution, evaluated on demand with diurnal correction
+    pTave = ForcingCopyCreate(pTmin,F_TEMP_AVE,Options.timestep,nVals,Options,true);
+    pTave->SetAsTemporalView(DERIVE_SUBDAILY_TEMP,pTmin,pTmax,pTave_daily,Options);
     AddForcingGrid(pTave,F_TEMP_AVE);
   }
   else //tstep ==  1 day
@@ -281,14 +254,8 @@ void CModel::GenerateAveSubdailyTempFromMinMax(const optStruct &Options)
     if(!ForcingGridIsInput(F_TEMP_AVE))
     {
       int    nVals     = pTave_daily->GetChunkSize();
-      pTave = ForcingCopyCreate(pTave_daily,F_TEMP_AVE,1.0,nVals,Options);
-
-      int nNonZero  =pTave->GetNumberNonZeroGridCells();
-      for(int it=0; it<nVals; it++) {                           // loop over time points in buffer
-        for(int ic=0; ic<nNonZero; ic++) {                      // loop over non-zero grid cell indexes
-          pTave->SetValue(ic,it,pTave_daily->GetValue(ic,it));  // --> just copy daily average values
-        }
-      }
+      pTave = ForcingCopyCreate(pTave_daily,F_TEMP_AVE,1.0,nVals,Options,true);
+      pTave->SetAsLinearView(pTave_daily,1.0,NULL,0.0,0.0);  // --> just daily average values
       AddForcingGrid(pTave,F_TEMP_AVE);
     }
   }
@@ -305,29 +272,15 @@ void CModel::GenerateMinMaxAveTempFromSubdaily(const optStruct &Options)
   pTave=GetForcingGrid(F_TEMP_AVE);
   pTave->Initialize(Options);  // needed for correct mapping from time series to model time
 
-  double interval = pTave->GetInterval();
-  int    nVals    = (int)ceil(pTave->GetChunkSize()*interval); // number of daily values
+  int    nVals    = (int)ceil(pTave->GetChunkSize()*pTave->GetInterval()); // number of daily values
 
-  pTmin_daily = ForcingCopyCreate(pTave,F_TEMP_DAILY_MIN,1.0,nVals,Options);
-  pTmax_daily = ForcingCopyCreate(pTave,F_TEMP_DAILY_MAX,1.0,nVals,Options);
-  pTave_daily = ForcingCopyCreate(pTave,F_TEMP_DAILY_AVE,1.0,nVals,Options);
+  pTmin_daily = ForcingCopyCreate(pTave,F_TEMP_DAILY_MIN,1.0,nVals,Options,true);
+  pTmax_daily = ForcingCopyCreate(pTave,F_TEMP_DAILY_MAX,1.0,nVals,Options,true);
+  pTave_daily = ForcingCopyCreate(pTave,F_TEMP_DAILY_AVE,1.0,nVals,Options,true);
 
-  int t_idx;
-  double time;
-  double time_shift=Options.julian_start_day-floor(Options.julian_start_day+TIME_CORRECTION);
-  int    nsteps_in_day=(int)(rvn_round(1.0/interval));
-
-  for (int it=0; it<nVals; it++) {                    // loop over time points in buffer
-    time=(double)it*nsteps_in_day;
-    time=floor(time-time_shift+TIME_CORRECTION); //model time corresponding to 00:00 on day of it
-    t_idx=(int)(time);
-
-    for (int ic=0; ic<pTave->GetNumberNonZeroGridCells(); ic++){         // loop over non-zero grid cell indexes
-      pTmin_daily->SetValue(ic, it, pTave->GetValue_min(ic, t_idx, nsteps_in_day));
-      pTmax_daily->SetValue(ic, it, pTave->GetValue_max(ic, t_idx, nsteps_in_day));
-      pTave_daily->SetValue(ic, it, pTave->GetValue_avg(ic, t_idx, nsteps_in_day));
-    }
-  }
+  pTmin_daily->SetAsTemporalView(DERIVE_DAILY_MIN,pTave,NULL,NULL,Options);
+  pTmax_daily->SetAsTemporalView(DERIVE_DAILY_MAX,pTave,NULL,NULL,Options);
+  pTave_daily->SetAsTemporalView(DERIVE_DAILY_AVE,pTave,NULL,NULL,Options);
 
   AddForcingGrid(pTmin_daily,F_TEMP_DAILY_MIN);
   AddForcingGrid(pTmax_daily,F_TEMP_DAILY_MAX);
@@ -350,18 +303,10 @@ void CModel::GenerateMinMaxSubdailyTempFromAve(const optStruct &Options)
   double interval = pTave_daily->GetInterval();
   int       nVals = pTave_daily->GetChunkSize(); // number of subdaily values (input resolution) - should be 1
 
-  pTmin_daily = ForcingCopyCreate(pTave_daily,F_TEMP_DAILY_MIN,interval,nVals,Options);
-  pTmax_daily = ForcingCopyCreate(pTave_daily,F_TEMP_DAILY_MAX,interval,nVals,Options);
-  int chunksize=pTave_daily->GetChunkSize();
-  int nNonZero =pTave_daily->GetNumberNonZeroGridCells();
-  double daily_temp;
-  for (int it=0; it<nVals; it++) {          // loop over time points in buffer
-    for (int ic=0; ic<nNonZero; ic++){      // loop over non-zero grid cell indexes
-      daily_temp=pTave_daily->GetValue(ic, min(chunksize,it));// should be it+0.5
-      pTmin_daily->SetValue(ic, it, daily_temp-4.0);
-      pTmax_daily->SetValue(ic, it, daily_temp+4.0);
-    }
-  }
+  pTmin_daily = ForcingCopyCreate(pTave_daily,F_TEMP_DAILY_MIN,interval,nVals,Options,true);
+  pTmax_daily = ForcingCopyCreate(pTave_daily,F_TEMP_DAILY_MAX,interval,nVals,Options,true);
+  pTmin_daily->SetAsLinearView(pTave_daily,1.0,NULL,0.0,-4.0);
+  pTmax_daily->SetAsLinearView(pTave_daily,1.0,NULL,0.0,+4.0);
   AddForcingGrid(pTmin_daily,F_TEMP_DAILY_MIN);
   AddForcingGrid(pTmax_daily,F_TEMP_DAILY_MAX);
 
@@ -394,14 +339,8 @@ void CModel::GeneratePrecipFromSnowRain(const optStruct &Options)
 
   int nVals = pSnow->GetChunkSize();
 
-  pPre = ForcingCopyCreate(pSnow,F_PRECIP,interval_snow,nVals,Options);
-
-  int nNonZero  =pPre->GetNumberNonZeroGridCells();
-  for (int it=0; it<nVals; it++) {     // loop over time points in buffer
-    for (int ic=0; ic<nNonZero; ic++){      // loop over non-zero grid cell indexes
-      pPre->SetValue(ic, it, pSnow->GetValue(ic, it) + pRain->GetValue(ic, it));  // precipitation = sum of snowfall and rainfall
-    }
-  }
+  pPre = ForcingCopyCreate(pSnow,F_PRECIP,interval_snow,nVals,Options,true);
+  pPre->SetAsLinearView(pSnow,1.0,pRain,1.0,0.0);  // precipitation = sum of snowfall and rainfall
 
   AddForcingGrid(pPre,F_PRECIP);
 }
@@ -419,15 +358,8 @@ void CModel::GenerateRainFromPrecip(const optStruct &Options)
 
   int nVals = pPre->GetChunkSize();
 
-  pRain = ForcingCopyCreate(pPre,F_RAINFALL,pPre->GetInterval(),nVals,Options);
-
-  // set forcing values
-  int nNonZero  =pRain->GetNumberNonZeroGridCells();
-  for(int it=0; it<nVals; it++) {                   // loop over time points in buffer
-    for(int ic=0; ic<nNonZero; ic++){                    // loop over non-zero grid cell indexes
-      pRain->SetValue(ic,it,pPre->GetValue(ic,it));      // copies precipitation values
-    }
-  }
+  pRain = ForcingCopyCreate(pPre,F_RAINFALL,pPre->GetInterval(),nVals,Options,true);
+  pRain->SetAsLinearView(pPre,1.0,NULL,0.0,0.0);    // same as precipitation values
 
   AddForcingGrid(pRain,F_RAINFALL);
 }
@@ -447,14 +379,8 @@ void CModel::GenerateZeroSnow(const optStruct &Options)
 
   int    nVals     = pPre->GetChunkSize();
 
-  pSnow = ForcingCopyCreate(pPre,F_SNOWFALL,pPre->GetInterval(),nVals,Options);
-
-  int nNonZero  =pSnow->GetNumberNonZeroGridCells();
-  for (int it=0; it<nVals; it++) {                   // loop over time points in buffer
-    for (int ic=0; ic<nNonZero; ic++){                    // loop over non-zero grid cell indexes
-      pSnow->SetValue(ic, it , 0.0);                      // fills everything with 0.0
-    }
-  }
+  pSnow = ForcingCopyCreate(pPre,F_SNOWFALL,pPre->GetInterval(),nVals,Options,true);
+  pSnow->SetAsLinearView(NULL,0.0,NULL,0.0,0.0);    // constant zero, no storage
 
   AddForcingGrid(pSnow,F_SNOWFALL);
 }
@@ -3,8 +3,29 @@
   Copyright (c) 2008-2023 the Raven Development Team
   ----------------------------------------------------------------*/
 #include "Model.h"
+#include "ModelEnsemble.h"
 #include "IrregularTimeSeries.h"
 #include "HeatConduction.h"
+#include <chrono>
+#include <map>
+#include <tuple>
+
+const int MIN_INIT_CHUNK=256; ///< minimum number of HRUs initialized per thread in parallel initialization loops
+
+//////////////////////////////////////////////////////////////////
+/// \brief reports wall clock time spent in an initialization phase (noisy mode only)
+/// \param phase [in] name of phase just completed
+/// \param &t_last [in/out] time at end of previous phase; reset to current time
+/// \param &Options [in] Global model options information
+//
+static void ReportInitPhaseTime(const string phase,chrono::steady_clock::time_point &t_last,const optStruct &Options)
+{
+  chrono::steady_clock::time_point t_now=chrono::steady_clock::now();
+  if (Options.noisy){
+    cout<<"    [init timing] "<<setw(36)<<left<<phase<<right<<": "<<chrono::duration<double>(t_now-t_last).count()<<" s"<<endl;
+  }
+  t_last=t_now;
+}
 
 /*****************************************************************
    Model Initialization Routines
@@ -29,6 +50,7 @@
 void CModel::Initialize(const optStruct &Options)
 {
   int g,i,j,k,kk,p,pp;
+  chrono::steady_clock::time_point t_phase=chrono::steady_clock::now();
 
   // Quality control
   //--------------------------------------------------------------
@@ -41,16 +63,12 @@ void CModel::Initialize(const optStruct &Options)
   ExitGracefullyIf(_nProcesses==0,
                     "CModel::Initialize: must have at least one hydrological process included in model",BAD_DATA);
 
-  //Ensure Basins & HRU IDs are unique
-  for (p=0;p<_nSubBasins;p++){
-    for (pp=0;pp<p;pp++){
-      if (_pSubBasins[p]->GetID()==_pSubBasins[pp]->GetID()){
-        ExitGracefully("CModel::Initialize: non-unique (repeated) basin identifier found",BAD_DATA);}}}
+  //Ensure Basins & HRU IDs are unique (ID indices only store first of repeated IDs)
+  if ((int)(_SBIndexByID.size())!=_nSubBasins){
+    ExitGracefully("CModel::Initialize: non-unique (repeated) basin identifier found",BAD_DATA);}
 
-  for (k=0;k<_nHydroUnits;k++){
-    for (kk=0;kk<p;kk++){
-      if ((k!=kk) && (_pHydroUnits[k]->GetHRUID()==_pHydroUnits[kk]->GetHRUID())){
-        ExitGracefully("CModel::Initialize: non-unique (repeated) HRU identifier found",BAD_DATA);}}}
+  if ((int)(_HRUIndexByID.size())!=_nHydroUnits){
+    ExitGracefully("CModel::Initialize: non-unique (repeated) HRU identifier found",BAD_DATA);}
 
   // initialize process algorithms, initialize water/energy balance arrays to zero
   //--------------------------------------------------------------
@@ -70,6 +88,7 @@ void CModel::Initialize(const optStruct &Options)
       }
     }
   }
+  ReportInitPhaseTime("process initialization",t_phase,Options);
 
   // reserve memory for mass balance arrays
   //--------------------------------------------------------------
@@ -104,6 +123,7 @@ void CModel::Initialize(const optStruct &Options)
     }
   }
   _CumulInput   =_CumulOutput  =0.0;
+  ReportInitPhaseTime("mass balance arrays",t_phase,Options);
 
   // Identify model UTM_zone for interpolation
   //--------------------------------------------------------------
@@ -120,7 +140,9 @@ void CModel::Initialize(const optStruct &Options)
 
   // Initialize HRUs, gauges and transient parameters
   //--------------------------------------------------------------
-  for (k=0;k<_nHydroUnits; k++ ){_pHydroUnits [k ]->Initialize(_UTM_zone);}
+  ParallelFor(_nHydroUnits,MIN_INIT_CHUNK,[&](int k1,int k2){
+    for (int k=k1;k<k2;k++){_pHydroUnits[k]->Initialize(_UTM_zone);}
+  });
   for (g=0;g<_nGauges;     g++ ){_pGauges     [g ]->Initialize(Options,_UTM_zone);}
   for (j=0;j<_nTransParams;j++ ){_pTransParams[j ]->Initialize(this,Options);}
   for (kk=0;kk<_nHRUGroups;kk++){_pHRUGroups  [kk]->Initialize(); } //disables HRUs
@@ -130,6 +152,7 @@ void CModel::Initialize(const optStruct &Options)
     _pStateVarOverrides[j]->pTS->Initialize(Options.julian_start_day, Options.julian_start_year, Options.duration, Options.timestep,true,Options.calendar);
   }
   InitializeParameterOverrides();
+  ReportInitPhaseTime("HRU, gauge & group initialization",t_phase,Options);
 
   // Forcing grids are not "Initialized" here because the derived data have to be populated everytime a new chunk is read
 
@@ -203,11 +226,25 @@ void CModel::Initialize(const optStruct &Options)
       WTS.close();
     }
 
-    GenerateGaugeWeights(_aGaugeWeights ,f_gauge   ,Options);//'other' forcings
-    GenerateGaugeWeights(_aGaugeWtPrecip,F_PRECIP  ,Options);
-    GenerateGaugeWeights(_aGaugeWtTemp  ,F_TEMP_AVE,Options);
-
+    double **aWts=NULL; //dense weights only held temporarily
+    GenerateGaugeWeights(aWts,f_gauge   ,Options);//'other' forcings
+    CompressGaugeWeights(aWts,_GaugeWts);
+    GenerateGaugeWeights(aWts,F_PRECIP  ,Options);
+    CompressGaugeWeights(aWts,_GaugeWtsPrecip);
+    GenerateGaugeWeights(aWts,F_TEMP_AVE,Options);
+    CompressGaugeWeights(aWts,_GaugeWtsTemp);
   }
+  else
+  {
+    double **aWts=NULL; //no gauge weights; empty sparse rows
+    CompressGaugeWeights(aWts,_GaugeWts);
+    CompressGaugeWeights(aWts,_GaugeWtsPrecip);
+    CompressGaugeWeights(aWts,_GaugeWtsTemp);
+  }
+  ReportInitPhaseTime("gauge interpolation weights",t_phase,Options);
+
+  GenerateSolarClasses(Options);
+  ReportInitPhaseTime("solar geometry classes",t_phase,Options);
 
   //Initialize SubBasins, calculate routing orders, topology
   //--------------------------------------------------------------
@@ -217,9 +254,11 @@ void CModel::Initialize(const optStruct &Options)
 
   if (!Options.silent){cout<<"  Calculating routing network topology..."<<endl;}
   InitializeRoutingNetwork(); //calculate proper routing orders
+  ReportInitPhaseTime("basin areas & routing topology",t_phase,Options);
 
   if (!Options.silent){cout<<"  Initializing Basins, calculating watershed area, setting initial flow conditions..."<<endl;}
   InitializeBasins(Options,false);
+  ReportInitPhaseTime("basin initialization",t_phase,Options);
 
   // Initialize Data Assimilation
   //--------------------------------------------------------------
@@ -242,6 +281,7 @@ void CModel::Initialize(const optStruct &Options)
     if (!Options.silent){cout<<"  Initializing Transport Model..."<<endl;}
     _pTransModel->Initialize(Options);
   }
+  ReportInitPhaseTime("data assimilation, GW & transport",t_phase,Options);
   for (j = 0; j < _nProcesses; j++) {
     if (_pProcesses[j]->GetProcessType() == HEATCONDUCTION) {
       CmvHeatConduction *pHC=static_cast<CmvHeatConduction *>(_pProcesses[j]);
@@ -256,11 +296,17 @@ void CModel::Initialize(const optStruct &Options)
     _aShouldApplyProcess[j]=NULL;
     _aShouldApplyProcess[j] = new bool [_nHydroUnits];
     ExitGracefullyIf(_aShouldApplyProcess[j]==NULL,"CModel::Initialize (_aShouldApplyProcess)",OUT_OF_MEMORY);
-    for (k=0; k<_nHydroUnits;k++){
-      _aShouldApplyProcess[j][k] = _pProcesses[j]->ShouldApply(_pHydroUnits[k]);
-      if (!_pHydroUnits[k]->IsEnabled()){ _aShouldApplyProcess[j][k] =false;}
-    }
+    _pProcesses[j]->CheckConditions(); //ShouldApply() must not report errors from worker threads
   }
+  ParallelFor(_nHydroUnits,MIN_INIT_CHUNK,[&](int k1,int k2){
+    for (int j=0; j<_nProcesses;j++){
+      for (int k=k1; k<k2;k++){
+        _aShouldApplyProcess[j][k] = _pProcesses[j]->ShouldApply(_pHydroUnits[k]);
+        if (!_pHydroUnits[k]->IsEnabled()){ _aShouldApplyProcess[j][k] =false;}
+      }
+    }
+  });
+  ReportInitPhaseTime("process applicability table",t_phase,Options);
 
   // Initialize NetCDF Output File IDs
   //--------------------------------------------------------------
@@ -272,20 +318,33 @@ void CModel::Initialize(const optStruct &Options)
 
   //Initialize Custom Output
   //--------------------------------------------------------------
+  FinalizeOutputSelection();
   for (int c=0;c<_nCustomOutputs;c++){
     _pCustomOutputs[c]->InitializeCustomOutput(Options);
   }
+  delete _pCustomAgg; //re-built for each ensemble member
+  _pCustomAgg=new CCustomOutputAggregator(this);
+  ExitGracefullyIf(_pCustomAgg==NULL,"CModel::Initialize: custom output aggregator",OUT_OF_MEMORY);
+  for (int c=0;c<_nCustomOutputs;c++){
+    _pCustomOutputs[c]->SetAggregator(_pCustomAgg);
+  }
+  _pCustomAgg->Initialize();
 
   quickSort(_aOutputTimes,0,_nOutputTimes-1);
 
   //Prepare Output Time Series
   //--------------------------------------------------------------
   InitializeObservations(Options);
+  ReportInitPhaseTime("custom output & observations",t_phase,Options);
 
   // Generate default diagnostic period - entire simulation
   //--------------------------------------------------------------
   CDiagPeriod *pDP=new CDiagPeriod("ALL","0001-01-01","9999-12-31",COMPARE_GREATERTHAN,-ALMOST_INF,Options);
   AddDiagnosticPeriod(pDP);
+  InitializeDiagAccums(Options);
+  if (_objbound_SBID!=DOESNT_EXIST){
+    FindObjective(_objbound_SBID,_objbound_diag,_objbound_period,_objbound_ind[0],_objbound_ind[1],_objbound_ind[2]);
+  }
 
   //General QA/QC
   //--------------------------------------------------------------
@@ -382,6 +441,31 @@ void CModel::Initialize(const optStruct &Options)
   if ((floor(rem_tsteps + TIME_CORRECTION)-rem_tsteps)>REAL_SMALL){
     WriteWarning("CModelInitialize: the model time step and model start time is such that midnight does not correspond to a time step ending. This will cause issues with use of daily temperature forcings (and potentially other errors) throughout the simulation.", Options.noisy);
   }
+  ReportInitPhaseTime("QA/QC checks",t_phase,Options);
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Sorts output HRU/subbasin selection and removes duplicates
+/// \details unselected subbasins are flagged as ungauged, so that all subbasin-based standard
+/// output (hydrographs, reservoir stages, constituent concentrations, etc.) skips them.
+/// May be called more than once (e.g., once per ensemble member)
+/// \remark this mutates model state rather than just output settings: SetGauged(false) is permanent
+/// for the remainder of the run (it is not undone if the selection changes), and anything else
+/// relying upon CSubBasin::IsGauged() (e.g., management optimization and energy transport output) sees the
+/// unselected subbasins as ungauged
+//
+void CModel::FinalizeOutputSelection()
+{
+  if (_aOutputHRUs!=NULL){
+    sort(_aOutputHRUs,_aOutputHRUs+_nOutputHRUs);
+    _nOutputHRUs=(int)(unique(_aOutputHRUs,_aOutputHRUs+_nOutputHRUs)-_aOutputHRUs);
+  }
+  if (_aOutputSubBasins!=NULL){
+    sort(_aOutputSubBasins,_aOutputSubBasins+_nOutputSubBasins);
+    _nOutputSubBasins=(int)(unique(_aOutputSubBasins,_aOutputSubBasins+_nOutputSubBasins)-_aOutputSubBasins);
+    for (int p=0;p<_nSubBasins;p++){
+      if (!IsOutputSubBasin(p)){_pSubBasins[p]->SetGauged(false);}
+    }
+  }
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Initializes SB demand members AFTER RVC FILE READ
@@ -399,9 +483,11 @@ void CModel::InitializePostRVC(const optStruct& Options)
 //
 void CModel::InitializePostRVM(const optStruct& Options)
 {
+  chrono::steady_clock::time_point t_phase=chrono::steady_clock::now();
   for (int p=0;p<_nSubBasins;p++){
     _pSubBasins[p]->InitializePostRVM(Options);
   }
+  ReportInitPhaseTime("post-.rvm basin initialization",t_phase,Options);
 }
 
 //////////////////////////////////////////////////////////////////
@@ -412,6 +498,7 @@ void CModel::InitializePostRVM(const optStruct& Options)
 void CModel::CalculateInitialWaterStorage(const optStruct &Options)
 {
   if (!Options.silent){cout<<"  Calculating initial system water storage..."<<endl;}
+  chrono::steady_clock::time_point t_phase=chrono::steady_clock::now();
   _initWater=0.0;
   double S=0;
   for (int i=0;i<_nStateVars;i++)
@@ -437,6 +524,7 @@ void CModel::CalculateInitialWaterStorage(const optStruct &Options)
       _pTransModel->GetConstituentModel(c)->CalculateInitialMassStorage(Options);
     }
   }
+  ReportInitPhaseTime("initial water storage",t_phase,Options);
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Initializes observation time series
@@ -451,18 +539,23 @@ void CModel::InitializeObservations(const optStruct &Options)
   int nModeledValues =(int)(ceil((Options.duration+TIME_CORRECTION)/Options.timestep)+1);
   _pModeledTS=new CTimeSeries * [_nObservedTS];
   _aObsIndex =new int           [_nObservedTS];
+  _aObsBindings=new obs_binding [_nObservedTS];
+  ExitGracefullyIf(_aObsBindings==NULL,"CModel::InitializeObservations",OUT_OF_MEMORY);
   CTimeSeriesABC** tmp = new CTimeSeriesABC *[_nObservedTS];
   for (int i = 0; i < _nObservedTS; i++)
   {
-    _pModeledTS[i] = new CTimeSeries("MODELED" + _pObservedTS[i]->GetName(),
-                                      _pObservedTS[i]->GetLocID(),"",
-                                      Options.julian_start_day,
-                                      Options.julian_start_year,
-                                      Options.timestep,nModeledValues,true);
-
+    _pModeledTS[i] = NULL;
+    if (ModeledSeriesNeeded(i)){
+      _pModeledTS[i] = new CTimeSeries("MODELED" + _pObservedTS[i]->GetName(),
+                                        _pObservedTS[i]->GetLocID(),"",
+                                        Options.julian_start_day,
+                                        Options.julian_start_year,
+                                        Options.timestep,nModeledValues,true);
+      _pModeledTS[i]->InitializeResample(nModeledValues,Options.timestep);
+    }
     _pObservedTS[i]->Initialize(Options.julian_start_day, Options.julian_start_year, Options.duration, Options.timestep,true,Options.calendar);
-    _pModeledTS [i]->InitializeResample(nModeledValues,Options.timestep);
     _aObsIndex  [i]=0;
+    BindObservation(i);
 
     //Match weights with observations based on Name, tag and numValues
     tmp[i] = NULL;
@@ -492,6 +585,102 @@ void CModel::InitializeObservations(const optStruct &Options)
   _pObsWeightTS = tmp;
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief returns true if modeled time series corresponding to observation i must be stored
+/// \details not needed if all diagnostics are computed from running sums (CDiagnostic::IsStreamable),
+///     unless series is written to an ObsVsSim file or used for assimilation (EnKF)
+///
+/// \param i [in] observation index
+//
+bool CModel::ModeledSeriesNeeded(const int i) const
+{
+  for (int j=0;j<_nDiagnostics;j++){
+    if (!CDiagnostic::IsStreamable(_pDiagnostics[j]->GetType())){return true;}
+  }
+  if ((_pEnsemble!=NULL) && (_pEnsemble->GetType()==ENSEMBLE_ENKF)){return true;}
+
+  int    layer_ind;
+  string datatype=_pObservedTS[i]->GetName();
+  sv_type svtyp  =_pStateVar->StringToSVType(datatype,layer_ind,false);
+  if ((svtyp!=UNRECOGNIZED_SVTYPE) && (datatype!="RESERVOIR_STAGE")){return true;} //HRU ObsVsSim file (CModel::RunDiagnostics)
+  return false;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Initializes running sums used for streaming diagnostics
+/// \details one set of sums per observation time series and diagnostic period, updated in UpdateDiagnostics.
+///     Called from CModel::Initialize once all diagnostic periods exist, and from RebootTimeVariables
+///     (ensemble mode) to restart the sums for a new run
+///
+/// \param &Options [in] Global model options information
+//
+void CModel::InitializeDiagAccums(const optStruct &Options)
+{
+  if ((_nDiagnostics==0) || (_nObservedTS==0)){return;}
+  if (_aDiagAccums==NULL)
+  {
+    _aDiagAccums=new diag_accum *[_nObservedTS];
+    ExitGracefullyIf(_aDiagAccums==NULL,"CModel::InitializeDiagAccums",OUT_OF_MEMORY);
+    for (int i=0;i<_nObservedTS;i++){
+      _aDiagAccums[i]=new diag_accum [_nDiagPeriods];
+      ExitGracefullyIf(_aDiagAccums[i]==NULL,"CModel::InitializeDiagAccums(2)",OUT_OF_MEMORY);
+    }
+  }
+  for (int i=0;i<_nObservedTS;i++){
+    for (int d=0;d<_nDiagPeriods;d++){
+      CDiagnostic::InitializeAccum(_aDiagAccums[i][d],_pObservedTS[i],_pObsWeightTS[i],
+                                   _pDiagPeriods[d]->GetStartTime(),_pDiagPeriods[d]->GetEndTime(),
+                                   _pDiagPeriods[d]->GetComparison(),_pDiagPeriods[d]->GetThreshold(),Options);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Resolves modeled quantity corresponding to observation time series i
+/// \details determines observation type, subbasin, HRU and state variable once,
+///     so that UpdateDiagnostics only samples model values
+///
+/// \param i [in] observation index
+//
+void CModel::BindObservation(const int i)
+{
+  int         layer_ind;
+  string      datatype=_pObservedTS[i]->GetName();
+  sv_type     svtyp   =_pStateVar->StringToSVType(datatype, layer_ind, false);
+  obs_binding &B      =_aObsBindings[i];
+
+  B.pBasin=GetSubBasinByID(_pObservedTS[i]->GetLocID());
+  B.p=DOESNT_EXIST;
+  B.c=DOESNT_EXIST;
+  B.k=DOESNT_EXIST;
+  B.i=DOESNT_EXIST;
+
+  if      ((B.pBasin==NULL) && (svtyp==UNRECOGNIZED_SVTYPE)){B.type=OBS_INVALID;}
+  else if ((B.pBasin==NULL) && (datatype=="RESERVOIR_STAGE")){B.type=OBS_INVALID;} //because svtyp would not be UNRECOGNIZED
+  else if (datatype=="HYDROGRAPH"         ){B.type=OBS_HYDROGRAPH;}
+  else if (datatype=="RESERVOIR_STAGE"    ){B.type=OBS_RES_STAGE;}
+  else if (datatype=="RESERVOIR_INFLOW"   ){B.type=OBS_RES_INFLOW;}
+  else if (datatype=="RESERVOIR_NETINFLOW"){B.type=OBS_RES_NETINFLOW;}
+  else if ((datatype=="STREAM_CONCENTRATION") || (datatype=="STREAM_TEMPERATURE"))
+  {
+    B.type=OBS_STREAM_CONC;
+    B.c   =_pObservedTS[i]->GetConstitInd();
+    B.p   =GetSubBasinIndex(_pObservedTS[i]->GetLocID());
+  }
+  else if (datatype=="WATER_LEVEL"        ){B.type=OBS_WATER_LEVEL;}
+  else if (datatype=="LAKE_AREA"          ){B.type=OBS_LAKE_AREA;}
+  else if (svtyp!=UNRECOGNIZED_SVTYPE)
+  {
+    B.type=OBS_STATE_VAR;
+    CHydroUnit *pHRU=GetHRUByID((long long int)(_pObservedTS[i]->GetLocID()));
+    string error="CModel::BindObservation: Invalid HRU ID specified in observed state variable time series "+_pObservedTS[i]->GetName();
+    ExitGracefullyIf(pHRU==NULL,error.c_str(),BAD_DATA);
+    B.k=pHRU->GetGlobalIndex();
+    B.i=GetStateVarIndex(svtyp,layer_ind);
+  }
+  else {B.type=OBS_UNRECOGNIZED;}
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Initializes routing network
 /// \details Calculates sub basin routing order - generates _aOrderedSBind array
@@ -729,27 +918,26 @@ void CModel::ClearTimeSeriesData(const optStruct& Options)
   if(DESTRUCTOR_DEBUG) { cout<<"DELETING RVT DATA"<<endl; }
   int c,f,g,i,j,k,p;
   for (g=0;g<_nGauges;       g++){delete _pGauges       [g];} delete [] _pGauges;       _pGauges=NULL; _nGauges=0;
+  _GaugeIndexByName.clear();
   for (f=0;f<_nForcingGrids; f++){delete _pForcingGrids [f];} delete [] _pForcingGrids; _pForcingGrids=NULL; _nForcingGrids=0;
   for (i=0;i<_nObservedTS;   i++){delete _pObservedTS   [i];} delete [] _pObservedTS;   _pObservedTS=NULL;
   if (_pModeledTS != NULL){
     for (i = 0; i < _nObservedTS; i++){ delete _pModeledTS[i]; } delete[] _pModeledTS;    _pModeledTS = NULL;
   }
+  if (_aDiagAccums != NULL){
+    for (i = 0; i < _nObservedTS; i++){ delete [] _aDiagAccums[i]; } delete [] _aDiagAccums; _aDiagAccums = NULL;
+  }
   _nObservedTS=0;
   for (i=0;i<_nObsWeightTS;  i++){delete _pObsWeightTS  [i];} delete [] _pObsWeightTS;  _pObsWeightTS=NULL; _nObsWeightTS;
 
-  if (_aGaugeWeights!=NULL){
-    for (k=0;k<_nHydroUnits;   k++){delete [] _aGaugeWeights[k]; } delete [] _aGaugeWeights;  _aGaugeWeights=NULL;
-  }
-  if (_aGaugeWtPrecip!=NULL){
-    for (k=0;k<_nHydroUnits;   k++){delete [] _aGaugeWtPrecip[k]; } delete [] _aGaugeWtPrecip;  _aGaugeWtPrecip=NULL;
-  }
-  if (_aGaugeWtTemp!=NULL){
-    for (k=0;k<_nHydroUnits;   k++){delete [] _aGaugeWtTemp[k]; } delete [] _aGaugeWtTemp;  _aGaugeWtTemp=NULL;
-  }
+  _GaugeWts.Clear();
+  _GaugeWtsPrecip.Clear();
+  _GaugeWtsTemp.Clear();
   for (j=0;j<_nTransParams;j++) {delete _pTransParams[j];} delete [] _pTransParams; _pTransParams=NULL; _nTransParams=0;
   for (j=0;j<_nClassChanges;j++){delete _pClassChanges[j];} delete [] _pClassChanges; _pClassChanges=NULL; _nClassChanges=0;
 
   delete [] _aObsIndex;      _aObsIndex=NULL;
+  delete [] _aObsBindings;   _aObsBindings=NULL;
 
   for(p=0;p<_nSubBasins;p++) {
     _pSubBasins[p]->ClearTimeSeriesData(Options);
@@ -831,7 +1019,6 @@ void CModel::GenerateGaugeWeights(double **&aWts, const forcing_type forcing, co
 {
   int k,g;
   bool *has_data=NULL;
-  location xyh,xyg;
 
   //allocate memory
   aWts=NULL;
@@ -842,10 +1029,12 @@ void CModel::GenerateGaugeWeights(double **&aWts, const forcing_type forcing, co
     aWts[k]=NULL;
     aWts[k]=new double [_nGauges];
     ExitGracefullyIf(aWts[k]==NULL,"GenerateGaugeWeights(2)",OUT_OF_MEMORY);
-    for (g=0;g<_nGauges;g++){
-      aWts[k][g]=0.0;
-    }
   }
+  ParallelFor(_nHydroUnits,MIN_INIT_CHUNK,[&](int k1,int k2){
+    for (int k=k1;k<k2;k++){
+      for (int g=0;g<_nGauges;g++){aWts[k][g]=0.0;}
+    }
+  });
 
   int nGaugesWithData=0;
   has_data=new bool [_nGauges];
@@ -870,24 +1059,27 @@ void CModel::GenerateGaugeWeights(double **&aWts, const forcing_type forcing, co
   case(INTERP_NEAREST_NEIGHBOR)://---------------------------------------------
   {
     //w=1.0 for nearest gauge, 0.0 for all others
-    double distmin,dist;
-    int    g_min=0;
-    for (k=0;k<_nHydroUnits;k++)
-    {
-      xyh=_pHydroUnits[k]->GetCentroid();
-      g_min=0;
-      distmin=ALMOST_INF;
-      for (g=0;g<_nGauges;g++)
+    ParallelFor(_nHydroUnits,MIN_INIT_CHUNK,[&](int k1,int k2){
+      double distmin,dist;
+      int    g_min=0;
+      location xyh,xyg;
+      for (int k=k1;k<k2;k++)
       {
-        if(has_data[g]){
-          xyg=_pGauges[g]->GetLocation();
-          dist=pow(xyh.UTM_x-xyg.UTM_x,2)+pow(xyh.UTM_y-xyg.UTM_y,2);
-          if(dist<distmin){ distmin=dist;g_min=g; }
+        xyh=_pHydroUnits[k]->GetCentroid();
+        g_min=0;
+        distmin=ALMOST_INF;
+        for (int g=0;g<_nGauges;g++)
+        {
+          if(has_data[g]){
+            xyg=_pGauges[g]->GetLocation();
+            dist=pow(xyh.UTM_x-xyg.UTM_x,2)+pow(xyh.UTM_y-xyg.UTM_y,2);
+            if(dist<distmin){ distmin=dist;g_min=g; }
+          }
+          aWts[k][g]=0.0;
         }
-        aWts[k][g]=0.0;
+        aWts[k][g_min]=1.0;
       }
-      aWts[k][g_min]=1.0;
-    }
+    });
     break;
   }
   case(INTERP_AVERAGE_ALL):                   //---------------------------------------------
@@ -903,75 +1095,78 @@ void CModel::GenerateGaugeWeights(double **&aWts, const forcing_type forcing, co
   case(INTERP_INVERSE_DISTANCE):                      //---------------------------------------------
   {
     //wt_i = (1/r_i^2) / (sum{1/r_j^2})
-    double dist;
-    double denomsum;
-    const double IDW_POWER=2.0;
-    int atop_gauge(DOESNT_EXIST);
-    for (k=0;k<_nHydroUnits;k++)
-    {
-      xyh=_pHydroUnits[k]->GetCentroid();
-      atop_gauge=DOESNT_EXIST;
-      denomsum=0;
-      for (g=0;g<_nGauges;g++)
+    ParallelFor(_nHydroUnits,MIN_INIT_CHUNK,[&](int k1,int k2){
+      double dist;
+      double denomsum;
+      const double IDW_POWER=2.0;
+      int atop_gauge(DOESNT_EXIST);
+      location xyh,xyg;
+      for (int k=k1;k<k2;k++)
       {
-        if(has_data[g]){
-          xyg=_pGauges[g]->GetLocation();
-          dist=sqrt(pow(xyh.UTM_x-xyg.UTM_x,2)+pow(xyh.UTM_y-xyg.UTM_y,2));
-          denomsum+=pow(dist,-IDW_POWER);
-          if(dist<REAL_SMALL){ atop_gauge=g; }//handles limiting case where weight= large number/large number
+        xyh=_pHydroUnits[k]->GetCentroid();
+        atop_gauge=DOESNT_EXIST;
+        denomsum=0;
+        for (int g=0;g<_nGauges;g++)
+        {
+          if(has_data[g]){
+            xyg=_pGauges[g]->GetLocation();
+            dist=sqrt(pow(xyh.UTM_x-xyg.UTM_x,2)+pow(xyh.UTM_y-xyg.UTM_y,2));
+            denomsum+=pow(dist,-IDW_POWER);
+            if(dist<REAL_SMALL){ atop_gauge=g; }//handles limiting case where weight= large number/large number
+          }
         }
-      }
 
-      for (g=0;g<_nGauges;g++)
-      {
-        aWts[k][g]=0.0;
-        if(has_data[g]){
-          xyg=_pGauges[g]->GetLocation();
-          dist=sqrt(pow(xyh.UTM_x-xyg.UTM_x,2)+pow(xyh.UTM_y-xyg.UTM_y,2));
+        for (int g=0;g<_nGauges;g++)
+        {
+          aWts[k][g]=0.0;
+          if(has_data[g]){
+            xyg=_pGauges[g]->GetLocation();
+            dist=sqrt(pow(xyh.UTM_x-xyg.UTM_x,2)+pow(xyh.UTM_y-xyg.UTM_y,2));
 
-          if(atop_gauge!=DOESNT_EXIST){ aWts[k][g]=0.0;aWts[k][atop_gauge]=1.0; }
-          else                        { aWts[k][g]=pow(dist,-IDW_POWER)/denomsum;         }
+            if(atop_gauge!=DOESNT_EXIST){ aWts[k][g]=0.0;aWts[k][atop_gauge]=1.0; }
+            else                        { aWts[k][g]=pow(dist,-IDW_POWER)/denomsum;         }
+          }
         }
       }
-    }
-
+    });
     break;
   }
   case(INTERP_INVERSE_DISTANCE_ELEVATION):                    //---------------------------------------------
   {
     //wt_i = (1/r_i^2) / (sum{1/r_j^2})
-    double dist;
-    double elevh,elevg;
-    double denomsum;
-    const double IDW_POWER=2.0;
-    int atop_gauge(DOESNT_EXIST);
-    for(k=0; k<_nHydroUnits; k++)
-    {
-      elevh=_pHydroUnits[k]->GetElevation();
-      atop_gauge=DOESNT_EXIST;
-      denomsum=0;
-      for(g=0; g<_nGauges; g++)
+    ParallelFor(_nHydroUnits,MIN_INIT_CHUNK,[&](int k1,int k2){
+      double dist;
+      double elevh,elevg;
+      double denomsum;
+      const double IDW_POWER=2.0;
+      int atop_gauge(DOESNT_EXIST);
+      for(int k=k1; k<k2; k++)
       {
-        if(has_data[g]){
-          elevg=_pGauges[g]->GetElevation();
-          dist=abs(elevh-elevg);
-          denomsum+=pow(dist,-IDW_POWER);
-          if(dist<REAL_SMALL){ atop_gauge=g; }//handles limiting case where weight= large number/large number
+        elevh=_pHydroUnits[k]->GetElevation();
+        atop_gauge=DOESNT_EXIST;
+        denomsum=0;
+        for(int g=0; g<_nGauges; g++)
+        {
+          if(has_data[g]){
+            elevg=_pGauges[g]->GetElevation();
+            dist=abs(elevh-elevg);
+            denomsum+=pow(dist,-IDW_POWER);
+            if(dist<REAL_SMALL){ atop_gauge=g; }//handles limiting case where weight= large number/large number
+          }
         }
-      }
 
-      for(g=0; g<_nGauges; g++)
-      {
-        aWts[k][g]=0.0;
-        if(has_data[g]){
-          elevg=_pGauges[g]->GetElevation();
-          dist=abs(elevh-elevg);
-          if(atop_gauge!=DOESNT_EXIST){ aWts[k][g]=0.0; aWts[k][atop_gauge]=1.0; }
-          else                        { aWts[k][g]=pow(dist,-IDW_POWER)/denomsum; }
+        for(int g=0; g<_nGauges; g++)
+        {
+          aWts[k][g]=0.0;
+          if(has_data[g]){
+            elevg=_pGauges[g]->GetElevation();
+            dist=abs(elevh-elevg);
+            if(atop_gauge!=DOESNT_EXIST){ aWts[k][g]=0.0; aWts[k][atop_gauge]=1.0; }
+            else                        { aWts[k][g]=pow(dist,-IDW_POWER)/denomsum; }
+          }
         }
       }
-    }
-
+    });
     break;
   }
   case (INTERP_FROM_FILE):                    //---------------------------------------------
@@ -1078,6 +1273,101 @@ void CModel::GenerateGaugeWeights(double **&aWts, const forcing_type forcing, co
   delete[] has_data;
 }
 //////////////////////////////////////////////////////////////////
+/// \brief Converts dense gauge weights to sparse (compressed row) form
+/// \details only non-zero weights are stored, in order of increasing gauge index;
+///          also flags which gauges are used by any HRU. Dense array is deleted.
+///
+/// \param aWts [in/out] dense weights matrix [nHRUs][nGauges] (deleted on return; NULL if no weights)
+/// \param W    [out] sparse weights
+//
+void CModel::CompressGaugeWeights(double **&aWts, gauge_weights &W) const
+{
+  int k,g,nnz=0;
+  W.Clear();
+  if(aWts!=NULL){
+    for (k=0;k<_nHydroUnits;k++){
+      for (g=0;g<_nGauges;g++){
+        if(aWts[k][g]!=0.0){nnz++;}
+      }
+    }
+  }
+  W.aStart=new int   [_nHydroUnits+1];
+  W.aGauge=new int   [max(nnz,1)];
+  W.aWt   =new double[max(nnz,1)];
+  W.aUsed =new bool  [max(_nGauges,1)];
+  ExitGracefullyIf(W.aUsed==NULL,"CompressGaugeWeights",OUT_OF_MEMORY);
+  for (g=0;g<_nGauges;g++){W.aUsed[g]=false;}
+
+  int j=0;
+  for (k=0;k<_nHydroUnits;k++){
+    W.aStart[k]=j;
+    if(aWts==NULL){continue;}
+    for (g=0;g<_nGauges;g++){
+      if(aWts[k][g]!=0.0){
+        W.aGauge[j]=g;
+        W.aWt   [j]=aWts[k][g];
+        W.aUsed [g]=true;
+        j++;
+      }
+    }
+  }
+  W.aStart[_nHydroUnits]=j;
+
+  if(aWts!=NULL){
+    for (k=0;k<_nHydroUnits;k++){delete [] aWts[k];} delete [] aWts; aWts=NULL;
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Groups HRUs into classes of identical solar geometry
+/// \details HRUs with the same latitude, slope and aspect (and elevation, if
+///  UBCWM shortwave radiation is used) receive identical extraterrestrial and
+///  clear sky radiation, which is then calculated once per class per time step
+///  (see GetSolarGeometry)
+///
+/// \param Options [in] global options structure
+//
+void CModel::GenerateSolarClasses(const optStruct &Options)
+{
+  int k,c;
+  typedef tuple<double,double,double,double> solar_key; //(latrad,slope,aspect,elev)
+  map<solar_key,int> class_lookup;
+  delete [] _aSolarClasses;    _aSolarClasses=NULL;
+  delete [] _aSolarClassIndex; _aSolarClassIndex=NULL;
+  _nSolarClasses=0;
+
+  _aSolarClasses   =new solar_geom[max(_nHydroUnits,1)];
+  _aSolarClassIndex=new int       [max(_nHydroUnits,1)];
+  ExitGracefullyIf(_aSolarClassIndex==NULL,"CModel::GenerateSolarClasses",OUT_OF_MEMORY);
+
+  for (k=0;k<_nHydroUnits;k++)
+  {
+    solar_geom S;
+    S.latrad       =_pHydroUnits[k]->GetLatRad();
+    S.slope        =_pHydroUnits[k]->GetSlope();
+    S.aspect       =_pHydroUnits[k]->GetAspect();
+    S.elev         =0.0;
+    if (Options.SW_radiation==SW_RAD_UBCWM){S.elev=_pHydroUnits[k]->GetElevation();}
+    S.t_cached     =-ALMOST_INF;
+    S.opt_air_mass =0.0;
+    S.ET_radia     =0.0;
+    S.ET_radia_flat=0.0;
+    S.clear_sky    =0.0;
+
+    solar_key key(S.latrad,S.slope,S.aspect,S.elev);
+    map<solar_key,int>::const_iterator it=class_lookup.find(key);
+    if (it!=class_lookup.end()){
+      c=it->second;
+    }
+    else {
+      c=_nSolarClasses;
+      _aSolarClasses[_nSolarClasses]=S;_nSolarClasses++;
+      class_lookup[key]=c;
+    }
+    _aSolarClassIndex[k]=c;
+  }
+  if (Options.noisy){cout<<"     "<<_nSolarClasses<<" distinct HRU solar geometry classes"<<endl;}
+}
+//////////////////////////////////////////////////////////////////
 /// \brief reboots all necessary variables for ensemble mode
 //
 void CModel::RebootTimeVariables(const optStruct &Options)
@@ -1105,4 +1395,6 @@ void CModel::RebootTimeVariables(const optStruct &Options)
   }
   _CumulInput   =_CumulOutput  =0.0;
 
+  InitializeDiagAccums(Options);
+  _terminated_early=false;
 }
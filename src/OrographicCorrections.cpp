@@ -367,8 +367,9 @@ void CModel::CorrectPET(const optStruct &Options,
   {
     double sat_vap_max,sat_vap_min,c1,ch;
     double max_month_temp(0.0),min_month_temp(0.0);
-    for (int g=0;g<_nGauges;g++)
+    for (int j=_GaugeWtsTemp.aStart[k];j<_GaugeWtsTemp.aStart[k+1];j++)
     {
+      int g=_GaugeWtsTemp.aGauge[j];
       double max=-ALMOST_INF;
       double min=ALMOST_INF;
       double tmp;
@@ -377,8 +378,8 @@ void CModel::CorrectPET(const optStruct &Options,
         upperswap(max,tmp);
         lowerswap(min,tmp);
       }
-      max_month_temp+=_aGaugeWtTemp[k][g]*max;
-      min_month_temp+=_aGaugeWtTemp[k][g]*min;
+      max_month_temp+=_GaugeWtsTemp.aWt[j]*max;
+      min_month_temp+=_GaugeWtsTemp.aWt[j]*min;
     }
 
     sat_vap_max=GetSaturatedVaporPressure(max_month_temp);
@@ -82,6 +82,7 @@ bool ParseEnsembleFile(CModel *&pModel,const optStruct &Options)
     else if(!strcmp(s[0],":ObservationErrorModel"))       { code=16; }
     else if(!strcmp(s[0],":EnKFMode"))                    { code=18; }
     else if(!strcmp(s[0],":ExtraRVTFilename"))            { code=19; }
+    else if(!strcmp(s[0],":EarlyTermination"))            { code=20; }
     else if(!strcmp(s[0],":AssimilateStreamflow"))        { code=101;}
 
     switch(code)
@@ -466,6 +467,17 @@ bool ParseEnsembleFile(CModel *&pModel,const optStruct &Options)
       }
       break;
     }
+    case(20):  //----------------------------------------------
+    {/*:EarlyTermination*/
+      if(Options.noisy) { cout <<":EarlyTermination"<<endl; }
+      if(pEnsemble->GetType()==ENSEMBLE_DDS) {
+        ((CDDSEnsemble*)(pEnsemble))->SetEarlyTermination(true);
+      }
+      else {
+        WriteWarning(":EarlyTermination command will be ignored; only valid for DDS calibration.",Options.noisy);
+      }
+      break;
+    }
     case(101)://----------------------------------------------
     {/*:AssimilateStreamflow  [SBID]*/
       if(Options.noisy) { cout <<"Assimilate streamflow"<<endl; }
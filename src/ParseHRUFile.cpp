@@ -10,6 +10,7 @@
 #include "ControlStructures.h"
 #include "LatConnect.h"
 #include "IceFlow.h"
+#include <vector>
 
 CReservoir *ReservoirParse(CParser *p,string name,const CModel *pModel,long long int &HRUID,const optStruct &Options);
 
@@ -102,6 +103,8 @@ bool ParseHRUPropsFile(CModel *&pModel, const optStruct &Options, bool terrain_r
     else if  (!strcmp(s[0],":GaugedSubBasinGroup"      )){code=20; }
     else if  (!strcmp(s[0],":LateralConnections"       )){code=21; }
     else if  (!strcmp(s[0],":HRUFlowLengths"           )){code=22; }
+    else if  (!strcmp(s[0],":OutputHRUSelection"       )){code=23; }
+    else if  (!strcmp(s[0],":OutputSubBasinSelection"  )){code=24; }
 
     switch(code)
     {
@@ -496,8 +499,6 @@ bool ParseHRUPropsFile(CModel *&pModel, const optStruct &Options, bool terrain_r
         }
         else
         {
-          int k;
-          int nHRUs=pModel->GetNumHRUs();
           for (i=0;i<Len;i++)
           {
             long long int ind1,ind2;
@@ -507,14 +508,9 @@ bool ParseHRUPropsFile(CModel *&pModel, const optStruct &Options, bool terrain_r
             bool gaps(false);
             for (long long int ii=ind1;ii<=ind2;ii++)
             {
-              found=false;
-              for (k=0;k<nHRUs;k++)
-              {
-                if (pModel->GetHydroUnit(k)->GetHRUID()==ii)
-                {
-                  pHRUGrp->AddHRU(pModel->GetHydroUnit(k));found=true; break;
-                }
-              }
+              CHydroUnit *pHRU=pModel->GetHRUByID(ii);
+              found=(pHRU!=NULL);
+              if (found){pHRUGrp->AddHRU(pHRU);}
               if ((!found) && (ind2-ind1>1)){gaps=true;}
               if((!found) && (ind1==ind2)) {
                 string warn="HRU ID "+to_string(ii)+" specified in :HRUGroup command for group "+pHRUGrp->GetName()+ " does not exist";
@@ -688,17 +684,11 @@ bool ParseHRUPropsFile(CModel *&pModel, const optStruct &Options, bool terrain_r
         else
         {
           int p;
-          int nSBs=pModel->GetNumSubBasins();
           for(i=0;i<Len;i++)
           {
             SBID=s_to_ll(s[i]);
-            for(p=0;p<nSBs;p++)
-            {
-              if(pModel->GetSubBasin(p)->GetID()==SBID)
-              {
-                pSBGrp->AddSubbasin(pModel->GetSubBasin(p));break;
-              }
-            }
+            p=pModel->GetSubBasinIndex(SBID);
+            if ((p!=DOESNT_EXIST) && (p!=INDEX_NOT_FOUND)){pSBGrp->AddSubbasin(pModel->GetSubBasin(p));}
           }
         }
       }
@@ -1234,6 +1224,113 @@ bool ParseHRUPropsFile(CModel *&pModel, const optStruct &Options, bool terrain_r
       }
       break;
     }
+    case(23):  //----------------------------------------------
+    { /*
+      :OutputHRUSelection {HRUGroup}
+      or
+      :OutputHRUSelection {ID1} {ID2} {ID3-ID4} ...
+      e.g.,
+      :OutputHRUSelection ForestHRUs
+      restricts HRU-based output (custom output by HRU, HRU storage) to the selected HRUs
+      may be repeated; selections are merged. HRU groups must be populated before this command
+      */
+      if (Options.noisy) { cout << "   Output HRU Selection..." << endl; }
+      if (Len < 2) { pp->ImproperFormat(s); break; }
+
+      CHRUGroup *pHRUGrp=NULL;
+      if (Len==2){pHRUGrp=pModel->GetHRUGroup(s[1]);}
+      if (pHRUGrp!=NULL)
+      {
+        int *aHRUs=new int [pHRUGrp->GetNumHRUs()+1];
+        ExitGracefullyIf(aHRUs==NULL,":OutputHRUSelection",OUT_OF_MEMORY);
+        for (int k=0;k<pHRUGrp->GetNumHRUs();k++){aHRUs[k]=pHRUGrp->GetHRU(k)->GetGlobalIndex();}
+        pModel->AddOutputHRUs(aHRUs,pHRUGrp->GetNumHRUs());
+        delete [] aHRUs;
+      }
+      else
+      {
+        vector<int> aSelected; //collected first, so that selection is extended once per command
+        for (i=1;i<Len;i++)
+        {
+          if ((s[i][0]<'0') || (s[i][0]>'9')){
+            string warn=":OutputHRUSelection: HRU ID or HRU group "+string(s[i])+" does not exist";
+            WriteWarning(warn.c_str(),Options.noisy);
+            continue;
+          }
+          long long int ind1,ind2;
+          s_to_range(s[i],ind1,ind2);
+          ExitGracefullyIf((ind2-ind1)>10000,"Parsing :OutputHRUSelection command: invalid range of HRU indices",BAD_DATA);
+          for (long long int ii=ind1;ii<=ind2;ii++)
+          {
+            CHydroUnit *pHRU=pModel->GetHRUByID(ii);
+            if (pHRU!=NULL){
+              aSelected.push_back(pHRU->GetGlobalIndex());
+            }
+            else if (ind1==ind2){
+              string warn=":OutputHRUSelection: HRU ID or HRU group "+string(s[i])+" does not exist";
+              WriteWarning(warn.c_str(),Options.noisy);
+            }
+          }
+        }
+        if (!aSelected.empty()){pModel->AddOutputHRUs(&aSelected[0],(int)(aSelected.size()));}
+      }
+      break;
+    }
+    case(24):  //----------------------------------------------
+    { /*
+      :OutputSubBasinSelection {SubBasinGroup}
+      or
+      :OutputSubBasinSelection {ID1} {ID2} {ID3-ID4} ...
+      e.g.,
+      :OutputSubBasinSelection KeyBasins
+      restricts subbasin-based output (hydrographs, reservoir stages, custom output by subbasin, etc.) to the
+      selected subbasins; only subbasins which are also gauged are written to standard output files
+      may be repeated; selections are merged
+      NOTE: unselected subbasins are set to ungauged during model initialization (see CModel::FinalizeOutputSelection),
+      which also affects any other code (e.g., management optimization output) that queries CSubBasin::IsGauged()
+      */
+      if (Options.noisy) { cout << "   Output SubBasin Selection..." << endl; }
+      if (Len < 2) { pp->ImproperFormat(s); break; }
+
+      CSubbasinGroup *pSBGroup=NULL;
+      if (Len==2){pSBGroup=pModel->GetSubBasinGroup(s[1]);}
+      if (pSBGroup!=NULL)
+      {
+        int *aSBs=new int [pSBGroup->GetNumSubbasins()+1];
+        ExitGracefullyIf(aSBs==NULL,":OutputSubBasinSelection",OUT_OF_MEMORY);
+        for (int p=0;p<pSBGroup->GetNumSubbasins();p++){aSBs[p]=pModel->GetSubBasinIndex(pSBGroup->GetSubBasin(p)->GetID());}
+        pModel->AddOutputSubBasins(aSBs,pSBGroup->GetNumSubbasins());
+        delete [] aSBs;
+      }
+      else
+      {
+        vector<int> aSelected; //collected first, so that selection is extended once per command
+        for (i=1;i<Len;i++)
+        {
+          if ((s[i][0]<'0') || (s[i][0]>'9')){
+            string warn=":OutputSubBasinSelection: subbasin ID or subbasin group "+string(s[i])+" does not exist";
+            WriteWarning(warn.c_str(),Options.noisy);
+            continue;
+          }
+          long long int ind1,ind2;
+          s_to_range(s[i],ind1,ind2);
+          ExitGracefullyIf((ind2-ind1)>10000,"Parsing :OutputSubBasinSelection command: invalid range of subbasin IDs",BAD_DATA);
+          for (long long int ii=ind1;ii<=ind2;ii++)
+          {
+            int p=pModel->GetSubBasinIndex(ii);
+            if (p>=0){
+              aSelected.push_back(p);
+            }
+            else if (ind1==ind2){
+              string warn=":OutputSubBasinSelection: subbasin ID or subbasin group "+string(s[i])+" does not exist";
+              WriteWarning(warn.c_str(),Options.noisy);
+            }
+          }
+        }
+        if (!aSelected.empty()){pModel->AddOutputSubBasins(&aSelected[0],(int)(aSelected.size()));}
+      }
+      break;
+    }
     default://------------------------------------------------
     {
       char firstChar = *(s[0]);
@@ -10,8 +10,10 @@
 #include "EnergyTransport.h"
 #include "IsotopeTransport.h"
 #include "AgeTracers.h"
+#include "Checkpoint.h"
 
 void SetInitialStateVar(CModel *&pModel,const int SVind,const sv_type typ,const int m,const int k,const double &val);
+bool ParseBinaryCheckpointFile(CModel *&pModel,const optStruct &Options,double &time_diff);
 //////////////////////////////////////////////////////////////////
 /// \brief Parses Initial conditions file
 /// \details model.rvc: input file that defines HRU and Subbasin initial conditions\n
@@ -76,8 +78,17 @@ bool ParseInitialConditionsFile(CModel *&pModel, const optStruct &Options)
       }
     }
   }
+  //--Binary checkpoint file (.rvb) written by :WriteBinaryCheckpoint--
+  bool end_of_file=false;
+  if (CCheckpointReader::IsCheckpointFile(Options.rvc_filename))
+  {
+    if (!ParseBinaryCheckpointFile(pModel,Options,time_diff)){IC.close();delete pp;return false;}
+    end_of_file=true;
+  }
   //--Sift through file-----------------------------------------------
-  bool end_of_file=pp->Tokenize(s,Len);
+  else{
+    end_of_file=pp->Tokenize(s,Len);
+  }
   while (!end_of_file)
   {
     if (ended){break;}
@@ -1114,3 +1125,297 @@ void SetInitialStateVar(CModel *&pModel,const int SVind,const sv_type typ,const
     pModel->GetHydroUnit(k)->SetStateVarValue(SVind,mass);
   }
 }
+
+//////////////////////////////////////////////////////////////////
+/// \brief returns true if state variable is not restored from initial conditions file
+/// \details cumulative precip, evaporation and glacier loss (and constituents stored in them) are left at zero
+//
+static bool IsIgnoredInitialCondition(CModel *&pModel,const optStruct &Options,const sv_type typ,const int layer_ind)
+{
+  if ((typ==ATMOS_PRECIP) || (typ==ATMOSPHERE) || ((typ==GLACIER_ICE) && (!Options.glacier_model_on))){return true;}
+  if (typ==CONSTITUENT){
+    int ii=pModel->GetTransportModel()->GetWaterStorIndexFromLayer(layer_ind);
+    if (ii!=DOESNT_EXIST){
+      sv_type wattyp=pModel->GetStateVarType(ii);
+      if ((wattyp==ATMOS_PRECIP) || (wattyp==ATMOSPHERE) || ((wattyp==GLACIER_ICE) && (!Options.glacier_model_on))){return true;}
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief reads array of n values (plus one trailing value, if with_last) from binary checkpoint into new array
+/// \param n [out] size of array, as stored in file
+//
+static double *GetCheckpointArray(CCheckpointReader &CHK,int &n,const bool with_last)
+{
+  n=CHK.Get<int>();
+  ExitGracefullyIf((!CHK.ok()) || (n<0),"ParseBinaryCheckpointFile: corrupt binary checkpoint file",BAD_DATA);
+  double *a=new double [n+1];
+  ExitGracefullyIf(a==NULL,"ParseBinaryCheckpointFile",OUT_OF_MEMORY);
+  a[n]=0.0;
+  CHK.GetArray(a,(with_last) ? n+1 : n);
+  return a;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Parses binary checkpoint file (.rvb) written by :WriteBinaryCheckpoint
+/// \details equivalent of the .rvc solution file written at the same time. The file is memory-mapped; if the HRUs and
+/// state variables of the model match those of the run which wrote the file, each HRU's state variables are copied
+/// in one block. Otherwise, values are matched by HRU ID and state variable type, as for :HRUStateVariableTable
+///
+/// \param *&pModel [out] Reference to model object
+/// \param &Options [in] Global model options information
+/// \param &time_diff [out] time between start of run which wrote file and start of this run [d]
+/// \return True if operation is successful
+//
+bool ParseBinaryCheckpointFile(CModel *&pModel,const optStruct &Options,double &time_diff)
+{
+  CCheckpointReader CHK;
+  if (!CHK.Open(Options.rvc_filename)){
+    cout << "ERROR reading binary checkpoint file: "<<Options.rvc_filename<<endl; return false;}
+
+  time_struct tt;
+  JulianConvert(0.0,Options.julian_start_day,Options.julian_start_year,Options.calendar,tt);
+
+  //equivalent of :TimeStamp, :TimeStep and :StartTime commands
+  if ((fabs(Options.julian_start_day-CHK.stamp_day)>TIME_CORRECTION) || (Options.julian_start_year!=CHK.stamp_year)){
+    WriteWarning("Time stamp of binary checkpoint (.rvb) file is not consistent with :StartDate command in model (.rvi) file",Options.noisy);
+  }
+  double rvc_tstep=CHK.tstep;
+  if (fabs(rvc_tstep-Options.timestep)>REAL_SMALL){
+    WriteAdvisory("ParseBinaryCheckpointFile: checkpoint file generated by model with different simulation time step. Inflow and lateral flow histories have been rescaled.",Options.noisy);
+  }
+  time_diff=TimeDifference(CHK.start_day,CHK.start_year,Options.julian_start_day,Options.julian_start_year,Options.calendar);
+
+  int         nSV=pModel->GetNumStateVars();
+  rvb_section type=RVB_END;
+  while (CHK.NextSection(type))
+  {
+    if (type==RVB_HRU_STATES)
+    {
+      if (Options.noisy) {cout <<"   Reading HRU state variables"<<endl;}
+      int nHRUsFile=CHK.Get<int>();
+      int nSVFile  =CHK.Get<int>();
+      ExitGracefullyIf((!CHK.ok()) || (nHRUsFile<0) || (nSVFile<0),
+        "ParseBinaryCheckpointFile: corrupt HRU state variable section",BAD_DATA);
+
+      int  *SVinds =new int [nSVFile];
+      bool *ignored=new bool[nSVFile];
+      ExitGracefullyIf(ignored==NULL,"ParseBinaryCheckpointFile",OUT_OF_MEMORY);
+      bool same_SVs=(nSVFile==nSV);
+      for (int i=0;i<nSVFile;i++)
+      {
+        int typ      =CHK.Get<int>();
+        int layer_ind=CHK.Get<int>();
+        SVinds [i]=DOESNT_EXIST;
+        ignored[i]=false;
+        if ((typ>=0) && (typ<MAX_STATE_VAR_TYPES) && (layer_ind>=DOESNT_EXIST) && (layer_ind<MAX_SV_LAYERS)){
+          SVinds[i]=pModel->GetStateVarIndex((sv_type)(typ),layer_ind);
+        }
+        if (SVinds[i]!=DOESNT_EXIST){
+          ignored[i]=IsIgnoredInitialCondition(pModel,Options,(sv_type)(typ),layer_ind);
+        }
+        if (SVinds[i]!=i){same_SVs=false;}
+      }
+      bool same_HRUs=(nHRUsFile==pModel->GetNumHRUs());
+      long long *HRUIDs=new long long [nHRUsFile];
+      ExitGracefullyIf(HRUIDs==NULL,"ParseBinaryCheckpointFile",OUT_OF_MEMORY);
+      for (int k=0;k<nHRUsFile;k++){
+        HRUIDs[k]=CHK.Get<long long>();
+        if ((same_HRUs) && (pModel->GetHydroUnit(k)->GetHRUID()!=HRUIDs[k])){same_HRUs=false;}
+      }
+
+      if ((same_SVs) && (same_HRUs))
+      {
+        //bulk copy of each HRU's state variable array; ignored variables keep their current value
+        int nIgnored=0;
+        int *aIgnored=new int [nSV];
+        double *keep =new double [nSV];
+        ExitGracefullyIf(keep==NULL,"ParseBinaryCheckpointFile",OUT_OF_MEMORY);
+        for (int i=0;i<nSV;i++){if (ignored[i]){aIgnored[nIgnored]=i;nIgnored++;}}
+        for (int k=0;k<nHRUsFile;k++)
+        {
+          double *aSV=pModel->GetHydroUnit(k)->GetStateVarArray();
+          for (int j=0;j<nIgnored;j++){keep[j]=aSV[aIgnored[j]];}
+          CHK.GetArray(aSV,nSV);
+          for (int j=0;j<nIgnored;j++){aSV[aIgnored[j]]=keep[j];}
+        }
+        delete [] aIgnored;
+        delete [] keep;
+      }
+      else
+      {
+        double *row=new double [nSVFile];
+        ExitGracefullyIf(row==NULL,"ParseBinaryCheckpointFile",OUT_OF_MEMORY);
+        for (int i=0;i<nSVFile;i++){
+          if (SVinds[i]==DOESNT_EXIST){
+            WriteWarning("ParseBinaryCheckpointFile: checkpoint file includes state variable not in model",Options.noisy);break;
+          }
+        }
+        for (int k=0;k<nHRUsFile;k++)
+        {
+          CHK.GetArray(row,nSVFile);
+          CHydroUnit *pHRU=pModel->GetHRUByID(HRUIDs[k]);
+          if (pHRU==NULL){
+            WriteWarning("HRU ID ["+to_string(HRUIDs[k])+"] in binary checkpoint file not found in model",Options.noisy);
+            continue;
+          }
+          for (int i=0;i<nSVFile;i++){
+            if ((SVinds[i]!=DOESNT_EXIST) && (!ignored[i])){pHRU->SetStateVarValue(SVinds[i],row[i]);}
+          }
+        }
+        delete [] row;
+      }
+      delete [] SVinds;
+      delete [] ignored;
+      delete [] HRUIDs;
+    }
+    else if (type==RVB_BASIN_STATES)
+    {
+      if (Options.noisy) {cout <<"   Reading Basin State Variables"<<endl;}
+      int nBasins=CHK.Get<int>();
+      for (int pp=0;(pp<nBasins) && (CHK.ok());pp++)
+      {
+        long long SBID=CHK.Get<long long>();
+        double    chan=CHK.Get<double>();
+        double    riv =CHK.Get<double>();
+        int nsegs,nQlat,nQin;
+        double *aQout=GetCheckpointArray(CHK,nsegs,true);
+        double *aQlat=GetCheckpointArray(CHK,nQlat,true);
+        double *aQin =GetCheckpointArray(CHK,nQin ,false);
+        bool has_res =(CHK.Get<int>()!=0);
+
+        CSubBasin *pBasin=pModel->GetSubBasinByID(SBID);
+        ExitGracefullyIf(pBasin==NULL,
+                         "ParseBinaryCheckpointFile: bad basin index in binary checkpoint file",BAD_DATA);
+        pBasin->SetChannelStorage(chan);
+        pBasin->SetRivuletStorage(riv);
+        pBasin->SetQoutArray(nsegs,aQout,aQout[nsegs]);
+        pBasin->SetQlatHist (nQlat,aQlat,aQlat[nQlat],rvc_tstep,Options.timestep);
+        pBasin->SetQinHist  (nQin ,aQin ,rvc_tstep,Options.timestep);
+        delete [] aQout;
+        delete [] aQlat;
+        delete [] aQin;
+
+        if (has_res)
+        {
+          double Q    =CHK.Get<double>(), Qlast    =CHK.Get<double>();
+          double stage=CHK.Get<double>(), stagelast=CHK.Get<double>();
+          double DA   =CHK.Get<double>(), DAlast   =CHK.Get<double>();
+          int nCS=CHK.Get<int>();
+          ExitGracefullyIf((!CHK.ok()) || (nCS<0),"ParseBinaryCheckpointFile: corrupt binary checkpoint file",BAD_DATA);
+          double *aQstruct=new double [2*nCS+1];
+          ExitGracefullyIf(aQstruct==NULL,"ParseBinaryCheckpointFile",OUT_OF_MEMORY);
+          CHK.GetArray(aQstruct,2*nCS);
+
+          CReservoir *pRes=pBasin->GetReservoir();
+          if (pRes!=NULL){
+            pRes->SetInitialFlow(Q,Qlast,true,tt,Options);
+            pRes->SetReservoirStage(stage,stagelast);
+            if ((DA!=0.0) || (DAlast!=0.0)){pRes->SetDataAssimFactors(DA,DAlast);}
+            for (int i=0;i<min(nCS,pRes->GetNumControlStructures());i++){
+              pRes->SetControlFlow(i,aQstruct[i],aQstruct[nCS+i]);
+            }
+          }
+          else{
+            WriteWarning("ParseBinaryCheckpointFile: reservoir initial conditions for basin without reservoir will be ignored.",Options.noisy);
+          }
+          delete [] aQstruct;
+        }
+      }
+    }
+    else if (type==RVB_TRANSPORT)
+    {
+      string name=CHK.GetString();
+      int c=pModel->GetTransportModel()->GetConstituentIndex(name);
+      if (c==DOESNT_EXIST) {
+        WriteWarning("Unrecognized constituent "+name+" in binary checkpoint file. Transport variables were ignored.",Options.noisy);
+        CHK.SkipSection();
+        continue;
+      }
+      CConstituentModel *pConstit=pModel->GetTransportModel()->GetConstituentModel(c);
+      if (Options.noisy) { cout <<"   Reading Basin Transport Variables for constituent "<<pConstit->GetName()<<endl; }
+
+      int nBasins=CHK.Get<int>();
+      for (int pp=0;(pp<nBasins) && (CHK.ok());pp++)
+      {
+        long long SBID=CHK.Get<long long>();
+        double    chan=CHK.Get<double>();
+        double    riv =CHK.Get<double>();
+        int nsegs,nMlat,nMin;
+        double *aMout=GetCheckpointArray(CHK,nsegs,true);
+        double *aMlat=GetCheckpointArray(CHK,nMlat,true);
+        double *aMin =GetCheckpointArray(CHK,nMin ,false);
+
+        CSubBasin *pBasin=pModel->GetSubBasinByID(SBID);
+        ExitGracefullyIf(pBasin==NULL,
+                         "ParseBinaryCheckpointFile: bad basin index in binary checkpoint file",BAD_DATA);
+        int p=pBasin->GetGlobalIndex();
+        pConstit->SetChannelMass(p,chan);
+        pConstit->SetRivuletMass(p,riv);
+        pConstit->SetMoutArray  (p,nsegs,aMout,aMout[nsegs]);
+        pConstit->SetMlatHist   (p,nMlat,aMlat,aMlat[nMlat]);
+        pConstit->SetMinHist    (p,nMin ,aMin);
+        delete [] aMout;
+        delete [] aMlat;
+        delete [] aMin;
+
+        if (CHK.Get<int>()!=0) //reservoir
+        {
+          double Mout=CHK.Get<double>(), Moutlast=CHK.Get<double>();
+          double Mres=CHK.Get<double>(), Mreslast=CHK.Get<double>();
+          double Msed=CHK.Get<double>(), Msedlast=CHK.Get<double>();
+          pConstit->SetReservoirMassOutflow(p,Mout,Moutlast);
+          pConstit->SetInitialReservoirMass(p,Mres,Mreslast);
+          pConstit->SetInitReservoirSedMass(p,Msed,Msedlast);
+        }
+        if (CHK.Get<int>()!=0) //bed temperature
+        {
+          double Tbed=CHK.Get<double>();
+          if (pConstit->GetType()==ENTHALPY){((CEnthalpyModel*)(pConstit))->SetBedTemperature(p,Tbed);}
+        }
+      }
+    }
+    else if (type==RVB_MANAGEMENT)
+    {
+      if (!Options.management_optimization){CHK.SkipSection();continue;}
+      CDemandOptimizer *pDO=pModel->GetManagementOptimizer();
+
+      int nVars=CHK.Get<int>();
+      for (int i=0;(i<nVars) && (CHK.ok());i++){
+        string name=CHK.GetString();
+        double val =CHK.Get<double>();
+        pDO->SetWorkflowVariable(name,val);
+      }
+      int nHist  =CHK.Get<int>();
+      int nBasins=CHK.Get<int>();
+      ExitGracefullyIf((!CHK.ok()) || (nHist<0),"ParseBinaryCheckpointFile: corrupt binary checkpoint file",BAD_DATA);
+      double *aHist=new double [nHist+1];
+      ExitGracefullyIf(aHist==NULL,"ParseBinaryCheckpointFile",OUT_OF_MEMORY);
+      const char codes[4]={'Q','I','h','A'};
+      for (int pp=0;(pp<nBasins) && (CHK.ok());pp++)
+      {
+        CSubBasin *pSB=pModel->GetSubBasinByID(CHK.Get<long long>());
+        int nItems=(CHK.Get<int>()!=0) ? 4 : 1; //flow only, or flow and reservoir inflow, stage and area
+        for (int j=0;j<nItems;j++){
+          CHK.GetArray(aHist,nHist);
+          if (pSB==NULL){continue;}//likely disabled in previous run
+          for (int i=0;i<nHist;i++){
+            pDO->SetHistoryVariable(codes[j],pSB->GetGlobalIndex(),i,aHist[i]);
+          }
+        }
+      }
+      delete [] aHist;
+    }
+    else
+    {
+      CHK.SkipSection(); //written by newer version of Raven
+    }
+    if (!CHK.ok()){break;}
+  }
+  if ((!CHK.ok()) || (type!=RVB_END)){
+    cout << "ERROR: binary checkpoint file "<<Options.rvc_filename<<" is truncated or corrupt"<<endl; return false;
+  }
+  return true;
+}
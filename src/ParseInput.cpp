@@ -250,6 +250,7 @@ bool ParseMainInputFile (CModel     *&pModel,
 
   Options.interpolation           =INTERP_NEAREST_NEIGHBOR;
   Options.interp_file             ="";
+  Options.ts_cache_dir            ="";
 
   Options.num_soillayers          =-1;//used to check if SoilModel command is used
   Options.soil_representation     =BROOKS_COREY;
@@ -322,6 +323,9 @@ bool ParseMainInputFile (CModel     *&pModel,
   Options.write_localflow         =false;
   Options.write_netresinflow      =false;
   Options.suppressICs             =false;
+  Options.async_output            =false;
+  Options.write_binary_rvc        =false;
+  Options.write_text_rvc          =true;
   Options.period_ending           =false;
   Options.period_starting         =false;
   Options.write_group_mb          =DOESNT_EXIST;
@@ -347,6 +351,8 @@ bool ParseMainInputFile (CModel     *&pModel,
   Options.glacier_model_on        =false;
 
   Options.NetCDF_chunk_mem        =10; //MB
+  Options.NetCDF_deflate_level    =NETCDF_DEFLATE_LEVEL;
+  Options.NetCDF_time_chunk       =0;
 
   Options.management_optimization =false;
 
@@ -497,6 +503,15 @@ bool ParseMainInputFile (CModel     *&pModel,
     else if  (!strcmp(s[0],":TimeOfConcentrationMethod" )){code=113;}
     else if  (!strcmp(s[0],":StateOverrideEndTime"      )){code=114;}//AFTER :StartDate,:Calendar commands
     else if  (!strcmp(s[0],":NetCDFUseBasinFullname"    )){code=115;}
+    else if  (!strcmp(s[0],":TimeSeriesCache"           )){code=116;}
+    else if  (!strcmp(s[0],":AsyncOutput"               )){code=117;}
+    else if  (!strcmp(s[0],":NetCDFDeflateLevel"        )){code=118;}
+    else if  (!strcmp(s[0],":NetCDFTimeChunkSize"       )){code=119;}
+    else if  (!strcmp(s[0],":WriteBinaryFormat"         )){code=120;}
+    else if  (!strcmp(s[0],":WarningLimit"              )){code=121;}
+    else if  (!strcmp(s[0],":ObjectiveBound"            )){code=122;}
+    else if  (!strcmp(s[0],":WriteBinaryCheckpoint"     )){code=123;}
+    else if  (!strcmp(s[0],":NumThreads"                )){code=124;}
 
     else if  (!strcmp(s[0],":WriteGroundwaterHeads"     )){code=510;}//GWMIGRATE -TO REMOVE
     else if  (!strcmp(s[0],":WriteGroundwaterFlows"     )){code=511;}//GWMIGRATE -TO REMOVE
@@ -2006,6 +2021,82 @@ bool ParseMainInputFile (CModel     *&pModel,
       Options.use_fullname_cf_role=true;
       break;
     }
+    case(116):  //--------------------------------------------
+    {/*:TimeSeriesCache [directory]*/
+      if(Len<2) { ImproperFormatWarning(":TimeSeriesCache",p,Options.noisy); break; }
+      if(Options.noisy) { cout << "Time series cache directory: "<<s[1] << endl; }
+      string dir="";
+      for (int i=1;i<Len;i++){dir+=string(s[i]); if(i<Len-1){dir+=' ';}}//if spaces in folder name
+      Options.ts_cache_dir=CorrectForRelativePath(dir,Options.rvi_filename)+"/";
+      break;
+    }
+    case(117):  //--------------------------------------------
+    {/*:AsyncOutput */
+      if(Options.noisy) { cout << "Asynchronous output writing ON" << endl; }
+      Options.async_output=true;
+      break;
+    }
+    case(118):  //--------------------------------------------
+    {/*:NetCDFDeflateLevel [level, 0-9]*/
+      if(Options.noisy) { cout << "NetCDF output compression level" << endl; }
+      if(Len<2) { ImproperFormatWarning(":NetCDFDeflateLevel",p,Options.noisy); break; }
+      Options.NetCDF_deflate_level=min(max(s_to_i(s[1]),0),9);
+      break;
+    }
+    case(119):  //--------------------------------------------
+    {/*:NetCDFTimeChunkSize [number of time steps]*/
+      if(Options.noisy) { cout << "NetCDF output time chunk size" << endl; }
+      if(Len<2) { ImproperFormatWarning(":NetCDFTimeChunkSize",p,Options.noisy); break; }
+      Options.NetCDF_time_chunk=max(s_to_i(s[1]),1);
+      break;
+    }
+    case(120):  //--------------------------------------------
+    {/*:WriteBinaryFormat */
+      if(Options.noisy) { cout <<"Write Binary Format ON"<<endl; }
+      Options.output_format=OUTPUT_BINARY;
+      break;
+    }
+    case(121):  //--------------------------------------------
+    {/*:WarningLimit [max number of warnings written per message type, 0 for unlimited]*/
+      if(Options.noisy) { cout <<"Warning limit"<<endl; }
+      if(Len<2) { ImproperFormatWarning(":WarningLimit",p,Options.noisy); break; }
+      g_warning_limit=max(s_to_i(s[1]),0);
+      break;
+    }
+    case(122):  //--------------------------------------------
+    {/*:ObjectiveBound [SBID] [diagnostic] [bound] {period}
+       ends run once the diagnostic can no longer reach the bound (e.g., NSE above bound)*/
+      if(Options.noisy) { cout <<"Objective bound"<<endl; }
+      if(Len<4) { ImproperFormatWarning(":ObjectiveBound",p,Options.noisy); break; }
+      if(pModel==NULL) {
+        WriteWarning(":ObjectiveBound command must be after the :SoilModel command in the .rvi file. This command will be ignored.",Options.noisy); break;
+      }
+      diag_type diag=StringToDiagnostic(s[2]);
+      if(!CDiagnostic::HasAchievableBound(diag)) {
+        WriteWarning(":ObjectiveBound command only supports NASH_SUTCLIFFE, RMSE and ABSERR diagnostics. This command will be ignored.",Options.noisy); break;
+      }
+      string period="ALL";
+      if(Len>=5) { period=s[4]; }
+      double bound=s_to_d(s[3]);
+      if(diag==DIAG_NASH_SUTCLIFFE) { bound*=-1; } //objective is minimized
+      pModel->SetObjectiveBound(s_to_ll(s[1]),diag,period,bound);
+      break;
+    }
+    case(123):  //--------------------------------------------
+    {/*:WriteBinaryCheckpoint {BINARY_ONLY}
+       solution state also (or, with BINARY_ONLY, only) written to binary checkpoint file solution.rvb*/
+      if(Options.noisy) { cout <<"Write binary checkpoint ON"<<endl; }
+      Options.write_binary_rvc=true;
+      if((Len>=2) && (!strcmp(s[1],"BINARY_ONLY"))) { Options.write_text_rvc=false; }
+      break;
+    }
+    case(124):  //--------------------------------------------
+    {/*:NumThreads [number of threads used in parallel model initialization, 0 for one per core]*/
+      if(Options.noisy) { cout <<"Number of threads"<<endl; }
+      if(Len<2) { ImproperFormatWarning(":NumThreads",p,Options.noisy); break; }
+      g_num_threads=max(s_to_i(s[1]),0);
+      break;
+    }
     case(160):  //--------------------------------------------
     {/*:rvh_Filename [filename.rvh]*/
       if(Options.noisy) { cout <<"rvh filename: "<<s[1]<<endl; }
@@ -5,12 +5,28 @@
 
 #include "ParseLib.h"
 #include "RavenInclude.h"
+#include <new>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static char wholeline[MAXCHARINLINE]; ///< current line of input file, split into tokens by Tokenize
 
 inline int      s_to_i (char *s1)            {return (int)atof(s1);   }
 inline double   s_to_d (char *s1)            {return atof(s1);        }
 inline bool     s_to_b (char *s1)            {return ((int)atof(s1)!=0);   }
 inline long long int s_to_ll(char *s1)       {return (long long int)atoll(s1);}
 
+// true if fast_s_to_d() consumed no digits between tok and end (e.g., "abc", "-"); unlike is_numeric(), "-0.0" and ".0" are numeric
+static bool IsNonNumeric(const char *tok, const char *end)
+{
+  for (const char *c=tok;c<end;c++){if ((*c>='0') && (*c<='9')){return false;}}
+  return true;
+}
+
 /*----------------------------------------------------------------
   Constructor
   -----------------------------------------------------------------------*/
@@ -21,6 +37,12 @@ CParser::CParser(ifstream &FILE, const int i)
   _lineno=i;
   _comma_only=false;
   _parsing_math_exp=false;
+  _pBuffer=NULL;
+  _bufSize=0;
+  _bufPos =0;
+  _bufIsMapped=false;
+  _pCache=NULL;
+  _badLine=0;
 }
 //-----------------------------------------------------------------------
 CParser::CParser(ifstream &FILE, string filename, const int i)
@@ -30,6 +52,18 @@ CParser::CParser(ifstream &FILE, string filename, const int i)
   _lineno=i;
   _comma_only=false;
   _parsing_math_exp=false;
+  _pBuffer=NULL;
+  _bufSize=0;
+  _bufPos =0;
+  _bufIsMapped=false;
+  _pCache=NULL;
+  _badLine=0;
+}
+//-----------------------------------------------------------------------
+CParser::~CParser()
+{
+  if (_pBuffer!=NULL){FreeFile(_pBuffer,_bufSize,_bufIsMapped);}
+  _pBuffer=NULL;
 }
 /*----------------------------------------------------------------
   Basic Member Functions
@@ -38,17 +72,166 @@ void   CParser::SetLineCounter(int i)    {_lineno=i;}
 //-----------------------------------------------------------------------
 int    CParser::GetLineNumber ()         {return _lineno;}
 //-----------------------------------------------------------------------
+int    CParser::GetBadLineNumber() const {return _badLine;}
+//-----------------------------------------------------------------------
 string CParser::GetFilename   ()         {return _filename;}
 //-----------------------------------------------------------------------
 void   CParser::NextIsMathExp ()         {_parsing_math_exp=true;}
 //-----------------------------------------------------------------------
 streampos CParser::GetPosition() const {
+  if (_pBuffer!=NULL){return streampos((streamoff)(_bufPos));}
   return _INPUT->tellg();
 }
 //-----------------------------------------------------------------------
 void      CParser::SetPosition(streampos& pos) {
+  if (_pBuffer!=NULL){_bufPos=(size_t)((streamoff)(pos));return;}
   _INPUT->seekg(pos,std::ios_base::beg);
 }
+//////////////////////////////////////////////////////////////////
+/// \brief memory-maps entire file or, where memory mapping is unavailable (Windows, or file
+///  not newline-terminated), reads it into memory in one block
+/// \note safe to call from any thread: never exits, and reports failure by returning NULL
+///
+/// \param filename [in] name of file
+/// \param &size [out] size of returned buffer, in bytes
+/// \param &is_mapped [out] true if returned buffer is a memory map (false if new[]-allocated)
+/// \return newline-terminated file contents (to be released by FreeFile()), or NULL if file cannot be read
+//
+char *CParser::LoadFile(const string &filename, size_t &size, bool &is_mapped)
+{
+  char *buf=NULL;
+  size     =0;
+  is_mapped=false;
+#ifndef _WIN32
+  int fd=open(filename.c_str(),O_RDONLY);
+  if (fd<0){return NULL;}
+  struct stat st;
+  if ((fstat(fd,&st)!=0) || (st.st_size<=0)){close(fd);return NULL;}
+  size=(size_t)(st.st_size);
+  void *map=mmap(NULL,size,PROT_READ,MAP_PRIVATE,fd,0);
+  close(fd);
+  if (map==MAP_FAILED){size=0;return NULL;}
+  buf=(char*)(map);
+  if (buf[size-1]=='\n'){is_mapped=true;return buf;}
+  munmap(map,size);buf=NULL; //last line must be newline-terminated for in-place number parsing
+#endif
+  ifstream IN(filename.c_str(),ios::binary);
+  if (IN.fail()){return NULL;}
+  IN.seekg(0,ios::end);
+  streamoff fsize=(streamoff)(IN.tellg());
+  if (fsize<=0){return NULL;}
+  IN.seekg(0,ios::beg);
+  buf=new (nothrow) char [(size_t)(fsize)+1];
+  if (buf==NULL){return NULL;}
+  IN.read(buf,fsize);
+  if (IN.gcount()!=fsize){delete [] buf;return NULL;}
+  size=(size_t)(fsize);
+  if (buf[size-1]!='\n'){buf[size]='\n';size++;}
+  return buf;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief releases file contents returned by LoadFile()
+//
+void CParser::FreeFile(const char *buf, const size_t size, const bool is_mapped)
+{
+#ifndef _WIN32
+  if (is_mapped){munmap((void*)(buf),size);return;}
+#endif
+  delete [] buf;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief switches parser to reading from a memory-mapped copy of the input file
+/// \details reading resumes from current position of input stream; the stream itself
+///  is no longer read by the parser. Lines are then located by a direct scan of the
+///  mapped file rather than by stream extraction. Where memory mapping is unavailable
+///  (Windows, or file not newline-terminated) the file is read into memory in one block.
+///
+/// \returns true if successful (otherwise parser continues to read from stream)
+//
+bool CParser::MapInputFile()
+{
+  if (_pBuffer!=NULL){return true;}
+  if ((_filename=="") || (_INPUT->fail())){return false;}
+  streamoff start=(streamoff)(_INPUT->tellg());
+  if (start<0){return false;}
+
+  size_t size;
+  bool   is_mapped;
+  char  *buf=LoadFile(_filename,size,is_mapped);
+  if (buf==NULL){return false;}
+  if ((size_t)(start)>size){FreeFile(buf,size,is_mapped);return false;}
+  SetInputBuffer(buf,size,is_mapped);
+  _bufPos=(size_t)(start);
+  return true;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief switches parser to reading from a copy of the input file already in memory
+/// \details as MapInputFile(), but the file contents are supplied (e.g., read in advance
+///  by another thread). The parser takes ownership of buf, which must have been returned
+///  by LoadFile(). Reading starts at the beginning of buf.
+///
+/// \param buf [in] entire contents of input file
+/// \param size [in] size of buf, in bytes
+/// \param is_mapped [in] true if buf is a memory map
+//
+void CParser::SetInputBuffer(char *buf, const size_t size, const bool is_mapped)
+{
+  if (_pBuffer!=NULL){FreeFile(_pBuffer,_bufSize,_bufIsMapped);}
+  _pBuffer    =buf;
+  _bufSize    =size;
+  _bufPos     =0;
+  _bufIsMapped=is_mapped;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief returns true if character c is a token delimiter in current parsing mode
+//
+inline bool CParser::IsDelimiter(const char c) const
+{
+  switch(c)
+  {
+    case('\r'):
+    case('\n'): return true;
+    case(' ' ): return ((!_comma_only) || (_parsing_math_exp));
+    case('\t'): return (!_comma_only);
+    case(',' ): return ((_comma_only) || (!_parsing_math_exp));
+  }
+  return false;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief reads next line of input file
+/// \details in memory-mapped mode, line points directly into the mapped file and is
+///  terminated by a newline character; otherwise line is read into (NULL-terminated) wholeline
+///
+/// \param line [out] pointer to first character of line
+/// \param len [out] number of characters in line (excluding newline)
+/// \returns true if file has ended
+//
+bool CParser::GetLine(const char *&line, int &len)
+{
+  if (_pBuffer!=NULL)
+  {
+    if (_bufPos>=_bufSize){return true;}
+    const char *start=_pBuffer+_bufPos;
+    const char *nl   =(const char*)(memchr(start,'\n',_bufSize-_bufPos));
+    size_t n=(nl!=NULL) ? (size_t)(nl-start) : (_bufSize-_bufPos);
+    if (n>=MAXCHARINLINE-1){return true;} //mimics failure of getline() for too-long lines
+    _bufPos+=n+1;
+    line=start;
+    len =(int)(n);
+    return false;
+  }
+  (*wholeline)=0;
+  if (_INPUT->eof()){return true;}
+  _INPUT->getline(wholeline,MAXCHARINLINE);            //get entire line as 1 string
+  if (_INPUT->fail()){
+    return true; //handles blank line peeked at end of file (for some reason)
+    //cout<<"failed: "<<filename<<" line "<<l<<"|"<<wholeline<<"|"<<INPUT->ios::eofbit<<endl;
+    //ExitGracefully("Too many characters in line or (maybe) using Mac-style carriage return line endings.",BAD_DATA);
+  }
+  line=wholeline;
+  len =(int)(strlen(wholeline));
+  return false;
+}
 //-----------------------------------------------------------------------
 string CParser::Peek()
 {
@@ -59,15 +242,18 @@ string CParser::Peek()
     bool eof;
     char *s[MAXINPUTITEMS];
 
-    if (_INPUT->eof()){return ""; }
-    place=_INPUT->tellg(); // Get current position
+    if (_pBuffer!=NULL){
+      if (_bufPos>=_bufSize){return ""; }
+    }
+    else if (_INPUT->eof()){return ""; }
+    place=GetPosition();   // Get current position
     eof=Tokenize(s,Len);   //read and parse whole line
     _lineno--;             //otherwise line number incremented upon peeking
 
     string firstword = "";
     if (Len > 0) {firstword=s[0];}
     //if (!eof){
-      _INPUT->seekg(place ,std::ios_base::beg);    // Return to position before peeked line
+      SetPosition(place);  // Return to position before peeked line
     //}
     return firstword;
 }
@@ -102,30 +288,14 @@ string CParser::AddSpacesBeforeOps(string line) const
   -------------------------------------------------------------------------*/
 bool CParser::Tokenize(char **out, int &numwords){
 
-  static char wholeline     [MAXCHARINLINE];
-  static char *tempwordarray[MAXINPUTITEMS];
+  const char *line;
   char *p;
-  int ct(0),w;
-  char delimiters[6];
-  delimiters[0]=' '; //space
-  delimiters[1]='\t';//tab
-  delimiters[2]=','; //comma
-  delimiters[3]='\r';//carriage return (ignored in visual c++)
-  delimiters[4]='\n';//newline -necc?
-  delimiters[5]='\0';//last delimiter
-  if (_comma_only){
-    delimiters[0]=delimiters[1]=',';
-  }
-  if (_parsing_math_exp) {
-     delimiters[2]=' ';//don't use commas
-  }
-  (*wholeline)=0;
-  if (_INPUT->eof()){return true;}
-  _INPUT->getline(wholeline,MAXCHARINLINE);            //get entire line as 1 string
-  if (_INPUT->fail()){
-    return true; //handles blank line peeked at end of file (for some reason)
-    //cout<<"failed: "<<filename<<" line "<<l<<"|"<<wholeline<<"|"<<INPUT->ios::eofbit<<endl;
-    //ExitGracefully("Too many characters in line or (maybe) using Mac-style carriage return line endings.",BAD_DATA);
+  int ct(0),len;
+
+  if (GetLine(line,len)){return true;}
+  if (line!=wholeline){ //memory-mapped line
+    memcpy(wholeline,line,len);
+    wholeline[len]='\0';
   }
 
   _lineno++;
@@ -140,27 +310,26 @@ bool CParser::Tokenize(char **out, int &numwords){
     string line;
     line=AddSpacesBeforeOps(wholeline);
     strcpy(wholeline,line.c_str());
-    _parsing_math_exp=false;
   }
 
-  p=strtok(wholeline, delimiters);
-  while (p){                                         //sift through words, place in temparray, count line length
-    tempwordarray[ct]=p;
-    //p=strtok_s(NULL, delimiters,&junk);
-    p=strtok(NULL, delimiters);
-    ct++;
-    if ((p!=NULL) && (p[0]=='#')){break;} //ignore all content after '#'
-  }
-  for (w=0; w<ct; w++){                              //copy temp array of words into out[]
-    if (w>MAXINPUTITEMS){numwords=ct;
+  p=wholeline;
+  while (true){                                      //sift through words, place in out[], count line length
+    while ((*p!='\0') && (IsDelimiter(*p))){p++;}
+    if (*p=='\0'){break;}
+    if ((ct>0) && (p[0]=='#')){break;}               //ignore all content after '#'
+    if (ct>=MAXINPUTITEMS){numwords=ct;
       string warn="Tokenizeline:: exceeded maximum number of items in single line in file "+_filename;
       ExitGracefully(warn.c_str(),BAD_DATA);
       return true;
     }
-    out[w]=tempwordarray[w];
-    //cout<<out[w]<<"|";
+    out[ct]=p;
+    ct++;
+    while ((*p!='\0') && (!IsDelimiter(*p))){p++;}
+    if (*p=='\0'){break;}
+    *p='\0';
+    p++;
   }
-  //cout <<endl;
+  _parsing_math_exp=false;
   numwords=ct;
   return false;
 }
@@ -444,6 +613,240 @@ parse_error CParser::ParseBigArray_dbl(Writeable1DArray v, int numv)
 
   return PARSE_GOOD;
 }
+/*-------------------------------------------------------------------------
+  ParseDataValues
+  -------------------------------------------------------------------------
+  Bulk reading of numv numeric values (e.g., :Data block contents) directly from
+  the input line, without tokenization; any number of values per line,
+  'NaN' and other non-numeric entries are assigned blank_val. Blank and comment lines are skipped.
+  Returns PARSE_BAD (all values read, but non-numeric entry found; see GetBadLineNumber()), PARSE_TOO_MANY (line extends past
+  numv items), PARSE_EOF (file ended early) or PARSE_GOOD
+  If the block is stored in the block cache, the cached result is used; if the
+  block cache is recording, successfully read blocks are added to it
+  -------------------------------------------------------------------------*/
+parse_error CParser::ParseDataValues(Writeable1DArray v, const int numv, const double blank_val)
+{
+  _badLine=0;
+  if ((_pCache!=NULL) && (_pBuffer!=NULL) && (_pCache->IsRecording()))
+  {
+    data_block B;
+    B.start    =_bufPos;
+    int line0  =_lineno;
+    B.err      =ReadDataValues(v,numv,blank_val);
+    if ((B.err!=PARSE_GOOD) || (numv<=0)){return B.err;}
+    B.end      =_bufPos;
+    B.nLines   =_lineno-line0;
+    B.numcol   =0;
+    B.maxv     =numv;
+    B.blank_val=blank_val;
+    B.numv     =0;
+    B.aValues  =new double [numv];
+    ExitGracefullyIf(B.aValues==NULL,"CParser::ParseDataValues",OUT_OF_MEMORY);
+    for (int i=0;i<numv;i++){B.aValues[i]=v[i];}
+    _pCache->AddBlock(B);
+    return B.err;
+  }
+  else if ((_pCache!=NULL) && (_pBuffer!=NULL))
+  {
+    data_block *B=_pCache->GetBlock(_bufPos);
+    if ((B!=NULL) && (B->numcol==0) && (B->maxv==numv) && (B->blank_val==blank_val))
+    {
+      for (int i=0;i<numv;i++){v[i]=B->aValues[i];}
+      _bufPos  =B->end;
+      _lineno +=B->nLines;
+      parse_error err=B->err;
+      _pCache->ReleaseBlock(B);
+      return err;
+    }
+  }
+  return ReadDataValues(v,numv,blank_val);
+}
+//-------------------------------------------------------------------------
+parse_error CParser::ReadDataValues(Writeable1DArray v, const int numv, const double blank_val)
+{
+  const char *line,*c,*eol,*tok,*end;
+  int   len,count(0);
+  double val;
+
+  while (count<numv)
+  {
+    if (GetLine(line,len)){return PARSE_EOF;}
+    _lineno++;
+    c  =line;
+    eol=line+len;
+    while ((c<eol) && (IsDelimiter(*c))){c++;}
+    if ((c==eol) || (*c=='#') || (*c=='*')){continue;} //blank line or comment
+
+    while ((c<eol) && (*c!='#'))//ignore all content after '#'
+    {
+      if (count>=numv){return PARSE_TOO_MANY;}
+      tok=c;
+      while ((c<eol) && (!IsDelimiter(*c))){c++;}
+      if (((c-tok)==3) && (!strncmp(tok,"NaN",3))){v[count]=blank_val;}
+      else{
+        val=fast_s_to_d(tok,end);
+        if (IsNonNumeric(tok,end)){val=blank_val;if (_badLine==0){_badLine=_lineno;}}
+        v[count]=val;
+      }
+      count++;
+      while ((c<eol) && (IsDelimiter(*c))){c++;}
+    }
+  }
+  if (_badLine!=0){return PARSE_BAD;}
+  return PARSE_GOOD;
+}
+/*-------------------------------------------------------------------------
+  ParseDataTable
+  -------------------------------------------------------------------------
+  Bulk reading of lines with numcol numeric values each (e.g., :MultiData
+  block contents) until a line starting with end_tag or end of file. Values
+  stored as v[column][line]. Blank and comment lines are skipped.
+  Returns PARSE_NOT_ENOUGH (wrong number of columns), PARSE_TOO_MANY (more
+  than maxv lines), PARSE_BAD (all lines read, but non-numeric entry stored as 0.0;
+  see GetBadLineNumber()), PARSE_EOF (no end_tag) or PARSE_GOOD
+  If the block is stored in the block cache, the cached result is used; if the
+  block cache is recording, successfully read blocks are added to it
+  -------------------------------------------------------------------------*/
+parse_error CParser::ParseDataTable(Writeable2DArray v, const int maxv, const int numcol, int &numv, const char *end_tag)
+{
+  _badLine=0;
+  if ((_pCache!=NULL) && (_pBuffer!=NULL) && (_pCache->IsRecording()))
+  {
+    data_block B;
+    B.start    =_bufPos;
+    int line0  =_lineno;
+    B.err      =ReadDataTable(v,maxv,numcol,numv,end_tag);
+    if ((B.err!=PARSE_GOOD) || (maxv<=0) || (numcol<=0)){return B.err;}
+    B.end      =_bufPos;
+    B.nLines   =_lineno-line0;
+    B.numcol   =numcol;
+    B.maxv     =maxv;
+    B.blank_val=0.0;
+    B.end_tag  =end_tag;
+    B.numv     =numv;
+    B.aValues  =new double [maxv*numcol];
+    ExitGracefullyIf(B.aValues==NULL,"CParser::ParseDataTable",OUT_OF_MEMORY);
+    for (int i=0;i<numcol;i++){
+      for (int n=0;n<numv;n++){B.aValues[i*maxv+n]=v[i][n];}
+    }
+    _pCache->AddBlock(B);
+    return B.err;
+  }
+  else if ((_pCache!=NULL) && (_pBuffer!=NULL))
+  {
+    data_block *B=_pCache->GetBlock(_bufPos);
+    if ((B!=NULL) && (B->numcol==numcol) && (B->maxv==maxv) && (B->end_tag==end_tag))
+    {
+      numv=B->numv;
+      for (int i=0;i<numcol;i++){
+        for (int n=0;n<numv;n++){v[i][n]=B->aValues[i*maxv+n];}
+      }
+      _bufPos  =B->end;
+      _lineno +=B->nLines;
+      parse_error err=B->err;
+      _pCache->ReleaseBlock(B);
+      return err;
+    }
+  }
+  return ReadDataTable(v,maxv,numcol,numv,end_tag);
+}
+//-------------------------------------------------------------------------
+parse_error CParser::ReadDataTable(Writeable2DArray v, const int maxv, const int numcol, int &numv, const char *end_tag)
+{
+  const char *line,*c,*eol,*tok,*end;
+  int    len,i;
+  double val;
+  size_t taglen=strlen(end_tag);
+
+  numv=0;
+  while (!GetLine(line,len))
+  {
+    _lineno++;
+    c  =line;
+    eol=line+len;
+    while ((c<eol) && (IsDelimiter(*c))){c++;}
+    if ((c==eol) || (*c=='#') || (*c=='*')){continue;} //blank line or comment
+
+    tok=c;
+    while ((c<eol) && (!IsDelimiter(*c))){c++;}
+    if (((size_t)(c-tok)==taglen) && (!strncmp(tok,end_tag,taglen))){
+      if (_badLine!=0){return PARSE_BAD;}
+      return PARSE_GOOD;
+    }
+
+    //count columns
+    i=0;
+    c=tok;
+    while ((c<eol) && (*c!='#')){
+      while ((c<eol) && (!IsDelimiter(*c))){c++;}
+      while ((c<eol) && (IsDelimiter(*c))){c++;}
+      i++;
+    }
+    if (i!=numcol){return PARSE_NOT_ENOUGH;}
+    if (numv>=maxv){return PARSE_TOO_MANY;}
+
+    c=tok;
+    for (i=0;i<numcol;i++){
+      val=fast_s_to_d(c,end);
+      if (IsNonNumeric(c,end)){if (_badLine==0){_badLine=_lineno;}} //stored as 0.0
+      v[i][numv]=val;
+      while ((c<eol) && (!IsDelimiter(*c))){c++;}
+      while ((c<eol) && (IsDelimiter(*c))){c++;}
+    }
+    numv++;
+  }
+  return PARSE_EOF;
+}
+/*----------------------------------------------------------------
+  CBlockCache
+  -----------------------------------------------------------------------*/
+CBlockCache::CBlockCache()
+{
+  _aBlocks=NULL;
+  _nBlocks=0;
+  _nAlloc =0;
+  _next   =0;
+  _recording=false;
+}
+//-----------------------------------------------------------------------
+CBlockCache::~CBlockCache()
+{
+  for (int i=0;i<_nBlocks;i++){delete [] _aBlocks[i].aValues;}
+  delete [] _aBlocks; _aBlocks=NULL;
+}
+//-----------------------------------------------------------------------
+void CBlockCache::AddBlock(const data_block &B)
+{
+  if (_nBlocks==_nAlloc)
+  {
+    _nAlloc=(_nAlloc==0) ? 16 : 2*_nAlloc;
+    data_block *tmp=new data_block [_nAlloc];
+    for (int i=0;i<_nBlocks;i++){tmp[i]=_aBlocks[i];}
+    delete [] _aBlocks;
+    _aBlocks=tmp;
+  }
+  _aBlocks[_nBlocks]=B;
+  _nBlocks++;
+}
+//-----------------------------------------------------------------------
+// blocks are usually requested in file order, so search begins after last block retrieved
+data_block *CBlockCache::GetBlock(const size_t start)
+{
+  for (int j=0;j<_nBlocks;j++)
+  {
+    int i=(_next+j)%_nBlocks;
+    if ((_aBlocks[i].start==start) && (_aBlocks[i].aValues!=NULL)){_next=i+1;return &_aBlocks[i];}
+  }
+  return NULL;
+}
+//-----------------------------------------------------------------------
+void CBlockCache::ReleaseBlock(data_block *B)
+{
+  delete [] B->aValues; B->aValues=NULL;
+}
+//-----------------------------------------------------------------------
+int               CBlockCache::GetNumBlocks   () const           {return _nBlocks;}
+const data_block *CBlockCache::GetBlockByIndex(const int i) const{return &_aBlocks[i];}
 /*-------------------------------------------------------------------------
   Parse2DArray_dbl
   -------------------------------------------------------------------------*
@@ -42,6 +42,55 @@ enum parse_error
   PARSE_EOF         ///< End of file error
 };
 
+///////////////////////////////////////////////////////////////////
+/// \brief Numeric data block recorded by a parser (e.g., for the time series cache)
+/// \details stores the outcome of a ParseDataValues() or ParseDataTable() call starting
+///  at buffer position start, so that the same call on a later parser of the same
+///  file can be answered without re-reading the file
+//
+struct data_block
+{
+  size_t      start;     ///< position in file of first line of block
+  size_t      end;       ///< position in file following last line read
+  int         nLines;    ///< number of lines read
+  int         numcol;    ///< number of columns (0 if read by ParseDataValues)
+  int         maxv;      ///< number of values requested (max number of rows if numcol>0)
+  double      blank_val; ///< value substituted for NaN entries (ParseDataValues only)
+  string      end_tag;   ///< closing tag (ParseDataTable only)
+  int         numv;      ///< number of rows read (ParseDataTable only)
+  parse_error err;       ///< error code returned by reader
+  double     *aValues;   ///< values read, column by column [maxv*max(numcol,1)]
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief Collection of numeric data blocks of a single file
+/// \details either supplies previously stored blocks to the parser, or (if recording)
+///  collects each block successfully read by the parser
+//
+class CBlockCache
+{
+private:
+  data_block *_aBlocks;        //< array of cached blocks, in order of position in file
+  int         _nBlocks;        //< number of cached blocks
+  int         _nAlloc;         //< allocated size of _aBlocks
+  int         _next;           //< index of block after last retrieved block (search start)
+  bool        _recording;      //< true if blocks read by parser are to be added
+
+public:
+  CBlockCache();
+  ~CBlockCache();
+
+  void        AddBlock    (const data_block &B);
+  data_block *GetBlock    (const size_t start);
+  void        ReleaseBlock(data_block *B);
+
+  int               GetNumBlocks   () const;
+  const data_block *GetBlockByIndex(const int i) const;
+
+  void        SetRecording(const bool rec){_recording=rec;}
+  bool        IsRecording () const        {return _recording;}
+};
+
 ///////////////////////////////////////////////////////////////////
 /// \brief Class for parsing data from file
 //
@@ -56,16 +105,30 @@ private:
   bool      _comma_only;       //< true if spaces & tabs ignored in tokenization
   bool      _parsing_math_exp; //< true if currently parsing math exp (commas not ignored)
 
+  const char *_pBuffer;        //< contents of memory-mapped input file (NULL if reading from stream)
+  size_t    _bufSize;          //< size of _pBuffer, in bytes
+  size_t    _bufPos;           //< current read position within _pBuffer
+  bool      _bufIsMapped;      //< true if _pBuffer is a memory map (false if heap copy)
+
+  CBlockCache *_pCache;        //< blocks of numeric data read by earlier run, or recorded for later runs (or NULL)
+  int       _badLine;          //< line of first non-numeric entry found by last ParseDataValues()/ParseDataTable() call (0 if none)
+
   string AddSpacesBeforeOps(string line) const;
+  bool   GetLine           (const char *&line, int &len);
+  inline bool IsDelimiter  (const char c) const;
+
+  parse_error ReadDataValues(Writeable1DArray v,  const int numv, const double blank_val);
+  parse_error ReadDataTable (Writeable2DArray v,  const int maxv, const int numcol, int &numv, const char *end_tag);
 
 public:
 
   CParser(ifstream &FILE, const int init_line_num);
   CParser(ifstream &FILE, string filename, const int init_line_num);
-  ~CParser(){}
+  ~CParser();
 
   void   SetLineCounter(int i);
   int    GetLineNumber ();
+  int    GetBadLineNumber() const;
   string GetFilename();
   void   ImproperFormat(char **s);
   void   IgnoreSpaces  (bool ignore_it){_comma_only=ignore_it;}
@@ -73,6 +136,15 @@ public:
   streampos GetPosition() const;
   void      SetPosition(streampos &pos);
 
+  bool   MapInputFile();
+  void   SetInputBuffer(char *buf, const size_t size, const bool is_mapped);
+
+  static char *LoadFile(const string &filename, size_t &size, bool &is_mapped);
+  static void  FreeFile(const char *buf, const size_t size, const bool is_mapped);
+
+  void   SetBlockCache (CBlockCache *pCache){_pCache=pCache;}
+  CBlockCache *GetBlockCache() const{return _pCache;}
+
   bool   Tokenize(char **tokens, int &numwords);
 
   string Peek();
@@ -142,6 +214,16 @@ public:
      [double] [double] ... [double]              (fixed (known) array size)
      & (if optfollow=true) */
   parse_error    ParseBigArray_dbl (Writeable1DArray v,  int numv);
+
+  /* [double] [double] ... [double] (any number per line, 'NaN' -> blank_val)
+     ...
+     [double] ... [double]              (until numv items read; comment lines skipped; non-numeric -> blank_val) */
+  parse_error    ParseDataValues   (Writeable1DArray v,  const int numv, const double blank_val);
+
+  /* [double] [double] ... [double]
+     ...       ...   ...    ...
+     [double] [double] ... [double]     (numcol per line, until line starting with end_tag; comment lines skipped; non-numeric -> 0.0) */
+  parse_error    ParseDataTable    (Writeable2DArray v,  const int maxv, const int numcol, int &numv, const char *end_tag);
 };
 
 #endif
@@ -251,8 +251,6 @@ void ParseLiveFile(CModel *&pModel,const optStruct &Options, const time_struct &
         else if (!strcmp(s[0],":EndRepopulateHRUGroup")){}//done
         else
         {
-          int k;
-          int nHRUs=pModel->GetNumHRUs();
           for (int i=0;i<Len;i++)
           {
             long long int ind1,ind2;
@@ -262,14 +260,9 @@ void ParseLiveFile(CModel *&pModel,const optStruct &Options, const time_struct &
             bool gaps(false);
             for (long long int ii=ind1;ii<=ind2;ii++)
             {
-              found=false;
-              for (k=0;k<nHRUs;k++)
-              {
-                if (pModel->GetHydroUnit(k)->GetHRUID()==ii)
-                {
-                  pHRUGrp->AddHRU(pModel->GetHydroUnit(k));found=true; break;
-                }
-              }
+              CHydroUnit *pHRU=pModel->GetHRUByID(ii);
+              found=(pHRU!=NULL);
+              if (found){pHRUGrp->AddHRU(pHRU);}
               if ((!found) && (ind2-ind1>1)){gaps=true;}
               if((!found) && (ind1==ind2)) {
                 string warn="ParseLiveFile: HRU ID "+to_string(ii)+" specified in :RepopulateHRUGroup command for group "+pHRUGrp->GetName()+ " does not exist";
@@ -7,6 +7,518 @@
 #include "TimeSeries.h"
 #include "IrregularTimeSeries.h"
 #include "ParseLib.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <new>
+
+bool ReadBlockCache (const string &srcfile,CBlockCache *pCache,const optStruct &Options);
+void WriteBlockCache(const string &srcfile,const CBlockCache *pCache,const optStruct &Options);
+
+const int    MAX_PREFETCH_THREADS=4;               ///< maximum number of threads reading redirected .rvt files in advance
+const size_t MAX_PREFETCH_BYTES  =256*1024*1024;   ///< maximum size of file contents read in advance but not yet parsed
+
+////////////////////////////////////////////////////////////////////
+/// \brief status of .rvt file in prefetch queue
+//
+enum prefetch_status
+{
+  PREFETCH_QUEUED,  ///< awaiting read by prefetch thread
+  PREFETCH_READING, ///< being read by prefetch thread
+  PREFETCH_READY,   ///< contents read, awaiting parser
+  PREFETCH_TAKEN    ///< handed to (or read directly by) parser
+};
+
+//////////////////////////////////////////////////////////////////
+/// \brief .rvt file (main file or :RedirectToFile target) in prefetch queue
+//
+struct rvt_file
+{
+  prefetch_status status; ///< current status
+  int             depth;  ///< redirection depth (0 for main .rvt)
+  char           *buf;    ///< file contents from CParser::LoadFile() (NULL if file could not be read)
+  size_t          size;   ///< size of buf, in bytes
+  bool            mapped; ///< true if buf is a memory map
+};
+
+//////////////////////////////////////////////////////////////////
+/// \brief returns size of file in bytes (0 if file cannot be opened)
+//
+static size_t FileSizeInBytes(const string &filename)
+{
+  ifstream IN(filename.c_str(),ios::binary);
+  if (IN.fail()){return 0;}
+  IN.seekg(0,ios::end);
+  streamoff fsize=(streamoff)(IN.tellg());
+  if (fsize<=0){return 0;}
+  return (size_t)(fsize);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief finds targets of :RedirectToFile commands in raw file contents
+/// \details a plain scan for lines beginning with :RedirectToFile; target is remainder of line,
+///  split and rejoined as by the parser. Nothing is checked here - a target the parser never
+///  opens (e.g., within an inactive :IfModeEquals block) is merely read in vain
+///
+/// \param buf [in] raw file contents
+/// \param size [in] size of buf, in bytes
+/// \param &targets [out] file names, as written in file
+//
+static void FindRedirectTargets(const char *buf,const size_t size,vector<string> &targets)
+{
+  const char  *cmd   =":RedirectToFile";
+  const size_t cmdlen=strlen(cmd);
+  const char  *c     =buf;
+  const char  *end   =buf+size;
+  while (c<end)
+  {
+    const char *eol=(const char*)(memchr(c,'\n',(size_t)(end-c)));
+    if (eol==NULL){eol=end;}
+    while ((c<eol) && ((*c==' ') || (*c=='\t') || (*c==','))){c++;}
+    if (((size_t)(eol-c)>cmdlen) && (!strncmp(c,cmd,cmdlen)) && (strchr(" \t,\r",c[cmdlen])!=NULL))
+    {
+      string target="";
+      c+=cmdlen;
+      while (c<eol)
+      {
+        while ((c<eol) && (strchr(" \t,\r",*c)!=NULL)){c++;}
+        if ((c==eol) || (*c=='#')){break;}
+        const char *tok=c;
+        while ((c<eol) && (strchr(" \t,\r",*c)==NULL)){c++;}
+        if (target!=""){target+=' ';}
+        target+=string(tok,(size_t)(c-tok));
+      }
+      if (target!=""){targets.push_back(target);}
+    }
+    c=eol+1;
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Reads .rvt file and the files it redirects to in advance of parsing, using a small pool of threads
+/// \details threads map each file (CParser::LoadFile()) and scan it for :RedirectToFile targets, which
+///  brings its contents into memory; parsing itself stays serial. All tokenizing, checking and error
+///  reporting remain with the parser in ParseTimeSeriesFile(), which takes each file's contents as it
+///  reaches the file, while later files are still being read. Files read in advance but not yet parsed
+///  total at most MAX_PREFETCH_BYTES; larger files are left to the parser. The parser thread counts
+///  towards g_num_threads.
+//
+class CRVTPrefetch
+{
+private:/*------------------------------------------------------*/
+  mutex                 _mtx;      ///< guards all members below
+  condition_variable    _cv;       ///< signalled when files are queued, read, or taken by parser
+  deque<string>         _queue;    ///< files awaiting read, in order of discovery
+  map<string,rvt_file>  _files;    ///< every file queued so far, keyed by path
+  size_t                _nBytes;   ///< size of contents being read or read but not yet taken by parser
+  int                   _nActive;  ///< number of threads currently handling a file
+  bool                  _stop;     ///< true once threads are to quit
+  thread               *_aThreads; ///< prefetch threads
+  int                   _nThreads; ///< number of prefetch threads
+  string                _rvt_file; ///< main .rvt file (to which redirected file paths are relative)
+
+  //------------------------------------------------
+  void Enqueue(const string &filename,const int depth) //requires lock
+  {
+    if (_files.find(filename)!=_files.end()){return;} //already queued
+    rvt_file F;
+    F.status=PREFETCH_QUEUED;
+    F.depth =depth;
+    F.buf   =NULL;
+    F.size  =0;
+    F.mapped=false;
+    _files[filename]=F;
+    _queue.push_back(filename);
+  }
+  //------------------------------------------------
+  void Store(const string &filename,char *buf,const size_t size,const bool mapped,const vector<string> &targets) //requires lock
+  {
+    rvt_file &F=_files[filename];
+    F.buf   =buf;
+    F.size  =size;
+    F.mapped=mapped;
+    F.status=PREFETCH_READY;
+    _nBytes+=size;
+    for (size_t i=0;(i<targets.size()) && (F.depth<2);i++){ //consistent with maximum nesting in ParseTimeSeriesFile()
+      Enqueue(CorrectForRelativePath(targets[i],_rvt_file),F.depth+1);
+    }
+  }
+  //------------------------------------------------
+  void Worker()
+  {
+    string         filename;
+    vector<string> targets;
+    char          *buf;
+    size_t         size,fsize;
+    bool           mapped;
+    unique_lock<mutex> lock(_mtx);
+    while (true)
+    {
+      if (_stop){return;}
+      if ((_queue.empty()) && (_nActive==0)){return;}
+      if (_queue.empty()){_cv.wait(lock);continue;}
+
+      filename=_queue.front(); _queue.pop_front();
+      rvt_file &F=_files[filename];
+      if (F.status!=PREFETCH_QUEUED){continue;} //parser got there first
+      _nActive++;
+      lock.unlock();
+      fsize=FileSizeInBytes(filename);
+      lock.lock();
+
+      //reserve space for contents, waiting for parser to take earlier files if needed
+      if (fsize>MAX_PREFETCH_BYTES){F.status=PREFETCH_TAKEN;} //left to parser
+      while ((!_stop) && (F.status==PREFETCH_QUEUED) && (_nBytes+fsize>MAX_PREFETCH_BYTES)){_cv.wait(lock);}
+      if ((_stop) || (F.status!=PREFETCH_QUEUED)){_nActive--;_cv.notify_all();continue;}
+      F.status=PREFETCH_READING;
+      _nBytes+=fsize;
+      lock.unlock();
+
+      targets.clear();
+      buf=CParser::LoadFile(filename,size,mapped);
+      if (buf!=NULL){FindRedirectTargets(buf,size,targets);} //scan also pages in mapped contents
+
+      lock.lock();
+      _nBytes-=fsize;
+      Store(filename,buf,size,mapped,targets);
+      _nActive--;
+      _cv.notify_all();
+    }
+  }
+
+public:/*-------------------------------------------------------*/
+  CRVTPrefetch()
+  {
+    _nBytes=0; _nActive=0; _stop=false;
+    _aThreads=NULL; _nThreads=0;
+  }
+  //------------------------------------------------
+  ~CRVTPrefetch()
+  {
+    {
+      lock_guard<mutex> lock(_mtx);
+      _stop=true;
+    }
+    _cv.notify_all();
+    for (int i=0;i<_nThreads;i++){_aThreads[i].join();}
+    delete [] _aThreads;
+    for (map<string,rvt_file>::iterator it=_files.begin();it!=_files.end();it++){
+      if (it->second.buf!=NULL){CParser::FreeFile(it->second.buf,it->second.size,it->second.mapped);}
+    }
+  }
+  //------------------------------------------------
+  /// \brief reads main .rvt file, then starts threads reading the files it redirects to
+  void Start(const optStruct &Options)
+  {
+    _rvt_file=Options.rvt_filename;
+    vector<string> targets;
+    size_t size;
+    bool   mapped;
+    char  *buf=CParser::LoadFile(_rvt_file,size,mapped);
+    if (buf!=NULL){FindRedirectTargets(buf,size,targets);}
+
+    lock_guard<mutex> lock(_mtx);
+    Enqueue(_rvt_file,0);
+    _queue.clear();
+    Store(_rvt_file,buf,size,mapped,targets);
+
+    int nThreads=g_num_threads;
+    if (nThreads<=0){nThreads=(int)(thread::hardware_concurrency());}
+    nThreads=min(nThreads-1,MAX_PREFETCH_THREADS); //parser thread is one of g_num_threads
+    nThreads=min(nThreads,(int)(_queue.size()));
+    if (nThreads<1){return;}
+    _aThreads=new thread [nThreads];
+    for (int i=0;i<nThreads;i++){_aThreads[i]=thread(&CRVTPrefetch::Worker,this);}
+    _nThreads=nThreads;
+  }
+  //------------------------------------------------
+  /// \brief hands contents of file to parser, waiting for file to be read if it is in progress
+  /// \return false if file was not read in advance (or could not be read), in which case parser reads it directly
+  bool TakeBuffer(const string &filename,char *&buf,size_t &size,bool &mapped)
+  {
+    buf=NULL; size=0; mapped=false;
+    unique_lock<mutex> lock(_mtx);
+    map<string,rvt_file>::iterator it=_files.find(filename);
+    if (it==_files.end()){return false;}
+    rvt_file &F=it->second;
+    while (F.status==PREFETCH_READING){_cv.wait(lock);}
+    if (F.status!=PREFETCH_READY){F.status=PREFETCH_TAKEN;_cv.notify_all();return false;}
+    buf=F.buf; size=F.size; mapped=F.mapped;
+    F.buf=NULL;
+    F.status=PREFETCH_TAKEN;
+    _nBytes-=size;
+    _cv.notify_all();
+    return (buf!=NULL);
+  }
+};
+
+//////////////////////////////////////////////////////////////////
+/// \brief creates parser of .rvt file, reading from contents read in advance where available
+/// \details if a time series cache is used, numeric data blocks are retrieved from (or else recorded for) the cache
+///
+/// \param &INPUT [in] open stream of file
+/// \param filename [in] path of file
+/// \param line [in] initial line number
+/// \param &Q [in/out] prefetched .rvt files
+/// \param Options [in] Global model options
+//
+static CParser *OpenTimeSeriesParser(ifstream &INPUT,const string &filename,const int line,CRVTPrefetch &Q,const optStruct &Options)
+{
+  CParser *p=new CParser(INPUT,filename,line);
+  char    *buf;
+  size_t   size;
+  bool     mapped;
+  if (Q.TakeBuffer(filename,buf,size,mapped)){p->SetInputBuffer(buf,size,mapped);}
+  else                                       {p->MapInputFile();} //large forcing files are read via memory map
+
+  if (Options.ts_cache_dir!="")
+  {
+    CBlockCache *pCache=new CBlockCache();
+    if (!ReadBlockCache(filename,pCache,Options)){pCache->SetRecording(true);}
+    p->SetBlockCache(pCache);
+  }
+  return p;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief deletes parser created by OpenTimeSeriesParser(), saving any recorded data blocks to the time series cache
+//
+static void CloseTimeSeriesParser(CParser *p,const optStruct &Options)
+{
+  CBlockCache *pCache=p->GetBlockCache();
+  if ((pCache!=NULL) && (pCache->IsRecording())){WriteBlockCache(p->GetFilename(),pCache,Options);}
+  delete pCache;
+  delete p;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Grid weights read from a :GridWeightsFile, in compressed sparse row form by HRU index
+/// \details shared by all forcing grids referring to the same file
+//
+struct grid_weight_table
+{
+  int     nHRUs;    ///< number of HRUs in model
+  int     nCells;   ///< number of grid cells that cell IDs were checked against
+  long long *aStart;///< weights of HRU k are entries aStart[k]..aStart[k+1]-1 [size: nHRUs+1]
+  int    *aCellID;  ///< cell ID of each entry [size: aStart[nHRUs]]
+  double *aWt;      ///< weight of each entry [size: aStart[nHRUs]]
+
+  grid_weight_table(){nHRUs=0;nCells=0;aStart=NULL;aCellID=NULL;aWt=NULL;}
+  ~grid_weight_table(){delete [] aStart; delete [] aCellID; delete [] aWt;}
+};
+
+//////////////////////////////////////////////////////////////////
+/// \brief reads raw columns (HRU ID, cell ID, weight) of a sparse grid weights file
+/// \details binary format (native byte order):
+///   char[8] "RVGRDWTS", int32 version (=1), int32 number of grid cells, int64 number of entries N,
+///   int64 HRU_ID[N], int32 cell_ID[N], double weight[N]
+///   NetCDF format (.nc extension): 1D variables HRU_ID, cell_ID and weight of identical length;
+///   optional global attribute number_grid_cells
+///
+/// \param filename  [in] name of weights file
+/// \param &nEntries [out] number of entries N
+/// \param &nCells   [out] number of grid cells specified in file (DOESNT_EXIST if unspecified)
+/// \param *&aHRUID  [out] HRU ID of each entry (created here) [size: N]
+/// \param *&aCellID [out] cell ID of each entry (created here) [size: N]
+/// \param *&aWt     [out] weight of each entry (created here) [size: N]
+//
+static void ReadGridWeightColumns(const string &filename,long long &nEntries,int &nCells,
+                                  long long *&aHRUID,int *&aCellID,double *&aWt)
+{
+  string warn;
+  nEntries=0;
+  nCells  =DOESNT_EXIST;
+  aHRUID  =NULL;
+  aCellID =NULL;
+  aWt     =NULL;
+
+  if (GetFileExtension(filename)=="nc")
+  {
+#ifdef _RVNETCDF_
+    int    ncid,retval,varid_h,varid_c,varid_w,ndims,dimid;
+    size_t len;
+    retval=nc_open(filename.c_str(),NC_NOWRITE,&ncid);
+    if (retval!=NC_NOERR){
+      warn=":GridWeightsFile: Cannot open NetCDF weights file "+filename;
+      ExitGracefully(warn.c_str(),BAD_DATA);
+    }
+    retval=nc_inq_varid(ncid,"HRU_ID" ,&varid_h);  HandleNetCDFErrors(retval);
+    retval=nc_inq_varid(ncid,"cell_ID",&varid_c);  HandleNetCDFErrors(retval);
+    retval=nc_inq_varid(ncid,"weight" ,&varid_w);  HandleNetCDFErrors(retval);
+    retval=nc_inq_varndims(ncid,varid_w,&ndims);   HandleNetCDFErrors(retval);
+    ExitGracefullyIf(ndims!=1,":GridWeightsFile: weight variable in NetCDF weights file must be one-dimensional",BAD_DATA);
+    retval=nc_inq_vardimid(ncid,varid_w,&dimid);   HandleNetCDFErrors(retval);
+    retval=nc_inq_dimlen  (ncid,dimid,&len);       HandleNetCDFErrors(retval);
+    nEntries=(long long)(len);
+
+    int nc_cells;
+    if (nc_get_att_int(ncid,NC_GLOBAL,"number_grid_cells",&nc_cells)==NC_NOERR){nCells=nc_cells;}
+
+    aHRUID =new long long[max(nEntries,1LL)];
+    aCellID=new int      [max(nEntries,1LL)];
+    aWt    =new double   [max(nEntries,1LL)];
+    ExitGracefullyIf(aWt==NULL,"ReadGridWeightColumns",OUT_OF_MEMORY);
+    retval=nc_get_var_longlong(ncid,varid_h,aHRUID);  HandleNetCDFErrors(retval);
+    retval=nc_get_var_int     (ncid,varid_c,aCellID); HandleNetCDFErrors(retval);
+    retval=nc_get_var_double  (ncid,varid_w,aWt);     HandleNetCDFErrors(retval);
+    retval=nc_close(ncid);                            HandleNetCDFErrors(retval);
+#else
+    ExitGracefully(":GridWeightsFile: NetCDF weights files are only allowed when NetCDF library is available!",BAD_DATA);
+#endif
+    return;
+  }
+
+  ifstream IN(filename.c_str(),ios::binary);
+  if (IN.fail()){
+    warn=":GridWeightsFile: Cannot find weights file "+filename;
+    ExitGracefully(warn.c_str(),BAD_DATA);
+  }
+  char magic[8];
+  int  version;
+  IN.read(magic,8);
+  IN.read((char*)(&version ),sizeof(int));
+  IN.read((char*)(&nCells  ),sizeof(int));
+  IN.read((char*)(&nEntries),sizeof(long long));
+  if ((IN.fail()) || (strncmp(magic,"RVGRDWTS",8)) || (version!=1) || (nEntries<0)){
+    warn=":GridWeightsFile: weights file "+filename+" is not a valid binary grid weights file";
+    ExitGracefully(warn.c_str(),BAD_DATA);
+  }
+  aHRUID =new long long[max(nEntries,1LL)];
+  aCellID=new int      [max(nEntries,1LL)];
+  aWt    =new double   [max(nEntries,1LL)];
+  ExitGracefullyIf(aWt==NULL,"ReadGridWeightColumns",OUT_OF_MEMORY);
+  IN.read((char*)(aHRUID ),nEntries*sizeof(long long));
+  IN.read((char*)(aCellID),nEntries*sizeof(int));
+  IN.read((char*)(aWt    ),nEntries*sizeof(double));
+  if (IN.fail()){
+    warn=":GridWeightsFile: weights file "+filename+" is truncated";
+    ExitGracefully(warn.c_str(),BAD_DATA);
+  }
+  IN.close();
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief reads sparse grid weights file and converts to compressed sparse rows by HRU index, in one pass
+/// \details entries keep file order within each HRU; repeated (HRU, cell) entries replace earlier
+///  values, as in :GridWeights blocks
+///
+/// \param filename   [in] name of weights file
+/// \param nGridCells [in] number of cells in forcing grid
+/// \param *pModel    [in] model
+/// \return new weight table
+//
+static grid_weight_table *LoadGridWeightsFile(const string &filename,const int nGridCells,const CModel *pModel)
+{
+  long long  nEntries;
+  int        nCells;
+  long long *aHRUID;
+  int       *aCellID;
+  double    *aWt;
+  string     warn;
+
+  ReadGridWeightColumns(filename,nEntries,nCells,aHRUID,aCellID,aWt);
+
+  if ((nCells!=DOESNT_EXIST) && (nCells!=nGridCells)) {
+    printf(":GridWeightsFile number of grid cells = %i\n",nCells);
+    printf("NetCDF cols * rows = %i\n",nGridCells);
+    ExitGracefully("ParseTimeSeriesFile: number of grid cells in :GridWeightsFile does not agree with NetCDF file content",BAD_DATA);
+  }
+
+  grid_weight_table *W=new grid_weight_table();
+  W->nHRUs =pModel->GetNumHRUs();
+  W->nCells=nGridCells;
+  W->aStart=new long long [W->nHRUs+1];
+  for (int k=0;k<=W->nHRUs;k++){W->aStart[k]=0;}
+
+  //resolve HRU index of each entry (consecutive entries usually share HRU)
+  int *aK=new int [max(nEntries,1LL)];
+  ExitGracefullyIf(aK==NULL,"LoadGridWeightsFile",OUT_OF_MEMORY);
+  long long lastID=-1;
+  int       lastk =DOESNT_EXIST;
+  for (long long e=0;e<nEntries;e++)
+  {
+    if ((e==0) || (aHRUID[e]!=lastID))
+    {
+      const CHydroUnit *pHRU=pModel->GetHRUByID(aHRUID[e]);
+      if (pHRU == NULL) {
+        warn="ParseTimeSeriesFile: HRU ID ("+to_string(aHRUID[e])+")found in :GridWeightsFile which does not exist in :HRUs!";
+        ExitGracefully(warn.c_str(), BAD_DATA);
+      }
+      lastID=aHRUID[e];
+      lastk =pHRU->GetGlobalIndex();
+    }
+    if ((aCellID[e]<0) || (aCellID[e]>=nGridCells)) {
+      ExitGracefully("ParseTimeSeriesFile: :GridWeightsFile: invalid cell ID",BAD_DATA);}
+    aK[e]=lastk;
+    W->aStart[lastk+1]++;
+  }
+  delete [] aHRUID;
+  for (int k=0;k<W->nHRUs;k++){W->aStart[k+1]+=W->aStart[k];}
+
+  //stable bucket fill
+  long long  nnz  =W->aStart[W->nHRUs];
+  long long *aNext=new long long [W->nHRUs];
+  W->aCellID =new int    [max(nnz,1LL)];
+  W->aWt     =new double [max(nnz,1LL)];
+  ExitGracefullyIf(W->aWt==NULL,"LoadGridWeightsFile",OUT_OF_MEMORY);
+  for (int k=0;k<W->nHRUs;k++){aNext[k]=W->aStart[k];}
+  for (long long e=0;e<nEntries;e++)
+  {
+    int k=aK[e];
+    W->aCellID[aNext[k]]=aCellID[e];
+    W->aWt    [aNext[k]]=aWt[e];
+    aNext[k]++;
+  }
+  delete [] aK;      //file columns no longer needed
+  delete [] aNext;
+  delete [] aCellID;
+  delete [] aWt;
+
+  //compact rows, later repeated (HRU,cell) entries replacing earlier ones
+  long long *aPos=new long long [nGridCells]; //location of entry referring to cell in current row
+  for (int c=0;c<nGridCells;c++){aPos[c]=DOESNT_EXIST;}
+  long long j=0;
+  for (int k=0;k<W->nHRUs;k++)
+  {
+    long long start=W->aStart[k];
+    long long end  =W->aStart[k+1];
+    W->aStart[k]=j;
+    for (long long i=start;i<end;i++){
+      int c=W->aCellID[i];
+      if (aPos[c]!=DOESNT_EXIST){W->aWt[aPos[c]]=W->aWt[i];continue;}
+      aPos[c]=j;
+      W->aCellID[j]=c;
+      W->aWt    [j]=W->aWt[i];
+      j++;
+    }
+    for (long long i=W->aStart[k];i<j;i++){aPos[W->aCellID[i]]=DOESNT_EXIST;}
+  }
+  W->aStart[W->nHRUs]=j;
+
+  delete [] aPos;
+  return W;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief checks grid weights once all are read and prepares grid cell indexing
+//
+static void FinalizeGridWeights(CForcingGrid *pGrid,CModel *pModel,const int nHydroUnits,const int nGridCells,const optStruct &Options)
+{
+  // check that weightings sum up to one per HRU
+  bool WeightArrayOK = pGrid->CheckWeightArray(nHydroUnits,nGridCells,pModel);
+  ExitGracefullyIf(!WeightArrayOK,
+                   "ParseTimeSeriesFile: Check of weights for gridded forcing failed. Sum of gridweights for ALL enabled HRUs must be 1.0.",BAD_DATA);
+  bool *disabledHRUs=new bool[nHydroUnits];
+  for (int k = 0; k < nHydroUnits; k++) {
+    disabledHRUs[k]=(!pModel->GetHydroUnit(k)->IsEnabled());
+  }
+  // store (sorted) grid cell ids with non-zero weight in array
+  pGrid->SetIdxNonZeroGridCells(nHydroUnits,nGridCells,disabledHRUs,Options);
+  pGrid->CalculateChunkSize(Options);
+  delete [] disabledHRUs;
+}
 
 void AllocateReservoirDemand(CModel *&pModel,const optStruct &Options,long long SBID, long long SBIDres,double pct_met,int jul_start,int jul_end);
 bool IsContinuousStageObs(const CTimeSeriesABC *pObs,long long SBID);
@@ -51,7 +563,13 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
   if (RVT.fail()){
     cout << "ERROR opening *.rvt file: "<<Options.rvt_filename<<endl; return false;}
 
-  CParser *p=new CParser(RVT,Options.rvt_filename,line);
+  map<string,grid_weight_table*> weight_tables; //:GridWeightsFile contents, by file
+
+  //read .rvt and redirected files in advance, while earlier files are parsed
+  CRVTPrefetch prefetch;
+  prefetch.Start(Options);
+
+  CParser *p=OpenTimeSeriesParser(RVT,Options.rvt_filename,line,prefetch,Options);
 
   if (Options.noisy)
   {
@@ -162,6 +680,7 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
     else if  (!strcmp(s[0],":StationIDNameNC"             )){code=416;}
     else if  (!strcmp(s[0],":StationElevationsByIdx"      )){code=417;}
     else if  (!strcmp(s[0],":MapStationsTo"               )){code=418;}//Alternate to :GridWeights for :StationForcing command
+    else if  (!strcmp(s[0],":GridWeightsFile"             )){code=419;}//Alternate to :GridWeights block
 
     //---------STATION DATA INPUT AS NETCDF (stations,time)------
     //             code 401-405 & 407-414 are shared between
@@ -198,7 +717,7 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
           ExitGracefully(warn.c_str(),BAD_DATA);
         }
         pMainParser=p;
-        p=new CParser(INPUT2,filename,line);//open new parser
+        p=OpenTimeSeriesParser(INPUT2,filename,line,prefetch,Options);//open new parser
       }
       else { //from already redirected .rvt file
         INPUT3.open(filename.c_str());
@@ -208,7 +727,7 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
           ExitGracefully(warn.c_str(),BAD_DATA);
         }
         pSecondaryParser=p;
-        p=new CParser(INPUT3,filename,line);//open new parser
+        p=OpenTimeSeriesParser(INPUT3,filename,line,prefetch,Options);//open new parser
       }
       break;
     }
@@ -1730,18 +2249,48 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
         } // end else
       } // end while
 
-      // check that weightings sum up to one per HRU
-      bool WeightArrayOK = pGrid->CheckWeightArray(nHydroUnits,nGridCells,pModel);
-      ExitGracefullyIf(!WeightArrayOK,
-                       "ParseTimeSeriesFile: Check of weights for gridded forcing failed. Sum of gridweights for ALL enabled HRUs must be 1.0.",BAD_DATA);
-      bool *disabledHRUs=new bool[nHydroUnits];
-      for (int k = 0; k < nHydroUnits; k++) {
-        disabledHRUs[k]=(!pModel->GetHydroUnit(k)->IsEnabled());
+      FinalizeGridWeights(pGrid,pModel,nHydroUnits,nGridCells,Options);
+      break;
+    }
+    case (419)://----------------------------------------------
+    {/*:GridWeightsFile [filename] # alternative to :GridWeights block - ALWAYS LAST!
+        binary (RVGRDWTS) or NetCDF (.nc) sparse weights file with HRU ID, cell ID, weight columns
+      */
+      if (Options.noisy){cout <<"GridWeightsFile..."<<endl;}
+#ifndef _RVNETCDF_
+      ExitGracefully("ParseTimeSeriesFile: :GriddedForcing and :StationForcing blocks are only allowed when NetCDF library is available!",BAD_DATA);
+#endif
+      ExitGracefullyIf(pGrid==NULL,
+                       "ParseTimeSeriesFile: :GridWeightsFile command must be within a :GriddedForcing or :StationForcing block",BAD_DATA);
+      if (Len<2){p->ImproperFormat(s); break;}
+
+      if (!grid_initialized) { //must initialize grid prior to adding grid weights
+        grid_initialized = true;
+        pGrid->ForcingGridInit(Options);
       }
-      // store (sorted) grid cell ids with non-zero weight in array
-      pGrid->SetIdxNonZeroGridCells(nHydroUnits,nGridCells,disabledHRUs,Options);
-      pGrid->CalculateChunkSize(Options);
-      delete [] disabledHRUs;
+      string filename="";
+      for(int i=1;i<Len;i++) { filename+=s[i]; if(i<Len-1) { filename+=' '; } }
+      filename =CorrectForRelativePath(filename ,Options.rvt_filename);
+
+      int nHydroUnits=pModel->GetNumHRUs();
+      int nGridCells =pGrid->GetCols() * pGrid->GetRows();
+
+      grid_weight_table *W=NULL; //each weights file read only once
+      map<string,grid_weight_table*>::iterator it=weight_tables.find(filename);
+      if (it!=weight_tables.end()){W=it->second;}
+      else {
+        W=LoadGridWeightsFile(filename,nGridCells,pModel);
+        weight_tables[filename]=W;
+      }
+      if (W->nCells!=nGridCells){
+        ExitGracefully("ParseTimeSeriesFile: :GridWeightsFile shared by grids with differing numbers of grid cells",BAD_DATA);
+      }
+
+      pGrid->SetnHydroUnits(nHydroUnits);
+      pGrid->AllocateWeightArray(nHydroUnits,nGridCells);
+      pGrid->SetWeightArrays(W->aStart,W->aCellID,W->aWt);
+
+      FinalizeGridWeights(pGrid,pModel,nHydroUnits,nGridCells,Options);
       break;
     }
 
@@ -2032,27 +2581,23 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
 
       // generate grid weights
       //====================================================================
+      unordered_map<long long,int> StationIndex; //station index i of each subbasin/HRU ID (first, if repeated)
+      for (int i=0;i<nStations;i++){StationIndex.emplace((long long)(StatIDs[i]),i);}
+
       int StationID=DOESNT_EXIST;
       for (int k=0;k<pModel->GetNumHRUs();k++)
       {
+        long long ID;
         if (sb_command){ //SUBBASINS
-          StationID=DOESNT_EXIST;
           int p=pModel->GetHydroUnit(k)->GetSubBasinIndex();
-          long long SBID=pModel->GetSubBasin(p)->GetID();
-          for (int i=0;i<nStations;i++){
-            if (SBID==StatIDs[i]){
-              StationID=i; break;
-            }
-          }
+          ID=pModel->GetSubBasin(p)->GetID();
         }
         else { //HRUS
-          StationID=DOESNT_EXIST;
-          for (int i=0;i<nStations;i++){
-            if (pModel->GetHydroUnit(k)->GetHRUID()==StatIDs[i]){
-              StationID=i; break;
-            }
-          }
+          ID=pModel->GetHydroUnit(k)->GetHRUID();
         }
+        StationID=DOESNT_EXIST;
+        unordered_map<long long,int>::const_iterator it=StationIndex.find(ID);
+        if (it!=StationIndex.end()){StationID=it->second;}
         int p=pModel->GetHydroUnit(k)->GetSubBasinIndex();
         //cout<<"SETTING WEIGHT "<<k<<" "<<StationID<<" "<<pModel->GetSubBasin(p)->GetID()<<endl;
         pGrid->SetWeightVal(k,StationID,1.0);
@@ -2162,7 +2707,7 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
     {
       INPUT3.clear();
       INPUT3.close();
-      delete p;
+      CloseTimeSeriesParser(p,Options);
       p=pSecondaryParser;
       pSecondaryParser=NULL;
       end_of_file=p->Tokenize(s,Len);
@@ -2171,7 +2716,7 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
     {
       INPUT2.clear();
       INPUT2.close();
-      delete p;
+      CloseTimeSeriesParser(p,Options);
       p=pMainParser;
       pMainParser=NULL;
       end_of_file=p->Tokenize(s,Len);
@@ -2186,7 +2731,9 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
     WriteWarning("ParseTimeSeriesFile: irrigation/diversions included with transport constituents. Since water demands are not currently simulated in the Raven transport module, transport results must be interpreted with care.",Options.noisy);
   }
 
-  delete p; p=NULL;
+  CloseTimeSeriesParser(p,Options); p=NULL;
+
+  for (map<string,grid_weight_table*>::iterator it=weight_tables.begin();it!=weight_tables.end();it++){delete it->second;}
 
   return true;
 }
@@ -30,7 +30,6 @@ double CRadiation::EstimateShortwaveRadiation(CModel* pModel,
 {
   const optStruct* Options = pModel->GetOptStruct();
   double latrad=pHRU->GetLatRad();
-  double lateq =pHRU->GetLatEq();
   switch(Options->SW_radiation)
   {
   //--------------------------------------------------------
@@ -44,15 +43,13 @@ double CRadiation::EstimateShortwaveRadiation(CModel* pModel,
   case(SW_RAD_DEFAULT):
   {
     double dew_pt    =GetDewPointTemp(F->temp_ave,F->rel_humidity);
-    double slope     =pHRU->GetSlope();
-    double solar_noon=pHRU->GetSolarNoon();
-    double aspect    =pHRU->GetAspect();
-
-    double SWrad= ClearSkySolarRadiation(tt.julian_day, Options->timestep,
-                                         latrad, lateq, slope, aspect,
-                                         F->day_angle, F->day_length,
-                                         solar_noon, dew_pt, ET_rad, ET_rad_flat,
-                                         (Options->timestep >= 1.0));
+
+    //geometric terms shared by all HRUs of same latitude, slope and aspect
+    const solar_geom *pS=pModel->GetSolarGeometry(pHRU->GetGlobalIndex(),F,*Options,tt);
+    ET_rad     =pS->ET_radia;
+    ET_rad_flat=pS->ET_radia_flat;
+
+    double SWrad= ClearSkyAttenuation(dew_pt,pS->opt_air_mass,ET_rad,ET_rad_flat);
     if (Options->SW_radiation==SW_RAD_DATA){return F->SW_radia;} //ensures ET_rad still calculated!
     else                                   {return SWrad;}
 
@@ -62,8 +59,9 @@ double CRadiation::EstimateShortwaveRadiation(CModel* pModel,
   {
     //calculates DAILY MEAN shortwave
     double solar_rad;
-    double elev=pHRU->GetElevation();
-    solar_rad= UBC_SolarRadiation(latrad,elev,F->day_angle, F->day_length,ET_rad);
+    const solar_geom *pS=pModel->GetSolarGeometry(pHRU->GetGlobalIndex(),F,*Options,tt);
+    solar_rad=pS->clear_sky;
+    ET_rad   =pS->ET_radia;
     ET_rad_flat=ET_rad;
     double orient=1.0-fabs(pHRU->GetAspect()/PI-1.0);        //=0 for north, 1.0 for south
     if(pHRU->GetLatRad()<0.0) { orient=1.0-orient; }//southern hemisphere phase shift
@@ -1003,11 +1001,42 @@ double CRadiation::ClearSkySolarRadiation(const double &julian_day,
                                                 double &ET_radia_flat, //ET radiation on flat ground [MJ/m2/d]
                                           const bool    avg_daily) //true if average daily is to be computed
 {
-  double Ket,Ketp;          //daily solar radiation with (Ket) and without (Ketp) slope correction, [MJ/m2/d]
-  double tau;               //total atmospheric transmissivity [-]
-  double tau2;              //50% of solar beam attenuation from vapor and dust [-]
   double Mopt;              //optical air mass [-]
-  double gamma_dust=0.025;  //attenuation due to dust
+
+  ClearSkyGeometry(julian_day,tstep,latrad,slope,aspect,day_angle,day_length,avg_daily,Mopt,ET_radia,ET_radia_flat);
+
+  return ClearSkyAttenuation(dew_pt,Mopt,ET_radia,ET_radia_flat);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Calculates the geometric (atmosphere-independent) terms of clear sky radiation
+/// \details depends only upon location, orientation and time, and may therefore be
+///  shared by all HRUs with the same latitude, slope and aspect
+///
+/// \param julian_day [in] Julian day of year
+/// \param tstep [in] time step [d]
+/// \param latrad [in] Latitude [rad]
+/// \param slope [in] Slope [rad]
+/// \param aspect [in] Aspect [rad]
+/// \param day_angle [in] Day angle [rad]
+/// \param day_length [in] Day length [days]
+/// \param avg_daily [in] True if average daily is to be computed
+/// \param opt_air_mass [out] optical air mass [-]
+/// \param ET_radia [out] Extraterrestrial radiation on slope [MJ/m2/d]
+/// \param ET_radia_flat [out] Extraterrestrial radiation on flat ground [MJ/m2/d]
+//
+void CRadiation::ClearSkyGeometry(const double &julian_day,
+                                  const double &tstep,
+                                  const double &latrad,    //[rad]
+                                  const double &slope,     //[rad]
+                                  const double &aspect,    //[rad]
+                                  const double &day_angle,
+                                  const double &day_length,
+                                  const bool    avg_daily,
+                                        double &opt_air_mass,
+                                        double &ET_radia,
+                                        double &ET_radia_flat)
+{
   double declin;            //solar declination
   double ecc;               //eccentricity correction [-]
   double t_sol,t_sol2;      //time of day w.r.t. solar noon (start & end of timestep) [d]
@@ -1018,23 +1047,70 @@ double CRadiation::ClearSkySolarRadiation(const double &julian_day,
   t_sol=julian_day-floor(julian_day)-0.5;
   t_sol2=t_sol+tstep;
 
-  Mopt =OpticalAirMass(latrad,declin,day_length,t_sol,avg_daily);
-  tau  =CalcScatteringTransmissivity(dew_pt,Mopt)-gamma_dust;               //Dingman E-9
-  tau2 =0.5*(1.0-CalcDiffScatteringTransmissivity(dew_pt,Mopt)+gamma_dust); //Dingman E-15
+  opt_air_mass =OpticalAirMass(latrad,declin,day_length,t_sol,avg_daily);
 
   //Ketp =CalcETRadiation(latrad,lateq ,declin,ecc,slope,solar_noon,day_length,t_sol,avg_daily); //old dingman approach
   //Ket  =CalcETRadiation(latrad,latrad,declin,ecc,0.0  ,0.0,       day_length,t_sol,avg_daily);
 
-  Ketp =CalcETRadiation2(latrad,aspect,declin,ecc,slope,t_sol,t_sol2,avg_daily);
-  Ket  =CalcETRadiation2(latrad,aspect,declin,ecc,0.0  ,t_sol,t_sol2,avg_daily);
+  ET_radia     =CalcETRadiation2(latrad,aspect,declin,ecc,slope,t_sol,t_sol2,avg_daily);
+  ET_radia_flat=CalcETRadiation2(latrad,aspect,declin,ecc,0.0  ,t_sol,t_sol2,avg_daily);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Recalculates the radiation terms of a solar geometry class for the current time step
+/// \details used for cached shortwave radiation terms shared between HRUs (see CModel::GetSolarGeometry)
+///
+/// \param S [in/out] solar geometry class
+/// \param *F [in] forcing functions of any HRU in class (only day angle and day length are used)
+/// \param Options [in] global options structure
+/// \param tt [in] current time structure
+//
+void CRadiation::UpdateSolarGeometry(solar_geom         &S,
+                                     const force_struct *F,
+                                     const optStruct    &Options,
+                                     const time_struct  &tt)
+{
+  if (Options.SW_radiation==SW_RAD_UBCWM)
+  {
+    S.clear_sky    =UBC_SolarRadiation(S.latrad,S.elev,F->day_angle,F->day_length,S.ET_radia);
+    S.ET_radia_flat=S.ET_radia;
+    S.opt_air_mass =0.0;
+  }
+  else
+  {
+    ClearSkyGeometry(tt.julian_day,Options.timestep,S.latrad,S.slope,S.aspect,
+                     F->day_angle,F->day_length,(Options.timestep>=1.0),
+                     S.opt_air_mass,S.ET_radia,S.ET_radia_flat);
+    S.clear_sky    =0.0;
+  }
+  S.t_cached=tt.model_time;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Applies atmospheric attenuation to extraterrestrial radiation to obtain clear sky radiation [MJ/m2/d]
+///
+/// \param dew_pt [in] Dew point temperature [C]
+/// \param opt_air_mass [in] optical air mass [-]
+/// \param ET_radia [in] Extraterrestrial radiation on slope [MJ/m2/d]
+/// \param ET_radia_flat [in] Extraterrestrial radiation on flat ground [MJ/m2/d]
+/// \return Clear sky total radiation [MJ/m2/d]
+//
+double CRadiation::ClearSkyAttenuation(const double &dew_pt,
+                                       const double &opt_air_mass,
+                                       const double &ET_radia,
+                                       const double &ET_radia_flat)
+{
+  double tau;               //total atmospheric transmissivity [-]
+  double tau2;              //50% of solar beam attenuation from vapor and dust [-]
+  double gamma_dust=0.025;  //attenuation due to dust
 
-  ET_radia=Ketp;
-  ET_radia_flat=Ket;
+  tau  =CalcScatteringTransmissivity(dew_pt,opt_air_mass)-gamma_dust;               //Dingman E-9
+  tau2 =0.5*(1.0-CalcDiffScatteringTransmissivity(dew_pt,opt_air_mass)+gamma_dust); //Dingman E-15
 
   //DingmanE-26 (from E-8,E-14,E-19,E-20)
-  return tau *Ketp+                               //direct solar radiation on surface
-         tau2*Ket+                                //diffuse radiation
-         tau2*GLOBAL_ALBEDO*(tau2+tau)*Ketp;      //backscattered radiation
+  return tau *ET_radia+                               //direct solar radiation on surface
+         tau2*ET_radia_flat+                          //diffuse radiation
+         tau2*GLOBAL_ALBEDO*(tau2+tau)*ET_radia;      //backscattered radiation
 }
 
 
@@ -10,6 +10,7 @@
 #include "HydroUnits.h"
 
 class CModel;  // defined in Model.h
+struct solar_geom; // defined in Model.h
 
 ///////////////////////////////////////////////////////////////////
 /// \brief Utility class for radiation calculations
@@ -87,6 +88,25 @@ public:/*------------------------------------------------------*/
                                            double &ET_radia,			  //ET radiation [MJ/m2/d]
                                            double &ET_radia_flat, //ET radiation without slope correction [MJ/m2/d]
                                            const bool   avg_daily);	//true if average daily is to be computed
+  static void   ClearSkyGeometry          (const double &julian_day,
+                                           const double &tstep,
+                                           const double &latrad,			//[rad]
+                                           const double &slope,			//[rad]
+                                           const double &aspect,     //[rad]
+                                           const double &day_angle,
+                                           const double &day_length,
+                                           const bool    avg_daily,
+                                           double &opt_air_mass,   //optical air mass [-]
+                                           double &ET_radia,			  //ET radiation [MJ/m2/d]
+                                           double &ET_radia_flat); //ET radiation without slope correction [MJ/m2/d]
+  static void   UpdateSolarGeometry       (solar_geom         &S,
+                                           const force_struct *F,
+                                           const optStruct    &Options,
+                                           const time_struct  &tt);
+  static double ClearSkyAttenuation       (const double &dew_pt,			//dew point temp, [C]
+                                           const double &opt_air_mass,
+                                           const double &ET_radia,
+                                           const double &ET_radia_flat);
   static double EstimateShortwaveRadiation(CModel* pModel,
                                            const force_struct *F,
                                            const CHydroUnit *pHRU,
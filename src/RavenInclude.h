@@ -98,8 +98,8 @@ Other comments:
 extern string g_output_directory; ///< Had to be here to avoid passing Options structure around willy-nilly
 extern double g_debug_vars[10];   ///< can store any variables used during debugging; written to raven_debug.csv if debug_mode is on
 extern bool   g_suppress_warnings;///< Had to be here to avoid passing Options structure around willy-nilly
-extern string g_last_warning;     ///
-extern int    g_warn_count;       
+extern int    g_warning_limit;    ///< maximum number of warnings written to Raven_errors.txt per message template (0 if unlimited)
+extern int    g_num_threads;      ///< number of threads used by ParallelFor (0 if one per available core)
 extern bool   g_suppress_zeros;   ///< converts all output numbers less than REAL_SMALL to zero
 extern bool   g_disable_freezing; ///< disables freezing impacts in thermal wrapper code
 extern double g_min_storage;      ///< minimum soil storage
@@ -264,6 +264,7 @@ const double  RAV_BLANK_DATA          =-1.2345;
 const double  DIRICHLET_TEMP          =-9999.0;                                 ///< dirichlet concentration flag corresponding to air temperature
 const int     FROM_STATION_VAR        =-55;                                     ///< special flag indicating that NetCDF indices should be looked up from station attribute table
 const double  BY_SUBBASIN_FLAG        =64;                                      ///< special flag indicating flush percentage should be retrieved from subbasin parameter
+const int     DEFAULT_WARNING_LIMIT   =0;                                       ///< default maximum number of warnings written per message template (:WarningLimit); 0 if unlimited
 
 //Decision constants
 const double  HUGE_RESIST             =1e20;                                    ///< [d/mm]   essentially infinite resistance
@@ -812,6 +813,7 @@ enum out_format
   OUTPUT_STANDARD,       ///< Output in default Raven format (.csv files)
   OUTPUT_ENSIM,          ///< Output in Ensim format (.tb0 files)
   OUTPUT_NETCDF,         ///< Output in NetCDF format (.nc files)
+  OUTPUT_BINARY,         ///< Output in binary column format (.npy files with .json sidecar)
   OUTPUT_NONE            ///< Output is suppressed
 };
 
@@ -1102,6 +1104,7 @@ struct optStruct
   string           flowinfo_filename;         ///< fully qualified filename of flowstate_mods.nc file from FEWS
   string           paraminfo_filename;        ///< fully qualified filename of param_mods.nc file from FEWS
   string           warm_ensemble_run;         ///< run name prefix in warm ensemble solution files
+  string           ts_cache_dir;              ///< directory of binary time series cache, includes final backslash (empty if cache not used)
 
   string           main_output_dir;           ///< primary output directory (=output_dir for non-ensemble), includes final backslash
   string           output_dir;                ///< output directory (can change during ensemble run), includes final backslash
@@ -1177,6 +1180,8 @@ struct optStruct
   bool             write_watershed_storage;   ///< true if WatershedStorage.csv/tb0/nc is written (default: true)
   bool             write_constitmass;         ///< true if constituent mass [mg/m2] is written instead of concentration [mg/L] in output files
   bool             write_basinfile;           ///< true if subbasins params are written to SubbasinParams.csv
+  bool             write_binary_rvc;          ///< true if solution state is also written to binary checkpoint file (solution.rvb)
+  bool             write_text_rvc;            ///< true if solution state is written to text solution file (solution.rvc) (default: true)
   bool             write_basinauto;           ///< true if autogenerated subbasin params are written to SubBasinProperties_Auto.rvh
   bool             write_interp_wts;          ///< true if interpolation weights are written to InterpolationWeights.csv
   bool             write_demandfile;          ///< true if demands.csv file is to be written
@@ -1186,6 +1191,7 @@ struct optStruct
   bool             write_netresinflow;        ///< true if reservoir net inflows are written to Hydrographs file (csv or nc)
   bool             benchmarking;              ///< true if benchmarking output - removes version/timestamps in output
   bool             suppressICs;               ///< true if initial conditions are suppressed when writing output time series
+  bool             async_output;              ///< true if .csv output buffers are written to disk by a background thread
   bool             period_ending;             ///< true if period ending convention should be used for reading/writing Ensim files
   bool             period_starting;           ///< true if all timestep-averaged output is reported using starttime of timestep
   bool             pause;                     ///< determines whether the simulation pauses at the end of the model run
@@ -1206,6 +1212,8 @@ struct optStruct
   netcdfatt       *aNetCDFattribs;            ///< array of NetCDF attrributes {attribute/value pair}
   int              nNetCDFattribs;            ///< size of array of NetCDF attributes
   int              NetCDF_chunk_mem;          ///< [MB] size of memory chunk for each forcing grid
+  int              NetCDF_deflate_level;      ///< deflate level of NetCDF output files (0: no compression)
+  int              NetCDF_time_chunk;         ///< time chunk size of NetCDF output files [time steps] (0: default)
   bool             in_bmi_mode;               ///< true if in BMI mode 
   bool             use_bmi_weather;           ///< true if forcings provided by BMI connection (no rvt, gauges, grids required)
   double           sv_override_endtime;       ///< model time [d] after which state variable overrides are disabled (default: 1e99)
@@ -1416,6 +1424,7 @@ void        AddTime               (const double      jul_day1,
                                          double      &jul_day_out,
                                          int         &year_out);
 int         StringToCalendar      (      string      cal_chars);
+string      CalendarToString      (const int         calendar);
 string      GetCurrentMachineTime ();
 double      FixTimestep           (      double      tstep);
 bool        IsValidDateString     (const string      sDate);
@@ -1674,8 +1683,11 @@ string   StringToUppercase      (const string &s);
 bool     IsComment              (const char *s, const int Len);
 void     WriteWarning           (const string warn, bool noisy);
 void     WriteAdvisory          (const string warn, bool noisy);
+void     FlushWarnings          ();
+void     CloseWarnings          ();
 HRU_type StringToHRUType        (const string s);
 double   fast_s_to_d            (const char *s);
+double   fast_s_to_d            (const char *s, const char *&end);
 double   FormatDouble           (const double &d);
 void     SubstringReplace       (string& str,const string& from,const string& to);
 
@@ -1738,6 +1750,8 @@ void   getRanks         (const double *arr, const int N, int *ranks);
 void   pushIntoIntArray (int*&a, const int &v, int &n);
 
 #include <functional>
+void   ParallelFor      (const int N,const int min_chunk,const std::function<void(int,int)> &body);
+
 template <typename T>
 void sortPointerArray(const T** arr, int n, std::function<bool(const T*, const T*)> cmp) {
   if (!arr || n <= 1 || !cmp) return;
@@ -22,8 +22,8 @@ double g_debug_vars[10];
 bool   g_disable_freezing =false;
 double g_min_storage      =0.0;
 int    g_current_e        =DOESNT_EXIST;
-int    g_warn_count       =1;
-string g_last_warning     =""; 
+int    g_warning_limit    =DEFAULT_WARNING_LIMIT;
+int    g_num_threads      =0;
 
 static string RavenBuildDate(__DATE__);
 
@@ -165,6 +165,7 @@ int main(int argc, char* argv[])
       pModel->UpdateDiagnostics          (Options,tt); //required to read stuff!!
       pModel->GetEnsemble()->CloseTimeStepOps(pModel,Options,tt,e);
 
+      if (pModel->CheckObjectiveBound(Options,tt)) { break; }
       if ((Options.use_stopfile) && (CheckForStopfile(step, tt, pModel))) { break; }
       step++;
     }
@@ -345,6 +346,7 @@ void CheckForErrorWarnings(bool quiet, CModel *pModel)
   bool     warnings_found(false);
   const optStruct* Options = pModel->GetOptStruct();
 
+  FlushWarnings();
   ifstream WARNINGS;
   WARNINGS.open((Options->main_output_dir+"Raven_errors.txt").c_str());
   if (WARNINGS.fail()){WARNINGS.close();return;}
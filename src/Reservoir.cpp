@@ -4,6 +4,7 @@
   ----------------------------------------------------------------*/
 #include "Reservoir.h"
 #include "Model.h"     // needed to define CModel
+#include "Checkpoint.h"
 
 //////////////////////////////////////////////////////////////////
 /// \brief Base Constructor for reservoir called by all other constructors
@@ -1864,6 +1865,19 @@ void CReservoir::WriteToSolutionFile (ofstream &RVC) const
   }
 }
 //////////////////////////////////////////////////////////////////
+/// \brief writes reservoir state to binary checkpoint file
+/// \details binary equivalent of WriteToSolutionFile
+//
+void CReservoir::WriteToCheckpoint (CCheckpointWriter &CHK) const
+{
+  CHK.Put<double>(_Qout);     CHK.Put<double>(_Qout_last);
+  CHK.Put<double>(_stage);    CHK.Put<double>(_stage_last);
+  CHK.Put<double>(_DAadjust); CHK.Put<double>(_DAadjust_last);
+  CHK.Put<int>(_nControlStructures);
+  CHK.PutArray(_aQstruct,     _nControlStructures);
+  CHK.PutArray(_aQstruct_last,_nControlStructures);
+}
+//////////////////////////////////////////////////////////////////
 /// \brief interpolates the volume from the volume-stage rating curve
 /// \param ht [in] reservoir stage
 /// \returns reservoir volume [m3] corresponding to stage ht
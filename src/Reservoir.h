@@ -44,6 +44,7 @@ struct down_demand {
 class CSubBasin;
 class CDemand;
 class CControlStructure;
+class CCheckpointWriter;
 /*****************************************************************
    Class CReservoir
 ------------------------------------------------------------------
@@ -296,6 +297,7 @@ public:/*-------------------------------------------------------*/
                                               const optStruct   &Options,
                                               const time_struct &tt);
   void              WriteToSolutionFile      (ofstream &OUT) const;
+  void              WriteToCheckpoint        (CCheckpointWriter &CHK) const;
   void              UpdateReservoir          (const time_struct &tt, const optStruct &Options);
   void              UpdateMassBalance        (const time_struct &tt, const double &tstep, const optStruct &Options);
   double            AdjustFlow               (const double &Qadjust, const bool overriding,const double &tstep,const double &t);
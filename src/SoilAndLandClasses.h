@@ -53,12 +53,14 @@ public:/*-------------------------------------------------------*/
   const soil_struct       *GetSoilStruct() const;
   double                   GetSoilProperty(string &param_name) const;
   void                     SetSoilProperty(string param_name, const double &value);
+  double                  *GetSoilPropertyAddress(const string &param_name);
 
   //routines
   void AutoCalculateSoilProps(const soil_struct &Stmp,const soil_struct &Sdefault,const int nConstit);
 
   static void              SetSoilProperty         (soil_struct &S, string param_name, const double value);
   static double            GetSoilProperty         (const soil_struct &S, string param_name, const bool strict=true);
+  static double           *GetSoilPropertyAddress  (soil_struct &S, const string param_name);
   static void              InitializeSoilProperties(soil_struct &S, bool is_template,int nConstits);
 
   static double            CalcSoilResistance(const double &psi,const soil_struct &S);
@@ -92,6 +94,7 @@ public:/*-------------------------------------------------------*/
   double                   GetParameter(const string param_name) const;//not currently used
   double                   GetVegetationProperty(string param_name) const;
   void                     SetVegetationProperty(const string &param_name, const double &value);
+  double                  *GetVegetationPropertyAddress(const string &param_name);
 
   //routines
   void AutoCalculateVegetationProps(const veg_struct    &Vtmp,
@@ -107,6 +110,7 @@ public:/*-------------------------------------------------------*/
   static void                    SetVegTransportProperty( int          constit_ind,int          constit_ind2,
                                                           veg_struct  &V,string param_name, const double value);
   static double                  GetVegetationProperty(const veg_struct &V, string param_name, const bool strict=true);
+  static double                 *GetVegetationPropertyAddress(veg_struct &V, const string param_name);
   static double                  GetVegTransportProperty(int constit_ind, const veg_struct &V,string &param_name);
 
   static void                    InitializeVegetationProps(string name, veg_struct &V, bool is_template);
@@ -167,6 +171,7 @@ public:/*-------------------------------------------------------*/
   const surface_struct *GetSurfaceStruct() const;
   double                GetSurfaceProperty(string param_name) const;
   void                  SetSurfaceProperty(const string &param_name, const double &value);
+  double               *GetSurfacePropertyAddress(const string &param_name);
   void                  InitializeSurfaceProperties(string name, bool is_template);
 
   //routines
@@ -179,6 +184,7 @@ public:/*-------------------------------------------------------*/
   static void          InitializeSurfaceProperties(string name, surface_struct &S, bool is_template);
   static void          SetSurfaceProperty         (surface_struct &S, const string param_name, const double value);
   static double        GetSurfaceProperty         (const surface_struct &S, string param_name, const bool strict=true);
+  static double       *GetSurfacePropertyAddress  (surface_struct &S, const string param_name);
 };
 
 ///////////////////////////////////////////////////////////////////
@@ -202,6 +208,7 @@ public:/*-------------------------------------------------------*/
   const terrain_struct    *GetTerrainStruct() const;
   double                   GetTerrainProperty(string param_name) const;
   void                     SetTerrainProperty(const string &param_name, const double &value);
+  double                  *GetTerrainPropertyAddress(const string &param_name);
 
   //routines
   void AutoCalculateTerrainProps(const terrain_struct &Ttmp, const terrain_struct &Tdefault);
@@ -214,6 +221,7 @@ public:/*-------------------------------------------------------*/
   static void                    InitializeTerrainProperties(terrain_struct &T, bool is_template);
   static void                    SetTerrainProperty(terrain_struct &T, const string  param_name, const double value);
   static double                  GetTerrainProperty(const terrain_struct &T, string param_name);
+  static double                 *GetTerrainPropertyAddress(terrain_struct &T, const string param_name);
 
   static void                    SummarizeToScreen();
 };
@@ -438,6 +438,84 @@ void  CSoilClass::SetSoilProperty(string        param_name,
   SetSoilProperty(_Soil,param_name,value);
 }
 //////////////////////////////////////////////////////////////////
+/// \brief Returns address of the soil property corresponding to param_name
+/// \param param_name [in] Parameter identifier
+/// \return address of parameter, or NULL if param_name is not a single-valued soil property
+//
+double *CSoilClass::GetSoilPropertyAddress(const string &param_name)
+{
+  return GetSoilPropertyAddress(_Soil,param_name);
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Returns address of the soil property corresponding to param_name
+/// \param &S [in] Soil properties structure
+/// \param param_name [in] Parameter identifier
+/// \return address of parameter in S, or NULL if param_name is not a single-valued soil property
+//
+double *CSoilClass::GetSoilPropertyAddress(soil_struct &S,
+                                           const string param_name)
+{
+  string name = StringToUppercase(param_name);
+
+  if      (!name.compare("ORG_CON"             )){return &(S.org_con);}
+  else if (!name.compare("CLAY_CON"            )){return &(S.clay_con);}
+  else if (!name.compare("SAND_CON"            )){return &(S.sand_con);}
+  else if (!name.compare("POROSITY"            )){return &(S.porosity);}
+  else if (!name.compare("STONE_FRAC"          )){return &(S.stone_frac);}
+  else if (!name.compare("BULK_DENSITY"        )){return &(S.bulk_density);}
+  else if (!name.compare("HEAT_CAPACITY"       )){return &(S.heat_capacity);}
+  else if (!name.compare("THERMAL_COND"        )){return &(S.thermal_cond);}
+  else if (!name.compare("HYDRAUL_COND"        )){return &(S.hydraul_cond);}
+  else if (!name.compare("CLAPP_B"             )){return &(S.clapp_b);}
+  else if (!name.compare("CLAPP_M"             )){return &(S.clapp_m);}
+  else if (!name.compare("CLAPP_N"             )){return &(S.clapp_n);}
+  else if (!name.compare("SAT_RES"             )){return &(S.sat_res);}
+  else if (!name.compare("SAT_WILT"            )){return &(S.sat_wilt);}
+  else if (!name.compare("FIELD_CAPACITY"      )){return &(S.field_capacity);}
+  else if (!name.compare("AIR_ENTRY_PRESSURE"  )){return &(S.air_entry_pressure);}
+  else if (!name.compare("WILTING_PRESSURE"    )){return &(S.wilting_pressure);}
+  else if (!name.compare("WETTING_FRONT_PSI"   )){return &(S.wetting_front_psi);}
+  else if (!name.compare("KSAT_STD_DEVIATION"  )){return &(S.ksat_std_deviation);}
+  else if (!name.compare("UNAVAIL_FRAC"        )){return &(S.unavail_frac);}
+
+  else if (!name.compare("EVAP_RES_FC"         )){return &(S.evap_res_fc);}
+  else if (!name.compare("SHUTTLEWORTH_B"      )){return &(S.shuttleworth_b);}
+  else if (!name.compare("PET_CORRECTION"      )){return &(S.PET_correction);}
+  else if (!name.compare("ALBEDO_WET"          )){return &(S.albedo_wet);}
+  else if (!name.compare("ALBEDO_DRY"          )){return &(S.albedo_dry);}
+  else if (!name.compare("VIC_ZMIN"            )){return &(S.VIC_zmin);}
+  else if (!name.compare("VIC_ZMAX"            )){return &(S.VIC_zmax);}
+  else if (!name.compare("VIC_ALPHA"           )){return &(S.VIC_alpha);}
+  else if (!name.compare("VIC_EVAP_GAMMA"      )){return &(S.VIC_evap_gamma);}
+  else if (!name.compare("B_EXP"               )){return &(S.VIC_b_exp);} //backward compat
+  else if (!name.compare("VIC_B_EXP"           )){return &(S.VIC_b_exp);}
+  else if (!name.compare("MAX_PERC_RATE"       )){return &(S.max_perc_rate);}
+  else if (!name.compare("PERC_N"              )){return &(S.perc_n);}
+  else if (!name.compare("PERC_COEFF"          )){return &(S.perc_coeff);}
+  else if (!name.compare("SAC_PERC_ALPHA"      )){return &(S.SAC_perc_alpha);}
+  else if (!name.compare("SAC_PERC_EXPON"      )){return &(S.SAC_perc_expon);}
+  else if (!name.compare("SAC_PERC_PFREE"      )){return &(S.SAC_perc_pfree);}
+  else if (!name.compare("PERC_ASPEN"          )){return &(S.perc_aspen);}
+  else if (!name.compare("MAX_INTERFLOW_RATE"  )){return &(S.max_interflow_rate);}
+  else if (!name.compare("INTERFLOW_COEFF"     )){return &(S.interflow_coeff);}
+  else if (!name.compare("MAX_BASEFLOW_RATE"   )){return &(S.max_baseflow_rate);}
+  else if (!name.compare("BASEFLOW_N"          )){return &(S.baseflow_n);}
+  else if (!name.compare("BASE_STOR_COEFF"     )){return &(S.baseflow_coeff);}
+  else if (!name.compare("BASEFLOW_COEFF"      )){return &(S.baseflow_coeff);}
+  else if (!name.compare("MAX_CAP_RISE_RATE"   )){return &(S.max_cap_rise_rate);}
+  else if (!name.compare("HBV_BETA"            )){return &(S.HBV_beta);}
+  else if (!name.compare("UBC_EVAP_SOIL_DEF"   )){return &(S.UBC_evap_soil_def);}
+  else if (!name.compare("UBC_INFIL_SOIL_DEF"  )){return &(S.UBC_infil_soil_def);}
+  else if (!name.compare("GR4J_X2"             )){return &(S.GR4J_x2);}
+  else if (!name.compare("GR4J_X3"             )){return &(S.GR4J_x3);}
+  else if (!name.compare("BASEFLOW_THRESH"     )){return &(S.baseflow_thresh);}
+  else if (!name.compare("EXCHANGE_FLOW"       )){return &(S.exchange_flow);}
+  else if (!name.compare("BASEFLOW_COEFF2"     )){return &(S.baseflow_coeff2);}
+  else if (!name.compare("STORAGE_THRESHOLD"   )){return &(S.storage_threshold);}
+
+  return NULL;
+}
+//////////////////////////////////////////////////////////////////
 /// \brief Sets the value of the soil property corresponding to param_name
 /// \note This is declared as a static member because soil class
 /// is not instantiated prior to read of .rvp file
@@ -452,61 +530,8 @@ void  CSoilClass::SetSoilProperty(soil_struct &S,
   string name;
   name = StringToUppercase(param_name);
 
-  if      (!name.compare("ORG_CON"             )){S.org_con=value;}
-  else if (!name.compare("CLAY_CON"            )){S.clay_con=value;}
-  else if (!name.compare("SAND_CON"            )){S.sand_con=value;}
-  else if (!name.compare("POROSITY"            )){S.porosity=value;}
-  else if (!name.compare("STONE_FRAC"          )){S.stone_frac=value;}
-  else if (!name.compare("BULK_DENSITY"        )){S.bulk_density=value;}
-  else if (!name.compare("HEAT_CAPACITY"       )){S.heat_capacity=value;}
-  else if (!name.compare("THERMAL_COND"        )){S.thermal_cond=value;}
-  else if (!name.compare("HYDRAUL_COND"        )){S.hydraul_cond=value;}
-  else if (!name.compare("CLAPP_B"             )){S.clapp_b=value;}
-  else if (!name.compare("CLAPP_M"             )){S.clapp_m=value;}
-  else if (!name.compare("CLAPP_N"             )){S.clapp_n=value;}
-  else if (!name.compare("SAT_RES"             )){S.sat_res=value;}
-  else if (!name.compare("SAT_WILT"            )){S.sat_wilt=value;}
-  else if (!name.compare("FIELD_CAPACITY"      )){S.field_capacity=value;}
-  else if (!name.compare("AIR_ENTRY_PRESSURE"  )){S.air_entry_pressure=value;}
-  else if (!name.compare("WILTING_PRESSURE"    )){S.wilting_pressure=value;}
-  else if (!name.compare("WETTING_FRONT_PSI"   )){S.wetting_front_psi=value;}
-  else if (!name.compare("KSAT_STD_DEVIATION"  )){S.ksat_std_deviation=value;}
-  else if (!name.compare("UNAVAIL_FRAC"        )){S.unavail_frac=value;}
-
-  else if (!name.compare("EVAP_RES_FC"         )){S.evap_res_fc=value;}
-  else if (!name.compare("SHUTTLEWORTH_B"      )){S.shuttleworth_b=value;}
-  else if (!name.compare("PET_CORRECTION"      )){S.PET_correction=value;}
-  else if (!name.compare("ALBEDO_WET"          )){S.albedo_wet=value;}
-  else if (!name.compare("ALBEDO_DRY"          )){S.albedo_dry=value;}
-  else if (!name.compare("VIC_ZMIN"            )){S.VIC_zmin=value;}
-  else if (!name.compare("VIC_ZMAX"            )){S.VIC_zmax=value;}
-  else if (!name.compare("VIC_ALPHA"           )){S.VIC_alpha=value;}
-  else if (!name.compare("VIC_EVAP_GAMMA"      )){S.VIC_evap_gamma=value;}
-  else if (!name.compare("B_EXP"               )){S.VIC_b_exp=value;} //backward compat
-  else if (!name.compare("VIC_B_EXP"           )){S.VIC_b_exp=value;}
-  else if (!name.compare("MAX_PERC_RATE"       )){S.max_perc_rate=value;}
-  else if (!name.compare("PERC_N"              )){S.perc_n=value;}
-  else if (!name.compare("PERC_COEFF"          )){S.perc_coeff=value;}
-  else if (!name.compare("SAC_PERC_ALPHA"      )){S.SAC_perc_alpha=value;}
-  else if (!name.compare("SAC_PERC_EXPON"      )){S.SAC_perc_expon=value;}
-  else if (!name.compare("SAC_PERC_PFREE"      )){S.SAC_perc_pfree=value;}
-  else if (!name.compare("PERC_ASPEN"          )){S.perc_aspen=value;}
-  else if (!name.compare("MAX_INTERFLOW_RATE"  )){S.max_interflow_rate=value;}
-  else if (!name.compare("INTERFLOW_COEFF"     )){S.interflow_coeff=value;}
-  else if (!name.compare("MAX_BASEFLOW_RATE"   )){S.max_baseflow_rate=value;}
-  else if (!name.compare("BASEFLOW_N"          )){S.baseflow_n=value;}
-  else if (!name.compare("BASE_STOR_COEFF"     )){S.baseflow_coeff=value;}
-  else if (!name.compare("BASEFLOW_COEFF"      )){S.baseflow_coeff=value;}
-  else if (!name.compare("MAX_CAP_RISE_RATE"   )){S.max_cap_rise_rate=value;}
-  else if (!name.compare("HBV_BETA"            )){S.HBV_beta=value;}
-  else if (!name.compare("UBC_EVAP_SOIL_DEF"   )){S.UBC_evap_soil_def =value;}
-  else if (!name.compare("UBC_INFIL_SOIL_DEF"  )){S.UBC_infil_soil_def=value;}
-  else if (!name.compare("GR4J_X2"             )){S.GR4J_x2 =value;}
-  else if (!name.compare("GR4J_X3"             )){S.GR4J_x3 =value;}
-  else if (!name.compare("BASEFLOW_THRESH"     )){S.baseflow_thresh =value;}
-  else if (!name.compare("EXCHANGE_FLOW"       )){S.exchange_flow=value;}
-  else if (!name.compare("BASEFLOW_COEFF2"     )){S.baseflow_coeff2=value; }
-  else if (!name.compare("STORAGE_THRESHOLD"   )){S.storage_threshold=value;}
+  double *px=GetSoilPropertyAddress(S,name);
+  if      (px!=NULL){*px=value;}
   else{
     WriteWarning("CSoilClass::SetSoilProperty: Unrecognized/invalid soil parameter name ("+name+") in .rvp file",false);
   }
@@ -14,6 +14,7 @@
   ----------------------------------------------------------------*/
 #include "Model.h"
 #include "StateVariables.h"
+#include "Checkpoint.h"
 
 #if defined(_WIN32)
 #include <direct.h>
@@ -26,9 +27,10 @@
 #endif
 int  NetCDFAddMetadata  (const int fileid,const int time_dimid,                  string shortname,string longname,string units);
 int  NetCDFAddMetadata2D(const int fileid,const int time_dimid,int nbasins_dimid,string shortname,string longname,string units);
+size_t NetCDFSetTimeStorage(const int fileid,const int varid_time,const size_t default_chunk,const optStruct &Options);
 void WriteNetCDFGlobalAttributes(const int out_ncid,const optStruct &Options,const string descript);
-void AddSingleValueToNetCDF     (const int out_ncid,const string &label,const size_t time_index,const double &value);
 void WriteNetCDFBasinList       (const int ncid,const int varid,const int varid_name,const CModel* pModel,bool is_res,const optStruct &Options);
+void WriteBinaryFileAttributes  (CBinaryColumnFile &BIN,const optStruct &Options,const string descript);
 //////////////////////////////////////////////////////////////////
 /// \brief returns true if specified observation time series is the flow series for subbasin SBID
 /// \param pObs [in] observation time series
@@ -138,12 +140,20 @@ void CModel::CloseOutputStreams()
   if (_RESSTAGE.is_open()){_RESSTAGE.close();}
   if ( _DEMANDS.is_open()){ _DEMANDS.close();}
   if (  _LEVELS.is_open()){  _LEVELS.close();}
+  _HYDRO_bin.close();
+  _STORAGE_bin.close();
+  _RESSTAGE_bin.close();
 
   if (_pDO!=NULL){_pDO->CloseOutputStreams();}
 
 #ifdef _RVNETCDF_
 
   int    retval;      // error value for NetCDF routines
+  _HYDRO_ncbuf.Flush();    _HYDRO_ncbuf.Destroy();
+  _STORAGE_ncbuf.Flush();  _STORAGE_ncbuf.Destroy();
+  _FORCINGS_ncbuf.Flush(); _FORCINGS_ncbuf.Destroy();
+  _RESSTAGE_ncbuf.Flush(); _RESSTAGE_ncbuf.Destroy();
+  _RESMB_ncbuf.Flush();    _RESMB_ncbuf.Destroy();
   if (_HYDRO_ncid != -9)    {retval = nc_close(_HYDRO_ncid);    HandleNetCDFErrors(retval); }
   _HYDRO_ncid    = -9;
   if (_STORAGE_ncid != -9)  {retval = nc_close(_STORAGE_ncid);  HandleNetCDFErrors(retval); }
@@ -171,6 +181,8 @@ void CModel::WriteOutputFileHeaders(const optStruct &Options)
 
   if(Options.noisy) { cout<<"  Writing Output File Headers..."<<endl; }
 
+  CBufferedOutputFile::SetAsynchronousWrites(Options.async_output);
+
   if (Options.output_format==OUTPUT_STANDARD)
   {
 
@@ -375,6 +387,10 @@ void CModel::WriteOutputFileHeaders(const optStruct &Options)
   {
     WriteNetcdfStandardHeaders(Options);  // creates NetCDF files, writes dimensions and creates variables (without writing actual values)
   }
+  else if (Options.output_format==OUTPUT_BINARY)
+  {
+    WriteBinaryStandardHeaders(Options);
+  }
 
   //Demands.csv
   //--------------------------------------------------------------
@@ -584,6 +600,7 @@ void CModel::WriteOutputFileHeaders(const optStruct &Options)
   if (_pOutputGroup!=NULL){
     for (int kk=0; kk<_pOutputGroup->GetNumHRUs();kk++)
     {
+      if (!IsOutputHRU(_pOutputGroup->GetHRU(kk)->GetGlobalIndex())){continue;}
       ofstream HRUSTOR;
       tmpFilename="HRUStorage_"+to_string(_pOutputGroup->GetHRU(kk)->GetHRUID())+".csv";
       tmpFilename=FilenamePrepare(tmpFilename,Options);
@@ -681,22 +698,24 @@ void CModel::WriteMinorOutput(const optStruct &Options,const time_struct &tt)
   int     i,iCumPrecip,k;
   double  output_int = 0.0;
   double  mod_final = 0.0;
-  double  val,Qin,P,E,GW;
+  double  val;
   double  S,currentWater;
   string  thisdate;
   string  thishour;
   bool    silent=true; //for debugging
   bool    quiet=true;  //for debugging
   double  t;
-  long long SBID;
 
   CSubBasin* pSB;
 
   string tmpFilename;
 
-  if ((tt.model_time==0) && (Options.suppressICs)){return;}
+  if ((tt.model_time==0) && (Options.suppressICs)){InvalidateWatershedReductions();return;}
 
-  if ((_pEnsemble != NULL) && (_pEnsemble->DontWriteOutput())) { return; } //specific to EnKF
+  if ((_pEnsemble != NULL) && (_pEnsemble->DontWriteOutput())) {InvalidateWatershedReductions();return; } //specific to EnKF
+
+  //watershed averages/totals are normally computed in IncrementCumulInput(); valid until end of output
+  if (!_reductions_valid){UpdateWatershedReductions();}
 
   //converts the 'write every x timesteps' into a 'write at time y' value
   output_int = Options.output_interval * Options.timestep;
@@ -734,6 +753,11 @@ void CModel::WriteMinorOutput(const optStruct &Options,const time_struct &tt)
       cout <<thisdate<<" "<<thishour<<":";
       if (t!=0){cout <<" | P: "<< setw(6)<<setiosflags(ios::fixed) << setprecision(2)<<GetAveragePrecip();}
       else     {cout <<" | P: ------";}
+      for (i=0;i<GetNumStateVars();i++){
+        if ((CStateVariable::IsWaterStorage(_aStateVarType[i])) && (i!=iCumPrecip)){
+          cout<<"  |"<< setw(6)<<setiosflags(ios::fixed) << setprecision(2)<<GetAvgStateVar(i);
+        }
+      }
     }
 
     //Write current state of water storage in system to WatershedStorage.csv (ALWAYS DONE if not switched OFF)
@@ -742,43 +766,9 @@ void CModel::WriteMinorOutput(const optStruct &Options,const time_struct &tt)
     {
       if (Options.write_watershed_storage)
       {
-        double snowfall      =GetAverageSnowfall();
-        double precip        =GetAveragePrecip();
-        double channel_stor  =GetTotalChannelStorage();
-        double reservoir_stor=GetTotalReservoirStorage();
-        double rivulet_stor  =GetTotalRivuletStorage();
-
         _STORAGE<<tt.model_time <<","<<thisdate<<","<<thishour; //instantaneous, so thishour rather than usehour used.
-
-        if (t!=0){_STORAGE<<","<<precip-snowfall<<","<<snowfall;}//precip
-        else     {_STORAGE<<",---,---";}
-        _STORAGE<<","<<channel_stor<<","<<reservoir_stor<<","<<rivulet_stor;
-
-        currentWater=0.0;
-        for (i=0;i<GetNumStateVars();i++)
-        {
-          if ((CStateVariable::IsWaterStorage(_aStateVarType[i])) && (i!=iCumPrecip))
-          {
-            S=GetAvgStateVar(i);
-            if (!silent){cout<<"  |"<< setw(6)<<setiosflags(ios::fixed) << setprecision(2)<<S;}
-            _STORAGE<<","<<FormatDouble(S);
-            currentWater+=S;
-          }
-        }
-        currentWater+=channel_stor+rivulet_stor+reservoir_stor;
-        if(t==0){
-          // \todo [fix]: this fixes a mass balance bug in reservoir simulations, but there is certainly a more proper way to do it
-          // JRC: I think somehow this is being double counted in the delta V calculations in the first timestep
-          for(int p=0;p<_nSubBasins;p++){
-            if(_pSubBasins[p]->GetReservoir()!=NULL){
-              currentWater+=_pSubBasins[p]->GetIntegratedReservoirInflow(Options.timestep)/2.0/_WatershedArea*MM_PER_METER/M2_PER_KM2;
-              currentWater-=_pSubBasins[p]->GetIntegratedOutflow        (Options.timestep)/2.0/_WatershedArea*MM_PER_METER/M2_PER_KM2;
-            }
-            //currentWater-=_pSubBasins[p]->GetIntegratedSpecInflow(0,Options.timestep)/2.0/_WatershedArea*MM_PER_METER/M2_PER_KM2;
-          }
-        }
-
-        _STORAGE<<","<<currentWater<<","<<_CumulInput<<","<<_CumulOutput<<","<<FormatDouble((currentWater-_initWater)+(_CumulOutput-_CumulInput));
+        CTextOutputRow ROW(_STORAGE);
+        WriteWatershedStorageRow(Options,tt,ROW);
         _STORAGE<<endl;
       }
 
@@ -788,61 +778,8 @@ void CModel::WriteMinorOutput(const optStruct &Options,const time_struct &tt)
       if (Options.ave_hydrograph)
       {
         _HYDRO<<usetime<<","<<usedate<<","<<usehour;
-        if(t!=0) { _HYDRO<<","<<GetAveragePrecip(); }//watershed-wide precip + irrigation
-        else     { _HYDRO<<",---";                  }
-
-        for (int p=0;p<_nSubBasins;p++)
-        {
-          pSB=_pSubBasins[p];
-          if (pSB->IsGauged()  && (pSB->IsEnabled()))
-          {
-            _HYDRO<<","<<pSB->GetIntegratedOutflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);
-            SBID=pSB->GetID();
-            /*FASTER OPTION
-            if (pSB->GetFlowObsTS()!=NULL){
-              double val = pSB->GetFlowObsTS()->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
-              if ((val != RAV_BLANK_DATA) && (tt.model_time>0)){ _HYDRO << "," << val; }
-              else                                             { _HYDRO << ",";       }
-            }*/
-            for (i = 0; i < _nObservedTS; i++)
-            {
-              if (IsContinuousFlowObs(_pObservedTS[i],SBID))
-              {
-                val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
-                if ((val != RAV_BLANK_DATA) && (tt.model_time>0)){ _HYDRO << "," << val; }
-                else                                             { _HYDRO << ",";       }
-              }
-            }
-            if (Options.write_localflow){
-              _HYDRO<<","<<pSB->GetIntegratedLocalOutflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);
-            }
-            if (pSB->GetReservoir() != NULL){
-              _HYDRO<<","<<pSB->GetIntegratedReservoirInflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);
-              if (Options.write_netresinflow){
-                Qin=pSB->GetIntegratedReservoirInflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);
-                P  =pSB->GetReservoir()->GetReservoirPrecipGains(Options.timestep)/(Options.timestep*SEC_PER_DAY);
-                E  =pSB->GetReservoir()->GetReservoirEvapLosses (Options.timestep)/(Options.timestep*SEC_PER_DAY);
-                GW =pSB->GetReservoir()->GetReservoirGWLosses   (Options.timestep)/(Options.timestep*SEC_PER_DAY);
-                _HYDRO<<","<<Qin+P-E-GW;
-              }
-              /*FASTER OPTION
-              if (pSB->GetInflowObsTS()!=NULL){
-                double val = pSB->GetInflowObsTS()->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
-                if ((val != RAV_BLANK_DATA) && (tt.model_time>0)){ _HYDRO << "," << val; }
-                else                                             { _HYDRO << ",";       }
-              }*/
-              for(i = 0; i < _nObservedTS; i++)
-              {
-                if(IsContinuousInflowObs(_pObservedTS[i],pSB->GetID()))
-                {
-                  val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
-                  if((val != RAV_BLANK_DATA) && (tt.model_time>0)) { _HYDRO << "," << val; }
-                  else                                             { _HYDRO << ","; }
-                }
-              }
-            }
-          }
-        }
+        CTextOutputRow ROW(_HYDRO);
+        WriteHydrographRow(Options,tt,ROW);
         _HYDRO<<endl;
       }
       else //point value hydrograph or t==0
@@ -850,58 +787,8 @@ void CModel::WriteMinorOutput(const optStruct &Options,const time_struct &tt)
         if((Options.period_starting) && (t==0)){}//don't write anything at time zero
         else{
           _HYDRO<<t<<","<<thisdate<<","<<thishour;
-          if(t!=0){ _HYDRO<<","<<GetAveragePrecip(); }//watershed-wide precip+irrigation
-          else    { _HYDRO<<",---";                  }
-          for(int p=0;p<_nSubBasins;p++)
-          {
-            pSB=_pSubBasins[p];
-            if(pSB->IsGauged()  && (pSB->IsEnabled()))
-            {
-              _HYDRO<<","<<pSB->GetOutflowRate();
-              /*FASTER OPTION
-              if (pSB->GetFlowObsTS()!=NULL){
-                double val = pSB->GetFlowObsTS()->GetAvgValue(tt.model_time,Options.timestep); 
-                if ((val != RAV_BLANK_DATA) && (tt.model_time>0)){ _HYDRO << "," << val; }
-                else                                             { _HYDRO << ",";       }
-              }*/
-              for(i = 0; i < _nObservedTS; i++){
-                if(IsContinuousFlowObs(_pObservedTS[i],pSB->GetID()))
-                {
-                  val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep);
-                  if((val != RAV_BLANK_DATA) && (tt.model_time>0)){ _HYDRO << "," << val; }
-                  else                                            { _HYDRO << ","; }
-                }
-              }
-              if (Options.write_localflow){
-                _HYDRO<<","<<pSB->GetLocalOutflowRate();
-              }
-              if(pSB->GetReservoir() != NULL){
-                _HYDRO<<","<<pSB->GetReservoirInflow();
-                if (Options.write_netresinflow){
-                  Qin=pSB->GetReservoirInflow();
-                  P  =pSB->GetReservoir()->GetReservoirPrecipGains(Options.timestep)/(Options.timestep*SEC_PER_DAY);
-                  E  =pSB->GetReservoir()->GetReservoirEvapLosses (Options.timestep)/(Options.timestep*SEC_PER_DAY);
-                  GW =pSB->GetReservoir()->GetReservoirGWLosses   (Options.timestep)/(Options.timestep*SEC_PER_DAY);
-                  _HYDRO<<","<<Qin+P-E-GW;
-                }
-                /*FASTER OPTION
-                if (pSB->GetInflowObsTS()!=NULL){
-                  double val = pSB->GetInflowObsTS()->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
-                  if ((val != RAV_BLANK_DATA) && (tt.model_time>0)){ _HYDRO << "," << val; }
-                  else                                             { _HYDRO << ",";       }
-                }*/
-                for(i = 0; i < _nObservedTS; i++)
-                {
-                  if(IsContinuousInflowObs(_pObservedTS[i],pSB->GetID()))
-                  {
-                    val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
-                    if((val != RAV_BLANK_DATA) && (tt.model_time>0)) { _HYDRO << "," << val; }
-                    else                                             { _HYDRO << ",";        }
-                  }
-                }
-              }
-            }
-          }
+          CTextOutputRow ROW(_HYDRO);
+          WriteHydrographRow(Options,tt,ROW);
           _HYDRO<<endl;
         }
       }
@@ -914,6 +801,10 @@ void CModel::WriteMinorOutput(const optStruct &Options,const time_struct &tt)
     {
       WriteNetcdfMinorOutput(Options,tt);
     }
+    else if (Options.output_format==OUTPUT_BINARY)
+    {
+      WriteBinaryMinorOutput(Options,tt);
+    }
 
     //Write cumulative mass balance info to HRUGroup_MassEnergyBalance.csv
     //----------------------------------------------------------------
@@ -1017,24 +908,9 @@ void CModel::WriteMinorOutput(const optStruct &Options,const time_struct &tt)
 
       if((Options.period_starting) && (t==0)){}//don't write anything at time zero
       else{
-	    _RESSTAGE<< t<<","<<thisdate<<","<<thishour<<","<<GetAveragePrecip();
-	    for (int p=0;p<_nSubBasins;p++)
-        {
-          pSB=_pSubBasins[p];
-	        if ((pSB->IsGauged())  && (pSB->IsEnabled()) && (pSB->GetReservoir()!=NULL))
-          {
-	          _RESSTAGE<<","<<pSB->GetReservoir()->GetResStage();
-
-	          for (i = 0; i < _nObservedTS; i++){
-	            if (IsContinuousStageObs(_pObservedTS[i],pSB->GetID()))
-	            {
-                val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep);
-	              if ((val != RAV_BLANK_DATA) && (tt.model_time>0)){ _RESSTAGE << "," << val; }
-	              else                                             { _RESSTAGE << ",";        }
-	            }
-            }
-          }
-        }
+	    _RESSTAGE<< t<<","<<thisdate<<","<<thishour;
+	    CTextOutputRow ROW(_RESSTAGE);
+	    WriteReservoirStageRow(Options,tt,ROW);
 	      _RESSTAGE<<endl;
 			}
     }
@@ -1308,6 +1184,7 @@ void CModel::WriteMinorOutput(const optStruct &Options,const time_struct &tt)
     {
       for (int kk=0;kk<_pOutputGroup->GetNumHRUs();kk++)
       {
+        if (!IsOutputHRU(_pOutputGroup->GetHRU(kk)->GetGlobalIndex())){continue;}
         ofstream HRUSTOR;
         tmpFilename="HRUStorage_"+to_string(_pOutputGroup->GetHRU(kk)->GetHRUID())+".csv";
         tmpFilename=FilenamePrepare(tmpFilename,Options);
@@ -1356,6 +1233,7 @@ void CModel::WriteMinorOutput(const optStruct &Options,const time_struct &tt)
 
   // Custom output files
   //--------------------------------------------------------------
+  if (_pCustomAgg!=NULL){_pCustomAgg->GatherValues(tt,Options);}
   for (int c=0;c<_nCustomOutputs;c++)
   {
     _pCustomOutputs[c]->WriteCustomOutput(tt,Options);
@@ -1374,23 +1252,174 @@ void CModel::WriteMinorOutput(const optStruct &Options,const time_struct &tt)
     WriteMajorOutput(Options,tt,tmpFilename,false);
   }
 
+  InvalidateWatershedReductions();
 }
 
 
 //////////////////////////////////////////////////////////////////
-/// \brief Replaces the WriteOutputFileHeaders function by not requiring the Options structure as an argument
+/// \brief Writes current row of WatershedStorage file (all columns after time columns)
+/// \details used for both WatershedStorage.csv and WatershedStorage.npy
+///
+/// \param &Options [in] global model options
+/// \param &tt      [in] current time structure
+/// \param &ROW     [out] destination of row values
+//
+void CModel::WriteWatershedStorageRow(const optStruct &Options,const time_struct &tt,COutputRow &ROW) const
+{
+  double t             =tt.model_time;
+  int    iCumPrecip    =GetStateVarIndex(ATMOS_PRECIP);
+  double snowfall      =GetAverageSnowfall();
+  double precip        =GetAveragePrecip();
+  double channel_stor  =GetTotalChannelStorage();
+  double reservoir_stor=GetTotalReservoirStorage();
+  double rivulet_stor  =GetTotalRivuletStorage();
+
+  if (t!=0){ROW.AddValue(precip-snowfall);ROW.AddValue(snowfall);}//precip
+  else     {ROW.AddUndefined();           ROW.AddUndefined();}
+  ROW.AddValue(channel_stor);
+  ROW.AddValue(reservoir_stor);
+  ROW.AddValue(rivulet_stor);
+
+  double S,currentWater=0.0;
+  for (int i=0;i<GetNumStateVars();i++)
+  {
+    if ((CStateVariable::IsWaterStorage(_aStateVarType[i])) && (i!=iCumPrecip))
+    {
+      S=GetAvgStateVar(i);
+      ROW.AddValue(FormatDouble(S));
+      currentWater+=S;
+    }
+  }
+  currentWater+=channel_stor+rivulet_stor+reservoir_stor;
+  if(t==0){
+    // \todo [fix]: this fixes a mass balance bug in reservoir simulations, but there is certainly a more proper way to do it
+    // JRC: I think somehow this is being double counted in the delta V calculations in the first timestep
+    for(int p=0;p<_nSubBasins;p++){
+      if(_pSubBasins[p]->GetReservoir()!=NULL){
+        currentWater+=_pSubBasins[p]->GetIntegratedReservoirInflow(Options.timestep)/2.0/_WatershedArea*MM_PER_METER/M2_PER_KM2;
+        currentWater-=_pSubBasins[p]->GetIntegratedOutflow        (Options.timestep)/2.0/_WatershedArea*MM_PER_METER/M2_PER_KM2;
+      }
+      //currentWater-=_pSubBasins[p]->GetIntegratedSpecInflow(0,Options.timestep)/2.0/_WatershedArea*MM_PER_METER/M2_PER_KM2;
+    }
+  }
+  ROW.AddValue(currentWater);
+  ROW.AddValue(_CumulInput);
+  ROW.AddValue(_CumulOutput);
+  ROW.AddValue(FormatDouble((currentWater-_initWater)+(_CumulOutput-_CumulInput)));
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Writes current row of Hydrographs file (all columns after time columns)
+/// \details used for both Hydrographs.csv and Hydrographs.npy; flows are period averages unless :SnapshotHydrograph is used
+///
+/// \param &Options [in] global model options
+/// \param &tt      [in] current time structure
+/// \param &ROW     [out] destination of row values
+//
+void CModel::WriteHydrographRow(const optStruct &Options,const time_struct &tt,COutputRow &ROW) const
+{
+  double     val,Qin,P,E,GW;
+  double     dt =Options.timestep*SEC_PER_DAY;
+  bool       ave=Options.ave_hydrograph;
+  CSubBasin *pSB;
+
+  if(tt.model_time!=0) { ROW.AddValue(GetAveragePrecip()); }//watershed-wide precip + irrigation
+  else                 { ROW.AddUndefined();               }
+
+  for (int p=0;p<_nSubBasins;p++)
+  {
+    pSB=_pSubBasins[p];
+    if (pSB->IsGauged()  && (pSB->IsEnabled()))
+    {
+      if (ave){ROW.AddValue(pSB->GetIntegratedOutflow(Options.timestep)/dt);}
+      else    {ROW.AddValue(pSB->GetOutflowRate());}
+      /*FASTER OPTION
+      if (pSB->GetFlowObsTS()!=NULL){
+        double val = pSB->GetFlowObsTS()->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
+        if ((val != RAV_BLANK_DATA) && (tt.model_time>0)){ ROW.AddValue(val); }
+        else                                             { ROW.AddMissing();  }
+      }*/
+      for (int i = 0; i < _nObservedTS; i++)
+      {
+        if (IsContinuousFlowObs(_pObservedTS[i],pSB->GetID()))
+        {
+          val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
+          if ((val != RAV_BLANK_DATA) && (tt.model_time>0)){ ROW.AddValue(val); }
+          else                                             { ROW.AddMissing();  }
+        }
+      }
+      if (Options.write_localflow){
+        if (ave){ROW.AddValue(pSB->GetIntegratedLocalOutflow(Options.timestep)/dt);}
+        else    {ROW.AddValue(pSB->GetLocalOutflowRate());}
+      }
+      if (pSB->GetReservoir() != NULL){
+        if (ave){Qin=pSB->GetIntegratedReservoirInflow(Options.timestep)/dt;}
+        else    {Qin=pSB->GetReservoirInflow();}
+        ROW.AddValue(Qin);
+        if (Options.write_netresinflow){
+          P  =pSB->GetReservoir()->GetReservoirPrecipGains(Options.timestep)/dt;
+          E  =pSB->GetReservoir()->GetReservoirEvapLosses (Options.timestep)/dt;
+          GW =pSB->GetReservoir()->GetReservoirGWLosses   (Options.timestep)/dt;
+          ROW.AddValue(Qin+P-E-GW);
+        }
+        for(int i = 0; i < _nObservedTS; i++)
+        {
+          if(IsContinuousInflowObs(_pObservedTS[i],pSB->GetID()))
+          {
+            val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
+            if((val != RAV_BLANK_DATA) && (tt.model_time>0)) { ROW.AddValue(val); }
+            else                                             { ROW.AddMissing();  }
+          }
+        }
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Writes current row of ReservoirStages file (all columns after time columns)
+/// \details used for both ReservoirStages.csv and ReservoirStages.npy
+///
+/// \param &Options [in] global model options
+/// \param &tt      [in] current time structure
+/// \param &ROW     [out] destination of row values
+//
+void CModel::WriteReservoirStageRow(const optStruct &Options,const time_struct &tt,COutputRow &ROW) const
+{
+  double     val;
+  CSubBasin *pSB;
+
+  ROW.AddValue(GetAveragePrecip());
+  for (int p=0;p<_nSubBasins;p++)
+  {
+    pSB=_pSubBasins[p];
+    if ((pSB->IsGauged())  && (pSB->IsEnabled()) && (pSB->GetReservoir()!=NULL))
+    {
+      ROW.AddValue(pSB->GetReservoir()->GetResStage());
+
+      for (int i = 0; i < _nObservedTS; i++){
+        if (IsContinuousStageObs(_pObservedTS[i],pSB->GetID()))
+        {
+          val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep);
+          if ((val != RAV_BLANK_DATA) && (tt.model_time>0)){ ROW.AddValue(val); }
+          else                                             { ROW.AddMissing();  }
+        }
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Writes solution state to text solution file {solfile}.rvc
 /// \param &tt [in] Local (model) time *at the end of* the pertinent time step
-/// \param solfile [in] Name of the solution file to be written
-/// \param final [in] Whether this is the final solution file to be written
+/// \param solfile [in] Name of the solution file to be written (without extension)
 //
-void CModel::WriteMajorOutput(const time_struct &tt, string solfile, bool final) const
+void CModel::WriteSolutionFile(const time_struct &tt, string solfile) const
 {
   int i,k;
   string tmpFilename;
   const optStruct* Options = this->_pOptStruct;  // just to make the code more readable
 
-  if (Options->output_format==OUTPUT_NONE){return;} //:SuppressOutput is on
-
   // WRITE {RunName}_solution.rvc - final state variables file
   ofstream RVC;
   tmpFilename=FilenamePrepare(solfile+".rvc", *_pOptStruct);
@@ -1454,6 +1483,27 @@ void CModel::WriteMajorOutput(const time_struct &tt, string solfile, bool final)
   if (Options->management_optimization){_pDO->WriteMajorOutput(RVC);}
 
   RVC.close();
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Replaces the WriteOutputFileHeaders function by not requiring the Options structure as an argument
+/// \param &tt [in] Local (model) time *at the end of* the pertinent time step
+/// \param solfile [in] Name of the solution file to be written
+/// \param final [in] Whether this is the final solution file to be written
+//
+void CModel::WriteMajorOutput(const time_struct &tt, string solfile, bool final) const
+{
+  int i;
+  string tmpFilename;
+  const optStruct* Options = this->_pOptStruct;  // just to make the code more readable
+
+  if (Options->output_format==OUTPUT_NONE){return;} //:SuppressOutput is on
+
+  // WRITE {RunName}_solution.rvb - final state variables, binary checkpoint file
+  if (Options->write_binary_rvc){WriteBinaryCheckpoint(tt,solfile);}
+
+  // WRITE {RunName}_solution.rvc - final state variables file
+  if (Options->write_text_rvc  ){WriteSolutionFile    (tt,solfile);}
 
   // SubbasinProperties.csv
   //--------------------------------------------------------------
@@ -1543,6 +1593,62 @@ void CModel::WriteMajorOutput(const optStruct &Options, const time_struct &tt, s
   WriteMajorOutput(tt,solfile,final);
 }
 //////////////////////////////////////////////////////////////////
+/// \brief Writes solution state to binary checkpoint file {solfile}.rvb
+/// \details same contents as .rvc solution file, at full precision (see Checkpoint.h).
+/// HRU state variables are written as one row of doubles per HRU so they may be copied in bulk on restart
+///
+/// \param &tt [in] Local (model) time *at the end of* the pertinent time step
+/// \param solfile [in] Name of the solution file to be written (without extension)
+//
+void CModel::WriteBinaryCheckpoint(const time_struct &tt, string solfile) const
+{
+  const optStruct* Options = this->_pOptStruct;
+  string tmpFilename=FilenamePrepare(solfile+".rvb", *_pOptStruct);
+
+  time_struct tts;
+  JulianConvert(0,Options->julian_start_day,Options->julian_start_year,Options->calendar,tts);
+
+  CCheckpointWriter CHK;
+  if (!CHK.open(tmpFilename,tts,tt,Options->timestep)){
+    WriteWarning(("CModel::WriteBinaryCheckpoint: Unable to open output file "+tmpFilename+" for writing.").c_str(),Options->noisy);
+    return;
+  }
+
+  //HRU state variables-------------
+  CHK.BeginSection(RVB_HRU_STATES);
+  CHK.Put<int>(_nHydroUnits);
+  CHK.Put<int>(_nStateVars);
+  for (int i=0;i<_nStateVars;i++){ //type and layer, such that GetStateVarIndex(type,layer)==i
+    int layer=_aStateVarLayer[i];
+    if (GetStateVarIndex(_aStateVarType[i],layer)!=i){layer=DOESNT_EXIST;}
+    CHK.Put<int>((int)(_aStateVarType[i]));
+    CHK.Put<int>(layer);
+  }
+  for (int k=0;k<_nHydroUnits;k++){
+    CHK.Put<long long>(_pHydroUnits[k]->GetHRUID());
+  }
+  for (int k=0;k<_nHydroUnits;k++){
+    CHK.PutArray(_pHydroUnits[k]->GetStateVarArray(),_nStateVars);
+  }
+  CHK.EndSection();
+
+  //By basin------------------------
+  CHK.BeginSection(RVB_BASIN_STATES);
+  CHK.Put<int>(_nSubBasins);
+  for (int p=0;p<_nSubBasins;p++){
+    _pSubBasins[p]->WriteToCheckpoint(CHK);
+  }
+  CHK.EndSection();
+
+  _pTransModel->WriteToCheckpoint(CHK);
+
+  if (Options->management_optimization){_pDO->WriteToCheckpoint(CHK);}
+
+  if (!CHK.close()){
+    WriteWarning(("CModel::WriteBinaryCheckpoint: Unable to write output file "+tmpFilename).c_str(),Options->noisy);
+  }
+}
+//////////////////////////////////////////////////////////////////
 /// \brief Writes simple output to file
 /// \note  written at start of time step before external script is read, after forcings processed.
 /// \param &Options      [in] Global model options information
@@ -1704,10 +1810,6 @@ void CModel::RunDiagnostics(const optStruct &Options)
   //body
   bool skip;
   for (int d=0; d<_nDiagPeriods; d++){
-    double starttime   = _pDiagPeriods[d]->GetStartTime();
-    double endtime     = _pDiagPeriods[d]->GetEndTime();
-    comparison compare = _pDiagPeriods[d]->GetComparison();
-    double     thresh  = _pDiagPeriods[d]->GetThreshold();
     for(int i=0;i<_nObservedTS;i++)
     {
       skip=false;
@@ -1725,7 +1827,15 @@ void CModel::RunDiagnostics(const optStruct &Options)
 
         DIAG<<_pObservedTS[i]->GetName()<<"_"<<_pDiagPeriods[d]->GetName()<<"["<<_pObservedTS[i]->GetLocID()<<"],"<<_pObservedTS[i]->GetSourceFile() <<",";//append to end of name for backward compatibility
         for(int j=0; j<_nDiagnostics;j++) {
-          DIAG<<_pDiagnostics[j]->CalculateDiagnostic(_pModeledTS[i],_pObservedTS[i],_pObsWeightTS[i],starttime,endtime,compare,thresh,Options)<<",";
+          if (_terminated_early) { //objective written as worst value, other diagnostics not evaluated (blank)
+            if ((i==_objbound_ind[0]) && (j==_objbound_ind[1]) && (d==_objbound_ind[2])){
+              DIAG<<((_objbound_diag==DIAG_NASH_SUTCLIFFE) ? -ALMOST_INF : ALMOST_INF);
+            }
+            DIAG<<",";
+          }
+          else {
+            DIAG<<EvaluateDiagnostic(i,d,j,Options)<<",";
+          }
         }
         DIAG<<endl;
       }
@@ -1753,7 +1863,8 @@ void CModel::RunDiagnostics(const optStruct &Options)
 
       DIAG<<name<<",[multiple],";
       for(int j=0; j<_nDiagnostics;j++) {
-        DIAG<<CalculateAggDiagnostic(ii,j,starttime,endtime,compare,thresh,Options)<<",";
+        if (_terminated_early){DIAG<<",";}
+        else                  {DIAG<<CalculateAggDiagnostic(ii,j,d,Options)<<",";}
       }
       DIAG<<endl;
     }
@@ -1822,9 +1933,12 @@ void CModel::RunDiagnostics(const optStruct &Options)
 //////////////////////////////////////////////////////////////////
 /// \brief run model diagnostics (at end of simulation)
 ///
+/// \param ii [in] index of aggregate diagnostic
+/// \param j [in] index of diagnostic
+/// \param d [in] index of diagnostic period
 /// \param &Options [in] global model options
 //
-double CModel::CalculateAggDiagnostic(const int ii, const int j, const double &starttime, const double &endtime, const comparison compare,const double &thresh, const optStruct &Options)
+double CModel::CalculateAggDiagnostic(const int ii, const int j, const int d, const optStruct &Options)
 {
   bool skip;
   double val;
@@ -1861,7 +1975,7 @@ double CModel::CalculateAggDiagnostic(const int ii, const int j, const double &s
 
     if (!skip)
     {
-      val=_pDiagnostics[j]->CalculateDiagnostic(_pModeledTS[i],_pObservedTS[i],_pObsWeightTS[i],starttime,endtime,compare, thresh,Options);
+      val=EvaluateDiagnostic(i,d,j,Options);
 
       if      (type==AGG_AVERAGE){stat+=val; N++;}
       else if (type==AGG_MAXIMUM){upperswap(stat,val);N++;}
@@ -2093,8 +2207,7 @@ void CModel::WriteNetcdfStandardHeaders(const optStruct &Options)
 
   retval = nc_def_var(_HYDRO_ncid, "time", NC_DOUBLE, ndims1,dimids1, &varid_time);   HandleNetCDFErrors(retval);
   // Enable compression and chunking
-  retval = nc_def_var_deflate (_HYDRO_ncid, varid_time, 1, 1, NETCDF_DEFLATE_LEVEL);  HandleNetCDFErrors(retval);
-  retval = nc_def_var_chunking(_HYDRO_ncid, varid_time, NC_CHUNKED, &chunksize_time); HandleNetCDFErrors(retval);
+  NetCDFSetTimeStorage(_HYDRO_ncid, varid_time, chunksize_time, Options);
 
   retval = nc_put_att_text(_HYDRO_ncid, varid_time, "units"   ,      strlen(starttime)  , starttime);   HandleNetCDFErrors(retval);
   retval = nc_put_att_text(_HYDRO_ncid, varid_time, "calendar",      strlen("gregorian"), "gregorian"); HandleNetCDFErrors(retval);
@@ -2152,6 +2265,7 @@ void CModel::WriteNetcdfStandardHeaders(const optStruct &Options)
 
   // End define mode. This tells netCDF we are done defining metadata.
   retval = nc_enddef(_HYDRO_ncid);  HandleNetCDFErrors(retval);
+  _HYDRO_ncbuf.Initialize(_HYDRO_ncid);
 
   // (a) write gauged basin names/IDs to variable "basin_name"
   if (nSim>0){
@@ -2183,8 +2297,7 @@ void CModel::WriteNetcdfStandardHeaders(const optStruct &Options)
     dimids1[0] = time_dimid;
     retval = nc_def_var     (_RESSTAGE_ncid,"time",NC_DOUBLE,ndims1,dimids1,&varid_time);           HandleNetCDFErrors(retval);
     // Enable compression and chunking
-    retval = nc_def_var_deflate(_RESSTAGE_ncid, varid_time, 1, 1, NETCDF_DEFLATE_LEVEL); HandleNetCDFErrors(retval);
-    retval = nc_def_var_chunking(_RESSTAGE_ncid, varid_time, NC_CHUNKED, &chunksize_time); HandleNetCDFErrors(retval);
+    NetCDFSetTimeStorage(_RESSTAGE_ncid, varid_time, chunksize_time, Options);
 
     retval = nc_put_att_text(_RESSTAGE_ncid,varid_time,"units",strlen(starttime),starttime);        HandleNetCDFErrors(retval);
     retval = nc_put_att_text(_RESSTAGE_ncid,varid_time,"calendar",strlen("gregorian"),"gregorian"); HandleNetCDFErrors(retval);
@@ -2237,6 +2350,7 @@ void CModel::WriteNetcdfStandardHeaders(const optStruct &Options)
 
     // End define mode. This tells netCDF we are done defining metadata.
     retval = nc_enddef(_RESSTAGE_ncid);  HandleNetCDFErrors(retval);
+    _RESSTAGE_ncbuf.Initialize(_RESSTAGE_ncid);
 
     // write values to NetCDF
     // (a) write gauged reservoir basin names/IDs to variable "basin_name"
@@ -2269,8 +2383,7 @@ void CModel::WriteNetcdfStandardHeaders(const optStruct &Options)
     dimids1[0] = time_dimid;
     retval = nc_def_var(_STORAGE_ncid, "time", NC_DOUBLE, ndims1,dimids1, &varid_time); HandleNetCDFErrors(retval);
     // Enable compression and chunking
-    retval = nc_def_var_deflate(_STORAGE_ncid, varid_time, 1, 1, NETCDF_DEFLATE_LEVEL); HandleNetCDFErrors(retval);
-    retval = nc_def_var_chunking(_STORAGE_ncid, varid_time, NC_CHUNKED, &chunksize_time); HandleNetCDFErrors(retval);
+    NetCDFSetTimeStorage(_STORAGE_ncid, varid_time, chunksize_time, Options);
 
     retval = nc_put_att_text(_STORAGE_ncid, varid_time, "units"   , strlen(starttime)  , starttime);   HandleNetCDFErrors(retval);
     retval = nc_put_att_text(_STORAGE_ncid, varid_time, "calendar", strlen("gregorian"), "gregorian"); HandleNetCDFErrors(retval);
@@ -2301,6 +2414,7 @@ void CModel::WriteNetcdfStandardHeaders(const optStruct &Options)
 
     // End define mode. This tells netCDF we are done defining metadata.
     retval = nc_enddef(_STORAGE_ncid);  HandleNetCDFErrors(retval);
+    _STORAGE_ncbuf.Initialize(_STORAGE_ncid);
   }
 
   //====================================================================
@@ -2322,8 +2436,7 @@ void CModel::WriteNetcdfStandardHeaders(const optStruct &Options)
     dimids1[0] = time_dimid;
     retval = nc_def_var(_FORCINGS_ncid,"time",NC_DOUBLE,ndims1,dimids1,&varid_time); HandleNetCDFErrors(retval);
     // Enable compression and chunking
-    retval = nc_def_var_deflate(_FORCINGS_ncid, varid_time, 1, 1, NETCDF_DEFLATE_LEVEL); HandleNetCDFErrors(retval);
-    retval = nc_def_var_chunking(_FORCINGS_ncid, varid_time, NC_CHUNKED, &chunksize_time); HandleNetCDFErrors(retval);
+    NetCDFSetTimeStorage(_FORCINGS_ncid, varid_time, chunksize_time, Options);
 
     retval = nc_put_att_text(_FORCINGS_ncid,varid_time,"units",strlen(starttime),starttime);   HandleNetCDFErrors(retval);
     retval = nc_put_att_text(_FORCINGS_ncid,varid_time,"calendar",strlen("gregorian"),"gregorian"); HandleNetCDFErrors(retval);
@@ -2354,6 +2467,7 @@ void CModel::WriteNetcdfStandardHeaders(const optStruct &Options)
 
     // End define mode. This tells netCDF we are done defining metadata.
     retval = nc_enddef(_FORCINGS_ncid);  HandleNetCDFErrors(retval);
+    _FORCINGS_ncbuf.Initialize(_FORCINGS_ncid);
   }
 
   //====================================================================
@@ -2377,8 +2491,7 @@ void CModel::WriteNetcdfStandardHeaders(const optStruct &Options)
     retval = nc_def_var(_RESMB_ncid,"time",NC_DOUBLE,ndims1,dimids1,&varid_time);                HandleNetCDFErrors(retval);
 
      // Enable compression and chunking
-    retval = nc_def_var_deflate(_RESMB_ncid, varid_time, 1, 1, NETCDF_DEFLATE_LEVEL); HandleNetCDFErrors(retval);
-    retval = nc_def_var_chunking(_RESMB_ncid, varid_time, NC_CHUNKED, &chunksize_time); HandleNetCDFErrors(retval);
+    NetCDFSetTimeStorage(_RESMB_ncid, varid_time, chunksize_time, Options);
 
     retval = nc_put_att_text(_RESMB_ncid,varid_time,"units",strlen(starttime),starttime);        HandleNetCDFErrors(retval);
     retval = nc_put_att_text(_RESMB_ncid,varid_time,"calendar",strlen("gregorian"),"gregorian"); HandleNetCDFErrors(retval);
@@ -2438,6 +2551,7 @@ void CModel::WriteNetcdfStandardHeaders(const optStruct &Options)
 
     // End define mode. This tells netCDF we are done defining metadata.
     retval = nc_enddef(_RESMB_ncid);  HandleNetCDFErrors(retval);
+    _RESMB_ncbuf.Initialize(_RESMB_ncid);
 
     // write values to NetCDF
     // (a) write gauged reservoir basin names/IDs to variable "basin_name"
@@ -2542,225 +2656,103 @@ void  CModel::WriteNetcdfMinorOutput ( const optStruct   &Options,
 {
 #ifdef _RVNETCDF_
 
-  int    retval;                // error value for NetCDF routines
-  int    time_id;               // variable id in NetCDF for time
-  size_t time_index[1], count1[1];  // determines where and how much will be written to NetCDF; 1D variable (pre, time)
-  size_t start2[2], count2[2];  // determines where and how much will be written to NetCDF; 2D variable (qsim, qobs, qin)
-  double current_time[1];       // current time in hours since start time
-  double current_prec[1];       // precipitation of current time step
-  size_t time_ind2;
-  current_time[0] = tt.model_time*HR_PER_DAY;
-  current_time[0]=RoundToNearestMinute(current_time[0]);
+  double current_time;          // current time in hours since start time
+  double current_prec;          // precipitation of current time step
+  size_t time_ind;              // element of NetCDF time dimension that will be written
+  current_time=tt.model_time*HR_PER_DAY;
+  current_time=RoundToNearestMinute(current_time);
+  time_ind    =int(rvn_round(tt.model_time/Options.timestep));
 
-  time_index [0] = int(rvn_round(tt.model_time/Options.timestep));   // element of NetCDF array that will be written
-  time_ind2       =int(rvn_round(tt.model_time/Options.timestep));
-  count1[0] = 1;                                                 // writes exactly one time step
+  current_prec = NETCDF_BLANK_VALUE;
+  if(tt.model_time != 0.0) { current_prec = GetAveragePrecip(); } //watershed-wide precip+irrigation
 
+  // values are placed directly into the rows of the block buffers (in order of nbasins dimension)
+  // and written to file one block of time steps at a time
   //====================================================================
   //  Hydrographs.nc
   //====================================================================
-  int    precip_id;             // variable id in NetCDF for precipitation
-  int    qsim_id;               // variable id in NetCDF for simulated outflow
-  int    qobs_id;               // variable id in NetCDF for observed outflow
-  int    qin_id;                // variable id in NetCDF for observed inflow
-  int    qin_net_id;            // variable id in NetCDF for simulated net res inflow
-
-  // (a) count how many values need to be written for q_obs, q_sim, q_in
-  int iSim, nSim; // current and total # of sub-basins with simulated outflows
-  nSim = 0;
-  for (int p=0;p<_nSubBasins;p++){
-    if (_pSubBasins[p]->IsGauged()  && (_pSubBasins[p]->IsEnabled())){nSim++;}
-  }
-
-  // (b) allocate memory if necessary
-  double *outflow_obs=NULL;   // q_obs
-  double *outflow_sim=NULL;   // q_sim
-  double *inflow_obs =NULL;   // q_in
-  double *outflow_loc=NULL;   // q_loc
-  double *inflow_net =NULL;   // q_net_res
-  if(nSim>0){
-    outflow_sim=new double[nSim];
-    outflow_obs=new double[nSim];
-    inflow_obs =new double[nSim];
-    outflow_loc=new double[nSim];
-    inflow_net =new double[nSim];
-  }
-
-  // (c) obtain data
-  iSim = 0;
-  current_prec[0] = NETCDF_BLANK_VALUE;
-  if (Options.ave_hydrograph)
+  _HYDRO_ncbuf.StartTimeStep(time_ind);
+  _HYDRO_ncbuf.SetValue("time"  ,current_time);
+  _HYDRO_ncbuf.SetValue("precip",current_prec);
+
+  double *outflow_sim=_HYDRO_ncbuf.GetRow("q_sim");   // NULL if no gauged basins
+  double *outflow_obs=_HYDRO_ncbuf.GetRow("q_obs");
+  double *inflow_obs =_HYDRO_ncbuf.GetRow("q_in");
+  double *outflow_loc=_HYDRO_ncbuf.GetRow("q_loc");   // NULL unless local flows written
+  double *inflow_net =_HYDRO_ncbuf.GetRow("qnet_in"); // NULL unless net reservoir inflows written
+  if (outflow_sim!=NULL)
   {
-    if(tt.model_time != 0.0) { current_prec[0] = GetAveragePrecip(); } //watershed-wide precip+irrigation
-    else                     { current_prec[0] = NETCDF_BLANK_VALUE; } // was originally '---'
+    int iSim=0;
     for (int p=0;p<_nSubBasins;p++)
     {
-      if (_pSubBasins[p]->IsGauged() && (_pSubBasins[p]->IsEnabled())){
-        outflow_sim[iSim] = _pSubBasins[p]->GetIntegratedOutflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);
-        outflow_obs[iSim] = NETCDF_BLANK_VALUE;
-        for (int i = 0; i < _nObservedTS; i++){
-          if (IsContinuousFlowObs(_pObservedTS[i],_pSubBasins[p]->GetID()))
-          {
-            double val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
-            if ((val != RAV_BLANK_DATA) && (tt.model_time>0)){ outflow_obs[iSim] = val;    }
-          }
-        }
-        outflow_loc[iSim] =_pSubBasins[p]->GetIntegratedLocalOutflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);
+      CSubBasin *pSB=_pSubBasins[p];
+      if (!pSB->IsGauged() || !pSB->IsEnabled()){continue;}
 
-        inflow_obs[iSim]=NETCDF_BLANK_VALUE;
-        inflow_net[iSim]=NETCDF_BLANK_VALUE;
-        if (_pSubBasins[p]->GetReservoir() != NULL){
-          inflow_obs[iSim] = _pSubBasins[p]->GetIntegratedReservoirInflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);
-          if (Options.write_netresinflow){
-              double Qin=inflow_obs[iSim];
-              double P  =_pSubBasins[p]->GetReservoir()->GetReservoirPrecipGains(Options.timestep)/(Options.timestep*SEC_PER_DAY);
-              double E  =_pSubBasins[p]->GetReservoir()->GetReservoirEvapLosses (Options.timestep)/(Options.timestep*SEC_PER_DAY);
-              double GW =_pSubBasins[p]->GetReservoir()->GetReservoirGWLosses   (Options.timestep)/(Options.timestep*SEC_PER_DAY);
-              inflow_net[iSim]=Qin+P-E-GW;
-          }
-        }
-        iSim++;
+      if (Options.ave_hydrograph){
+        outflow_sim[iSim]=pSB->GetIntegratedOutflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);
+        if (outflow_loc!=NULL){outflow_loc[iSim]=pSB->GetIntegratedLocalOutflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);}
       }
-    }
-  }
-  else {  // point-value hydrograph
-    if (tt.model_time != 0.0){current_prec[0] = GetAveragePrecip();} //watershed-wide precip+irrigation
-    else                     {current_prec[0] = NETCDF_BLANK_VALUE;} // was originally '---'
-    for (int p=0;p<_nSubBasins;p++)
-    {
-      if (_pSubBasins[p]->IsGauged() && (_pSubBasins[p]->IsEnabled())){
-        outflow_sim[iSim] = _pSubBasins[p]->GetOutflowRate();
-        outflow_obs[iSim] = NETCDF_BLANK_VALUE;
-        for (int i = 0; i < _nObservedTS; i++){
-          if (IsContinuousFlowObs(_pObservedTS[i],_pSubBasins[p]->GetID()))
-          {
-            double val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep);
-            if ((val != RAV_BLANK_DATA) && (tt.model_time>0)){ outflow_obs[iSim] = val;    }
-          }
+      else{ // point-value hydrograph
+        outflow_sim[iSim]=pSB->GetOutflowRate();
+        if (outflow_loc!=NULL){outflow_loc[iSim]=pSB->GetLocalOutflowRate();}
+      }
+      outflow_obs[iSim] = NETCDF_BLANK_VALUE;
+      for (int i = 0; i < _nObservedTS; i++){
+        if (IsContinuousFlowObs(_pObservedTS[i],pSB->GetID()))
+        {
+          double val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
+          if ((val != RAV_BLANK_DATA) && (tt.model_time>0)){ outflow_obs[iSim] = val;    }
         }
-        outflow_loc[iSim] =_pSubBasins[p]->GetLocalOutflowRate();
+      }
 
-        inflow_obs[iSim]=NETCDF_BLANK_VALUE;
-        inflow_net[iSim]=NETCDF_BLANK_VALUE;
-        if (_pSubBasins[p]->GetReservoir() != NULL){
-          inflow_obs[iSim] = _pSubBasins[p]->GetReservoirInflow();
-          if (Options.write_netresinflow){
-              double Qin=inflow_obs[iSim];
-              double P  =_pSubBasins[p]->GetReservoir()->GetReservoirPrecipGains(Options.timestep)/(Options.timestep*SEC_PER_DAY);
-              double E  =_pSubBasins[p]->GetReservoir()->GetReservoirEvapLosses (Options.timestep)/(Options.timestep*SEC_PER_DAY);
-              double GW =_pSubBasins[p]->GetReservoir()->GetReservoirGWLosses   (Options.timestep)/(Options.timestep*SEC_PER_DAY);
-              inflow_net[iSim]=Qin+P-E-GW;
-          }
+      inflow_obs[iSim]=NETCDF_BLANK_VALUE;
+      if (inflow_net!=NULL){inflow_net[iSim]=NETCDF_BLANK_VALUE;}
+      if (pSB->GetReservoir() != NULL){
+        if (Options.ave_hydrograph){inflow_obs[iSim] = pSB->GetIntegratedReservoirInflow(Options.timestep)/(Options.timestep*SEC_PER_DAY);}
+        else                       {inflow_obs[iSim] = pSB->GetReservoirInflow();}
+        if (inflow_net!=NULL){
+          double Qin=inflow_obs[iSim];
+          double P  =pSB->GetReservoir()->GetReservoirPrecipGains(Options.timestep)/(Options.timestep*SEC_PER_DAY);
+          double E  =pSB->GetReservoir()->GetReservoirEvapLosses (Options.timestep)/(Options.timestep*SEC_PER_DAY);
+          double GW =pSB->GetReservoir()->GetReservoirGWLosses   (Options.timestep)/(Options.timestep*SEC_PER_DAY);
+          inflow_net[iSim]=Qin+P-E-GW;
         }
-        iSim++;
       }
+      iSim++;
     }
   }
 
-  // write new time step
-  retval = nc_inq_varid      (_HYDRO_ncid, "time",   &time_id);                            HandleNetCDFErrors(retval);
-  retval = nc_put_vara_double(_HYDRO_ncid, time_id, time_index, count1, &current_time[0]); HandleNetCDFErrors(retval);
-
-  // write precipitation values
-  retval = nc_inq_varid      (_HYDRO_ncid, "precip", &precip_id);                          HandleNetCDFErrors(retval);
-  retval = nc_put_vara_double(_HYDRO_ncid,precip_id,time_index,count1,&current_prec[0]);   HandleNetCDFErrors(retval);
-
-  // write simulated outflow/obs outflow/obs inflow values
-  if (nSim > 0){
-    start2[0] = int(rvn_round(tt.model_time/Options.timestep)); // element of NetCDF array that will be written
-    start2[1] = 0;                                              // element of NetCDF array that will be written
-    count2[0] = 1;      // writes exactly one time step
-    count2[1] = nSim;   // writes exactly nSim elements
-    retval = nc_inq_varid (_HYDRO_ncid, "q_sim", &qsim_id);                             HandleNetCDFErrors(retval);
-    retval = nc_inq_varid (_HYDRO_ncid, "q_obs", &qobs_id);                             HandleNetCDFErrors(retval);
-    retval = nc_inq_varid (_HYDRO_ncid, "q_in",  &qin_id);                              HandleNetCDFErrors(retval);
-    retval = nc_put_vara_double(_HYDRO_ncid, qsim_id, start2, count2, &outflow_sim[0]); HandleNetCDFErrors(retval);
-    retval = nc_put_vara_double(_HYDRO_ncid, qobs_id, start2, count2, &outflow_obs[0]); HandleNetCDFErrors(retval);
-    retval = nc_put_vara_double(_HYDRO_ncid, qin_id,  start2, count2, &inflow_obs[0]);  HandleNetCDFErrors(retval);
-    if (Options.write_localflow){
-      int qloc_id;
-      retval = nc_inq_varid (_HYDRO_ncid, "q_loc",  &qloc_id);                            HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_HYDRO_ncid, qloc_id, start2, count2, &outflow_loc[0]); HandleNetCDFErrors(retval);
-    }
-    if (Options.write_netresinflow){
-      retval = nc_inq_varid (_HYDRO_ncid, "qnet_in",  &qin_net_id);                     HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_HYDRO_ncid, qin_net_id,  start2, count2, &inflow_net[0]);  HandleNetCDFErrors(retval);
-    }
-  }
-
-  delete[] outflow_obs;
-  delete[] outflow_sim;
-  delete[] inflow_obs;
-  delete[] outflow_loc;
-
   //====================================================================
   //  ReservoirStages.nc
   //====================================================================
   if(Options.write_reservoir)
   {
-    int    precip_id;             // variable id in NetCDF for precipitation
-    int    hsim_id;               // variable id in NetCDF for simulated stage
-    int    hobs_id;               // variable id in NetCDF for observed stage
-
-    // (a) count how many values need to be written for h_obs, h_sim
-    int iSim,nSim; // current and total # of sub-basins with simulated stages
-    nSim = 0;
-    for(int p=0;p<_nSubBasins;p++) {
-      if(_pSubBasins[p]->IsGauged()  && (_pSubBasins[p]->IsEnabled()) && (_pSubBasins[p]->GetReservoir()!=NULL)) { nSim++; }
-    }
-
-    // (b) allocate memory if necessary
-    double* stage_obs=NULL;   // h_obs
-    double* stage_sim=NULL;   // h_sim
-    if(nSim>0) {
-      stage_sim=new double[nSim];
-      stage_obs=new double[nSim];
-    }
-
-    // (c) obtain data
-    iSim = 0;
-    current_prec[0] = NETCDF_BLANK_VALUE;
-    if(tt.model_time != 0.0) { current_prec[0] = GetAveragePrecip(); } //watershed-wide precip+irrigation
+    _RESSTAGE_ncbuf.StartTimeStep(time_ind);
+    _RESSTAGE_ncbuf.SetValue("time"  ,current_time);
+    _RESSTAGE_ncbuf.SetValue("precip",current_prec);
 
-    for(int p=0;p<_nSubBasins;p++)
+    double *stage_sim=_RESSTAGE_ncbuf.GetRow("h_sim"); // NULL if no gauged reservoirs
+    double *stage_obs=_RESSTAGE_ncbuf.GetRow("h_obs");
+    if (stage_sim!=NULL)
     {
-      if(_pSubBasins[p]->IsGauged() && (_pSubBasins[p]->IsEnabled()) && (_pSubBasins[p]->GetReservoir()!=NULL))
+      int iSim=0;
+      for(int p=0;p<_nSubBasins;p++)
       {
-        stage_sim[iSim] = _pSubBasins[p]->GetReservoir()->GetResStage();
-        stage_obs[iSim] = NETCDF_BLANK_VALUE;
-        for(int i = 0; i < _nObservedTS; i++) {
-          if(IsContinuousStageObs(_pObservedTS[i],_pSubBasins[p]->GetID()))
-          {
-            double val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
-            if((val != RAV_BLANK_DATA) && (tt.model_time>0)) { stage_obs[iSim] = val; }
+        if(_pSubBasins[p]->IsGauged() && (_pSubBasins[p]->IsEnabled()) && (_pSubBasins[p]->GetReservoir()!=NULL))
+        {
+          stage_sim[iSim] = _pSubBasins[p]->GetReservoir()->GetResStage();
+          stage_obs[iSim] = NETCDF_BLANK_VALUE;
+          for(int i = 0; i < _nObservedTS; i++) {
+            if(IsContinuousStageObs(_pObservedTS[i],_pSubBasins[p]->GetID()))
+            {
+              double val = _pObservedTS[i]->GetAvgValue(tt.model_time,Options.timestep); //time shift handled in CTimeSeries::Parse
+              if((val != RAV_BLANK_DATA) && (tt.model_time>0)) { stage_obs[iSim] = val; }
+            }
           }
+          iSim++;
         }
-        iSim++;
       }
     }
-
-    // write new time step
-    retval = nc_inq_varid      (_RESSTAGE_ncid,"time",&time_id);                              HandleNetCDFErrors(retval);
-    retval = nc_put_vara_double(_RESSTAGE_ncid,time_id,time_index,count1,&current_time[0]);   HandleNetCDFErrors(retval);
-
-    // write precipitation values
-    retval = nc_inq_varid      (_RESSTAGE_ncid,"precip",&precip_id);                          HandleNetCDFErrors(retval);
-    retval = nc_put_vara_double(_RESSTAGE_ncid,precip_id,time_index,count1,&current_prec[0]); HandleNetCDFErrors(retval);
-
-    // write simulated stage/obs stage values
-    if(nSim > 0) {
-      start2[0] = int(rvn_round(tt.model_time/Options.timestep)); // element of NetCDF array that will be written
-      start2[1] = 0;                                              // element of NetCDF array that will be written
-      count2[0] = 1;      // writes exactly one time step
-      count2[1] = nSim;   // writes exactly nSim elements
-      retval = nc_inq_varid(_RESSTAGE_ncid,"h_sim",&hsim_id);                          HandleNetCDFErrors(retval);
-      retval = nc_inq_varid(_RESSTAGE_ncid,"h_obs",&hobs_id);                          HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_RESSTAGE_ncid,hsim_id,start2,count2,&stage_sim[0]); HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_RESSTAGE_ncid,hobs_id,start2,count2,&stage_obs[0]); HandleNetCDFErrors(retval);
-    }
-
-    delete[] stage_obs;
-    delete[] stage_sim;
   }
 
   //====================================================================
@@ -2774,17 +2766,16 @@ void  CModel::WriteNetcdfMinorOutput ( const optStruct   &Options,
     double reservoir_stor=GetTotalReservoirStorage();
     double rivulet_stor  =GetTotalRivuletStorage();
 
-    // write new time step
-    retval = nc_inq_varid (_STORAGE_ncid, "time",   &time_id);                                 HandleNetCDFErrors(retval);
-    retval = nc_put_vara_double(_STORAGE_ncid, time_id, time_index, count1, &current_time[0]); HandleNetCDFErrors(retval);
+    _STORAGE_ncbuf.StartTimeStep(time_ind);
+    _STORAGE_ncbuf.SetValue("time",current_time);
 
     if(tt.model_time!=0){
-      AddSingleValueToNetCDF(_STORAGE_ncid,"rainfall"       ,time_ind2,precip-snowfall);
-      AddSingleValueToNetCDF(_STORAGE_ncid,"snowfall"       ,time_ind2,snowfall);
+      _STORAGE_ncbuf.SetValue("rainfall"       ,precip-snowfall);
+      _STORAGE_ncbuf.SetValue("snowfall"       ,snowfall);
     }
-    AddSingleValueToNetCDF(_STORAGE_ncid,"channel_storage"  ,time_ind2,channel_stor);
-    AddSingleValueToNetCDF(_STORAGE_ncid,"reservoir_storage",time_ind2,reservoir_stor);
-    AddSingleValueToNetCDF(_STORAGE_ncid,"rivulet_storage"  ,time_ind2,rivulet_stor);
+    _STORAGE_ncbuf.SetValue("channel_storage"  ,channel_stor);
+    _STORAGE_ncbuf.SetValue("reservoir_storage",reservoir_stor);
+    _STORAGE_ncbuf.SetValue("rivulet_storage"  ,rivulet_stor);
 
     double currentWater=0.0;
     double S;string short_name;
@@ -2797,7 +2788,7 @@ void  CModel::WriteNetcdfMinorOutput ( const optStruct   &Options,
 	    short_name = GetStateVarInfo()->GetStateVarLongName(_aStateVarType[i],
                                                           _aStateVarLayer[i],
                                                           GetTransportModel());
-	    AddSingleValueToNetCDF(_STORAGE_ncid, short_name.c_str(),time_ind2,S);
+	    _STORAGE_ncbuf.SetValue(short_name,S);
 	    currentWater+=S;
 	  }
     }
@@ -2813,10 +2804,10 @@ void  CModel::WriteNetcdfMinorOutput ( const optStruct   &Options,
 	      }
       }
     }
-    AddSingleValueToNetCDF(_STORAGE_ncid,"total"        ,time_ind2,currentWater);
-    AddSingleValueToNetCDF(_STORAGE_ncid,"cum_input"    ,time_ind2,_CumulInput);
-    AddSingleValueToNetCDF(_STORAGE_ncid,"cum_outflow"  ,time_ind2,_CumulOutput);
-    AddSingleValueToNetCDF(_STORAGE_ncid,"MB_error"     ,time_ind2,FormatDouble((currentWater-_initWater)+(_CumulOutput-_CumulInput)));
+    _STORAGE_ncbuf.SetValue("total"        ,currentWater);
+    _STORAGE_ncbuf.SetValue("cum_input"    ,_CumulInput);
+    _STORAGE_ncbuf.SetValue("cum_outflow"  ,_CumulOutput);
+    _STORAGE_ncbuf.SetValue("MB_error"     ,FormatDouble((currentWater-_initWater)+(_CumulOutput-_CumulInput)));
   }
 
   //====================================================================
@@ -2829,32 +2820,31 @@ void  CModel::WriteNetcdfMinorOutput ( const optStruct   &Options,
     double snowfall      =GetAverageSnowfall();
     pFave = &faveStruct;
 
-    // write new time step
-    retval = nc_inq_varid      (_FORCINGS_ncid, "time",   &time_id);                            HandleNetCDFErrors(retval);
-    retval = nc_put_vara_double(_FORCINGS_ncid, time_id, time_index, count1, &current_time[0]); HandleNetCDFErrors(retval);
+    _FORCINGS_ncbuf.StartTimeStep(time_ind);
+    _FORCINGS_ncbuf.SetValue("time",current_time);
 
     // write data
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"rainfall"         ,time_ind2,pFave->precip-snowfall);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"snowfall"         ,time_ind2,snowfall);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"temp"             ,time_ind2,pFave->temp_ave);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"temp_daily_min"   ,time_ind2,pFave->temp_daily_min);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"temp_daily_max"   ,time_ind2,pFave->temp_daily_max);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"temp_daily_ave"   ,time_ind2,pFave->temp_daily_ave);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"air_density"      ,time_ind2,pFave->air_dens);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"air_pressure"     ,time_ind2,pFave->air_pres);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"relative_humidity",time_ind2,pFave->rel_humidity);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"cloud_cover"      ,time_ind2,pFave->cloud_cover);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"ET_radiation"     ,time_ind2,pFave->ET_radia);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"SW_radiation"     ,time_ind2,pFave->SW_radia);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"net_SW_radiation" ,time_ind2,pFave->SW_radia_net);
-    //AddSingleValueToNetCDF(_FORCINGS_ncid,"SW_radia_subcan"  ,time_ind2,pFave->SW_rad_subcanopy);
-    //AddSingleValueToNetCDF(_FORCINGS_ncid,"SW_subcan_net"    ,time_ind2,pFave->SW_subcan_net);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"LW_incoming"      ,time_ind2,pFave->LW_incoming);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"LW_radiation"     ,time_ind2,pFave->cloud_cover);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"wind_velocity"    ,time_ind2,pFave->wind_vel);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"PET"              ,time_ind2,pFave->PET);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"OW_PET"           ,time_ind2,pFave->OW_PET);
-    AddSingleValueToNetCDF(_FORCINGS_ncid,"potential_melt"   ,time_ind2,pFave->potential_melt);
+    _FORCINGS_ncbuf.SetValue("rainfall"         ,pFave->precip-snowfall);
+    _FORCINGS_ncbuf.SetValue("snowfall"         ,snowfall);
+    _FORCINGS_ncbuf.SetValue("temp"             ,pFave->temp_ave);
+    _FORCINGS_ncbuf.SetValue("temp_daily_min"   ,pFave->temp_daily_min);
+    _FORCINGS_ncbuf.SetValue("temp_daily_max"   ,pFave->temp_daily_max);
+    _FORCINGS_ncbuf.SetValue("temp_daily_ave"   ,pFave->temp_daily_ave);
+    _FORCINGS_ncbuf.SetValue("air_density"      ,pFave->air_dens);
+    _FORCINGS_ncbuf.SetValue("air_pressure"     ,pFave->air_pres);
+    _FORCINGS_ncbuf.SetValue("relative_humidity",pFave->rel_humidity);
+    _FORCINGS_ncbuf.SetValue("cloud_cover"      ,pFave->cloud_cover);
+    _FORCINGS_ncbuf.SetValue("ET_radiation"     ,pFave->ET_radia);
+    _FORCINGS_ncbuf.SetValue("SW_radiation"     ,pFave->SW_radia);
+    _FORCINGS_ncbuf.SetValue("net_SW_radiation" ,pFave->SW_radia_net);
+    //_FORCINGS_ncbuf.SetValue("SW_radia_subcan"  ,pFave->SW_rad_subcanopy);
+    //_FORCINGS_ncbuf.SetValue("SW_subcan_net"    ,pFave->SW_subcan_net);
+    _FORCINGS_ncbuf.SetValue("LW_incoming"      ,pFave->LW_incoming);
+    _FORCINGS_ncbuf.SetValue("LW_radiation"     ,pFave->cloud_cover);
+    _FORCINGS_ncbuf.SetValue("wind_velocity"    ,pFave->wind_vel);
+    _FORCINGS_ncbuf.SetValue("PET"              ,pFave->PET);
+    _FORCINGS_ncbuf.SetValue("OW_PET"           ,pFave->OW_PET);
+    _FORCINGS_ncbuf.SetValue("potential_melt"   ,pFave->potential_melt);
   }
 
   //====================================================================
@@ -2862,117 +2852,194 @@ void  CModel::WriteNetcdfMinorOutput ( const optStruct   &Options,
   //====================================================================
   if(Options.write_reservoirMB)
   {
+    _RESMB_ncbuf.StartTimeStep(time_ind);
+    _RESMB_ncbuf.SetValue("time"  ,current_time);
+    _RESMB_ncbuf.SetValue("precip",current_prec);
+
+    double *stage  =_RESMB_ncbuf.GetRow("stage");  // NULL if no gauged reservoirs
+    double *area   =_RESMB_ncbuf.GetRow("area");
+    double *inflow =_RESMB_ncbuf.GetRow("inflow");
+    double *outflow=_RESMB_ncbuf.GetRow("outflow");
+    double *evap   =_RESMB_ncbuf.GetRow("evap");
+    double *seepage=_RESMB_ncbuf.GetRow("seepage");
+    double *stor   =_RESMB_ncbuf.GetRow("volume");
+    double *MBerr  =_RESMB_ncbuf.GetRow("MB_error");
+    double *losses =_RESMB_ncbuf.GetRow("losses");
+    double *precip =_RESMB_ncbuf.GetRow("precip_m3");
+    if (stage!=NULL)
+    {
+      int iSim=0;
+      double oldstor;
+      for(int p=0;p<_nSubBasins;p++)
+      {
+        CSubBasin *pSB=_pSubBasins[p];
+        if(pSB->IsGauged() && (pSB->IsEnabled()) && (pSB->GetReservoir()!=NULL))
+        {
+          stage  [iSim]=pSB->GetReservoir()->GetResStage();
+          area   [iSim]=pSB->GetReservoir()->GetSurfaceArea();
+          inflow [iSim]=pSB->GetIntegratedReservoirInflow(Options.timestep);//m3
+          outflow[iSim]=pSB->GetIntegratedOutflow        (Options.timestep);//m3
+          evap   [iSim]=pSB->GetReservoir()->GetReservoirEvapLosses (Options.timestep);//m3
+          seepage[iSim]=pSB->GetReservoir()->GetReservoirGWLosses   (Options.timestep);//m3
+          stor   [iSim]=pSB->GetReservoir()->GetStorage             ();//m3
+          oldstor      =pSB->GetReservoir()->GetOldStorage          ();//m3
+          losses [iSim]=pSB->GetReservoir()->GetReservoirLosses     (Options.timestep);//m3 = GW+ET
+          precip [iSim]=pSB->GetReservoir()->GetReservoirPrecipGains(Options.timestep);//m3
+          MBerr  [iSim]=inflow[iSim]-outflow[iSim]-losses[iSim]+precip[iSim]-(stor[iSim]-oldstor);
+          if(tt.model_time==0.0){ inflow[iSim]=0.0; }
+
+          iSim++;
+        }
+      }
+    }
+  }
+#endif
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Creates WatershedStorage.npy, Hydrographs.npy and ReservoirStages.npy and their .json sidecars
+/// \details columns are identical to those of the corresponding .csv files, except that date and hour
+/// columns are omitted (time is in days since simulation start; see sidecar)
+///
+/// \param &Options [in] global model options
+//
+void CModel::WriteBinaryStandardHeaders(const optStruct &Options)
+{
+  int i,p;
+  string tmpFilename,name;
+  CSubBasin *pSB;
+
+  //WatershedStorage.npy
+  //--------------------------------------------------------------
+  if (Options.write_watershed_storage)
+  {
+    tmpFilename=FilenamePrepare("WatershedStorage.npy",Options);
+    if (!_STORAGE_bin.open(tmpFilename)){
+      ExitGracefully(("CModel::WriteBinaryStandardHeaders: unable to open output file "+tmpFilename+" for writing.").c_str(),FILE_OPEN_ERR);
+    }
+    WriteBinaryFileAttributes(_STORAGE_bin,Options,"Standard Output");
+
+    int iCumPrecip=GetStateVarIndex(ATMOS_PRECIP);
+    _STORAGE_bin.AddColumn("time"             ,"d");
+    _STORAGE_bin.AddColumn("rainfall"         ,"mm/d");
+    _STORAGE_bin.AddColumn("snowfall"         ,"mm/d SWE");
+    _STORAGE_bin.AddColumn("Channel Storage"  ,"mm");
+    _STORAGE_bin.AddColumn("Reservoir Storage","mm");
+    _STORAGE_bin.AddColumn("Rivulet Storage"  ,"mm");
+    for (i=0;i<GetNumStateVars();i++){
+      if ((CStateVariable::IsWaterStorage(_aStateVarType[i]) && (i!=iCumPrecip))){
+        _STORAGE_bin.AddColumn(CStateVariable::GetStateVarLongName(_aStateVarType[i],_aStateVarLayer[i],_pTransModel),"mm");
+      }
+    }
+    _STORAGE_bin.AddColumn("Total"       ,"mm");
+    _STORAGE_bin.AddColumn("Cum. Inputs" ,"mm");
+    _STORAGE_bin.AddColumn("Cum. Outflow","mm");
+    _STORAGE_bin.AddColumn("MB Error"    ,"mm");
+  }
 
-    int    this_id;
+  //Hydrographs.npy
+  //--------------------------------------------------------------
+  tmpFilename=FilenamePrepare("Hydrographs.npy",Options);
+  if (!_HYDRO_bin.open(tmpFilename)){
+    ExitGracefully(("CModel::WriteBinaryStandardHeaders: unable to open output file "+tmpFilename+" for writing.").c_str(),FILE_OPEN_ERR);
+  }
+  WriteBinaryFileAttributes(_HYDRO_bin,Options,"Standard Output");
 
-    // (a) count how many values need to be written
-    int iSim,nSim; // current and total # of sub-basins with simulated stages
-    nSim = 0;
-    for(int p=0;p<_nSubBasins;p++) {
-      if(_pSubBasins[p]->IsGauged()  && (_pSubBasins[p]->IsEnabled()) && (_pSubBasins[p]->GetReservoir()!=NULL)) { nSim++; }
-    }
-
-    // (b) allocate memory if necessary
-    double* stage=NULL;
-    double* area=NULL;
-    double* inflow=NULL;
-    double* outflow=NULL;
-    double* evap=NULL;
-    double* seepage=NULL;
-    double *stor=NULL;
-    double* MBerr=NULL;
-    double* losses=NULL;
-    double* precip=NULL;
-    if(nSim>0) {
-      stage  =new double [nSim];
-      area   =new double [nSim];
-      inflow =new double [nSim];
-      outflow=new double [nSim];
-      evap   =new double [nSim];
-      seepage=new double [nSim];
-      stor   =new double [nSim];
-      MBerr  =new double [nSim];
-      losses =new double [nSim];
-      precip =new double [nSim];
-    }
-
-    // (c) obtain data
-    iSim = 0;
-    current_prec[0] = NETCDF_BLANK_VALUE;
-    if(tt.model_time != 0.0) { current_prec[0] = GetAveragePrecip(); } //watershed-wide precip+irrigation
-    double oldstor;
-    for(int p=0;p<_nSubBasins;p++)
+  _HYDRO_bin.AddColumn("time"  ,"d");
+  _HYDRO_bin.AddColumn("precip","mm/d");
+  for (p=0;p<_nSubBasins;p++)
+  {
+    pSB=_pSubBasins[p];
+    if (pSB->IsGauged() && pSB->IsEnabled())
     {
-      CSubBasin *pSB=_pSubBasins[p];
-      if(pSB->IsGauged() && (pSB->IsEnabled()) && (pSB->GetReservoir()!=NULL))
+      if (pSB->GetName()==""){name="ID="+to_string(pSB->GetID());}
+      else                   {name=pSB->GetName();}
+
+      _HYDRO_bin.AddColumn(name,"m3/s");
+      for (i = 0; i < _nObservedTS; i++){
+        if (IsContinuousFlowObs(_pObservedTS[i],pSB->GetID())){_HYDRO_bin.AddColumn(name+" (observed)","m3/s");}
+      }
+      if (Options.write_localflow){_HYDRO_bin.AddColumn(name+" (local)","m3/s");}
+      if (pSB->GetReservoir() != NULL)
       {
-        stage  [iSim]=pSB->GetReservoir()->GetResStage();
-        area   [iSim]=pSB->GetReservoir()->GetSurfaceArea();
-        inflow [iSim]=pSB->GetIntegratedReservoirInflow(Options.timestep);//m3
-        outflow[iSim]=pSB->GetIntegratedOutflow        (Options.timestep);//m3
-        evap   [iSim]=pSB->GetReservoir()->GetReservoirEvapLosses (Options.timestep);//m3
-        seepage[iSim]=pSB->GetReservoir()->GetReservoirGWLosses   (Options.timestep);//m3
-        stor   [iSim]=pSB->GetReservoir()->GetStorage             ();//m3
-        oldstor      =pSB->GetReservoir()->GetOldStorage          ();//m3
-        losses [iSim]=pSB->GetReservoir()->GetReservoirLosses     (Options.timestep);//m3 = GW+ET
-        precip [iSim]=pSB->GetReservoir()->GetReservoirPrecipGains(Options.timestep);//m3
-        MBerr  [iSim]=inflow[iSim]-outflow[iSim]-losses[iSim]+precip[iSim]-(stor[iSim]-oldstor);
-        //constraint_str[iSim]=pSB->GetReservoir()->GetCurrentConstraint   ();
-        if(tt.model_time==0.0){ inflow[iSim]=0.0; }
-
-        iSim++;
-      }
-    }
-
-    // write new time step
-    retval = nc_inq_varid      (_RESMB_ncid,"time",&time_id);                              HandleNetCDFErrors(retval);
-    retval = nc_put_vara_double(_RESMB_ncid,time_id,time_index,count1,&current_time[0]);   HandleNetCDFErrors(retval);
-
-    // write precipitation values
-    retval = nc_inq_varid      (_RESMB_ncid,"precip",&this_id);                          HandleNetCDFErrors(retval);
-    retval = nc_put_vara_double(_RESMB_ncid,this_id,time_index,count1,&current_prec[0]); HandleNetCDFErrors(retval);
-
-    // write simulated stage/obs stage values
-    if(nSim > 0) {
-      start2[0] = int(rvn_round(tt.model_time/Options.timestep)); // element of NetCDF array that will be written
-      start2[1] = 0;                                              // element of NetCDF array that will be written
-      count2[0] = 1;      // writes exactly one time step
-      count2[1] = nSim;   // writes exactly nSim elements
-      retval = nc_inq_varid(_RESMB_ncid,"stage",&this_id);                          HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_RESMB_ncid,this_id,start2,count2,&stage[0]);     HandleNetCDFErrors(retval);
-      retval = nc_inq_varid(_RESMB_ncid,"area",&this_id);                           HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_RESMB_ncid,this_id,start2,count2,&area[0]);      HandleNetCDFErrors(retval);
-      retval = nc_inq_varid(_RESMB_ncid,"inflow",&this_id);                         HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_RESMB_ncid,this_id,start2,count2,&inflow[0]);    HandleNetCDFErrors(retval);
-      retval = nc_inq_varid(_RESMB_ncid,"outflow",&this_id);                        HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_RESMB_ncid,this_id,start2,count2,&outflow[0]);   HandleNetCDFErrors(retval);
-      retval = nc_inq_varid(_RESMB_ncid,"evap",&this_id);                           HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_RESMB_ncid,this_id,start2,count2,&evap[0]);      HandleNetCDFErrors(retval);
-      retval = nc_inq_varid(_RESMB_ncid,"seepage",&this_id);                        HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_RESMB_ncid,this_id,start2,count2,&seepage[0]);   HandleNetCDFErrors(retval);
-      retval = nc_inq_varid(_RESMB_ncid,"volume",&this_id);                         HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_RESMB_ncid,this_id,start2,count2,&stor[0]);      HandleNetCDFErrors(retval);
-      retval = nc_inq_varid(_RESMB_ncid,"MB_error",&this_id);                       HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_RESMB_ncid,this_id,start2,count2,&MBerr[0]);     HandleNetCDFErrors(retval);
-      retval = nc_inq_varid(_RESMB_ncid,"losses",&this_id);                         HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_RESMB_ncid,this_id,start2,count2,&losses[0]);    HandleNetCDFErrors(retval);
-      retval = nc_inq_varid(_RESMB_ncid,"precip_m3",&this_id);                      HandleNetCDFErrors(retval);
-      retval = nc_put_vara_double(_RESMB_ncid,this_id,start2,count2,&precip[0]);    HandleNetCDFErrors(retval);
-      //retval = nc_inq_varid(_RESMB_ncid,"constraint",&this_id);                      HandleNetCDFErrors(retval);
-      //retval = nc_put_vara_double(_RESMB_ncid,this_id,start2,count2,&constraint[0]); HandleNetCDFErrors(retval);
-    }
-    delete [] stage;
-    delete [] area;
-    delete [] inflow;
-    delete [] outflow;
-    delete [] evap;
-    delete [] seepage;
-    delete [] stor;
-    delete [] MBerr;
-    delete [] losses;
-    delete [] precip;
+        _HYDRO_bin.AddColumn(name+" (res. inflow)","m3/s");
+        if (Options.write_netresinflow){_HYDRO_bin.AddColumn(name+" (res. net inflow)","m3/s");}
+        for (i = 0; i < _nObservedTS; i++){
+          if (IsContinuousInflowObs(_pObservedTS[i],pSB->GetID())){_HYDRO_bin.AddColumn(name+" (obs. res. inflow)","m3/s");}
+        }
+      }
+    }
+  }
+
+  //ReservoirStages.npy
+  //--------------------------------------------------------------
+  if (Options.write_reservoir)
+  {
+    tmpFilename=FilenamePrepare("ReservoirStages.npy",Options);
+    if (!_RESSTAGE_bin.open(tmpFilename)){
+      ExitGracefully(("CModel::WriteBinaryStandardHeaders: unable to open output file "+tmpFilename+" for writing.").c_str(),FILE_OPEN_ERR);
+    }
+    WriteBinaryFileAttributes(_RESSTAGE_bin,Options,"Standard Output");
+
+    _RESSTAGE_bin.AddColumn("time"  ,"d");
+    _RESSTAGE_bin.AddColumn("precip","mm/d");
+    for (p=0;p<_nSubBasins;p++)
+    {
+      pSB=_pSubBasins[p];
+      if ((pSB->IsGauged()) && (pSB->IsEnabled()) && (pSB->GetReservoir()!=NULL))
+      {
+        if (pSB->GetName()==""){name="ID="+to_string(pSB->GetID());}
+        else                   {name=pSB->GetName();}
+
+        _RESSTAGE_bin.AddColumn(name,"m");
+        for (i = 0; i < _nObservedTS; i++){
+          if (IsContinuousStageObs(_pObservedTS[i],pSB->GetID())){_RESSTAGE_bin.AddColumn(name+" (observed)","m");}
+        }
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Writes minor output data to WatershedStorage.npy, Hydrographs.npy and ReservoirStages.npy
+/// \details values are those written to the .csv files; blank entries (precipitation at time zero, missing observations) are NaN
+///
+/// \param &Options [in] global model options
+/// \param &tt      [in] current time structure
+//
+void  CModel::WriteBinaryMinorOutput(const optStruct   &Options,
+                                     const time_struct &tt)
+{
+  double t=tt.model_time;
+
+  //WatershedStorage.npy
+  //----------------------------------------------------------------
+  if (Options.write_watershed_storage)
+  {
+    _STORAGE_bin.AddValue(t);
+    WriteWatershedStorageRow(Options,tt,_STORAGE_bin);
+    _STORAGE_bin.EndRow();
+  }
+
+  //Hydrographs.npy
+  //----------------------------------------------------------------
+  bool ave=Options.ave_hydrograph;
+  if ((ave) || (!Options.period_starting) || (t!=0))
+  {
+    if ((ave) && (Options.period_starting)){_HYDRO_bin.AddValue(t-Options.timestep);}
+    else                                   {_HYDRO_bin.AddValue(t);}
+    WriteHydrographRow(Options,tt,_HYDRO_bin);
+    _HYDRO_bin.EndRow();
+  }
+
+  //ReservoirStages.npy
+  //----------------------------------------------------------------
+  if ((Options.write_reservoir) && ((!Options.period_starting) || (t!=0)))
+  {
+    _RESSTAGE_bin.AddValue(t);
+    WriteReservoirStageRow(Options,tt,_RESSTAGE_bin);
+    _RESSTAGE_bin.EndRow();
   }
-#endif
 }
 
 
@@ -3059,6 +3126,30 @@ string CorrectForRelativePath(const string filename,const string relfile)
   return filename;
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief sets compression and chunking of the time variable of a NetCDF output file
+/// \details variables added with NetCDFAddMetadata/NetCDFAddMetadata2D inherit these settings
+/// \param fileid [in] NetCDF output file id
+/// \param varid_time [in] identifier of time variable
+/// \param default_chunk [in] time chunk size used unless overridden by :NetCDFTimeChunkSize
+/// \param Options [in] global model options
+/// \return time chunk size [time steps]
+//
+size_t NetCDFSetTimeStorage(const int fileid,const int varid_time,const size_t default_chunk,const optStruct &Options)
+{
+  size_t chunksize=max(default_chunk,(size_t)(1));
+  if (Options.NetCDF_time_chunk>0){chunksize=(size_t)(Options.NetCDF_time_chunk);}
+#ifdef _RVNETCDF_
+  int retval;
+  if (Options.NetCDF_deflate_level>0){
+    retval = nc_def_var_deflate (fileid, varid_time, 1, 1, Options.NetCDF_deflate_level); HandleNetCDFErrors(retval);
+  }
+  retval = nc_def_var_chunking(fileid, varid_time, NC_CHUNKED, &chunksize); HandleNetCDFErrors(retval);
+#else
+  (void)(fileid); (void)(varid_time);
+#endif
+  return chunksize;
+}
 //////////////////////////////////////////////////////////////////
 /// \brief adds metadata of attribute to NetCDF file
 /// \param fileid [in] NetCDF output file id
@@ -3075,6 +3166,7 @@ int NetCDFAddMetadata(const int fileid,const int time_dimid,string shortname,str
   int dimids[1];
   dimids[0] = time_dimid;
   int    time_varid;
+  int    shuffle,deflate,level;
   size_t chunksize[1];
 
   static double fill_val[] = {NETCDF_BLANK_VALUE};
@@ -3082,10 +3174,12 @@ int NetCDFAddMetadata(const int fileid,const int time_dimid,string shortname,str
 
   // (a) create variable precipitation
   retval = nc_def_var(fileid,shortname.c_str(),NC_DOUBLE,1,dimids,&varid); HandleNetCDFErrors(retval);
-  // Set compression
-  retval = nc_def_var_deflate(fileid, varid, 1, 1, NETCDF_DEFLATE_LEVEL); HandleNetCDFErrors(retval);
-  // Set the chunksize to the chunksize of the time variable
+  // Set compression and the chunksize to those of the time variable
   retval = nc_inq_varid(fileid, "time", &time_varid); HandleNetCDFErrors(retval);
+  retval = nc_inq_var_deflate(fileid, time_varid, &shuffle, &deflate, &level); HandleNetCDFErrors(retval);
+  if (deflate){
+    retval = nc_def_var_deflate(fileid, varid, shuffle, 1, level); HandleNetCDFErrors(retval);
+  }
   retval = nc_inq_var_chunking(fileid, time_varid, NULL, &chunksize[0]); HandleNetCDFErrors(retval);
   retval = nc_def_var_chunking(fileid, varid, NC_CHUNKED, chunksize); HandleNetCDFErrors(retval);
 
@@ -3113,6 +3207,7 @@ int NetCDFAddMetadata2D(const int fileid,const int time_dimid,int nbasins_dimid,
   int    retval;
   int    dimids2[2];
   int    time_varid;
+  int    shuffle,deflate,level;
   string tmp;
   size_t chunksize2[2];
 
@@ -3124,10 +3219,13 @@ int NetCDFAddMetadata2D(const int fileid,const int time_dimid,int nbasins_dimid,
 
   // (a) create variable
   retval = nc_def_var(fileid,shortname.c_str(),NC_DOUBLE,2,dimids2,&varid); HandleNetCDFErrors(retval);
-  // Set compression
-  retval = nc_def_var_deflate(fileid, varid, 1, 1, NETCDF_DEFLATE_LEVEL); HandleNetCDFErrors(retval);
-  // Set time chunksize to number of time steps
+  // Set compression to that of the time variable
   retval = nc_inq_varid(fileid, "time", &time_varid); HandleNetCDFErrors(retval);
+  retval = nc_inq_var_deflate(fileid, time_varid, &shuffle, &deflate, &level); HandleNetCDFErrors(retval);
+  if (deflate){
+    retval = nc_def_var_deflate(fileid, varid, shuffle, 1, level); HandleNetCDFErrors(retval);
+  }
+  // Set time chunksize to that of the time variable
   retval = nc_inq_var_chunking(fileid, time_varid, NULL, &chunksize2[0]); HandleNetCDFErrors(retval);
    // Set nbasins chunksize to number ensuring that chunks have approximately 10 MB of data (assuming double precision)
   retval = nc_inq_dimlen(fileid, nbasins_dimid, &chunksize2[1]); HandleNetCDFErrors(retval);
@@ -3174,26 +3272,28 @@ void WriteNetCDFGlobalAttributes(const int out_ncid,const optStruct &Options,con
 #endif
 }
 //////////////////////////////////////////////////////////////////
-/// \brief adds single value of attribute 'shortname' linked to time time_index to NetCDF file
-/// \param out_ncid [in] NetCDF file identifier
-/// \param shortname [in] short name of attribute (e.g., 'rainfall')
-/// \param time_index [in] index of current time step
-/// \param value [in] value of attribute at current time step
+/// \brief sets time axis and attributes of binary column file
+/// \param &BIN [out] binary column file
+/// \param Options [in] model Options structure
+/// \param descript [in] contents of description attribute
 //
-void AddSingleValueToNetCDF(const int out_ncid,const string &shortname,const size_t time_index,const double &value)
+void WriteBinaryFileAttributes(CBinaryColumnFile &BIN,const optStruct &Options,const string descript)
 {
-#ifdef _RVNETCDF_
-  static size_t count1[1]; //static for speed of execution
-  static size_t time_ind[1];
-  static double val[1];
-  time_ind[0]=time_index;
-  count1  [0]=1;
-  val     [0]=value;
-  int var_id(0);
-  int retval(0);
-  retval = nc_inq_varid      (out_ncid,shortname.c_str(),&var_id);      HandleNetCDFErrors(retval);
-  retval = nc_put_vara_double(out_ncid,var_id,time_ind,count1,&val[0]); HandleNetCDFErrors(retval);
-#endif
+  //time is in "days since YYYY-MM-DD HH:MM:SS"  (model start time)
+  time_struct tt;
+  JulianConvert(0.0,Options.julian_start_day,Options.julian_start_year,Options.calendar,tt);
+  string units="days since "+tt.date_string+" "+DecDaysToHours(tt.julian_day,true);
+  if (Options.time_zone!=0){units+=TimeZoneToString(Options.time_zone);}
+
+  BIN.SetTimeAxis(units,CalendarToString(Options.calendar),Options.timestep);
+
+  BIN.AddAttribute("application","Raven");
+  if (!Options.benchmarking){
+    BIN.AddAttribute("version"      ,Options.version);
+    BIN.AddAttribute("creation_date",GetCurrentMachineTime());
+  }
+  if (Options.run_name!=""){BIN.AddAttribute("run_name",Options.run_name);}
+  BIN.AddAttribute("description",descript);
 }
 //////////////////////////////////////////////////////////////////
 /// \brief writes list of Basin IDs to NetCDF file
@@ -3242,42 +3342,108 @@ void WriteNetCDFBasinList(const int ncid,const int varid,const int varid_name,co
 //
 double CModel::GetObjFuncVal(long long calib_SBID,diag_type calib_Obj, const string calib_period) const
 {
-  double starttime=0.0;
-  double endtime  =0.0;
-  comparison compare=COMPARE_GREATERTHAN;
-  double thresh=-ALMOST_INF;
   double objval;
-  int ii=DOESNT_EXIST; // observation index
-  int jj=DOESNT_EXIST; // diagnostic measure
+  int ii,jj,dd; // observation, diagnostic and period index
 
   //- grab diagnostic information -----------------------------------
-  for(int d=0;d<_nDiagPeriods;d++) {
-    if(_pDiagPeriods[d]->GetName()==calib_period) {
-      starttime=_pDiagPeriods[d]->GetStartTime();
-      endtime  =_pDiagPeriods[d]->GetEndTime();
-      compare  =_pDiagPeriods[d]->GetComparison();
-      thresh   =_pDiagPeriods[d]->GetThreshold();
-    }
+  FindObjective(calib_SBID,calib_Obj,calib_period,ii,jj,dd);
+
+  if (_terminated_early){return ALMOST_INF;} //run ended early because objective bound could not be met
+
+  //- Calculate objective function -----------------------------------
+  if ((_aDiagAccums!=NULL) && (CDiagnostic::IsStreamable(calib_Obj))) { //running sums - no pass over stored series
+    objval=GetRunningDiagnostic(ii,dd,jj);
+  }
+  else {
+    objval=EvaluateDiagnostic(ii,dd,jj,*_pOptStruct);
   }
 
+  if((calib_Obj==DIAG_NASH_SUTCLIFFE) ||
+     (calib_Obj==DIAG_KLING_GUPTA))
+  {
+    objval*=-1;
+  }
+  return objval;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief finds observation, diagnostic and period index of calibration objective
+/// \param SBID [in] target subbasin ID (hydrograph observations)
+/// \param obj [in] objective diagnostic (must be in :EvaluationMetrics)
+/// \param period [in] name of diagnostic period
+/// \param ii, jj, dd [out] observation, diagnostic and period index
+//
+void CModel::FindObjective(const long long SBID, const diag_type obj, const string period,
+                           int &ii, int &jj, int &dd) const
+{
+  ii=jj=dd=DOESNT_EXIST;
+  for(int d=0;d<_nDiagPeriods;d++) {
+    if(_pDiagPeriods[d]->GetName()==period) { dd=d; }
+  }
   for(int i=0;i<_nObservedTS;i++)
   {
-    if((_pObservedTS[i]->GetName()=="HYDROGRAPH") && (_pObservedTS[i]->GetLocID()==calib_SBID)) { ii=i; }
+    if((_pObservedTS[i]->GetName()=="HYDROGRAPH") && (_pObservedTS[i]->GetLocID()==SBID)) { ii=i; }
   }
   for(int j=0; j<_nDiagnostics;j++) {
-    if(_pDiagnostics[j]->GetType()==calib_Obj) { jj=j; }
+    if(_pDiagnostics[j]->GetType()==obj) { jj=j; }
   }
   ExitGracefullyIf(ii==DOESNT_EXIST,"GetObjFuncVal: unable to find calibration target time series (hydrograph in basin :CalibrationSBID)",BAD_DATA);
   ExitGracefullyIf(jj==DOESNT_EXIST,"GetObjFuncVal: unable to find calibration target diagnostic ",BAD_DATA);
-  ExitGracefullyIf(endtime==0.0,    "GetObjFuncVal: unable to find calibration period with this name ",BAD_DATA);
+  ExitGracefullyIf(dd==DOESNT_EXIST,"GetObjFuncVal: unable to find calibration period with this name ",BAD_DATA);
+}
 
-  //- Calculate objective function -----------------------------------
-  objval=_pDiagnostics[jj]->CalculateDiagnostic(_pModeledTS[ii],_pObservedTS[ii],_pObsWeightTS[ii],starttime,endtime,compare,thresh,*_pOptStruct);
+//////////////////////////////////////////////////////////////////
+/// \brief sets objective bound used to end hopeless calibration runs early
+/// \details once the running error sums show that the objective (as returned by GetObjFuncVal) can no longer
+/// reach the bound, CheckObjectiveBound ends the run. Only supported for objectives with
+/// CDiagnostic::HasAchievableBound; ignored otherwise
+/// \param SBID [in] target subbasin ID (hydrograph observations)
+/// \param obj [in] objective diagnostic
+/// \param period [in] name of diagnostic period
+/// \param bound [in] objective bound (minimized, e.g., -NSE); ALMOST_INF to disable
+//
+void CModel::SetObjectiveBound(const long long SBID, const diag_type obj, const string period, const double &bound)
+{
+  if (!CDiagnostic::HasAchievableBound(obj)){return;}
+  _objbound_SBID  =SBID;
+  _objbound_diag  =obj;
+  _objbound_period=period;
+  _objbound       =bound;
+  if (_aDiagAccums!=NULL){ //model already initialized
+    FindObjective(_objbound_SBID,_objbound_diag,_objbound_period,_objbound_ind[0],_objbound_ind[1],_objbound_ind[2]);
+  }
+}
 
-  if((calib_Obj==DIAG_NASH_SUTCLIFFE) ||
-     (calib_Obj==DIAG_KLING_GUPTA))
-  {
-    objval*=-1;
+//////////////////////////////////////////////////////////////////
+/// \brief returns true if current run was ended early because the objective bound could no longer be met
+//
+bool CModel::IsTerminatedEarly() const
+{
+  return _terminated_early;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief checks whether objective bound can still be met, given the time steps simulated so far
+/// \details called every time step after UpdateDiagnostics; cost is independent of simulation length
+/// \param &Options [in] Global model options information
+/// \param &tt [in] current time structure
+/// \return true if simulation should end
+//
+bool CModel::CheckObjectiveBound(const optStruct &Options, const time_struct &tt)
+{
+  if ((_objbound==ALMOST_INF) || (_aDiagAccums==NULL) || (_objbound_ind[0]==DOESNT_EXIST)){return false;}
+
+  const int ii=_objbound_ind[0];
+  const int jj=_objbound_ind[1];
+  const int dd=_objbound_ind[2];
+  double best=_pDiagnostics[jj]->CalculateBestAchievable(_aDiagAccums[ii][dd]);
+  if (_objbound_diag==DIAG_NASH_SUTCLIFFE){best*=-1;} //same convention as GetObjFuncVal
+
+  if (best<=_objbound+PRETTY_SMALL*max(fabs(_objbound),1.0)){return false;} //tolerance keeps runs which would tie bound
+
+  _terminated_early=true;
+  if (!Options.silent){
+    cout<<"Objective bound can no longer be met: simulation ended early ("<<tt.date_string<<")"<<endl;
   }
-  return objval;
+  return true;
 }
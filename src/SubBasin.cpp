@@ -3,6 +3,7 @@
   Copyright (c) 2008-2026 the Raven Development Team
   ----------------------------------------------------------------*/
 #include "SubBasin.h"
+#include "Checkpoint.h"
 
 /*****************************************************************
    Constructor/Destructor
@@ -1136,6 +1137,46 @@ void CSubBasin::SetGlobalIndex(const int p)
   _global_p=p;
 }
 //////////////////////////////////////////////////////////////////
+/// \brief Returns address of real-valued basin property
+/// \param param_name [in] String property identifier
+/// \return address of property, or NULL if unrecognized or not stored as a real value
+//
+double *CSubBasin::GetBasinPropertyAddress(const string param_name)
+{
+  string label_n = StringToUppercase(param_name);
+
+  if      (!label_n.compare("TIME_CONC"     ))  {return &(_t_conc);}
+  else if (!label_n.compare("TIME_TO_PEAK"  ))  {return &(_t_peak);}
+  else if (!label_n.compare("TIME_LAG"      ))  {return &(_t_lag);}
+  else if (!label_n.compare("RES_CONSTANT"  ))  {return &(_reservoir_constant);}
+  else if (!label_n.compare("GAMMA_SHAPE"   ))  {return &(_gamma_shape);}
+  else if (!label_n.compare("GAMMA_SCALE"   ))  {return &(_gamma_scale);}
+  else if (!label_n.compare("DIVERT_FRACT"  ))  {return &(_divert_fract);}
+  else if (!label_n.compare("FLUSH_FRACT"   ))  {return &(_flush_fract);}
+
+  else if (!label_n.compare("Q_REFERENCE"   ))  {return &(_Q_ref);}
+  else if (!label_n.compare("MANNINGS_N"    ))  {return &(_mannings_n);}
+  else if (!label_n.compare("SLOPE"         ))  {return &(_slope);}
+  else if (!label_n.compare("DIFFUSIVITY"   ))  {return &(_diffusivity);}
+  else if (!label_n.compare("CELERITY"      ))  {return &(_c_ref);}
+
+  else if (!label_n.compare("RAIN_CORR"     ))  {return &(_rain_corr);}
+  else if (!label_n.compare("SNOW_CORR"     ))  {return &(_snow_corr);}
+  else if (!label_n.compare("RECHARGE_CORR" ))  {return &(_recharge_corr);}
+  else if (!label_n.compare("TEMP_CORR"     ))  {return &(_temperature_corr);}
+
+  else if (!label_n.compare("HYPORHEIC_FLUX"))  {return &(_hyporheic_flux);}
+  else if (!label_n.compare("CONVECT_COEFF" ))  {return &(_convect_coeff);}
+  else if (!label_n.compare("SENS_EXCH_COEFF")) {return &(_sens_exch_coeff);}
+  else if (!label_n.compare("GW_EXCH_COEFF" ))  {return &(_GW_exch_coeff);}
+
+  else if (!label_n.compare("RIVERBED_CONDUCTIVITY")){return &(_bed_conductivity);}
+  else if (!label_n.compare("RIVERBED_THICKNESS"   )){return &(_bed_thickness);}
+  else if (!label_n.compare("CORR_REACH_LENGTH"   )) {return &(_reach_length2);}
+
+  return NULL;
+}
+//////////////////////////////////////////////////////////////////
 /// \brief Sets basin properties
 /// \param label [in] String property identifier
 /// \param &value [in] Property set value
@@ -1145,37 +1186,11 @@ bool CSubBasin::SetBasinProperties(const string label,
                                    const double &value)
 {
   string label_n = StringToUppercase(label);
-  if      (!label_n.compare("TIME_CONC"     ))  {_t_conc=value;}
-  else if (!label_n.compare("TIME_TO_PEAK"  ))  {_t_peak=value;}
-  else if (!label_n.compare("TIME_LAG"      ))  {_t_lag=value;}
-  else if (!label_n.compare("RES_CONSTANT"  ))  {_reservoir_constant=value;}
+  double *px=GetBasinPropertyAddress(label_n);
+  if      (px!=NULL){*px=value;}
   else if (!label_n.compare("NUM_RESERVOIRS"))  {_num_reservoirs=(int)(value);}
-  else if (!label_n.compare("GAMMA_SHAPE"   ))  {_gamma_shape=value;}
-  else if (!label_n.compare("GAMMA_SCALE"   ))  {_gamma_scale=value;}
-  else if (!label_n.compare("DIVERT_FRACT"  ))  {_divert_fract=value;}
-  else if (!label_n.compare("FLUSH_FRACT"   ))  {_flush_fract=value;}
-
-  else if (!label_n.compare("Q_REFERENCE"   ))  {_Q_ref=value;}
-  else if (!label_n.compare("MANNINGS_N"    ))  {_mannings_n=value;}
-  else if (!label_n.compare("SLOPE"         ))  {_slope=value;}
-  else if (!label_n.compare("DIFFUSIVITY"   ))  {_diffusivity=value; }
-  else if (!label_n.compare("CELERITY"      ))  {_c_ref=value; }
-
-  else if (!label_n.compare("RAIN_CORR"     ))  {_rain_corr=value;}
-  else if (!label_n.compare("SNOW_CORR"     ))  {_snow_corr=value;}
-  else if (!label_n.compare("RECHARGE_CORR" ))  {_recharge_corr=value;}
-  else if (!label_n.compare("TEMP_CORR"     ))  {_temperature_corr=value; }
-
   else if (!label_n.compare("REACH_HRU_ID"  ))  { _reach_HRUindex=(int)(value); }
-  else if (!label_n.compare("HYPORHEIC_FLUX"))  { _hyporheic_flux=value; }
-  else if (!label_n.compare("CONVECT_COEFF" ))  { _convect_coeff=value; }
-  else if (!label_n.compare("SENS_EXCH_COEFF")) { _sens_exch_coeff=value; }
-  else if (!label_n.compare("GW_EXCH_COEFF" ))  { _GW_exch_coeff=value; }
-
-  else if (!label_n.compare("RIVERBED_CONDUCTIVITY")){ _bed_conductivity = value; }
-  else if (!label_n.compare("RIVERBED_THICKNESS"   )){ _bed_thickness = value; }
   else if (!label_n.compare("RESERVOIR_DISABLED"  )) { _res_disabled=(bool)(value); }
-  else if (!label_n.compare("CORR_REACH_LENGTH"   )) { _reach_length2=value; }
   else if (!label_n.compare("LAKEBED_CONDUCTIVITY")) {
     if (_pReservoir != NULL) {_pReservoir->SetLakebedConductivity(value); }
   }
@@ -2877,6 +2892,25 @@ void CSubBasin::WriteToSolutionFile (ofstream &RVC) const
     _pReservoir->WriteToSolutionFile(RVC);
   }
 }
+
+//////////////////////////////////////////////////////////////////
+/// \brief writes subbasin (and reservoir) state to binary checkpoint file
+/// \details binary equivalent of WriteToSolutionFile
+/// \param &CHK [out] checkpoint file
+//
+void CSubBasin::WriteToCheckpoint (CCheckpointWriter &CHK) const
+{
+  CHK.Put<long long>(_ID);
+  CHK.Put<double>   (_channel_storage);
+  CHK.Put<double>   (_rivulet_storage);
+  CHK.Put<int>(_nSegments); CHK.PutArray(_aQout,    _nSegments); CHK.Put<double>(_QoutLast);
+  CHK.Put<int>(_nQlatHist); CHK.PutArray(_aQlatHist,_nQlatHist); CHK.Put<double>(_QlatLast);
+  CHK.Put<int>(_nQinHist ); CHK.PutArray(_aQinHist, _nQinHist );
+  CHK.Put<int>((int)(_pReservoir!=NULL));
+  if (_pReservoir!=NULL){
+    _pReservoir->WriteToCheckpoint(CHK);
+  }
+}
 //////////////////////////////////////////////////////////////////
 /// \brief clears all time series data for re-read of .rvt file
 /// \remark Called only in ensemble mode
@@ -11,10 +11,12 @@
 #include "ChannelXSect.h"
 #include "TimeSeries.h"
 #include "Reservoir.h"
+#include <unordered_set>
 class CReservoir;
 class CDemand;
 class CChannelXSect;  // defined in ChannelXSect.h
 class CSubbasinGroup;
+class CCheckpointWriter; // defined in 'Checkpoint.h'
 enum res_constraint;
 
 ///////////////////////////////////////////////////////////////////
@@ -284,6 +286,7 @@ public:/*-------------------------------------------------------*/
   void            AddReservoir             (CReservoir *pReservoir);
   void            SetGlobalIndex           (const int p);
   bool            SetBasinProperties       (const string label,const double &value);
+  double         *GetBasinPropertyAddress  (const string param_name);
   void            SetAsNonHeadwater        ();
   double          CalculateBasinArea       ();
   void            Initialize               (const double    &Qin_avg,          //[m3/s]
@@ -345,6 +348,7 @@ public:/*-------------------------------------------------------*/
                                             const time_struct &tt) const;
 
   void            WriteToSolutionFile      (ofstream &OUT) const;
+  void            WriteToCheckpoint        (CCheckpointWriter &CHK) const;
 };
 
 ///////////////////////////////////////////////////////////////////
@@ -360,6 +364,8 @@ private:/*------------------------------------------------------*/
   int             _global_pp;  ///< index of group in master Subbasin Group array (in CModel)
   bool            _disabled;   ///< true if all Subbasins in group are disabled
 
+  unordered_set<long long> _MemberIDs; ///< subbasin IDs of group members, for constant-time membership lookup
+
 public:/*-------------------------------------------------------*/
   //Constructors:
   CSubbasinGroup(string tag,int global_ind);
@@ -53,10 +53,7 @@ int    CSubbasinGroup::GetGlobalIndex       () const {return _global_pp;}
 //
 bool  CSubbasinGroup::IsInGroup          (const long long SBID) const
 {
-  for (int p=0;p<_nSubbasins; p++){
-    if (_pSubbasins[p]->GetID()==SBID){return true;}
-  }
-  return false;
+  return (_MemberIDs.find(SBID)!=_MemberIDs.end());
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Returns Subbasin corresponding to index p in group
@@ -82,6 +79,7 @@ void CSubbasinGroup::AddSubbasin(const CSubBasin *pSB)
 {
   if (!DynArrayAppend((void**&)(_pSubbasins),(void*)(pSB),_nSubbasins)){
    ExitGracefully("CSubbasinGroup::AddSubbasin: adding NULL subbasin",BAD_DATA);}
+  _MemberIDs.insert(pSB->GetID());
 }
 //////////////////////////////////////////////////////////////////
 /// \brief initializes Subbasin Groups
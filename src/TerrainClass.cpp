@@ -100,6 +100,32 @@ void  CTerrainClass::SetTerrainProperty(const string &param_name,
   SetTerrainProperty(T,param_name,value);
 }
 //////////////////////////////////////////////////////////////////
+/// \brief Returns address of the terrain property corresponding to param_name
+/// \param param_name [in] Parameter identifier
+/// \return address of parameter, or NULL if param_name is not a single-valued terrain property
+//
+double *CTerrainClass::GetTerrainPropertyAddress(const string &param_name)
+{
+  return GetTerrainPropertyAddress(T,param_name);
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Returns address of the terrain property corresponding to param_name
+/// \param &T [in] Terrain properties structure
+/// \param param_name [in] Parameter identifier
+/// \return address of parameter in T, or NULL if param_name is not a terrain property
+//
+double *CTerrainClass::GetTerrainPropertyAddress(terrain_struct &T,
+                                                 const string    param_name)
+{
+  string name = StringToUppercase(param_name);
+
+  if      (!name.compare("HILLSLOPE_LENGTH"  )){return &(T.hillslope_length);}
+  else if (!name.compare("DRAINAGE_DENSITY"  )){return &(T.drainage_density);}
+  else if (!name.compare("TOPMODEL_LAMBDA"   )){return &(T.topmodel_lambda);}
+
+  return NULL;
+}
+//////////////////////////////////////////////////////////////////
 /// \brief Sets the value of the terrain property corresponding to param_name
 /// \param &T [out] Terrain properties class
 /// \param param_name [in] Parameter identifier
@@ -112,9 +138,8 @@ void  CTerrainClass::SetTerrainProperty(terrain_struct &T,
   string name;
   name = StringToUppercase(param_name);
 
-  if      (!name.compare("HILLSLOPE_LENGTH"  )){T.hillslope_length=value;}
-  else if (!name.compare("DRAINAGE_DENSITY"  )){T.drainage_density=value;}
-  else if (!name.compare("TOPMODEL_LAMBDA"   )){T.topmodel_lambda=value; }
+  double *px=GetTerrainPropertyAddress(T,name);
+  if      (px!=NULL){*px=value;}
   else{
     WriteWarning("CTerrainClass::SetTerrainProperty: Unrecognized/invalid terrain parameter name ("+name+") in .rvp file",false);
   }
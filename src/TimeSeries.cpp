@@ -8,6 +8,8 @@
 
 void GetNetCDFStationArray(const int ncid, const string filename,int &stat_dimid,int &stat_varid, long *&aStations, string *&aStat_strings,int &nStations);
 
+const int PREFIX_SUM_MIN_PULSES=32; ///< averaging windows spanning more pulses than this use prefix sums rather than summation
+
 /*****************************************************************
    Constructor/Destructor
 ------------------------------------------------------------------
@@ -30,6 +32,8 @@ CTimeSeries::CTimeSeries(string Name, long long loc_ID, double one_value)
   _sub_daily=false;
   _t_corr   =0.0;
   _pulse    =true;
+  _aCumSum  =NULL;
+  _aCumBlank=NULL;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -74,6 +78,8 @@ CTimeSeries::CTimeSeries(string     Name,
   }
   _sub_daily=(_interval<(1.0-TIME_CORRECTION));//to account for potential roundoff error
   _t_corr=0.0;
+  _aCumSum  =NULL;
+  _aCumBlank=NULL;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -111,6 +117,8 @@ CTimeSeries::CTimeSeries(string     Name,
 
   _sub_daily=(_interval<(1.0-TIME_CORRECTION));//to account for potential roundoff error
   _t_corr=0.0;
+  _aCumSum  =NULL;
+  _aCumBlank=NULL;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -135,6 +143,8 @@ CTimeSeries::CTimeSeries(string Name,
   }
   _sub_daily=t._sub_daily;
   _t_corr   =0.0;
+  _aCumSum  =NULL;
+  _aCumBlank=NULL;
 }
 ///////////////////////////////////////////////////////////////////
 /// \brief Implementation of the destructor
@@ -143,6 +153,7 @@ CTimeSeries::~CTimeSeries()
 {
   if (DESTRUCTOR_DEBUG){cout<<"    DELETING TIME SERIES"<<endl;}
   delete [] _aVal;     _aVal =NULL;
+  ClearPrefixSums();
 }
 
 /*****************************************************************
@@ -255,6 +266,10 @@ void CTimeSeries::Initialize( const double model_start_day,   //julian day
     }
   }
 
+  // Index forcing data for fast window averages (used in resampling)
+  //------------------------------------------------------------------------------
+  if (!is_observation){IndexWindowAverages(timestep);}
+
   // Resample time series
   //------------------------------------------------------------------------------
   if (is_observation){Resample(timestep, model_duration+timestep);} //extra timestep needed for last observation of continuous hydrograph
@@ -333,6 +348,43 @@ double CTimeSeries::GetValue(const double &t) const
   }
 }
 
+///////////////////////////////////////////////////////////////////
+/// \brief Builds prefix sum and blank count arrays of pulse values
+/// \details enables O(1) evaluation of GetAvgValue over long windows
+//
+void CTimeSeries::BuildPrefixSums()
+{
+  ClearPrefixSums();
+  _aCumSum  =new double[_nPulses+1];
+  _aCumBlank=new int   [_nPulses+1];
+  ExitGracefullyIf(_aCumBlank==NULL,"CTimeSeries::BuildPrefixSums",OUT_OF_MEMORY);
+  _aCumSum  [0]=0.0;
+  _aCumBlank[0]=0;
+  for (int n=0;n<_nPulses;n++)
+  {
+    if (_aVal[n]==RAV_BLANK_DATA){_aCumSum[n+1]=_aCumSum[n];         _aCumBlank[n+1]=_aCumBlank[n]+1;}
+    else                         {_aCumSum[n+1]=_aCumSum[n]+_aVal[n];_aCumBlank[n+1]=_aCumBlank[n];  }
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief Builds prefix sums if averages over windows of given length span more than PREFIX_SUM_MIN_PULSES pulses
+/// \details short windows are summed directly, so series queried only at the model time step carry no index
+/// \param window [in] length of averaging window [d]
+//
+void CTimeSeries::IndexWindowAverages(const double &window)
+{
+  if ((_pulse) && (_aCumSum==NULL) && (_nPulses>PREFIX_SUM_MIN_PULSES) && (window/_interval>PREFIX_SUM_MIN_PULSES)){BuildPrefixSums();}
+}
+///////////////////////////////////////////////////////////////////
+/// \brief Deletes prefix sum arrays (window averages revert to summation)
+//
+void CTimeSeries::ClearPrefixSums()
+{
+  delete [] _aCumSum;   _aCumSum  =NULL;
+  delete [] _aCumBlank; _aCumBlank=NULL;
+}
+
 ///////////////////////////////////////////////////////////////////
 /// \brief Returns average value of time series over interval t to t+tstep
 /// \param &t [in] Left bound of model time interval over which average value of time series is to be determined
@@ -363,9 +415,15 @@ double CTimeSeries::GetAvgValue(const double &t, const double &tstep) const
       if (_aVal[n1] == RAV_BLANK_DATA)  { blank += inc; }
       else                              { sum += _aVal[n1] * inc; }
 
-      for (int n = n1 + 1; n < n2; n++){
-        if (_aVal[n] == RAV_BLANK_DATA) { blank += _interval; }
-        else                            { sum += _aVal[n] * _interval; }
+      if ((_aCumSum != NULL) && (n2 - n1 > PREFIX_SUM_MIN_PULSES)){
+        blank += (double)(_aCumBlank[n2] - _aCumBlank[n1 + 1]) * _interval;
+        sum   +=         (_aCumSum  [n2] - _aCumSum  [n1 + 1]) * _interval;
+      }
+      else{
+        for (int n = n1 + 1; n < n2; n++){
+          if (_aVal[n] == RAV_BLANK_DATA) { blank += _interval; }
+          else                            { sum += _aVal[n] * _interval; }
+        }
       }
       inc = ((t_loc + tstep) - (double)(n2)*_interval);
       if (_aVal[n2] == RAV_BLANK_DATA)  { blank += inc; }
@@ -457,6 +515,7 @@ void   CTimeSeries::Multiply     (const double &factor)
   {
     _aVal [n]*=factor;
   }
+  if (_aCumSum!=NULL){BuildPrefixSums();}
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -527,6 +586,7 @@ void CTimeSeries::SetValue(const int n, const double &val)
   ExitGracefullyIf(n>=_nPulses, "CTimeSeries::SetValue: Overwriting array allocation",RUNTIME_ERR);
 #endif
   _aVal[n]=val;
+  ClearPrefixSums(); //no longer consistent with data
 }
 
 
@@ -1051,34 +1111,20 @@ CTimeSeries *CTimeSeries::Parse(CParser *p, bool is_pulse, string name, long lon
     ExitGracefully("CTimeSeries::Parse",OUT_OF_MEMORY);
   }
 
-  int n=0;
-  //cout << n << " "<<nMeasurements << " " << s[0] << " "<<Len<<" "<<strcmp(s[0],"&")<<" "<<p->Tokenize(s,Len)<<endl;
-  while ((n<nMeasurements) && (!p->Tokenize(s,Len)))
+  int n=nMeasurements;
+  parse_error err=p->ParseDataValues(aVal,nMeasurements,RAV_BLANK_DATA); //bulk read directly into value array
+  if (err==PARSE_TOO_MANY)
   {
-    if (IsComment(s[0],Len)){p->Tokenize(s,Len);}//try again
-    for(int i=0;i<Len;i++){
-      if (n>=nMeasurements)
-      {
-        cout << " n | nMeasurements " << n << " "<<nMeasurements<<endl;
-        ExitGracefully("CTimeSeries::Parse: Bad number of time series points",BAD_DATA);
-      }
-      if (!is_numeric(s[i]))
-      {
-        if(!strcmp(s[i],"NaN")){aVal[n]=RAV_BLANK_DATA; }
-        else{
-          ExitGracefully( ("Non-numeric value found in time series (line " +to_string(p->GetLineNumber())+" of file "+p->GetFilename()+")").c_str(),BAD_DATA_WARN);
-        }
-      }
-      else{
-        aVal [n]=fast_s_to_d(s[i]);
-      }
-      n++;
-    }
+    cout << " n | nMeasurements " << n << " "<<nMeasurements<<endl;
+    ExitGracefully("CTimeSeries::Parse: Bad number of time series points",BAD_DATA);
   }
-
-  if (n!=nMeasurements){
+  else if (err==PARSE_BAD)
+  {
+    ExitGracefully( ("Non-numeric value found in time series (line " +to_string(p->GetBadLineNumber())+" of file "+p->GetFilename()+")").c_str(),BAD_DATA_WARN);
+  }
+  else if (err==PARSE_EOF){
     cout<<p->GetFilename()<<endl;
-    cout << " n | nMeasurements " << n << " "<<nMeasurements<<endl;
+    cout << " nMeasurements " <<nMeasurements<<endl;
     ExitGracefully("CTimeSeries::Parse: Insufficient number of time series points",BAD_DATA);
   }
 
@@ -1193,37 +1239,23 @@ CTimeSeries **CTimeSeries::ParseMultiple(CParser *p, int &nTS, forcing_type *aTy
     aVal[i] =new double [nMeasurements];
   }
   int n=0;
-  while (!p->Tokenize(s,Len))
+  parse_error err=p->ParseDataTable(aVal,nMeasurements,nTS,n,":EndMultiData"); //bulk read directly into value arrays
+  if (err==PARSE_NOT_ENOUGH)
   {
-    if (!IsComment(s[0],Len))
-    {
-      if (!strcmp(s[0],":EndMultiData")){break;}
-      else{
-        if (Len!=nTS)
-        {
-          cout<<"line number: "<<p->GetLineNumber()<<endl;
-          cout<<"measurement " <<n+1 << " of "<<nMeasurements<<endl;
-          string error="CTimeSeries:ParseMultiple: wrong number of columns in :MultiData data. File: "+p->GetFilename();
-          ExitGracefully(error.c_str(),BAD_DATA);
-        }
-        if (n>=nMeasurements)
-        {
-          cout<<" first val | nMeaurements: "<<s[0]<<" | "<<n<<" nMeasurements"<<endl;
-          string error="CTimeSeries::ParseMultiple: Bad number of time series points. File: "+p->GetFilename();
-          ExitGracefully(error.c_str(),BAD_DATA);
-        }
-
-        for(i=0;i<Len;i++){
-          if (!is_numeric(s[i]))
-          {
-            ExitGracefully( ("Non-numeric value found in time series (line " +to_string(p->GetLineNumber())+" of file "+p->GetFilename()+")").c_str(),BAD_DATA_WARN);
-          }
-          aVal [i][n]=fast_s_to_d(s[i]);
-          //aVal [i][n]=s_to_d(s[i]);
-        }
-        n++;
-      }
-    }
+    cout<<"line number: "<<p->GetLineNumber()<<endl;
+    cout<<"measurement " <<n+1 << " of "<<nMeasurements<<endl;
+    string error="CTimeSeries:ParseMultiple: wrong number of columns in :MultiData data. File: "+p->GetFilename();
+    ExitGracefully(error.c_str(),BAD_DATA);
+  }
+  else if (err==PARSE_TOO_MANY)
+  {
+    cout<<" line | nMeaurements: "<<p->GetLineNumber()<<" | "<<n<<" nMeasurements"<<endl;
+    string error="CTimeSeries::ParseMultiple: Bad number of time series points. File: "+p->GetFilename();
+    ExitGracefully(error.c_str(),BAD_DATA);
+  }
+  else if (err==PARSE_BAD)
+  {
+    ExitGracefully( ("Non-numeric value found in time series (line " +to_string(p->GetBadLineNumber())+" of file "+p->GetFilename()+")").c_str(),BAD_DATA_WARN);
   }
 
   if (n!=nMeasurements){
@@ -1280,6 +1312,10 @@ CTimeSeries **CTimeSeries::ParseEnsimTb0(string filename, int &nTS, forcing_type
     return NULL;
   }
 
+  string cache_key="ParseEnsimTb0|"+to_string(Options.calendar);
+  pTimeSeries=ReadFromCache(filename,cache_key,nTS,aType,Options);
+  if (pTimeSeries!=NULL){INPUT.close();return pTimeSeries;}
+
   ifstream inFile(filename.c_str());
   int linecount=(int)std::count(istreambuf_iterator<char>(inFile),
                                 istreambuf_iterator<char>(), '\n');//count # of lines in file
@@ -1396,6 +1432,7 @@ CTimeSeries **CTimeSeries::ParseEnsimTb0(string filename, int &nTS, forcing_type
       }
       delete [] aVal; aVal=NULL;
 
+      WriteToCache(filename,cache_key,pTimeSeries,nTS,aType,Options);
       return pTimeSeries;
     }
   }
@@ -1469,6 +1506,20 @@ CTimeSeries *CTimeSeries::ReadTimeSeriesFromNetCDF(const optStruct &Options, str
   // (1) open NetCDF read-only (get ncid)
   // -------------------------------
   if (Options.noisy){ cout<<"Start reading time series for "<< VarNameNC << " from NetCDF file "<< FileNameNC << endl; }
+
+  ostringstream cache_key; //all arguments determining series contents
+  cache_key<<setprecision(17)<<"ReadTimeSeriesFromNetCDF|"<<VarNameNC<<"|"<<DimNamesNC_stations<<"|"<<DimNamesNC_time<<"|"<<StationIdx;
+  cache_key<<"|"<<TimeShift<<"|"<<LinTrans_a<<"|"<<LinTrans_b<<"|"<<is_pulse<<shift_to_per_ending<<shift_from_per_ending;
+  cache_key<<"|"<<name<<"|"<<loc_ID<<"|"<<gauge_name<<"|"<<Options.calendar;
+  int nCached;
+  CTimeSeries **pCached=ReadFromCache(FileNameNC,cache_key.str(),nCached,NULL,Options);
+  if (pCached!=NULL){
+    pTimeSeries=pCached[0];
+    for (int i=1;i<nCached;i++){delete pCached[i];}
+    delete [] pCached;
+    return pTimeSeries;
+  }
+
   retval = nc_open(FileNameNC.c_str(), NC_NOWRITE, &ncid);
   if (retval != NC_NOERR) {
     string warn="ReadTimeSeriesFromNetCDF : unable to open file "+FileNameNC +" (NetCDF error: "+to_string(nc_strerror(retval))+")";
@@ -1850,6 +1901,7 @@ CTimeSeries *CTimeSeries::ReadTimeSeriesFromNetCDF(const optStruct &Options, str
   //is_pulse = true;
 
   pTimeSeries=new CTimeSeries(name,loc_ID,FileNameNC.c_str(),start_day,start_yr,tstep,aVal,nMeasurements,is_pulse);
+  WriteToCache(FileNameNC,cache_key.str(),&pTimeSeries,1,NULL,Options);
 
   // -------------------------------
   // (16) delete dynamic memory
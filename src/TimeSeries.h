@@ -40,10 +40,15 @@ private:/*------------------------------------------------------*/
   bool       _pulse; ///< flag determining whether this is a pulse-based or piecewise-linear time series
   ///< \remark forcing functions are all pulse-based
 
+  double   *_aCumSum; ///< prefix sums of non-blank pulse values; _aCumSum[n]=sum of _aVal[0..n-1] (NULL if not indexed) [size: _nPulses+1]
+  int    *_aCumBlank; ///< prefix count of blank pulses; _aCumBlank[n]=number of blanks in _aVal[0..n-1] (NULL if not indexed) [size: _nPulses+1]
+
   int     GetTimeIndex(const double &t_loc) const;
 
   void        Resample(const double &tstep,          //days
                        const double &model_duration);//days
+  void        BuildPrefixSums();
+  void        ClearPrefixSums();
 
   CTimeSeries(const CTimeSeries &t); //suppresses default copy constructor
 
@@ -106,7 +111,11 @@ public:/*-------------------------------------------------------*/
   static CTimeSeries **ParseMultiple(CParser *p, int &nTS, forcing_type *aType, bool is_pulse, const optStruct &Options);
   static CTimeSeries **ParseEnsimTb0(string filename, int &nTS, forcing_type *aType, const optStruct &Options);
 
+  static CTimeSeries **ReadFromCache(const string &srcfile, const string &key, int &nTS, forcing_type *aType, const optStruct &Options);
+  static void          WriteToCache (const string &srcfile, const string &key, CTimeSeries **pTS, const int nTS, const forcing_type *aType, const optStruct &Options);
+
   void   Multiply        (const double &factor);
+  void   IndexWindowAverages(const double &window);
 
   double GetModelledValue(const double &t,const ts_type type) const;
   void   SetValue        (const int n, const double &val);
@@ -0,0 +1,405 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2026 the Raven Development Team
+  ----------------------------------------------------------------
+  Binary cache of parsed time series (:TimeSeriesCache command)
+
+  Each cache file stores the parsed contents of one source file,
+  together with the size and modification time of the source file
+  and a key describing how it was parsed. A cache file is only used
+  if all of these match; otherwise the source is parsed normally and
+  the cache file is (re)written.
+  ----------------------------------------------------------------*/
+#include "TimeSeries.h"
+#include <sys/stat.h>
+#include <thread>
+#ifdef _WIN32
+#include <process.h>
+#include <direct.h>
+#define getpid _getpid
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+const char TS_CACHE_MAGIC[8]={'R','V','T','S','C','A','C','H'}; ///< first (and last) bytes of each cache file
+const int  TS_CACHE_VERSION  =2;                                ///< incremented whenever cache file layout changes
+
+////////////////////////////////////////////////////////////////////
+/// \brief contents of cache file
+//
+enum cache_content
+{
+  CACHE_SERIES=1, ///< array of time series (e.g., from .tb0 or NetCDF file)
+  CACHE_BLOCKS=2  ///< numeric data blocks of .rvt file (see CBlockCache)
+};
+
+//////////////////////////////////////////////////////////////////
+/// \brief read-only view of an entire cache file (memory-mapped where possible)
+//
+struct cache_file
+{
+  const char *buf;    ///< file contents
+  size_t      size;   ///< size of buf, in bytes
+  size_t      pos;    ///< current read position
+  bool        mapped; ///< true if buf is a memory map
+  bool        ok;     ///< false once any read has run past end of file
+
+  cache_file(){buf=NULL;size=0;pos=0;mapped=false;ok=true;}
+  ~cache_file()
+  {
+#ifndef _WIN32
+    if (mapped){munmap((void*)(buf),size);buf=NULL;}
+#endif
+    delete [] buf;
+  }
+  //------------------------------------------------
+  bool Open(const string &filename)
+  {
+#ifndef _WIN32
+    int fd=open(filename.c_str(),O_RDONLY);
+    if (fd<0){return false;}
+    struct stat st;
+    if ((fstat(fd,&st)!=0) || (st.st_size<=0)){close(fd);return false;}
+    void *map=mmap(NULL,(size_t)(st.st_size),PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if (map==MAP_FAILED){return false;}
+    buf=(const char*)(map); size=(size_t)(st.st_size); mapped=true;
+#else
+    ifstream IN(filename.c_str(),ios::binary);
+    if (IN.fail()){return false;}
+    IN.seekg(0,ios::end);
+    streamoff fsize=(streamoff)(IN.tellg());
+    if (fsize<=0){return false;}
+    IN.seekg(0,ios::beg);
+    char *tmp=new char [(size_t)(fsize)];
+    IN.read(tmp,fsize);
+    buf=tmp; size=(size_t)(fsize);
+    if (IN.gcount()!=fsize){return false;}
+#endif
+    return true;
+  }
+  //------------------------------------------------
+  template <class T> T Get()
+  {
+    T v=T();
+    if (pos+sizeof(T)>size){ok=false;return v;}
+    memcpy(&v,buf+pos,sizeof(T));
+    pos+=sizeof(T);
+    return v;
+  }
+  //------------------------------------------------
+  string GetString()
+  {
+    int len=Get<int>();
+    if ((!ok) || (len<0) || (pos+(size_t)(len)>size)){ok=false;return "";}
+    string s(buf+pos,(size_t)(len));
+    pos+=(size_t)(len);
+    return s;
+  }
+  //------------------------------------------------
+  bool GetArray(double *a,const int n)
+  {
+    if ((n<0) || (pos+(size_t)(n)*sizeof(double)>size)){ok=false;return false;}
+    memcpy(a,buf+pos,(size_t)(n)*sizeof(double));
+    pos+=(size_t)(n)*sizeof(double);
+    return true;
+  }
+};
+
+//////////////////////////////////////////////////////////////////
+/// \brief writes binary values to cache file
+//
+template <class T> static void Put(ofstream &OUT,const T &v){OUT.write((const char*)(&v),sizeof(T));}
+static void PutString(ofstream &OUT,const string &s){
+  Put<int>(OUT,(int)(s.length()));
+  OUT.write(s.c_str(),s.length());
+}
+static void PutArray (ofstream &OUT,const double *a,const int n){
+  OUT.write((const char*)(a),(size_t)(n)*sizeof(double));
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief retrieves size and last modification time of file
+/// \return false if file does not exist
+//
+static bool GetFileStamp(const string &filename,long long &size,long long &mtime)
+{
+  struct stat st;
+  if (stat(filename.c_str(),&st)!=0){return false;}
+  size =(long long)(st.st_size);
+  mtime=(long long)(st.st_mtime);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief returns name of cache file for identifier id (FNV-1a hash of id)
+//
+static string GetCacheFilename(const string &id,const optStruct &Options)
+{
+  unsigned long long h=14695981039346656037ULL;
+  for (size_t i=0;i<id.length();i++){
+    h^=(unsigned char)(id[i]);
+    h*=1099511628211ULL;
+  }
+  char tmp[32];
+  sprintf(tmp,"%016llx",h);
+  return Options.ts_cache_dir+"ts_"+string(tmp)+".rvtcache";
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief opens cache file of source file srcfile and checks that it is current
+/// \details header stores content type, source size and modification time and full identifier;
+///  trailing magic number guards against incomplete files
+/// \return true if cache file is valid and positioned at start of contents
+//
+static bool OpenCacheFile(cache_file &F,const cache_content content,const string &srcfile,const string &key,const optStruct &Options)
+{
+  long long size,mtime;
+  if (!GetFileStamp(srcfile,size,mtime)){return false;}
+
+  string id=to_string((int)(content))+"|"+srcfile+"|"+key;
+  if (!F.Open(GetCacheFilename(id,Options))){return false;}
+
+  if (F.size<2*sizeof(TS_CACHE_MAGIC)){return false;}
+  if (memcmp(F.buf,TS_CACHE_MAGIC,sizeof(TS_CACHE_MAGIC))){return false;}
+  if (memcmp(F.buf+F.size-sizeof(TS_CACHE_MAGIC),TS_CACHE_MAGIC,sizeof(TS_CACHE_MAGIC))){return false;}
+  F.pos=sizeof(TS_CACHE_MAGIC);
+  if (F.Get<int>()      !=TS_CACHE_VERSION){return false;}
+  if (F.Get<int>()      !=(int)(content)  ){return false;}
+  if (F.Get<long long>()!=size            ){return false;}
+  if (F.Get<long long>()!=mtime           ){return false;}
+  if (F.GetString()     !=id              ){return false;}
+  return F.ok;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief creates temporary cache file for source file srcfile and writes header
+/// \details contents are written to a temporary file which is renamed by CloseCacheFile(),
+///  so that simultaneous runs sharing a cache directory never read incomplete files
+/// \return false if cache file cannot be created
+//
+static bool CreateCacheFile(ofstream &OUT,string &filename,string &tmpfile,const cache_content content,const string &srcfile,const string &key,const optStruct &Options)
+{
+  long long size,mtime;
+  if (!GetFileStamp(srcfile,size,mtime)){return false;}
+
+#if defined(_WIN32)
+  _mkdir(Options.ts_cache_dir.c_str());
+#else
+  mkdir(Options.ts_cache_dir.c_str(),0777);
+#endif
+
+  string id=to_string((int)(content))+"|"+srcfile+"|"+key;
+  filename=GetCacheFilename(id,Options);
+  tmpfile =filename+"."+to_string((long long)(getpid()))+"_"+to_string((unsigned long long)(hash<thread::id>()(this_thread::get_id())))+".tmp";
+
+  OUT.open(tmpfile.c_str(),ios::binary);
+  if (OUT.fail()){return false;}
+  OUT.write(TS_CACHE_MAGIC,sizeof(TS_CACHE_MAGIC));
+  Put<int>      (OUT,TS_CACHE_VERSION);
+  Put<int>      (OUT,(int)(content));
+  Put<long long>(OUT,size);
+  Put<long long>(OUT,mtime);
+  PutString     (OUT,id);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief completes cache file created by CreateCacheFile()
+//
+static void CloseCacheFile(ofstream &OUT,const string &filename,const string &tmpfile)
+{
+  OUT.write(TS_CACHE_MAGIC,sizeof(TS_CACHE_MAGIC));
+  bool failed=OUT.fail();
+  OUT.close();
+  if (failed){remove(tmpfile.c_str());return;}
+#ifdef _WIN32
+  remove(filename.c_str()); //rename does not overwrite on Windows
+#endif
+  if (rename(tmpfile.c_str(),filename.c_str())!=0){remove(tmpfile.c_str());}
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief reads array of time series previously parsed from file srcfile with parse options key
+///
+/// \param srcfile [in] source file of time series
+/// \param key     [in] string uniquely describing parse options (e.g., variable name and options used)
+/// \param &nTS    [out] number of time series read
+/// \param *aType  [out] forcing type of each time series (may be NULL)
+/// \param Options [in] Global model options
+/// \return array (size nTS) of time series, or NULL if no current cache exists
+//
+CTimeSeries **CTimeSeries::ReadFromCache(const string &srcfile,const string &key,int &nTS,forcing_type *aType,const optStruct &Options)
+{
+  nTS=0;
+  if (Options.ts_cache_dir==""){return NULL;}
+
+  cache_file F;
+  if (!OpenCacheFile(F,CACHE_SERIES,srcfile,key,Options)){return NULL;}
+
+  int n=F.Get<int>();
+  if ((!F.ok) || (n<=0) || ((aType!=NULL) && (n>MAX_MULTIDATA))){return NULL;}
+
+  CTimeSeries **pTS=new CTimeSeries *[n];
+  ExitGracefullyIf(pTS==NULL,"CTimeSeries::ReadFromCache",OUT_OF_MEMORY);
+  int i;
+  for (i=0;i<n;i++){pTS[i]=NULL;}
+  for (i=0;i<n;i++)
+  {
+    string    name     =F.GetString();
+    long long loc_ID   =F.Get<long long>();
+    string    filename =F.GetString();
+    double    start_day=F.Get<double>();
+    int       start_yr =F.Get<int>();
+    double    interval =F.Get<double>();
+    bool      is_pulse =(F.Get<int>()!=0);
+    int       type     =F.Get<int>();
+    int       nValues  =F.Get<int>();
+    if ((!F.ok) || (nValues<=0)){break;}
+
+    pTS[i]=new CTimeSeries(name,loc_ID,filename,start_day,start_yr,interval,nValues,is_pulse);
+    if (!F.GetArray(pTS[i]->_aVal,nValues)){break;}
+    if (aType!=NULL){aType[i]=(forcing_type)(type);}
+  }
+  if (i<n) //corrupt cache - ignore
+  {
+    for (int j=0;j<=i && j<n;j++){delete pTS[j];}
+    delete [] pTS;
+    return NULL;
+  }
+  nTS=n;
+  return pTS;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief writes array of time series parsed from file srcfile with parse options key to cache
+/// \note failure to write cache is silently ignored
+///
+/// \param srcfile [in] source file of time series
+/// \param key     [in] string uniquely describing parse options
+/// \param **pTS   [in] array of time series (size nTS)
+/// \param nTS     [in] number of time series
+/// \param *aType  [in] forcing type of each time series (may be NULL)
+/// \param Options [in] Global model options
+//
+void CTimeSeries::WriteToCache(const string &srcfile,const string &key,CTimeSeries **pTS,const int nTS,const forcing_type *aType,const optStruct &Options)
+{
+  if ((Options.ts_cache_dir=="") || (pTS==NULL) || (nTS<=0)){return;}
+  for (int i=0;i<nTS;i++){if (pTS[i]==NULL){return;}}
+
+  ofstream OUT;
+  string   filename,tmpfile;
+  if (!CreateCacheFile(OUT,filename,tmpfile,CACHE_SERIES,srcfile,key,Options)){return;}
+
+  Put<int>(OUT,nTS);
+  for (int i=0;i<nTS;i++)
+  {
+    const CTimeSeries *pT=pTS[i];
+    int type=F_UNRECOGNIZED;
+    if (aType!=NULL){type=(int)(aType[i]);}
+    PutString     (OUT,pT->GetName());
+    Put<long long>(OUT,pT->GetLocID());
+    PutString     (OUT,pT->GetSourceFile());
+    Put<double>   (OUT,pT->_start_day);
+    Put<int>      (OUT,pT->_start_year);
+    Put<double>   (OUT,pT->_interval);
+    Put<int>      (OUT,(int)(pT->_pulse));
+    Put<int>      (OUT,type);
+    Put<int>      (OUT,pT->_nPulses);
+    PutArray      (OUT,pT->_aVal,pT->_nPulses);
+  }
+  CloseCacheFile(OUT,filename,tmpfile);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief fills block cache of .rvt file srcfile with numeric data blocks stored in time series cache
+/// \note blocks are positioned by byte offset in srcfile, so stored blocks depend only upon source file contents
+///
+/// \param srcfile [in] .rvt file
+/// \param *pCache [out] block cache of file
+/// \param Options [in] Global model options
+/// \return true if current cache exists and was read
+//
+bool ReadBlockCache(const string &srcfile,CBlockCache *pCache,const optStruct &Options)
+{
+  if (Options.ts_cache_dir==""){return false;}
+
+  cache_file F;
+  if (!OpenCacheFile(F,CACHE_BLOCKS,srcfile,"",Options)){return false;}
+
+  int nBlocks=F.Get<int>();
+  if ((!F.ok) || (nBlocks<0)){return false;}
+  data_block *aBlocks=new data_block [nBlocks+1]; //filled first, so that pCache unchanged if cache corrupt
+  int b;
+  for (b=0;b<nBlocks;b++)
+  {
+    data_block &B=aBlocks[b];
+    B.start    =(size_t)(F.Get<long long>());
+    B.end      =(size_t)(F.Get<long long>());
+    B.nLines   =F.Get<int>();
+    B.numcol   =F.Get<int>();
+    B.maxv     =F.Get<int>();
+    B.blank_val=F.Get<double>();
+    B.end_tag  =F.GetString();
+    B.numv     =F.Get<int>();
+    B.err      =(parse_error)(F.Get<int>());
+    int nStored=F.Get<int>();
+    B.aValues  =NULL;
+    if ((!F.ok) || (nStored<=0)){F.ok=false;break;}
+    B.aValues  =new double [nStored];
+    if (!F.GetArray(B.aValues,nStored)){break;}
+  }
+  if (F.ok)
+  {
+    for (int i=0;i<nBlocks;i++){pCache->AddBlock(aBlocks[i]);} //block cache takes ownership of values
+  }
+  else
+  {
+    for (int i=0;i<=b && i<nBlocks;i++){delete [] aBlocks[i].aValues;}
+  }
+  delete [] aBlocks;
+  return F.ok;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief writes contents of block cache of .rvt file srcfile to time series cache
+/// \note called once parser has recorded all blocks of file
+///
+/// \param srcfile [in] .rvt file
+/// \param *pCache [in] block cache of file
+/// \param Options [in] Global model options
+//
+void WriteBlockCache(const string &srcfile,const CBlockCache *pCache,const optStruct &Options)
+{
+  if ((Options.ts_cache_dir=="") || (pCache==NULL)){return;}
+
+  ofstream OUT;
+  string   filename,tmpfile;
+  if (!CreateCacheFile(OUT,filename,tmpfile,CACHE_BLOCKS,srcfile,"",Options)){return;}
+
+  int nBlocks=0;
+  for (int b=0;b<pCache->GetNumBlocks();b++){
+    if (pCache->GetBlockByIndex(b)->aValues!=NULL){nBlocks++;}
+  }
+  Put<int>(OUT,nBlocks);
+  for (int b=0;b<pCache->GetNumBlocks();b++)
+  {
+    const data_block *B=pCache->GetBlockByIndex(b);
+    if (B->aValues==NULL){continue;}
+    int nStored=(B->numcol==0) ? B->maxv : B->maxv*B->numcol;
+    Put<long long>(OUT,(long long)(B->start));
+    Put<long long>(OUT,(long long)(B->end));
+    Put<int>      (OUT,B->nLines);
+    Put<int>      (OUT,B->numcol);
+    Put<int>      (OUT,B->maxv);
+    Put<double>   (OUT,B->blank_val);
+    PutString     (OUT,B->end_tag);
+    Put<int>      (OUT,B->numv);
+    Put<int>      (OUT,(int)(B->err));
+    Put<int>      (OUT,nStored);
+    PutArray      (OUT,B->aValues,nStored);
+  }
+  CloseCacheFile(OUT,filename,tmpfile);
+}
@@ -31,6 +31,7 @@ CTransientParam::CTransientParam(CTimeSeries      *pTS,
     class_name=classname;
   }
   _pModel = pModel;
+  _pxAddress=NULL;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -74,37 +75,75 @@ void CTransientParam::Initialize(const CModel *pModel, const optStruct &Options)
                           false,
                           Options.calendar);
 
+  //resolve memory address of parameter so that updates bypass name lookups
+  // (parameters without a single address, e.g., RELATIVE_LAI, are set by name in Update())
+  _pxAddress=NULL;
   if (param_type==CLASS_SOIL)
   {
-    if (_pModel->StringToSoilClass(class_name) == NULL){
+    CSoilClass *pSoil=_pModel->StringToSoilClass(class_name);
+    if (pSoil == NULL){
       string msg="CTransientParam::Initialize: invalid soil class name: "+class_name;
       ExitGracefully(msg.c_str(),BAD_DATA);
     }
+    _pxAddress=pSoil->GetSoilPropertyAddress(param_name);
   }
   else if (param_type==CLASS_VEGETATION)
   {
-    if (_pModel->StringToVegClass(class_name) == NULL){
+    CVegetationClass *pVeg=_pModel->StringToVegClass(class_name);
+    if (pVeg == NULL){
       string msg="CTransientParam::Initialize: invalid vegetation class name: "+class_name;
       ExitGracefully(msg.c_str(),BAD_DATA);
     }
+    _pxAddress=pVeg->GetVegetationPropertyAddress(param_name);
   }
   else if (param_type==CLASS_TERRAIN)
   {
-    if (_pModel->StringToTerrainClass(class_name)==NULL){
+    CTerrainClass *pTerr=_pModel->StringToTerrainClass(class_name);
+    if (pTerr==NULL){
       string msg="CTransientParam::Initialize: invalid terrain class name: "+class_name;
       ExitGracefully(msg.c_str(),BAD_DATA);
     }
+    _pxAddress=pTerr->GetTerrainPropertyAddress(param_name);
   }
   else if (param_type == CLASS_LANDUSE)
   {
-    if (_pModel->StringToLUClass(class_name) == NULL) {
+    CLandUseClass *pLU=_pModel->StringToLUClass(class_name);
+    if (pLU == NULL) {
       string msg = "CTransientParam::Initialize: invalid land use/land type class name: " + class_name;
       ExitGracefully(msg.c_str(), BAD_DATA);
     }
+    _pxAddress=pLU->GetSurfacePropertyAddress(param_name);
   }
   else if (param_type==CLASS_GLOBAL)
   {
-    //
+    _pxAddress=_pModel->GetGlobalParams()->GetGlobalPropertyAddress(param_name);
   }
+  else if (param_type==CLASS_GAUGE)
+  {
+    int g=_pModel->GetGaugeIndexFromName(class_name);
+    if (g!=DOESNT_EXIST){_pxAddress=_pModel->GetGauge(g)->GetGaugePropertyAddress(param_name);}
+  }
+  else if (param_type==CLASS_SUBBASIN)
+  {
+    long long SBID=s_to_ll(class_name.c_str()); //class name should be SBID in this case
+    if( (strlen(class_name.c_str())>8) && //also accept SUBBASIN32 instead of 32
+        (!strcmp(class_name.substr(0,8).c_str(),"SUBBASIN")) ) {
+      SBID=s_to_ll(class_name.substr(8,strlen(class_name.c_str())-8).c_str());
+    }
+    CSubBasin *pSB=_pModel->GetSubBasinByID(SBID);
+    if (pSB!=NULL){_pxAddress=pSB->GetBasinPropertyAddress(param_name);}
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Updates parameter value to that of time series at current time step
+/// \param nn [in] current time step index
+//
+void CTransientParam::Update(const int nn)
+{
+  double value=pTimeSeries->GetSampledValue(nn);
+  if (value==RAV_BLANK_DATA){return;}
 
+  if (_pxAddress!=NULL){*_pxAddress=value;}
+  else                 {_pModel->UpdateParameter(param_type,param_name,class_name,value);}
 }
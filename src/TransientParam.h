@@ -37,6 +37,7 @@ protected:/*----------------------------------------------------*/
 
   CTimeSeries *pTimeSeries; ///< Time series of parameter value
   CModel      *_pModel;
+  double      *_pxAddress;  ///< address of parameter value in its class, resolved in Initialize (NULL if set by name)
 
 public:/*-------------------------------------------------------*/
 
@@ -55,6 +56,7 @@ public:/*-------------------------------------------------------*/
 
   //routines
   void Initialize(const CModel *pModel, const optStruct &Options);
+  void Update    (const int nn);
 
 };
 
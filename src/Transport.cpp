@@ -10,6 +10,7 @@ coordinates information about constituent storage
 #include "Model.h"
 #include "Transport.h"
 #include "HeatConduction.h"
+#include "Checkpoint.h"
 #include "EnergyTransport.h"
 #include "IsotopeTransport.h"
 #include "AgeTracers.h"
@@ -877,7 +878,7 @@ void   CTransportModel::IncrementCumulOutput(const optStruct &Options)
 //
 void CTransportModel::WriteOutputFileHeaders(const optStruct &Options) const
 {
-  if (Options.output_format==OUTPUT_STANDARD){
+  if ((Options.output_format==OUTPUT_STANDARD) || (Options.output_format==OUTPUT_BINARY)){//constituent output written as .csv in binary mode
     for(int c=0;c<_nConstituents;c++) {
       _pConstitModels[c]->WriteOutputFileHeaders(Options);
     }
@@ -901,7 +902,7 @@ void CTransportModel::WriteOutputFileHeaders(const optStruct &Options) const
 //
 void CTransportModel::WriteMinorOutput(const optStruct &Options,const time_struct &tt) const
 {
-  if (Options.output_format==OUTPUT_STANDARD){
+  if ((Options.output_format==OUTPUT_STANDARD) || (Options.output_format==OUTPUT_BINARY)){
     for(int c=0;c<_nConstituents;c++) {
       _pConstitModels[c]->WriteMinorOutput(Options,tt);
     }
@@ -936,3 +937,12 @@ void  CTransportModel::WriteMajorOutput(ofstream &RVC) const
     _pConstitModels[c]->WriteMajorOutput(RVC);
   }
 }
+//////////////////////////////////////////////////////////////////
+/// \brief Write basin transport states to binary checkpoint file
+//
+void  CTransportModel::WriteToCheckpoint(CCheckpointWriter &CHK) const
+{
+  for(int c=0;c<_nConstituents;c++) {
+    _pConstitModels[c]->WriteToCheckpoint(CHK);
+  }
+}
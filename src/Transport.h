@@ -7,6 +7,7 @@ Copyright (c) 2008-2026 the Raven Development Team
 #define TRANSPORTMODEL_H
 
 #include "RavenInclude.h"
+#include "BufferedOutput.h"
 #include "Model.h"
 
 enum constit_type {
@@ -70,6 +71,7 @@ struct geochem_param
 class CModel;
 class CConstituentModel;
 class CEnthalpyModel;
+class CCheckpointWriter;
 
 class CTransportModel
 {
@@ -181,6 +183,7 @@ public:/*-------------------------------------------------------*/
   void   WriteOutputFileHeaders     (const optStruct &Options) const;
   void   WriteMinorOutput           (const optStruct &Options,const time_struct &tt) const;
   void   WriteMajorOutput           (ofstream& RVC) const;
+  void   WriteToCheckpoint          (CCheckpointWriter &CHK) const;
   void   CloseOutputFiles           () const;
 };
 ///////////////////////////////////////////////////////////////////
@@ -237,12 +240,14 @@ protected:
   int              _nMassLoadingTS;  ///< number of specified mass/energy loading time series [kg/d]
   CTimeSeries    **_pMassLoadingTS;  ///< array of pointers to time series of mass loadings [kg/d] - TS tag corresponds to SBID
 
-  ofstream                 _OUTPUT;  ///< output stream for Concentrations.csv/Temperatures.csv
-  ofstream                 _POLLUT;  ///< output stream for Pollutograph.csv/StreamTemperatures.csv
-  ofstream                _LOADING;  ///< output stream for MassLoadings.csv
+  CBufferedOutputFile      _OUTPUT;  ///< output stream for Concentrations.csv/Temperatures.csv
+  CBufferedOutputFile      _POLLUT;  ///< output stream for Pollutograph.csv/StreamTemperatures.csv
+  CBufferedOutputFile     _LOADING;  ///< output stream for MassLoadings.csv
   int                   _CONC_ncid;  ///< NetCDF id for Concentrations.nc/Temperatures.nc
   int                 _POLLUT_ncid;  ///< NetCDF id for Pollutograph.nc/StreamTemperatures.nc
   int                _LOADING_ncid;  ///< NetCDF id for MassLoadings.nc
+  CNetCDFBlockBuffer    _CONC_ncbuf;  ///< block buffer for Concentrations.nc/Temperatures.nc time series
+  CNetCDFBlockBuffer  _POLLUT_ncbuf;  ///< block buffer for Pollutograph.nc/StreamTemperatures.nc time series
 
   // private member funcctions
   void   DeleteRoutingVars();
@@ -326,6 +331,7 @@ public:/*-------------------------------------------------------*/
   virtual void   WriteNetCDFOutputFileHeaders(const optStruct &Options);
   virtual void   WriteNetCDFMinorOutput      (const optStruct &Options,const time_struct& tt);
           void   WriteMajorOutput            (ofstream& RVC) const;
+          void   WriteToCheckpoint           (CCheckpointWriter &CHK) const;
   virtual void   CloseOutputFiles            ();
 };
 
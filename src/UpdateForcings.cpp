@@ -35,7 +35,7 @@ void CModel::UpdateHRUForcingFunctions(const optStruct &Options,
   static force_struct *Fg=NULL;
   double              elev;
   int                 mo,yr;
-  int                 k,g,nn;
+  int                 k,g,j,nn;
   double              mid_day,model_day, time_shift;
   double              wt;
   bool                rvt_file_provided = (strcmp(Options.rvt_filename.c_str(), "") != 0);
@@ -54,6 +54,9 @@ void CModel::UpdateHRUForcingFunctions(const optStruct &Options,
   model_day = floor(tt.model_time+time_shift+TIME_CORRECTION); //model time of 00:00 of current day
   mid_day   = floor(tt.julian_day+TIME_CORRECTION)+0.5;//mid day
 
+  //weighted values of gridded forcings are cached for all HRUs on first use in this time step
+  for (int f=0;f<_nForcingGrids;f++){_pForcingGrids[f]->ClearWeightedValueCache();}
+
   CForcingGrid *pGrid_pre        = NULL;            // forcing grids
   CForcingGrid *pGrid_rain       = NULL;
   CForcingGrid *pGrid_snow       = NULL;
@@ -95,11 +98,12 @@ void CModel::UpdateHRUForcingFunctions(const optStruct &Options,
   bool irrig_gridded          = ForcingGridIsInput(F_IRRIGATION);
 
   //Extract data from gauge time series
+  //  only gauges with a non-zero interpolation weight for some HRU are queried
   for (g=0;g<_nGauges;g++)
   {
     ZeroOutForcings(Fg[g]);
 
-    if ( !(pre_gridded || snow_gridded || rain_gridded) )
+    if ( !(pre_gridded || snow_gridded || rain_gridded) && (_GaugeWtsPrecip.aUsed[g]) )
     {
       if(_pGauges[g]->TimeSeriesExists(F_PRECIP)){//if precip exists, others exist
         Fg[g].precip          =_pGauges[g]->GetForcingValue(F_PRECIP,nn);     //mm/d
@@ -111,22 +115,29 @@ void CModel::UpdateHRUForcingFunctions(const optStruct &Options,
     if ( !(temp_daily_min_gridded && temp_daily_max_gridded) )
     {
       if(_pGauges[g]->TimeSeriesExists(F_TEMP_AVE)){//if temp_ave exists, others exist
-        Fg[g].temp_ave        =_pGauges[g]->GetForcingValue(F_TEMP_AVE,nn);
-        Fg[g].temp_daily_ave  =_pGauges[g]->GetForcingValue(F_TEMP_DAILY_AVE,nn);
-        Fg[g].temp_daily_min  =_pGauges[g]->GetForcingValue(F_TEMP_DAILY_MIN,nn);
+        Fg[g].temp_daily_min  =_pGauges[g]->GetForcingValue(F_TEMP_DAILY_MIN,nn); //min/max read for all gauges (checked below)
         Fg[g].temp_daily_max  =_pGauges[g]->GetForcingValue(F_TEMP_DAILY_MAX,nn);
-        Fg[g].temp_ave_unc    =Fg[g].temp_daily_ave;
-        Fg[g].temp_min_unc    =Fg[g].temp_daily_min;
-        Fg[g].temp_max_unc    =Fg[g].temp_daily_max;
+        if (_GaugeWtsTemp.aUsed[g]){
+          Fg[g].temp_ave        =_pGauges[g]->GetForcingValue(F_TEMP_AVE,nn);
+          Fg[g].temp_daily_ave  =_pGauges[g]->GetForcingValue(F_TEMP_DAILY_AVE,nn);
+          Fg[g].temp_ave_unc    =Fg[g].temp_daily_ave;
+          Fg[g].temp_min_unc    =Fg[g].temp_daily_min;
+          Fg[g].temp_max_unc    =Fg[g].temp_daily_max;
+        }
         if(Fg[g].temp_daily_max < Fg[g].temp_daily_min)
         {
           WriteWarning("UpdateHRUForcingFunctions: max_temp<min_temp at gauge: "+_pGauges[g]->GetName() + " on " + tt.date_string,Options.noisy);
         }
       }
     }
-    Fg[g].temp_month_max  =_pGauges[g]->GetMonthlyMaxTemp  (mo);
-    Fg[g].temp_month_min  =_pGauges[g]->GetMonthlyMinTemp  (mo);
-    Fg[g].temp_month_ave  =_pGauges[g]->GetMonthlyAveTemp  (mo);
+    if (_GaugeWtsTemp.aUsed[g])
+    {
+      Fg[g].temp_month_max  =_pGauges[g]->GetMonthlyMaxTemp  (mo);
+      Fg[g].temp_month_min  =_pGauges[g]->GetMonthlyMinTemp  (mo);
+      Fg[g].temp_month_ave  =_pGauges[g]->GetMonthlyAveTemp  (mo);
+    }
+    if (!_GaugeWts.aUsed[g]){continue;}
+
     Fg[g].PET_month_ave   =_pGauges[g]->GetMonthlyAvePET   (mo);
 
     Fg[g].LW_radia_net    =_pGauges[g]->GetForcingValue    (F_LW_RADIA_NET,nn);
@@ -160,6 +171,12 @@ void CModel::UpdateHRUForcingFunctions(const optStruct &Options,
   double ref_elev_temp;
   double ref_elev_precip;
   double ref_measurement_ht; //m above land surface
+  double day_angle(0.0),declin(0.0); //same for all HRUs
+  if(tt.day_changed)
+  {
+    day_angle = CRadiation::DayAngle(mid_day,yr,Options.calendar);
+    declin    = CRadiation::SolarDeclination(day_angle);
+  }
   for (k = 0; k < _nHydroUnits; k++)
   {
     elev  = _pHydroUnits[k]->GetElevation();
@@ -171,8 +188,8 @@ void CModel::UpdateHRUForcingFunctions(const optStruct &Options,
     //not gauge-based
     if(tt.day_changed)
     {
-      F.day_angle  = CRadiation::DayAngle(mid_day,yr,Options.calendar);
-      F.day_length = CRadiation::DayLength(_pHydroUnits[k]->GetLatRad(),CRadiation::SolarDeclination(F.day_angle));
+      F.day_angle  = day_angle;
+      F.day_length = CRadiation::DayLength(_pHydroUnits[k]->GetLatRad(),declin);
     }
 
     if(_pHydroUnits[k]->IsEnabled())
@@ -181,58 +198,58 @@ void CModel::UpdateHRUForcingFunctions(const optStruct &Options,
 
       //interpolate forcing values from gauges
       //-------------------------------------------------------------------
-      for(g = 0; g < _nGauges; g++)
+      if(!(pre_gridded || snow_gridded || rain_gridded))
       {
-        wt=_aGaugeWtPrecip[k][g];
-        if(wt != 0.0) {
-          if(!(pre_gridded || snow_gridded || rain_gridded))
-          {
-            F.precip           += wt * Fg[g].precip;
-            F.precip_daily_ave += wt * Fg[g].precip_daily_ave;
-            F.precip_5day      += wt * Fg[g].precip_5day;
-            F.snow_frac        += wt * Fg[g].snow_frac;
-            ref_elev_precip    += wt * _pGauges[g]->GetElevation();
-          }
-        }
-        wt=_aGaugeWtTemp[k][g];
-        if(wt != 0.0) {
-          if(!(temp_ave_gridded || (temp_daily_min_gridded && temp_daily_max_gridded) || temp_daily_ave_gridded))
-          {
-            F.temp_ave         += wt * Fg[g].temp_ave;
-            F.temp_daily_ave   += wt * Fg[g].temp_daily_ave;
-            F.temp_daily_min   += wt * Fg[g].temp_daily_min;
-            F.temp_daily_max   += wt * Fg[g].temp_daily_max;
-            F.temp_month_min   += wt * Fg[g].temp_month_min;
-            F.temp_month_max   += wt * Fg[g].temp_month_max;
-            F.temp_month_ave   += wt * Fg[g].temp_month_ave;
-            ref_elev_temp      += wt * _pGauges[g]->GetElevation();
-          }
+        for(j=_GaugeWtsPrecip.aStart[k]; j<_GaugeWtsPrecip.aStart[k+1]; j++)
+        {
+          g=_GaugeWtsPrecip.aGauge[j]; wt=_GaugeWtsPrecip.aWt[j];
+          F.precip           += wt * Fg[g].precip;
+          F.precip_daily_ave += wt * Fg[g].precip_daily_ave;
+          F.precip_5day      += wt * Fg[g].precip_5day;
+          F.snow_frac        += wt * Fg[g].snow_frac;
+          ref_elev_precip    += wt * _pGauges[g]->GetElevation();
         }
-        wt=_aGaugeWeights[k][g];
-        if(wt != 0.0) {
-          F.rel_humidity   += wt * Fg[g].rel_humidity;
-          F.air_pres       += wt * Fg[g].air_pres;
-          F.air_dens       += wt * Fg[g].air_dens;
-          F.wind_vel       += wt * Fg[g].wind_vel;
-          F.cloud_cover    += wt * Fg[g].cloud_cover;
-          F.ET_radia       += wt * Fg[g].ET_radia;
-          F.LW_incoming    += wt * Fg[g].LW_incoming;
-          F.LW_radia_net   += wt * Fg[g].LW_radia_net;
-          F.SW_radia       += wt * Fg[g].SW_radia;
-          F.SW_radia_net   += wt * Fg[g].SW_radia_net;
-          F.SW_radia_subcan+= wt * Fg[g].SW_radia_subcan;
-          F.SW_subcan_net  += wt * Fg[g].SW_subcan_net;
-          F.PET_month_ave  += wt * Fg[g].PET_month_ave;
-          F.potential_melt += wt * Fg[g].potential_melt;
-          F.PET            += wt * Fg[g].PET;
-          F.OW_PET         += wt * Fg[g].OW_PET;
-          F.recharge       += wt * Fg[g].recharge;
-          F.precip_temp    += wt * Fg[g].precip_temp;
-          F.precip_conc    += wt * Fg[g].precip_conc;
-          F.irrigation     += wt * Fg[g].irrigation;
-          ref_measurement_ht+=wt*_pGauges[g]->GetMeasurementHt();
+      }
+      if(!(temp_ave_gridded || (temp_daily_min_gridded && temp_daily_max_gridded) || temp_daily_ave_gridded))
+      {
+        for(j=_GaugeWtsTemp.aStart[k]; j<_GaugeWtsTemp.aStart[k+1]; j++)
+        {
+          g=_GaugeWtsTemp.aGauge[j]; wt=_GaugeWtsTemp.aWt[j];
+          F.temp_ave         += wt * Fg[g].temp_ave;
+          F.temp_daily_ave   += wt * Fg[g].temp_daily_ave;
+          F.temp_daily_min   += wt * Fg[g].temp_daily_min;
+          F.temp_daily_max   += wt * Fg[g].temp_daily_max;
+          F.temp_month_min   += wt * Fg[g].temp_month_min;
+          F.temp_month_max   += wt * Fg[g].temp_month_max;
+          F.temp_month_ave   += wt * Fg[g].temp_month_ave;
+          ref_elev_temp      += wt * _pGauges[g]->GetElevation();
         }
       }
+      for(j=_GaugeWts.aStart[k]; j<_GaugeWts.aStart[k+1]; j++)
+      {
+        g=_GaugeWts.aGauge[j]; wt=_GaugeWts.aWt[j];
+        F.rel_humidity   += wt * Fg[g].rel_humidity;
+        F.air_pres       += wt * Fg[g].air_pres;
+        F.air_dens       += wt * Fg[g].air_dens;
+        F.wind_vel       += wt * Fg[g].wind_vel;
+        F.cloud_cover    += wt * Fg[g].cloud_cover;
+        F.ET_radia       += wt * Fg[g].ET_radia;
+        F.LW_incoming    += wt * Fg[g].LW_incoming;
+        F.LW_radia_net   += wt * Fg[g].LW_radia_net;
+        F.SW_radia       += wt * Fg[g].SW_radia;
+        F.SW_radia_net   += wt * Fg[g].SW_radia_net;
+        F.SW_radia_subcan+= wt * Fg[g].SW_radia_subcan;
+        F.SW_subcan_net  += wt * Fg[g].SW_subcan_net;
+        F.PET_month_ave  += wt * Fg[g].PET_month_ave;
+        F.potential_melt += wt * Fg[g].potential_melt;
+        F.PET            += wt * Fg[g].PET;
+        F.OW_PET         += wt * Fg[g].OW_PET;
+        F.recharge       += wt * Fg[g].recharge;
+        F.precip_temp    += wt * Fg[g].precip_temp;
+        F.precip_conc    += wt * Fg[g].precip_conc;
+        F.irrigation     += wt * Fg[g].irrigation;
+        ref_measurement_ht+=wt*_pGauges[g]->GetMeasurementHt();
+      }
 
       // if in BMI without RVT file, precip and temp values are expected to have been given before this point
       if (Options.use_bmi_weather) {
@@ -442,10 +459,11 @@ void CModel::UpdateHRUForcingFunctions(const optStruct &Options,
       {
         double gauge_corr;
         F.temp_ave = F.temp_daily_ave = F.temp_daily_max = F.temp_daily_min = 0.0; // leave out monthly for now
-        for (g = 0; g < _nGauges; g++)
+        for (j = _GaugeWtsTemp.aStart[k]; j < _GaugeWtsTemp.aStart[k+1]; j++)
         {
+          g  = _GaugeWtsTemp.aGauge[j];
+          wt = _GaugeWtsTemp.aWt[j];
           gauge_corr = tc + _pGauges[g]->GetTemperatureCorr();
-          wt = _aGaugeWtTemp[k][g];
 
           F.temp_ave       += wt * (gauge_corr + Fg[g].temp_ave);
           F.temp_daily_ave += wt * (gauge_corr + Fg[g].temp_daily_ave);
@@ -516,10 +534,11 @@ void CModel::UpdateHRUForcingFunctions(const optStruct &Options,
         F.precip=F.precip_5day=F.precip_daily_ave=0.0;
         if (!Options.use_bmi_weather) {
           // Gauge-based precip and snowfall correction
-          for(g=0; g<_nGauges; g++)
+          for(j=_GaugeWtsPrecip.aStart[k]; j<_GaugeWtsPrecip.aStart[k+1]; j++)
           {
+            g =_GaugeWtsPrecip.aGauge[j];
+            wt=_GaugeWtsPrecip.aWt[j];
             gauge_corr= F.snow_frac*sc*_pGauges[g]->GetSnowfallCorr() + (1.0-F.snow_frac)*rc*_pGauges[g]->GetRainfallCorr();
-            wt=_aGaugeWtPrecip[k][g];
             F.precip         += wt*gauge_corr*Fg[g].precip;
             F.precip_daily_ave+=wt*gauge_corr*Fg[g].precip_daily_ave;
             F.precip_5day    += wt*gauge_corr*Fg[g].precip_5day;
@@ -664,6 +683,29 @@ void CModel::UpdateHRUForcingFunctions(const optStruct &Options,
   }
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief Returns geometric shortwave radiation terms of HRU k for the current time step
+/// \details Terms are calculated once per time step for each solar geometry class
+///  (HRUs with identical latitude, slope and aspect) and cached
+///
+/// \param k [in] global HRU index
+/// \param *F [in] forcing functions of HRU k (day angle and day length must be current)
+/// \param Options [in] global options structure
+/// \param tt [in] current time structure
+/// \return pointer to solar geometry class of HRU k
+//
+const solar_geom *CModel::GetSolarGeometry(const int          k,
+                                           const force_struct *F,
+                                           const optStruct   &Options,
+                                           const time_struct &tt)
+{
+  solar_geom *pS=&(_aSolarClasses[_aSolarClassIndex[k]]);
+  if (pS->t_cached!=tt.model_time){
+    CRadiation::UpdateSolarGeometry(*pS,F,Options,tt);
+  }
+  return pS;
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Estimates air pressure given elevation [kPa]
 /// \param method [in] Method of calculating air pressure
@@ -921,9 +963,10 @@ double CModel::EstimateCloudCover  (const optStruct &Options,
     double range=(F.temp_max_unc-F.temp_min_unc); //uses uncorrected station temperature
     double cloud_min_range(0.0),cloud_max_range(0.0);
 
-    for (int g=0;g<_nGauges;g++){
-      cloud_min_range+=_aGaugeWtTemp[k][g]*_pGauges[g]->GetCloudMinRange();//[C] A0FOGY in UBC_WM
-      cloud_max_range+=_aGaugeWtTemp[k][g]*_pGauges[g]->GetCloudMaxRange();//[C] A0SUNY in UBC_WM
+    for (int j=_GaugeWtsTemp.aStart[k];j<_GaugeWtsTemp.aStart[k+1];j++){
+      int g=_GaugeWtsTemp.aGauge[j];
+      cloud_min_range+=_GaugeWtsTemp.aWt[j]*_pGauges[g]->GetCloudMinRange();//[C] A0FOGY in UBC_WM
+      cloud_max_range+=_GaugeWtsTemp.aWt[j]*_pGauges[g]->GetCloudMaxRange();//[C] A0SUNY in UBC_WM
     }
     cover=1.0-(range-cloud_min_range)/(cloud_max_range-cloud_min_range);
     lowerswap(cover,1.0);
@@ -1003,13 +1046,17 @@ double CModel::CalculateSubDailyCorrection(const force_struct &F,
 
       start_of_day=floor(tt_tmp.model_time+time_shift);
       ZeroOutForcings(Ftmp);
-      for (int g=0;g<_nGauges;g++)
+      for (int j=_GaugeWtsPrecip.aStart[k];j<_GaugeWtsPrecip.aStart[k+1];j++)
       {
-        Ftmp.precip_daily_ave+=_aGaugeWtPrecip[k][g]*_pGauges[g]->GetForcingValue(F_PRECIP,start_of_day,1);
-
-        Ftmp.temp_ave        +=_aGaugeWtTemp[k][g]*_pGauges[g]->GetForcingValue(F_TEMP_AVE,nnn);
-        Ftmp.temp_daily_max  +=_aGaugeWtTemp[k][g]*_pGauges[g]->GetForcingValue(F_TEMP_DAILY_MAX,nnn);
-        Ftmp.temp_daily_min  +=_aGaugeWtTemp[k][g]*_pGauges[g]->GetForcingValue(F_TEMP_DAILY_MIN,nnn);
+        int g=_GaugeWtsPrecip.aGauge[j];
+        Ftmp.precip_daily_ave+=_GaugeWtsPrecip.aWt[j]*_pGauges[g]->GetForcingValue(F_PRECIP,start_of_day,1);
+      }
+      for (int j=_GaugeWtsTemp.aStart[k];j<_GaugeWtsTemp.aStart[k+1];j++)
+      {
+        int g=_GaugeWtsTemp.aGauge[j];
+        Ftmp.temp_ave        +=_GaugeWtsTemp.aWt[j]*_pGauges[g]->GetForcingValue(F_TEMP_AVE,nnn);
+        Ftmp.temp_daily_max  +=_GaugeWtsTemp.aWt[j]*_pGauges[g]->GetForcingValue(F_TEMP_DAILY_MAX,nnn);
+        Ftmp.temp_daily_min  +=_GaugeWtsTemp.aWt[j]*_pGauges[g]->GetForcingValue(F_TEMP_DAILY_MIN,nnn);
       }
       CorrectTemp(Options,Ftmp,elev,ref_elev_temp,tt_tmp);
       sum+=max(Ftmp.temp_ave,0.0);